@@ -8,28 +8,123 @@
 
 #include "../base/bnd_utils.h"
 #include "../base/brep_utils.h"
+#include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
+#include "../base/document.h"
 #include "../base/io_reader.h"
 #include "../base/io_writer.h"
 #include "../base/io_system.h"
+#include "../base/label_data.h"
+#include "../base/math_utils.h"
+#include "../base/mesh_utils.h"
+#include "../base/part_deduplication.h"
 #include "../base/settings.h"
+#include "../base/task_progress.h"
+#include "../base/triangulation_annex_data.h"
+#include "../base/unit_system.h"
+#include "../base/xcaf.h"
 #include "../gui/gui_application.h"
 #include "../gui/gui_document.h"
 #include "qtcore_utils.h"
+#include "qtgui_utils.h"
 #include "filepath_conv.h"
 #include "qstring_conv.h"
+#include "theme.h"
 
 #include <BRepBndLib.hxx>
+#include <BRep_Tool.hxx>
+#include <TopoDS.hxx>
 
 #include <QtCore/QDir>
 #include <QtCore/QtDebug>
 #include <QtGui/QGuiApplication>
 
 #include <fmt/format.h>
+#include <functional>
 #include <iterator>
+#include <unordered_set>
 
 namespace Mayo {
 
+namespace {
+
+// Cleans up the triangulations of the mesh parts(faces without surface) located below 'label'
+// Returns the count of merged mesh nodes
+int cleanupMeshParts(const TDF_Label& label, const MeshUtils::CleanupOptions& options, TaskProgress* progress)
+{
+    std::vector<TDF_Label> vecPart;
+    std::unordered_set<TDF_Label> setVisited;
+    std::function<void(const TDF_Label&)> fnCollectParts = [&](const TDF_Label& lbl) {
+        const TDF_Label product = XCaf::isShapeReference(lbl) ? XCaf::shapeReferred(lbl) : lbl;
+        if (!setVisited.insert(product).second)
+            return;
+
+        if (XCaf::isShapeAssembly(product)) {
+            for (const TDF_Label& component : XCaf::shapeComponents(product))
+                fnCollectParts(component);
+        }
+        else {
+            const LabelDataFlags flags = findLabelDataFlags(product);
+            if ((flags & LabelData_ShapeIsFace) && !(flags & LabelData_ShapeIsGeometricFace))
+                vecPart.push_back(product);
+        }
+    };
+    fnCollectParts(label);
+
+    int mergedNodeCount = 0;
+    bool isShapeModified = false;
+    for (const TDF_Label& part : vecPart) {
+        if (TaskProgress::isAbortRequested(progress))
+            break;
+
+        const TopoDS_Face face = TopoDS::Face(XCaf::shape(part));
+        TopLoc_Location locFace;
+        const Handle(Poly_Triangulation)& mesh = BRep_Tool::Triangulation(face, locFace);
+        // Nodes of different colors aren't merged
+        auto annexData = CafUtils::findAttribute<TriangulationAnnexData>(part);
+        const Span<const Quantity_Color> spanNodeColor =
+                annexData ? annexData->nodeColors() : Span<const Quantity_Color>{};
+        MeshUtils::CleanupOptions partOptions = options;
+        if (!spanNodeColor.empty()) {
+            partOptions.fnCanMergeNodes = [=](int i, int j) {
+                return spanNodeColor[i].IsEqual(spanNodeColor[j]);
+            };
+        }
+
+        MeshUtils::CleanupResult result;
+        const Handle(Poly_Triangulation) newMesh = MeshUtils::cleanup(mesh, partOptions, &result);
+        if (newMesh != mesh) {
+            TopoDS_Face newFace = BRepUtils::makeFace(newMesh);
+            newFace.Location(face.Location());
+            Document::findFrom(part)->xcaf().setShape(part, newFace);
+            isShapeModified = true;
+            mergedNodeCount += result.mergedNodeCount;
+
+            // Node colors follow the new node numbering
+            if (!spanNodeColor.empty()) {
+                std::vector<Quantity_Color> vecNodeColor;
+                vecNodeColor.reserve(result.sourceNodes.size());
+                for (int inode : result.sourceNodes)
+                    vecNodeColor.push_back(spanNodeColor[inode]);
+
+                TriangulationAnnexData::Set(part, std::move(vecNodeColor));
+            }
+        }
+
+        if (progress) {
+            const auto ipart = &part - &vecPart.front();
+            progress->setValue(MathUtils::toPercent(ipart + 1, 0, vecPart.size()));
+        }
+    }
+
+    if (isShapeModified && XCaf::isShapeAssembly(label))
+        Document::findFrom(label)->xcaf().shapeTool()->UpdateAssemblies();
+
+    return mergedNodeCount;
+}
+
+} // namespace
+
 AppModule::AppModule()
     : m_settings(new Settings),
       m_props(m_settings),
@@ -43,6 +138,14 @@ AppModule::AppModule()
     }
 
     m_settings->setPropertyValueConversion(this);
+    m_thumbnailTaskMgr.signalEnded.connectSlot([=](TaskId taskId) {
+        auto itFound = m_mapThumbnailTaskFilepath.find(taskId);
+        if (itFound != m_mapThumbnailTaskFilepath.end()) {
+            const FilePath fp = itFound->second;
+            m_mapThumbnailTaskFilepath.erase(itFound);
+            this->signalRecentFileThumbnailRecorded.send(fp);
+        }
+    });
 }
 
 QStringUtils::TextOptions AppModule::defaultTextOptions() const
@@ -213,16 +316,20 @@ void AppModule::recordRecentFileThumbnail(GuiDocument* guiDoc)
     if (!recentFile->isThumbnailOutOfSync())
         return;
 
-    RecentFile newRecentFile = *recentFile;
-    const bool okRecord = newRecentFile.recordThumbnail(guiDoc, this->recentFileThumbnailSize());
-    if (!okRecord)
+    // Graphics scene of the document is rendered here(GUI thread), its presentations being reused
+    // Only image encoding and saving go in background
+    const RecentFile taskRecentFile = *recentFile;
+    const Handle_Image_AlienPixMap pixmap = taskRecentFile.renderThumbnail(
+                guiDoc, this->recentFileThumbnailParameters()
+    );
+    if (!pixmap)
         return;
 
-    const RecentFiles& listRecentFile = m_props.recentFiles.value();
-    RecentFiles newListRecentFile = listRecentFile;
-    const auto indexRecentFile = std::distance(&listRecentFile.front(), recentFile);
-    newListRecentFile.at(indexRecentFile) = newRecentFile;
-    m_props.recentFiles.setValue(newListRecentFile);
+    const TaskId taskId = m_thumbnailTaskMgr.newTask([=](TaskProgress*) {
+        taskRecentFile.saveThumbnail(pixmap);
+    });
+    m_mapThumbnailTaskFilepath.insert({ taskId, taskRecentFile.filepath });
+    m_thumbnailTaskMgr.run(taskId);
 }
 
 void AppModule::recordRecentFileThumbnails(GuiApplication* guiApp)
@@ -230,21 +337,19 @@ void AppModule::recordRecentFileThumbnails(GuiApplication* guiApp)
     if (!guiApp)
         return;
 
-    const RecentFiles& listRecentFile = m_props.recentFiles.value();
-    RecentFiles newListRecentFile = listRecentFile;
-    for (GuiDocument* guiDoc : guiApp->guiDocuments()) {
-        const RecentFile* recentFile = this->findRecentFile(guiDoc->document()->filePath());
-        if (!recentFile || !recentFile->isThumbnailOutOfSync())
-            continue; // Skip
-
-        RecentFile newRecentFile = *recentFile;
-        if (newRecentFile.recordThumbnail(guiDoc, this->recentFileThumbnailSize())) {
-            auto indexRecentFile = std::distance(&listRecentFile.front(), recentFile);
-            newListRecentFile.at(indexRecentFile) = newRecentFile;
-        }
-    }
+    for (GuiDocument* guiDoc : guiApp->guiDocuments())
+        this->recordRecentFileThumbnail(guiDoc);
+
+    m_thumbnailTaskMgr.foreachTask([=](TaskId taskId) { m_thumbnailTaskMgr.waitForDone(taskId); });
+}
 
-    m_props.recentFiles.setValue(newListRecentFile);
+IO::ImageWriter::Parameters AppModule::recentFileThumbnailParameters() const
+{
+    IO::ImageWriter::Parameters params;
+    params.width = this->recentFileThumbnailSize().width();
+    params.height = this->recentFileThumbnailSize().height();
+    params.backgroundColor = QtGuiUtils::toPreferredColorSpace(mayoTheme()->color(Theme::Color::Palette_Window));
+    return params;
 }
 
 static QuantityLength shapeChordalDeflection(const TopoDS_Shape& shape)
@@ -320,6 +425,42 @@ void AppModule::computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* prog
         this->computeBRepMesh(XCaf::shape(labelEntity), progress);
 }
 
+void AppModule::postProcessImportedEntity(const TDF_Label& labelEntity, TaskProgress* progress)
+{
+    const bool isMeshCleanupOn = m_props.importMeshCleanup.value();
+    if (isMeshCleanupOn) {
+        TaskProgress cleanupProgress(progress, 20, textIdTr("Clean up meshes"));
+        MeshUtils::CleanupOptions options;
+        options.weldTolerance = UnitSystem::millimeters(m_props.importMeshWeldTolerance.quantity());
+        options.reorderForLocality = true;
+        const int mergedNodeCount = cleanupMeshParts(labelEntity, options, &cleanupProgress);
+        if (mergedNodeCount > 0)
+            this->emitInfo(fmt::format(textIdTr("{} duplicated mesh nodes merged"), mergedNodeCount));
+    }
+
+    const bool isDeduplicationOn = m_props.importDeduplicateParts.value();
+    if (isDeduplicationOn) {
+        TaskProgress dedupProgress(progress, 30, textIdTr("Merge identical parts"));
+        const PartDeduplication::Result result = PartDeduplication::run(labelEntity, {}, &dedupProgress);
+        if (result.mergedPartCount > 0) {
+            this->emitInfo(fmt::format(
+                               textIdTr("{} identical parts replaced by instances, out of {} parts"),
+                               result.mergedPartCount, result.partCount
+            ));
+        }
+    }
+
+    const int meshProgressSize = 100 - (isMeshCleanupOn ? 20 : 0) - (isDeduplicationOn ? 30 : 0);
+    TaskProgress meshProgress(progress, meshProgressSize);
+    this->computeBRepMesh(labelEntity, &meshProgress);
+}
+
+bool AppModule::isImportPostProcessRequired(IO::Format format) const
+{
+    return IO::formatProvidesBRep(format)
+            || (IO::formatProvidesMesh(format) && m_props.importMeshCleanup.value());
+}
+
 void AppModule::addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr)
 {
     m_vecDocTreeNodePropsProvider.push_back(std::move(ptr));
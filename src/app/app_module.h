@@ -16,10 +16,13 @@
 #include "../base/occ_brep_mesh_parameters.h"
 #include "../base/property_value_conversion.h"
 #include "../base/settings.h"
+#include "../base/task_manager.h"
 #include "../base/unit_system.h"
 
 #include <locale>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 class TDF_Label;
 class TopoDS_Shape;
@@ -80,15 +83,25 @@ public:
     // Recent files
     void prependRecentFile(const FilePath& fp);
     const RecentFile* findRecentFile(const FilePath& fp) const;
+    // Thumbnail is rendered from the graphics scene of 'guiDoc', then saved in background
+    // signalRecentFileThumbnailRecorded is emitted once saved
     void recordRecentFileThumbnail(GuiDocument* guiDoc);
+    // Records the thumbnails of all documents, then waits for all the thumbnails being saved
     void recordRecentFileThumbnails(GuiApplication* guiApp);
     QSize recentFileThumbnailSize() const { return { 190, 150 }; }
+    Signal<const FilePath&> signalRecentFileThumbnailRecorded;
 
     // Meshing of BRep shapes
     OccBRepMeshParameters brepMeshParameters(const TopoDS_Shape& shape) const;
     void computeBRepMesh(const TopoDS_Shape& shape, TaskProgress* progress = nullptr);
     void computeBRepMesh(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
 
+    // Post-processing of entities just imported: cleanup of meshes and merging of identical
+    // parts(if enabled in properties) and then meshing of BRep shapes
+    void postProcessImportedEntity(const TDF_Label& labelEntity, TaskProgress* progress = nullptr);
+    // Whether postProcessImportedEntity() has to be called for entities read from 'format' files
+    bool isImportPostProcessRequired(IO::Format format) const;
+
     // Providers to query document tree node properties
     void addPropertiesProvider(std::unique_ptr<DocumentTreeNodePropertiesProvider> ptr);
     std::unique_ptr<PropertyGroupSignals> properties(const DocumentTreeNode& treeNode) const;
@@ -113,6 +126,8 @@ private:
     AppModule(const AppModule&) = delete; // Not copyable
     AppModule& operator=(const AppModule&) = delete; // Not copyable
 
+    IO::ImageWriter::Parameters recentFileThumbnailParameters() const;
+
     Settings* m_settings = nullptr;
     IO::System m_ioSystem;
     AppModuleProperties m_props;
@@ -121,6 +136,8 @@ private:
     std::locale m_stdLocale;
     QLocale m_qtLocale;
     std::vector<std::unique_ptr<DocumentTreeNodePropertiesProvider>> m_vecDocTreeNodePropsProvider;
+    TaskManager m_thumbnailTaskMgr;
+    std::unordered_map<TaskId, FilePath> m_mapThumbnailTaskFilepath;
 };
 
 } // namespace Mayo
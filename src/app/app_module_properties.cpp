@@ -6,6 +6,7 @@
 
 #include "app_module_properties.h"
 #include "app_module.h"
+#include "io_worker_process.h"
 
 #include "../base/io_reader.h"
 #include "../base/io_writer.h"
@@ -46,8 +47,13 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
     settings->addSetting(&this->lastOpenDir, groupId_application);
     settings->addSetting(&this->lastSelectedFormatFilter, groupId_application);
     settings->addSetting(&this->linkWithDocumentSelector, groupId_application);
+    settings->addSetting(&this->importInWorkerProcesses, groupId_application);
+    settings->addSetting(&this->importDeduplicateParts, groupId_application);
+    settings->addSetting(&this->importMeshCleanup, groupId_application);
+    settings->addSetting(&this->importMeshWeldTolerance, groupId_application);
     this->recentFiles.setUserVisible(false);
     this->lastOpenDir.setUserVisible(false);
+    this->importInWorkerProcesses.setEnabled(IO::WorkerProcessFactoryReader::isSupported());
     this->lastSelectedFormatFilter.setUserVisible(false);
 
     // Meshing
@@ -56,11 +62,20 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
     settings->addSetting(&this->meshingChordalDeflection, groupId_meshing);
     settings->addSetting(&this->meshingAngularDeflection, groupId_meshing);
     settings->addSetting(&this->meshingRelative, groupId_meshing);
+    settings->addSetting(&this->meshingLevelsOfDetail, groupId_meshing);
 
     // Graphics
     settings->addSetting(&this->navigationStyle, groupId_graphics);
     settings->addSetting(&this->defaultShowOriginTrihedron, groupId_graphics);
     settings->addSetting(&this->instantZoomFactor, groupId_graphics);
+    settings->addSetting(&this->navigationCullingSize, groupId_graphics);
+    this->navigationCullingSize.setRange(0, 100);
+    this->navigationCullingSize.setSingleStep(1);
+    this->navigationCullingSize.setConstraintsEnabled(true);
+    settings->addSetting(&this->pointCloudMaxPointCount, groupId_graphics);
+    this->pointCloudMaxPointCount.setRange(1, 500);
+    this->pointCloudMaxPointCount.setSingleStep(1);
+    this->pointCloudMaxPointCount.setConstraintsEnabled(true);
     // -- Clip planes
     settings->addSetting(&this->clipPlanesCappingOn, sectionId_graphicsClipPlanes);
     settings->addSetting(&this->clipPlanesCappingHatchOn, sectionId_graphicsClipPlanes);
@@ -70,6 +85,14 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
     settings->addSetting(&this->meshDefaultsMaterial, sectionId_graphicsMeshDefaults);
     settings->addSetting(&this->meshDefaultsShowEdges, sectionId_graphicsMeshDefaults);
     settings->addSetting(&this->meshDefaultsShowNodes, sectionId_graphicsMeshDefaults);
+    settings->addSetting(&this->meshDefaultsMaxTriangleCount, sectionId_graphicsMeshDefaults);
+    this->meshDefaultsMaxTriangleCount.setRange(0, 100000);
+    this->meshDefaultsMaxTriangleCount.setSingleStep(100);
+    this->meshDefaultsMaxTriangleCount.setConstraintsEnabled(true);
+    settings->addSetting(&this->meshDefaultsPreviewTriangleCount, sectionId_graphicsMeshDefaults);
+    this->meshDefaultsPreviewTriangleCount.setRange(0, 100000);
+    this->meshDefaultsPreviewTriangleCount.setSingleStep(100);
+    this->meshDefaultsPreviewTriangleCount.setConstraintsEnabled(true);
 
     // Register reset functions
     settings->addResetFunction(sectionId_systemUnits, [=]{
@@ -82,17 +105,24 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
         this->lastOpenDir.setValue({});
         this->lastSelectedFormatFilter.setValue({});
         this->linkWithDocumentSelector.setValue(true);
+        this->importInWorkerProcesses.setValue(false);
+        this->importDeduplicateParts.setValue(false);
+        this->importMeshCleanup.setValue(false);
+        this->importMeshWeldTolerance.setQuantity(0 * Quantity_Millimeter);
     });
     settings->addResetFunction(groupId_graphics, [=]{
         this->navigationStyle.setValue(WidgetOccViewController::NavigationStyle::Mayo);
         this->defaultShowOriginTrihedron.setValue(true);
         this->instantZoomFactor.setValue(5.);
+        this->navigationCullingSize.setValue(6);
+        this->pointCloudMaxPointCount.setValue(10);
     });
     settings->addResetFunction(groupId_meshing, [&]{
         this->meshingQuality.setValue(BRepMeshQuality::Normal);
         this->meshingChordalDeflection.setQuantity(1 * Quantity_Millimeter);
         this->meshingAngularDeflection.setQuantity(20 * Quantity_Degree);
         this->meshingRelative.setValue(false);
+        this->meshingLevelsOfDetail.setValue(false);
     });
     settings->addResetFunction(sectionId_graphicsClipPlanes, [=]{
         this->clipPlanesCappingOn.setValue(true);
@@ -105,6 +135,8 @@ AppModuleProperties::AppModuleProperties(Settings* settings)
         this->meshDefaultsMaterial.setValue(meshDefaults.material);
         this->meshDefaultsShowEdges.setValue(meshDefaults.showEdges);
         this->meshDefaultsShowNodes.setValue(meshDefaults.showNodes);
+        this->meshDefaultsMaxTriangleCount.setValue(meshDefaults.maxTriangleCount / 1000);
+        this->meshDefaultsPreviewTriangleCount.setValue(meshDefaults.previewTriangleCount / 1000);
     });
 }
 
@@ -152,6 +184,21 @@ void AppModuleProperties::retranslate()
     this->linkWithDocumentSelector.setDescription(
                 textIdTr("In case where multiple documents are opened, make sure the document displayed in "
                          "the 3D view corresponds to what is selected in the model tree"));
+    this->importInWorkerProcesses.setDescription(
+                textIdTr("STEP/IGES files are read within separate processes, so multiple files can be "
+                         "imported really in parallel. Requires OpenCascade >= v7.6.0"));
+    this->importDeduplicateParts.setDescription(
+                textIdTr("After import of BRep shapes, parts having the same geometry are replaced by "
+                         "instances of a single part. This reduces memory usage, meshing time and count "
+                         "of graphics objects for assemblies exported as many separate copies of the "
+                         "same parts(eg screws)"));
+    this->importMeshCleanup.setDescription(
+                textIdTr("After import of mesh files, coincident nodes are merged and degenerate triangles "
+                         "are removed. Triangles are also reordered so they are stored close to their "
+                         "neighbours, which speeds up display"));
+    this->importMeshWeldTolerance.setDescription(
+                textIdTr("Mesh nodes closer than this distance are merged, only exactly coincident nodes "
+                         "are merged if zero"));
     this->meshingQuality.setDescription(
                 textIdTr("Controls precision of the mesh to be computed from the BRep shape"));
     this->meshingChordalDeflection.setDescription(
@@ -165,8 +212,29 @@ void AppModuleProperties::retranslate()
                          "If activated, deflection used for the polygonalisation of each edge will be "
                          "`ChordalDeflection` &#215; `SizeOfEdge`. The deflection used for the faces will be "
                          "the maximum deflection of their edges."));
+    this->meshingLevelsOfDetail.setDescription(
+                textIdTr("Display coarser or finer meshes of BRep shapes depending on their size in the 3D view\n\n"
+                         "Additional meshes are computed in background when needed. They are used for display "
+                         "only, meshes of the document(eg exported ones) aren't affected"));
     this->navigationStyle.setDescription(
                 textIdTr("3D view manipulation shortcuts configuration to mimic other common CAD applications"));
+    this->navigationCullingSize.setDescription(
+                textIdTr("Objects whose size in the 3D view is below this value(in pixels) aren't drawn "
+                         "while the view is rotated, panned or zoomed. Value 0 disables this behavior"));
+    this->pointCloudMaxPointCount.setDescription(
+                textIdTr("Maximum count of points(in millions) displayed for a big point cloud\n\n"
+                         "Displayed points are coarser while the view is moved, then progressively refined "
+                         "up to this count once the view is idle"));
+    this->meshDefaultsMaxTriangleCount.setDescription(
+                textIdTr("Maximum count of triangles(in thousands) displayed for a mesh, bigger meshes(eg "
+                         "scans) are simplified in background for display, a preview being shown meanwhile. "
+                         "No limit if zero\n\n"
+                         "This doesn't affect meshes already displayed, nor exported meshes"));
+    this->meshDefaultsPreviewTriangleCount.setDescription(
+                textIdTr("Meshes having more triangles(in thousands) are first displayed with a coarse "
+                         "preview, so they can be inspected without waiting. Full resolution is then "
+                         "prepared in background and replaces the preview once ready. Disabled if zero\n\n"
+                         "Pending meshes can be left with their preview using command \"Stop Loading Meshes\""));
     this->defaultShowOriginTrihedron.setDescription(
                 textIdTr("Show or hide by default the trihedron centered at world origin. "
                          "This doesn't affect 3D view of currently opened documents"));
@@ -182,7 +250,9 @@ void AppModuleProperties::onPropertyChanged(Property* prop)
             || prop == &this->meshDefaultsEdgeColor
             || prop == &this->meshDefaultsMaterial
             || prop == &this->meshDefaultsShowEdges
-            || prop == &this->meshDefaultsShowNodes)
+            || prop == &this->meshDefaultsShowNodes
+            || prop == &this->meshDefaultsMaxTriangleCount
+            || prop == &this->meshDefaultsPreviewTriangleCount)
     {
         auto values = GraphicsMeshObjectDriver::defaultValues();
         values.color = this->meshDefaultsColor.value();
@@ -190,6 +260,8 @@ void AppModuleProperties::onPropertyChanged(Property* prop)
         values.material = static_cast<Graphic3d_NameOfMaterial>(this->meshDefaultsMaterial.value());
         values.showEdges = this->meshDefaultsShowEdges.value();
         values.showNodes = this->meshDefaultsShowNodes.value();
+        values.maxTriangleCount = 1000 * this->meshDefaultsMaxTriangleCount.value();
+        values.previewTriangleCount = 1000 * this->meshDefaultsPreviewTriangleCount.value();
         GraphicsMeshObjectDriver::setDefaultValues(values);
     }
     else if (prop == &this->meshingQuality) {
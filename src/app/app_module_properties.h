@@ -52,16 +52,23 @@ public:
     PropertyFilePath lastOpenDir{ this, textId("lastOpenFolder") };
     PropertyString lastSelectedFormatFilter{ this, textId("lastSelectedFormatFilter") };
     PropertyBool linkWithDocumentSelector{ this, textId("linkWithDocumentSelector") };
+    PropertyBool importInWorkerProcesses{ this, textId("importInWorkerProcesses") };
+    PropertyBool importDeduplicateParts{ this, textId("importDeduplicateParts") };
+    PropertyBool importMeshCleanup{ this, textId("importMeshCleanup") };
+    PropertyLength importMeshWeldTolerance{ this, textId("importMeshWeldTolerance") };
     // Meshing
     enum class BRepMeshQuality { VeryCoarse, Coarse, Normal, Precise, VeryPrecise, UserDefined };
     PropertyEnum<BRepMeshQuality> meshingQuality{ this, textId("meshingQuality") };
     PropertyLength meshingChordalDeflection{ this, textId("meshingChordalDeflection") };
     PropertyAngle meshingAngularDeflection{ this, textId("meshingAngularDeflection") };
     PropertyBool meshingRelative{ this, textId("meshingRelative") };
+    PropertyBool meshingLevelsOfDetail{ this, textId("meshingLevelsOfDetail") };
     // Graphics
     PropertyEnum<WidgetOccViewController::NavigationStyle> navigationStyle{ this, textId("navigationStyle") };
     PropertyBool defaultShowOriginTrihedron{ this, textId("defaultShowOriginTrihedron") };
     PropertyDouble instantZoomFactor{ this, textId("instantZoomFactor") };
+    PropertyInt navigationCullingSize{ this, textId("navigationCullingSize") };
+    PropertyInt pointCloudMaxPointCount{ this, textId("pointCloudMaxPointCount") }; // In millions
     // -- Graphics/ClipPlanes
     PropertyBool clipPlanesCappingOn{ this, textId("cappingOn") };
     PropertyBool clipPlanesCappingHatchOn{ this, textId("cappingHatchOn") };
@@ -71,6 +78,8 @@ public:
     PropertyEnumeration meshDefaultsMaterial{ this, textId("material"), &OcctEnums::Graphic3d_NameOfMaterial() };
     PropertyBool meshDefaultsShowEdges{ this, textId("showEgesOn") };
     PropertyBool meshDefaultsShowNodes{ this, textId("showNodesOn") };
+    PropertyInt meshDefaultsMaxTriangleCount{ this, textId("maxTriangleCount") }; // In thousands
+    PropertyInt meshDefaultsPreviewTriangleCount{ this, textId("previewTriangleCount") }; // In thousands
 
 protected:
     // -- from PropertyGroup
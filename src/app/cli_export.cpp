@@ -13,6 +13,7 @@
 #include "../base/io_system.h"
 #include "../base/messenger.h"
 #include "../base/task_manager.h"
+#include "../io_image/io_image.h"
 
 #include <Message.hxx>
 
@@ -24,6 +25,7 @@
 #include <iomanip>
 #include <iostream>
 #include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
@@ -163,6 +165,50 @@ void exportDocument(const DocumentPtr& doc, const FilePath& filepath, Helper* he
     --(helper->exportTaskCount);
 }
 
+// Exports the document to several image files, graphics scene being built once for all of them
+void exportDocumentImages(
+        const DocumentPtr& doc, Span<const FilePath> spanFilepath, Helper* helper, TaskProgress* progress
+    )
+{
+    auto appModule = AppModule::get();
+    ErrorMessageCollect errorCollect;
+    std::unique_ptr<IO::Writer> writer = appModule->ioSystem()->createWriter(IO::Format_Image);
+    auto imageWriter = dynamic_cast<IO::ImageWriter*>(writer.get());
+    bool okExport = false;
+    if (imageWriter) {
+        imageWriter->setMessenger(&errorCollect);
+        imageWriter->applyProperties(appModule->findWriterParameters(IO::Format_Image));
+        std::vector<IO::ImageWriter::Shot> vecShot;
+        for (const FilePath& filepath : spanFilepath) {
+            const std::vector<IO::ImageWriter::Shot> vecFileShot = imageWriter->shots(filepath);
+            vecShot.insert(vecShot.end(), vecFileShot.cbegin(), vecFileShot.cend());
+        }
+
+        const ApplicationItem appItems[] = { doc };
+        okExport = imageWriter->transfer(appItems, progress) && imageWriter->writeFiles(vecShot, progress);
+    }
+    else {
+        errorCollect.emitError(CliExport::textIdTr("No supporting writer"));
+    }
+
+    std::string strFilenames;
+    for (const FilePath& filepath : spanFilepath) {
+        if (!strFilenames.empty())
+            strFilenames += ", ";
+
+        strFilenames += filepath.filename().u8string();
+    }
+
+    const std::string msg =
+            okExport ?
+                fmt::format(CliExport::textIdTr("Exported {}"), strFilenames) :
+                errorCollect.message();
+    helper->taskMgr.setTitle(progress->taskId(), msg);
+    helper->mapTaskStatus.at(progress->taskId())->success = okExport;
+    helper->mapTaskStatus.at(progress->taskId())->finished = true;
+    --(helper->exportTaskCount);
+}
+
 } // namespace
 
 void cli_asyncExportDocuments(
@@ -209,7 +255,15 @@ void cli_asyncExportDocuments(
             fnPrintProgress();
     });
 
-    helper->exportTaskCount = int(args.filesToExport.size());
+    // Image files are written by a single task, so the graphics scene is built just once
+    std::vector<FilePath> vecImageFilepath;
+    std::vector<FilePath> vecOtherFilepath;
+    for (const FilePath& filepath : args.filesToExport) {
+        const bool isImage = AppModule::get()->ioSystem()->probeFormat(filepath) == IO::Format_Image;
+        (isImage ? vecImageFilepath : vecOtherFilepath).push_back(filepath);
+    }
+
+    helper->exportTaskCount = int(vecOtherFilepath.size()) + (!vecImageFilepath.empty() ? 1 : 0);
     taskMgr->signalEnded.connectSlot([=]{
         if (helper->exportTaskCount == 0) {
             bool okExport = true;
@@ -238,7 +292,7 @@ void cli_asyncExportDocuments(
         return fnExit(EXIT_FAILURE); // Error
 
     // Run export operations(asynchronous)
-    for (const FilePath& filepath : args.filesToExport) {
+    for (const FilePath& filepath : vecOtherFilepath) {
         const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
             exportDocument(doc, filepath, helper, progress);
         });
@@ -247,6 +301,14 @@ void cli_asyncExportDocuments(
         taskMgr->setTitle(taskId, fmt::format(CliExport::textIdTr("Exporting {}..."), strFilename));
     }
 
+    if (!vecImageFilepath.empty()) {
+        const TaskId taskId = taskMgr->newTask([=](TaskProgress* progress) {
+            exportDocumentImages(doc, vecImageFilepath, helper, progress);
+        });
+        helper->mapTaskStatus.insert({ taskId, std::make_unique<TaskStatus>() });
+        taskMgr->setTitle(taskId, CliExport::textIdTr("Exporting images..."));
+    }
+
     taskMgr->foreachTask([=](TaskId taskId) {
         if (taskId != importTaskId)
             taskMgr->run(taskId, TaskAutoDestroy::Off);
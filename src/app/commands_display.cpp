@@ -237,6 +237,38 @@ void CommandTogglePerformanceStats::onCurrentDocumentChanged()
     }
 }
 
+CommandStopLoadingMeshes::CommandStopLoadingMeshes(IAppContext* context)
+    : Command(context)
+{
+    auto action = new QAction(this);
+    action->setText(Command::tr("Stop Loading Meshes"));
+    action->setToolTip(Command::tr("Keep the preview of huge meshes still loading in background"));
+    this->setAction(action);
+
+    // Enabled status depends on the meshes loading in current document
+    auto fnUpdateEnabled = [=]{ this->action()->setEnabled(this->getEnabledStatus()); };
+    QObject::connect(context, &IAppContext::currentDocumentChanged, this, fnUpdateEnabled);
+    this->guiApp()->signalGuiDocumentAdded.connectSlot([=](GuiDocument* guiDoc) {
+        guiDoc->signalMeshPreviewsPendingChanged.connectSlot([=](bool) {
+            if (guiDoc == this->currentGuiDocument())
+                fnUpdateEnabled();
+        });
+    });
+}
+
+void CommandStopLoadingMeshes::execute()
+{
+    GuiDocument* guiDoc = this->currentGuiDocument();
+    if (guiDoc && guiDoc->hasPendingMeshPreviews())
+        guiDoc->abortMeshPreviewCompletion();
+}
+
+bool CommandStopLoadingMeshes::getEnabledStatus() const
+{
+    const GuiDocument* guiDoc = this->currentGuiDocument();
+    return guiDoc && guiDoc->hasPendingMeshPreviews();
+}
+
 CommandZoomInCurrentDocument::CommandZoomInCurrentDocument(IAppContext* context)
     : Command(context)
 {
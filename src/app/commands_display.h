@@ -55,6 +55,13 @@ private:
     void onCurrentDocumentChanged();
 };
 
+class CommandStopLoadingMeshes : public Command {
+public:
+    CommandStopLoadingMeshes(IAppContext* context);
+    void execute() override;
+    bool getEnabledStatus() const override;
+};
+
 class CommandZoomInCurrentDocument : public Command {
 public:
     CommandZoomInCurrentDocument(IAppContext* context);
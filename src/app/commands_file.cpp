@@ -8,6 +8,7 @@
 
 #include "../base/application.h"
 #include "../base/task_manager.h"
+#include "../graphics/graphics_mesh_object_driver.h"
 #include "../gui/gui_application.h"
 #include "app_module.h"
 #include "filepath_conv.h"
@@ -166,6 +167,8 @@ void FileCommandTools::openDocumentsFromList(IAppContext* context, Span<const Fi
 {
     auto app = context->guiApp()->application();
     auto appModule = AppModule::get();
+    // Huge meshes are displayed with a preview sampled from the files while they're imported
+    const int previewTriangleCount = GraphicsMeshObjectDriver::defaultValues().previewTriangleCount;
     for (const FilePath& fp : listFilePath) {
         DocumentPtr docPtr = app->findDocumentByLocation(fp);
         if (docPtr.IsNull()) {
@@ -185,10 +188,13 @@ void FileCommandTools::openDocumentsFromList(IAppContext* context, Span<const Fi
                         .withFilepath(fp)
                         .withParametersProvider(appModule)
                         .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
-                            appModule->computeBRepMesh(labelEntity, progress);
+                            appModule->postProcessImportedEntity(labelEntity, progress);
+                        })
+                        .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                            return appModule->isImportPostProcessRequired(format);
                         })
-                        .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                         .withEntityPostProcessInfoProgress(20, Command::textIdTr("Mesh BRep shapes"))
+                        .withPreviewMesh(previewTriangleCount)
                         .withMessenger(appModule)
                         .withTaskProgress(progress)
                         .execute();
@@ -316,6 +322,7 @@ void CommandImportInCurrentDocument::execute()
         return;
 
     auto appModule = AppModule::get();
+    const int previewTriangleCount = GraphicsMeshObjectDriver::defaultValues().previewTriangleCount;
     const TaskId taskId = this->taskMgr()->newTask([=](TaskProgress* progress) {
         QElapsedTimer chrono;
         chrono.start();
@@ -325,10 +332,13 @@ void CommandImportInCurrentDocument::execute()
                 .withFilepaths(resFileNames.listFilepath)
                 .withParametersProvider(appModule)
                 .withEntityPostProcess([=](TDF_Label labelEntity, TaskProgress* progress) {
-                        appModule->computeBRepMesh(labelEntity, progress);
+                        appModule->postProcessImportedEntity(labelEntity, progress);
+                })
+                .withEntityPostProcessRequiredIf([=](IO::Format format) {
+                        return appModule->isImportPostProcessRequired(format);
                 })
-                .withEntityPostProcessRequiredIf(&IO::formatProvidesBRep)
                 .withEntityPostProcessInfoProgress(20, Command::textIdTr("Mesh BRep shapes"))
+                .withPreviewMesh(previewTriangleCount)
                 .withMessenger(appModule)
                 .withTaskProgress(progress)
                 .execute();
@@ -8,9 +8,14 @@
 
 #include "../base/application.h"
 #include "../base/application_item_selection_model.h"
+#include "../base/brep_utils.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
 #include "../gui/gui_application.h"
 #include "../gui/gui_document.h"
 #include "app_module.h"
+#include "dialog_clearance_analysis.h"
+#include "dialog_interference_analysis.h"
 #include "dialog_inspect_xde.h"
 #include "dialog_options.h"
 #include "dialog_save_image_view.h"
@@ -18,9 +23,26 @@
 #include "theme.h"
 
 #include <QtWidgets/QWidget>
+#include <fmt/format.h>
 
 namespace Mayo {
 
+namespace {
+
+// Tree nodes selected in the document of 'guiDoc'
+std::vector<TreeNodeId> selectedTreeNodes(const GuiApplication* guiApp, const GuiDocument* guiDoc)
+{
+    std::vector<TreeNodeId> vecNodeId;
+    for (const ApplicationItem& appItem : guiApp->selectionModel()->selectedItems()) {
+        if (appItem.isDocumentTreeNode() && appItem.document() == guiDoc->document())
+            vecNodeId.push_back(appItem.documentTreeNode().id());
+    }
+
+    return vecNodeId;
+}
+
+} // namespace
+
 CommandSaveViewImage::CommandSaveViewImage(IAppContext* context)
     : Command(context)
 {
@@ -80,6 +102,135 @@ bool CommandInspectXde::getEnabledStatus() const
             && firstAppItem.document()->isXCafDocument();
 }
 
+CommandRemeshDocument::CommandRemeshDocument(IAppContext* context)
+    : Command(context)
+{
+    auto action = new QAction(this);
+    action->setText(Command::tr("Re-mesh Document"));
+    action->setToolTip(Command::tr("Mesh again the BRep shapes according to current meshing options"));
+    this->setAction(action);
+
+    this->taskMgr()->signalEnded.connectSlot(&CommandRemeshDocument::onTaskEnded, this);
+}
+
+void CommandRemeshDocument::execute()
+{
+    GuiDocument* guiDoc = this->currentGuiDocument();
+    if (!guiDoc)
+        return;
+
+    // Meshes will be modified, levels of detail can't be used meanwhile
+    auto job = std::make_shared<Job>();
+    job->docId = guiDoc->document()->identifier();
+    job->wasMeshLodEnabled = guiDoc->isMeshLevelsOfDetailEnabled();
+    guiDoc->setMeshLevelsOfDetailEnabled(false);
+
+    // Document and settings are read in the main thread, the task just computes meshes of copies
+    const DocumentPtr doc = guiDoc->document();
+    for (int i = 0; i < doc->entityCount(); ++i) {
+        const TDF_Label labelEntity = doc->entityLabel(i);
+        if (XCaf::isShape(labelEntity)) {
+            const TopoDS_Shape shape = XCaf::shape(labelEntity);
+            job->vecShapeParams.push_back({ shape, AppModule::get()->brepMeshParameters(shape) });
+        }
+    }
+
+    const TaskId taskId = this->taskMgr()->newTask([=](TaskProgress* progress) {
+        const int shapeCount = int(job->vecShapeParams.size());
+        for (int i = 0; i < shapeCount && !progress->isAbortRequested(); ++i) {
+            TaskProgress subProgress(progress, 100. / shapeCount);
+            const auto& [shape, params] = job->vecShapeParams.at(i);
+            job->vecRemesh.push_back(BRepUtils::computeRemesh(shape, params, 4., &subProgress));
+        }
+    });
+    m_mapTaskJob.insert({ taskId, job });
+    this->taskMgr()->setTitle(taskId, fmt::format(Command::textIdTr("Re-mesh {}"), guiDoc->document()->name()));
+    this->taskMgr()->run(taskId);
+}
+
+bool CommandRemeshDocument::getEnabledStatus() const
+{
+    return this->app()->documentCount() != 0;
+}
+
+void CommandRemeshDocument::onTaskEnded(TaskId taskId)
+{
+    auto itJob = m_mapTaskJob.find(taskId);
+    if (itJob == m_mapTaskJob.end())
+        return;
+
+    const std::shared_ptr<Job> job = itJob->second;
+    m_mapTaskJob.erase(itJob);
+    GuiDocument* guiDoc = this->guiApp()->findGuiDocument(this->app()->findDocumentByIdentifier(job->docId));
+    if (!guiDoc)
+        return;
+
+    TopTools_IndexedMapOfShape mapFaceRemeshed;
+    for (const BRepUtils::RemeshData& remesh : job->vecRemesh) {
+        BRepUtils::applyRemesh(remesh);
+        for (int iFace = 1; iFace <= remesh.mapFace.Extent(); ++iFace)
+            mapFaceRemeshed.Add(remesh.mapFace.FindKey(iFace));
+    }
+
+    guiDoc->recomputeBRepShapeGraphics(mapFaceRemeshed);
+    guiDoc->setMeshLevelsOfDetailEnabled(job->wasMeshLodEnabled);
+    AppModule::get()->emitInfo(
+                fmt::format(Command::textIdTr("{} faces re-meshed"), mapFaceRemeshed.Extent())
+    );
+}
+
+CommandClearanceAnalysis::CommandClearanceAnalysis(IAppContext* context)
+    : Command(context)
+{
+    auto action = new QAction(this);
+    action->setText(Command::tr("Clearance Analysis"));
+    action->setToolTip(Command::tr("Find the pairs of parts closer than some distance"));
+    this->setAction(action);
+}
+
+void CommandClearanceAnalysis::execute()
+{
+    GuiDocument* guiDoc = this->currentGuiDocument();
+    if (!guiDoc)
+        return;
+
+    // Restrict analysis to the tree nodes selected in current document, if any
+    auto dlg = new DialogClearanceAnalysis(guiDoc, this->taskMgr(), this->widgetMain());
+    dlg->setScope(selectedTreeNodes(this->guiApp(), guiDoc));
+    QtWidgetsUtils::asyncDialogExec(dlg);
+}
+
+bool CommandClearanceAnalysis::getEnabledStatus() const
+{
+    return this->app()->documentCount() != 0;
+}
+
+CommandInterferenceAnalysis::CommandInterferenceAnalysis(IAppContext* context)
+    : Command(context)
+{
+    auto action = new QAction(this);
+    action->setText(Command::tr("Interference Analysis"));
+    action->setToolTip(Command::tr("Find the pairs of overlapping parts"));
+    this->setAction(action);
+}
+
+void CommandInterferenceAnalysis::execute()
+{
+    GuiDocument* guiDoc = this->currentGuiDocument();
+    if (!guiDoc)
+        return;
+
+    // Restrict analysis to the tree nodes selected in current document, if any
+    auto dlg = new DialogInterferenceAnalysis(guiDoc, this->taskMgr(), this->widgetMain());
+    dlg->setScope(selectedTreeNodes(this->guiApp(), guiDoc));
+    QtWidgetsUtils::asyncDialogExec(dlg);
+}
+
+bool CommandInterferenceAnalysis::getEnabledStatus() const
+{
+    return this->app()->documentCount() != 0;
+}
+
 CommandEditOptions::CommandEditOptions(IAppContext* context)
     : Command(context)
 {
@@ -7,6 +7,14 @@
 #pragma once
 
 #include "commands_api.h"
+#include "../base/brep_utils.h"
+#include "../base/document.h"
+#include "../base/task_common.h"
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Mayo {
 
@@ -24,6 +32,45 @@ public:
     bool getEnabledStatus() const override;
 };
 
+// Meshes again the BRep shapes of current document with respect to current meshing settings
+// Only faces whose mesh doesn't conform to these settings are processed
+class CommandRemeshDocument : public Command {
+public:
+    CommandRemeshDocument(IAppContext* context);
+    void execute() override;
+    bool getEnabledStatus() const override;
+
+private:
+    struct Job {
+        Document::Identifier docId;
+        bool wasMeshLodEnabled = false;
+        // Shapes and their meshing parameters, captured in the main thread
+        std::vector<std::pair<TopoDS_Shape, OccBRepMeshParameters>> vecShapeParams;
+        // Computed in the worker thread, applied to the shapes in the main thread
+        std::vector<BRepUtils::RemeshData> vecRemesh;
+    };
+
+    void onTaskEnded(TaskId taskId);
+
+    std::unordered_map<TaskId, std::shared_ptr<Job>> m_mapTaskJob;
+};
+
+// Finds the pairs of parts closer than some distance in current document(or in the selected items)
+class CommandClearanceAnalysis : public Command {
+public:
+    CommandClearanceAnalysis(IAppContext* context);
+    void execute() override;
+    bool getEnabledStatus() const override;
+};
+
+// Finds the pairs of overlapping parts in current document(or in the selected items)
+class CommandInterferenceAnalysis : public Command {
+public:
+    CommandInterferenceAnalysis(IAppContext* context);
+    void execute() override;
+    bool getEnabledStatus() const override;
+};
+
 class CommandEditOptions : public Command {
 public:
     CommandEditOptions(IAppContext* context);
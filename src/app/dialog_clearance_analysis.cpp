@@ -0,0 +1,302 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "dialog_clearance_analysis.h"
+
+#include "../base/application_item_selection_model.h"
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/unit_system.h"
+#include "../gui/gui_application.h"
+#include "../gui/gui_document.h"
+#include "app_module.h"
+#include "qstring_conv.h"
+#include "qstring_utils.h"
+#include "ui_dialog_clearance_analysis.h"
+
+#include <QtCore/QPointer>
+#include <QtCore/QTimer>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QPushButton>
+#include <fmt/format.h>
+
+namespace Mayo {
+
+namespace {
+
+MeasureDisplayConfig measureDisplayConfig(const QWidget* widget)
+{
+    MeasureDisplayConfig cfg;
+    cfg.doubleToStringOptions.locale = AppModule::get()->stdLocale();
+    cfg.doubleToStringOptions.decimalCount = AppModule::get()->defaultTextOptions().unitDecimals;
+    cfg.devicePixelRatio = widget->devicePixelRatioF();
+    return cfg;
+}
+
+} // namespace
+
+DialogClearanceAnalysis::DialogClearanceAnalysis(GuiDocument* guiDoc, TaskManager* taskMgr, QWidget* parent)
+    : QDialog(parent),
+      m_ui(new Ui_DialogClearanceAnalysis),
+      m_timerRedraw(new QTimer(this)),
+      m_guiDoc(guiDoc),
+      m_taskMgr(taskMgr)
+{
+    m_ui->setupUi(this);
+    m_ui->table_Results->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    this->setScope({});
+
+    m_btnRun = new QPushButton(tr("Run"), this);
+    m_btnStop = new QPushButton(tr("Stop"), this);
+    m_ui->buttonBox->addButton(m_btnRun, QDialogButtonBox::ActionRole);
+    m_ui->buttonBox->addButton(m_btnStop, QDialogButtonBox::ActionRole);
+    QObject::connect(m_btnRun, &QAbstractButton::clicked, this, &DialogClearanceAnalysis::run);
+    QObject::connect(m_btnStop, &QAbstractButton::clicked, this, &DialogClearanceAnalysis::stop);
+    QObject::connect(
+                m_ui->table_Results, &QTableWidget::currentCellChanged,
+                this, [=](int row) { this->onCurrentRowChanged(row); }
+    );
+    QObject::connect(
+                m_ui->check_ShowInView, &QAbstractButton::toggled,
+                this, &DialogClearanceAnalysis::onShowInViewToggled
+    );
+
+    // Results may be found at a high rate, so redraw of the 3D view is throttled
+    m_timerRedraw->setSingleShot(true);
+    m_timerRedraw->setInterval(100);
+    QObject::connect(m_timerRedraw, &QTimer::timeout, this, [=]{
+        if (m_guiDoc)
+            m_guiDoc->graphicsScene()->redraw();
+    });
+
+    // Slots might be called after destruction of the dialog(they are queued when signals are emitted
+    // from a worker thread), hence the guard pointer
+    QPointer<DialogClearanceAnalysis> guard(this);
+    m_connResultFound = m_analysis.signalResultFound.connectSlot([=](const ClearanceAnalysis::Result& result) {
+        if (guard)
+            guard->onResultFound(result);
+    });
+    m_connTaskEnded = m_taskMgr->signalEnded.connectSlot([=](TaskId taskId) {
+        if (guard)
+            guard->onTaskEnded(taskId);
+    });
+    m_connGuiDocumentErased = m_guiDoc->guiApplication()->signalGuiDocumentErased.connectSlot([=](GuiDocument* guiDoc) {
+        if (guard && guiDoc == guard->m_guiDoc) {
+            guard->stop();
+            guard->m_vecMeasureDisplay.clear();
+            guard->m_guiDoc = nullptr;
+            guard->reject();
+        }
+    });
+
+    this->updateButtons();
+}
+
+DialogClearanceAnalysis::~DialogClearanceAnalysis()
+{
+    m_connResultFound.disconnect();
+    m_connTaskEnded.disconnect();
+    m_connGuiDocumentErased.disconnect();
+    if (m_isRunning) {
+        // Task job references m_analysis
+        m_taskMgr->requestAbort(m_taskId);
+        m_taskMgr->waitForDone(m_taskId);
+    }
+
+    this->clearResults();
+    if (m_guiDoc)
+        m_guiDoc->graphicsScene()->redraw();
+
+    delete m_ui;
+}
+
+void DialogClearanceAnalysis::setScope(Span<const TreeNodeId> spanNodeId)
+{
+    m_vecScopeNodeId.assign(spanNodeId.begin(), spanNodeId.end());
+    if (m_vecScopeNodeId.empty())
+        m_ui->label_ScopeValue->setText(tr("Whole document"));
+    else if (m_vecScopeNodeId.size() == 1)
+        m_ui->label_ScopeValue->setText(this->partName(m_vecScopeNodeId.front()));
+    else
+        m_ui->label_ScopeValue->setText(tr("%1 selected items").arg(int(m_vecScopeNodeId.size())));
+}
+
+void DialogClearanceAnalysis::run()
+{
+    if (m_isRunning || !m_guiDoc)
+        return;
+
+    this->clearResults();
+    m_guiDoc->graphicsScene()->redraw();
+    m_analysis.setMaxDistance(m_ui->edit_MaxDistance->value() * Quantity_Millimeter);
+    m_isAbortRequested = false;
+    m_isRunning = true;
+    m_ui->label_Status->setText(tr("Analysis in progress..."));
+
+    const DocumentPtr doc = m_guiDoc->document();
+    const std::vector<TreeNodeId> vecScopeNodeId = m_vecScopeNodeId;
+    m_taskId = m_taskMgr->newTask([=](TaskProgress* progress) {
+        m_analysis.run(doc, vecScopeNodeId, progress);
+    });
+    m_taskMgr->setTitle(m_taskId, fmt::format(ClearanceAnalysis::textIdTr("Clearance analysis of {}"), doc->name()));
+    m_taskMgr->run(m_taskId);
+    this->updateButtons();
+}
+
+void DialogClearanceAnalysis::stop()
+{
+    if (m_isRunning) {
+        m_isAbortRequested = true;
+        m_taskMgr->requestAbort(m_taskId);
+    }
+}
+
+void DialogClearanceAnalysis::clearResults()
+{
+    m_ui->table_Results->setRowCount(0);
+    m_vecResult.clear();
+    if (m_guiDoc) {
+        for (const std::unique_ptr<IMeasureDisplay>& measure : m_vecMeasureDisplay)
+            this->setResultDisplayVisible(measure.get(), false);
+    }
+
+    m_vecMeasureDisplay.clear();
+}
+
+void DialogClearanceAnalysis::onResultFound(const ClearanceAnalysis::Result& result)
+{
+    if (!m_isRunning)
+        return;
+
+    this->addResultRow(result);
+    this->addResultDisplay(result);
+}
+
+void DialogClearanceAnalysis::onTaskEnded(TaskId taskId)
+{
+    if (!m_isRunning || taskId != m_taskId)
+        return;
+
+    m_isRunning = false;
+    if (m_isAbortRequested) {
+        m_ui->label_Status->setText(tr("Analysis stopped, %1 pairs found").arg(int(m_vecResult.size())));
+    }
+    else {
+        // Replace streamed results with the final ones, sorted by distance
+        m_ui->table_Results->setRowCount(0);
+        m_vecResult.clear();
+        for (const ClearanceAnalysis::Result& result : m_analysis.results())
+            this->addResultRow(result);
+
+        QString status = tr("%1 pairs found, %2 candidate pairs checked")
+                .arg(int(m_vecResult.size()))
+                .arg(m_analysis.candidatePairCount());
+        if (m_analysis.failedPairCount() > 0)
+            status += tr(", %1 failures").arg(m_analysis.failedPairCount());
+
+        m_ui->label_Status->setText(status);
+    }
+
+    this->updateButtons();
+}
+
+void DialogClearanceAnalysis::onCurrentRowChanged(int row)
+{
+    if (!m_guiDoc || row < 0 || row >= int(m_vecResult.size()))
+        return;
+
+    const DocumentPtr& doc = m_guiDoc->document();
+    const ClearanceAnalysis::Result& result = m_vecResult.at(row);
+    std::vector<ApplicationItem> vecAppItem = {
+        DocumentTreeNode(doc, result.treeNodeId1), DocumentTreeNode(doc, result.treeNodeId2)
+    };
+    ApplicationItemSelectionModel* selectionModel = m_guiDoc->guiApplication()->selectionModel();
+    selectionModel->clear();
+    selectionModel->add(vecAppItem);
+}
+
+void DialogClearanceAnalysis::onShowInViewToggled(bool on)
+{
+    if (!m_guiDoc)
+        return;
+
+    for (const std::unique_ptr<IMeasureDisplay>& measure : m_vecMeasureDisplay)
+        this->setResultDisplayVisible(measure.get(), on);
+
+    m_guiDoc->graphicsScene()->redraw();
+}
+
+void DialogClearanceAnalysis::addResultRow(const ClearanceAnalysis::Result& result)
+{
+    const int row = m_ui->table_Results->rowCount();
+    m_ui->table_Results->insertRow(row);
+    m_ui->table_Results->setItem(row, 0, new QTableWidgetItem(this->partName(result.treeNodeId1)));
+    m_ui->table_Results->setItem(row, 1, new QTableWidgetItem(this->partName(result.treeNodeId2)));
+    m_ui->table_Results->setItem(row, 2, new QTableWidgetItem(this->distanceText(result)));
+    m_vecResult.push_back(result);
+}
+
+void DialogClearanceAnalysis::addResultDisplay(const ClearanceAnalysis::Result& result)
+{
+    if (!m_guiDoc)
+        return;
+
+    auto measure = std::make_unique<MeasureDisplayMinDistance>(result.minDistance);
+    measure->update(measureDisplayConfig(this));
+    if (m_ui->check_ShowInView->isChecked())
+        this->setResultDisplayVisible(measure.get(), true);
+
+    m_vecMeasureDisplay.push_back(std::move(measure));
+    this->redrawLater();
+}
+
+void DialogClearanceAnalysis::setResultDisplayVisible(const IMeasureDisplay* measure, bool on)
+{
+    GraphicsScene* gfxScene = m_guiDoc->graphicsScene();
+    for (int i = 0; i < measure->graphicsObjectsCount(); ++i) {
+        const GraphicsObjectPtr gfxObject = measure->graphicsObjectAt(i);
+        if (on) {
+            gfxObject->SetZLayer(Graphic3d_ZLayerId_Topmost);
+            gfxScene->addObject(gfxObject);
+        }
+        else {
+            gfxScene->eraseObject(gfxObject);
+        }
+    }
+}
+
+void DialogClearanceAnalysis::updateButtons()
+{
+    m_btnRun->setEnabled(!m_isRunning);
+    m_btnStop->setEnabled(m_isRunning);
+    m_ui->edit_MaxDistance->setEnabled(!m_isRunning);
+}
+
+void DialogClearanceAnalysis::redrawLater()
+{
+    if (!m_timerRedraw->isActive())
+        m_timerRedraw->start();
+}
+
+QString DialogClearanceAnalysis::partName(TreeNodeId nodeId) const
+{
+    if (!m_guiDoc)
+        return {};
+
+    const TDF_Label& label = m_guiDoc->document()->modelTree().nodeData(nodeId);
+    return to_QString(CafUtils::labelAttrStdName(label));
+}
+
+QString DialogClearanceAnalysis::distanceText(const ClearanceAnalysis::Result& result) const
+{
+    const QStringUtils::TextOptions textOptions = AppModule::get()->defaultTextOptions();
+    const auto trDistance = UnitSystem::translate(textOptions.unitSchema, result.minDistance.value);
+    return QStringUtils::text(trDistance.value, textOptions) + trDistance.strUnit;
+}
+
+} // namespace Mayo
@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/task_common.h"
+#include "../measure/clearance_analysis.h"
+#include "../measure/measure_display.h"
+
+#include <QtWidgets/QDialog>
+#include <memory>
+#include <vector>
+
+class QPushButton;
+class QTimer;
+
+namespace Mayo {
+
+class GuiDocument;
+class TaskManager;
+
+// Runs ClearanceAnalysis in background on a document, pairs found are reported as they come in
+// the result table and shown in the 3D view
+class DialogClearanceAnalysis : public QDialog {
+    Q_OBJECT
+public:
+    DialogClearanceAnalysis(GuiDocument* guiDoc, TaskManager* taskMgr, QWidget* parent = nullptr);
+    ~DialogClearanceAnalysis();
+
+    // Analysis is restricted to the parts located below these tree nodes, all the document if empty
+    void setScope(Span<const TreeNodeId> spanNodeId);
+
+private:
+    void run();
+    void stop();
+    void clearResults();
+
+    void onResultFound(const ClearanceAnalysis::Result& result);
+    void onTaskEnded(TaskId taskId);
+    void onCurrentRowChanged(int row);
+    void onShowInViewToggled(bool on);
+
+    void addResultRow(const ClearanceAnalysis::Result& result);
+    void addResultDisplay(const ClearanceAnalysis::Result& result);
+    void setResultDisplayVisible(const IMeasureDisplay* measure, bool on);
+    void updateButtons();
+    void redrawLater();
+
+    QString partName(TreeNodeId nodeId) const;
+    QString distanceText(const ClearanceAnalysis::Result& result) const;
+
+    class Ui_DialogClearanceAnalysis* m_ui = nullptr;
+    QPushButton* m_btnRun = nullptr;
+    QPushButton* m_btnStop = nullptr;
+    QTimer* m_timerRedraw = nullptr;
+    GuiDocument* m_guiDoc = nullptr;
+    TaskManager* m_taskMgr = nullptr;
+    TaskId m_taskId = 0;
+    bool m_isRunning = false;
+    bool m_isAbortRequested = false;
+    ClearanceAnalysis m_analysis;
+    std::vector<TreeNodeId> m_vecScopeNodeId;
+    std::vector<ClearanceAnalysis::Result> m_vecResult; // Same order as rows in result table
+    std::vector<std::unique_ptr<IMeasureDisplay>> m_vecMeasureDisplay;
+    SignalConnectionHandle m_connResultFound;
+    SignalConnectionHandle m_connTaskEnded;
+    SignalConnectionHandle m_connGuiDocumentErased;
+};
+
+} // namespace Mayo
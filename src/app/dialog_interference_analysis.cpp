@@ -0,0 +1,224 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "dialog_interference_analysis.h"
+
+#include "../base/application_item_selection_model.h"
+#include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/task_manager.h"
+#include "../base/unit_system.h"
+#include "../gui/gui_application.h"
+#include "../gui/gui_document.h"
+#include "app_module.h"
+#include "qstring_conv.h"
+#include "qstring_utils.h"
+#include "ui_dialog_interference_analysis.h"
+
+#include <QtCore/QPointer>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QPushButton>
+#include <fmt/format.h>
+
+namespace Mayo {
+
+DialogInterferenceAnalysis::DialogInterferenceAnalysis(GuiDocument* guiDoc, TaskManager* taskMgr, QWidget* parent)
+    : QDialog(parent),
+      m_ui(new Ui_DialogInterferenceAnalysis),
+      m_guiDoc(guiDoc),
+      m_taskMgr(taskMgr)
+{
+    m_ui->setupUi(this);
+    m_ui->table_Results->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    this->setScope({});
+
+    m_btnRun = new QPushButton(tr("Run"), this);
+    m_btnStop = new QPushButton(tr("Stop"), this);
+    m_ui->buttonBox->addButton(m_btnRun, QDialogButtonBox::ActionRole);
+    m_ui->buttonBox->addButton(m_btnStop, QDialogButtonBox::ActionRole);
+    QObject::connect(m_btnRun, &QAbstractButton::clicked, this, &DialogInterferenceAnalysis::run);
+    QObject::connect(m_btnStop, &QAbstractButton::clicked, this, &DialogInterferenceAnalysis::stop);
+    QObject::connect(
+                m_ui->table_Results, &QTableWidget::currentCellChanged,
+                this, [=](int row) { this->onCurrentRowChanged(row); }
+    );
+
+    // Slots might be called after destruction of the dialog(they are queued when signals are emitted
+    // from a worker thread), hence the guard pointer
+    QPointer<DialogInterferenceAnalysis> guard(this);
+    m_connResultFound = m_analysis.signalResultFound.connectSlot([=](const InterferenceAnalysis::Result& result) {
+        if (guard)
+            guard->onResultFound(result);
+    });
+    m_connTaskEnded = m_taskMgr->signalEnded.connectSlot([=](TaskId taskId) {
+        if (guard)
+            guard->onTaskEnded(taskId);
+    });
+    m_connGuiDocumentErased = m_guiDoc->guiApplication()->signalGuiDocumentErased.connectSlot([=](GuiDocument* guiDoc) {
+        if (guard && guiDoc == guard->m_guiDoc) {
+            guard->stop();
+            guard->m_guiDoc = nullptr;
+            guard->reject();
+        }
+    });
+
+    this->updateButtons();
+}
+
+DialogInterferenceAnalysis::~DialogInterferenceAnalysis()
+{
+    m_connResultFound.disconnect();
+    m_connTaskEnded.disconnect();
+    m_connGuiDocumentErased.disconnect();
+    if (m_isRunning) {
+        // Task job references m_analysis
+        m_taskMgr->requestAbort(m_taskId);
+        m_taskMgr->waitForDone(m_taskId);
+    }
+
+    delete m_ui;
+}
+
+void DialogInterferenceAnalysis::setScope(Span<const TreeNodeId> spanNodeId)
+{
+    m_vecScopeNodeId.assign(spanNodeId.begin(), spanNodeId.end());
+    if (m_vecScopeNodeId.empty())
+        m_ui->label_ScopeValue->setText(tr("Whole document"));
+    else if (m_vecScopeNodeId.size() == 1)
+        m_ui->label_ScopeValue->setText(this->partName(m_vecScopeNodeId.front()));
+    else
+        m_ui->label_ScopeValue->setText(tr("%1 selected items").arg(int(m_vecScopeNodeId.size())));
+}
+
+void DialogInterferenceAnalysis::run()
+{
+    if (m_isRunning || !m_guiDoc)
+        return;
+
+    m_ui->table_Results->setRowCount(0);
+    m_vecResult.clear();
+    m_analysis.setTolerance(m_ui->edit_Tolerance->value() * Quantity_Millimeter);
+    m_analysis.setCommonVolumeEnabled(m_ui->check_CommonVolume->isChecked());
+    m_isAbortRequested = false;
+    m_isRunning = true;
+    m_ui->label_Status->setText(tr("Analysis in progress..."));
+
+    const DocumentPtr doc = m_guiDoc->document();
+    const std::vector<TreeNodeId> vecScopeNodeId = m_vecScopeNodeId;
+    m_taskId = m_taskMgr->newTask([=](TaskProgress* progress) {
+        m_analysis.run(doc, vecScopeNodeId, progress);
+    });
+    m_taskMgr->setTitle(m_taskId, fmt::format(InterferenceAnalysis::textIdTr("Interference analysis of {}"), doc->name()));
+    m_taskMgr->run(m_taskId);
+    this->updateButtons();
+}
+
+void DialogInterferenceAnalysis::stop()
+{
+    if (m_isRunning) {
+        m_isAbortRequested = true;
+        m_taskMgr->requestAbort(m_taskId);
+    }
+}
+
+void DialogInterferenceAnalysis::onResultFound(const InterferenceAnalysis::Result& result)
+{
+    if (m_isRunning)
+        this->addResultRow(result);
+}
+
+void DialogInterferenceAnalysis::onTaskEnded(TaskId taskId)
+{
+    if (!m_isRunning || taskId != m_taskId)
+        return;
+
+    m_isRunning = false;
+    if (m_isAbortRequested) {
+        m_ui->label_Status->setText(tr("Analysis stopped, %1 interferences found").arg(int(m_vecResult.size())));
+    }
+    else {
+        // Replace streamed results with the final ones, sorted
+        m_ui->table_Results->setRowCount(0);
+        m_vecResult.clear();
+        for (const InterferenceAnalysis::Result& result : m_analysis.results())
+            this->addResultRow(result);
+
+        QString status = tr("%1 interferences found, %2 candidate pairs checked")
+                .arg(int(m_vecResult.size()))
+                .arg(m_analysis.candidatePairCount());
+        if (m_analysis.uncheckedPairCount() > 0)
+            status += tr(", %1 pairs with missing mesh").arg(m_analysis.uncheckedPairCount());
+
+        m_ui->label_Status->setText(status);
+    }
+
+    this->updateButtons();
+}
+
+void DialogInterferenceAnalysis::onCurrentRowChanged(int row)
+{
+    if (!m_guiDoc || row < 0 || row >= int(m_vecResult.size()))
+        return;
+
+    const DocumentPtr& doc = m_guiDoc->document();
+    const InterferenceAnalysis::Result& result = m_vecResult.at(row);
+    std::vector<ApplicationItem> vecAppItem = {
+        DocumentTreeNode(doc, result.treeNodeId1), DocumentTreeNode(doc, result.treeNodeId2)
+    };
+    ApplicationItemSelectionModel* selectionModel = m_guiDoc->guiApplication()->selectionModel();
+    selectionModel->clear();
+    selectionModel->add(vecAppItem);
+}
+
+void DialogInterferenceAnalysis::addResultRow(const InterferenceAnalysis::Result& result)
+{
+    const int row = m_ui->table_Results->rowCount();
+    m_ui->table_Results->insertRow(row);
+    m_ui->table_Results->setItem(row, 0, new QTableWidgetItem(this->partName(result.treeNodeId1)));
+    m_ui->table_Results->setItem(row, 1, new QTableWidgetItem(this->partName(result.treeNodeId2)));
+    m_ui->table_Results->setItem(row, 2, new QTableWidgetItem(DialogInterferenceAnalysis::typeText(result.type)));
+    m_ui->table_Results->setItem(row, 3, new QTableWidgetItem(DialogInterferenceAnalysis::volumeText(result)));
+    m_vecResult.push_back(result);
+}
+
+void DialogInterferenceAnalysis::updateButtons()
+{
+    m_btnRun->setEnabled(!m_isRunning);
+    m_btnStop->setEnabled(m_isRunning);
+    m_ui->edit_Tolerance->setEnabled(!m_isRunning);
+    m_ui->check_CommonVolume->setEnabled(!m_isRunning);
+}
+
+QString DialogInterferenceAnalysis::partName(TreeNodeId nodeId) const
+{
+    if (!m_guiDoc)
+        return {};
+
+    const TDF_Label& label = m_guiDoc->document()->modelTree().nodeData(nodeId);
+    return to_QString(CafUtils::labelAttrStdName(label));
+}
+
+QString DialogInterferenceAnalysis::typeText(InterferenceAnalysis::Type type)
+{
+    switch (type) {
+    case InterferenceAnalysis::Type::Intersection: return tr("Intersection");
+    case InterferenceAnalysis::Type::Inclusion: return tr("Inclusion");
+    }
+
+    return {};
+}
+
+QString DialogInterferenceAnalysis::volumeText(const InterferenceAnalysis::Result& result)
+{
+    if (!result.commonVolume)
+        return {};
+
+    const QStringUtils::TextOptions textOptions = AppModule::get()->defaultTextOptions();
+    const auto trVolume = UnitSystem::translate(textOptions.unitSchema, *result.commonVolume);
+    return QStringUtils::text(trVolume.value, textOptions) + trVolume.strUnit;
+}
+
+} // namespace Mayo
@@ -0,0 +1,66 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/task_common.h"
+#include "../measure/interference_analysis.h"
+
+#include <QtWidgets/QDialog>
+#include <vector>
+
+class QPushButton;
+
+namespace Mayo {
+
+class GuiDocument;
+class TaskManager;
+
+// Runs InterferenceAnalysis in background on a document, interfering pairs are reported as they
+// come in the result table. Selecting a row selects the two parts
+class DialogInterferenceAnalysis : public QDialog {
+    Q_OBJECT
+public:
+    DialogInterferenceAnalysis(GuiDocument* guiDoc, TaskManager* taskMgr, QWidget* parent = nullptr);
+    ~DialogInterferenceAnalysis();
+
+    // Analysis is restricted to the parts located below these tree nodes, all the document if empty
+    void setScope(Span<const TreeNodeId> spanNodeId);
+
+private:
+    void run();
+    void stop();
+
+    void onResultFound(const InterferenceAnalysis::Result& result);
+    void onTaskEnded(TaskId taskId);
+    void onCurrentRowChanged(int row);
+
+    void addResultRow(const InterferenceAnalysis::Result& result);
+    void updateButtons();
+
+    QString partName(TreeNodeId nodeId) const;
+    static QString typeText(InterferenceAnalysis::Type type);
+    static QString volumeText(const InterferenceAnalysis::Result& result);
+
+    class Ui_DialogInterferenceAnalysis* m_ui = nullptr;
+    QPushButton* m_btnRun = nullptr;
+    QPushButton* m_btnStop = nullptr;
+    GuiDocument* m_guiDoc = nullptr;
+    TaskManager* m_taskMgr = nullptr;
+    TaskId m_taskId = 0;
+    bool m_isRunning = false;
+    bool m_isAbortRequested = false;
+    InterferenceAnalysis m_analysis;
+    std::vector<TreeNodeId> m_vecScopeNodeId;
+    std::vector<InterferenceAnalysis::Result> m_vecResult; // Same order as rows in result table
+    SignalConnectionHandle m_connResultFound;
+    SignalConnectionHandle m_connTaskEnded;
+    SignalConnectionHandle m_connGuiDocumentErased;
+};
+
+} // namespace Mayo
@@ -0,0 +1,487 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "document_tree_item_model.h"
+
+#include "../base/application_item_selection_model.h"
+#include "../base/document.h"
+#include "../gui/gui_application.h"
+#include "../gui/gui_document.h"
+#include "qtcore_utils.h"
+#include "widget_model_tree_builder.h"
+
+#include <QtCore/QMetaType>
+#include <algorithm>
+#include <vector>
+
+Q_DECLARE_METATYPE(Mayo::DocumentPtr)
+Q_DECLARE_METATYPE(Mayo::DocumentTreeNode)
+
+namespace Mayo {
+
+// Note: internal pointer of a QModelIndex is null for document items, otherwise it's the
+//       ChildrenEntry object containing the tree node item
+
+DocumentTreeItemModel::DocumentTreeItemModel(QObject* parent)
+    : QAbstractItemModel(parent)
+{
+}
+
+DocumentTreeItemModel::~DocumentTreeItemModel()
+{
+}
+
+void DocumentTreeItemModel::addBuilder(WidgetModelTreeBuilder* builder)
+{
+    m_vecBuilder.push_back(builder);
+}
+
+void DocumentTreeItemModel::appendDocument(const DocumentPtr& doc)
+{
+    auto docEntry = std::make_unique<DocumentEntry>();
+    docEntry->doc = doc;
+    docEntry->builder = this->findSupportBuilder(doc);
+    docEntry->entities.docEntry = docEntry.get();
+    const int row = this->rowCount();
+    this->beginInsertRows(QModelIndex(), row, row);
+    m_vecDocEntry.push_back(std::move(docEntry));
+    this->endInsertRows();
+}
+
+void DocumentTreeItemModel::removeDocument(const DocumentPtr& doc)
+{
+    auto itFound = std::find_if(m_vecDocEntry.begin(), m_vecDocEntry.end(), [&](const auto& docEntry) {
+        return docEntry->doc == doc;
+    });
+    if (itFound != m_vecDocEntry.end()) {
+        const int row = int(itFound - m_vecDocEntry.begin());
+        this->beginRemoveRows(QModelIndex(), row, row);
+        m_vecDocEntry.erase(itFound);
+        this->endRemoveRows();
+    }
+}
+
+void DocumentTreeItemModel::appendDocumentEntity(const DocumentTreeNode& entityNode)
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(entityNode.document());
+    if (!docEntry)
+        return;
+
+    auto& vecEntityId = docEntry->entities.vecChildId;
+    const int row = int(vecEntityId.size());
+    this->beginInsertRows(this->indexOf(docEntry->doc), row, row);
+    vecEntityId.push_back(entityNode.id());
+    docEntry->mapRow.insert({ entityNode.id(), row });
+    docEntry->mapEntityBuilder.insert({ entityNode.id(), this->findSupportBuilder(entityNode) });
+    this->endInsertRows();
+}
+
+void DocumentTreeItemModel::removeDocumentEntity(const DocumentTreeNode& entityNode)
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(entityNode.document());
+    if (!docEntry)
+        return;
+
+    auto itRow = docEntry->mapRow.find(entityNode.id());
+    if (itRow == docEntry->mapRow.end())
+        return;
+
+    const int row = itRow->second;
+    const Tree<TDF_Label>& modelTree = docEntry->doc->modelTree();
+    this->beginRemoveRows(this->indexOf(docEntry->doc), row, row);
+    // Forget items exposed for the entity, model tree is still valid at this point
+    auto fnIsEntityNode = [&](TreeNodeId id) { return modelTree.nodeRoot(id) == entityNode.id(); };
+    for (auto it = docEntry->mapChildren.begin(); it != docEntry->mapChildren.end();)
+        it = fnIsEntityNode(it->first) ? docEntry->mapChildren.erase(it) : std::next(it);
+
+    for (auto it = docEntry->mapRow.begin(); it != docEntry->mapRow.end();)
+        it = fnIsEntityNode(it->first) ? docEntry->mapRow.erase(it) : std::next(it);
+
+    auto& vecEntityId = docEntry->entities.vecChildId;
+    vecEntityId.erase(vecEntityId.begin() + row);
+    for (int i = row; i < int(vecEntityId.size()); ++i)
+        docEntry->mapRow[vecEntityId.at(i)] = i;
+
+    docEntry->mapEntityBuilder.erase(entityNode.id());
+    this->endRemoveRows();
+}
+
+void DocumentTreeItemModel::refreshItems()
+{
+    for (const auto& docEntry : m_vecDocEntry)
+        this->refreshItems(docEntry->doc);
+}
+
+void DocumentTreeItemModel::refreshItems(const DocumentPtr& doc)
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(doc);
+    if (!docEntry)
+        return;
+
+    const QModelIndex indexDoc = this->indexOf(doc);
+    emit this->dataChanged(indexDoc, indexDoc);
+    this->emitDataChanged(&docEntry->entities);
+    for (const auto& mapPair : docEntry->mapChildren)
+        this->emitDataChanged(mapPair.second.get());
+}
+
+void DocumentTreeItemModel::refreshItems(const DocumentPtr& doc, Span<const TDF_Label> spanLabel)
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(doc);
+    if (!docEntry || spanLabel.empty())
+        return;
+
+    const Tree<TDF_Label>& modelTree = docEntry->doc->modelTree();
+    auto fnIsLabelRefreshed = [=](const TDF_Label& label) {
+        return std::find(spanLabel.begin(), spanLabel.end(), label) != spanLabel.end();
+    };
+    for (const auto& mapPair : docEntry->mapRow) {
+        const TreeNodeId id = mapPair.first;
+        const TreeNodeId holderId = this->childrenHolderNode(docEntry, id);
+        if (fnIsLabelRefreshed(modelTree.nodeData(id))
+                || (holderId != id && fnIsLabelRefreshed(modelTree.nodeData(holderId))))
+        {
+            const QModelIndex index = this->indexOf(docEntry, id);
+            emit this->dataChanged(index, index);
+        }
+    }
+}
+
+void DocumentTreeItemModel::refreshCheckStates(
+        const DocumentPtr& doc, const std::unordered_map<TreeNodeId, CheckState>& mapNodeState)
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(doc);
+    if (!docEntry)
+        return;
+
+    // Only items exposed so far need to be notified
+    for (const auto& mapPair : mapNodeState) {
+        if (docEntry->mapRow.find(mapPair.first) != docEntry->mapRow.cend()) {
+            const QModelIndex index = this->indexOf(docEntry, mapPair.first);
+            emit this->dataChanged(index, index, { Qt::CheckStateRole });
+        }
+    }
+}
+
+QModelIndex DocumentTreeItemModel::indexOf(const DocumentPtr& doc) const
+{
+    const DocumentEntry* docEntry = this->findDocumentEntry(doc);
+    return docEntry ? this->createIndex(this->documentRow(docEntry), 0, nullptr) : QModelIndex();
+}
+
+QModelIndex DocumentTreeItemModel::indexOf(const DocumentTreeNode& node) const
+{
+    DocumentEntry* docEntry = this->findDocumentEntry(node.document());
+    if (!docEntry || !node.isValid())
+        return {};
+
+    return this->indexOf(docEntry, this->displayedNode(docEntry, node.id()));
+}
+
+DocumentTreeItemModel::ItemType DocumentTreeItemModel::itemType(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return ItemType_Unknown;
+
+    if (!index.internalPointer())
+        return ItemType_Document;
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    return entry->parentId == 0 ? ItemType_DocumentEntity : ItemType_DocumentTreeNode;
+}
+
+DocumentPtr DocumentTreeItemModel::document(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.internalPointer() || index.row() >= int(m_vecDocEntry.size()))
+        return {};
+
+    return m_vecDocEntry.at(index.row())->doc;
+}
+
+DocumentTreeNode DocumentTreeItemModel::documentTreeNode(const QModelIndex& index) const
+{
+    const TreeNodeId id = this->nodeId(index);
+    if (id == 0)
+        return DocumentTreeNode::null();
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    return DocumentTreeNode(entry->docEntry->doc, id);
+}
+
+QModelIndex DocumentTreeItemModel::index(int row, int column, const QModelIndex& parent) const
+{
+    if (row < 0 || column != 0)
+        return {};
+
+    if (!parent.isValid())
+        return row < int(m_vecDocEntry.size()) ? this->createIndex(row, 0, nullptr) : QModelIndex();
+
+    ChildrenEntry* entry = this->childrenEntry(parent);
+    if (!entry || row >= int(entry->vecChildId.size()))
+        return {};
+
+    return this->createIndex(row, 0, entry);
+}
+
+QModelIndex DocumentTreeItemModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid() || !index.internalPointer())
+        return {};
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    if (entry->parentId == 0)
+        return this->createIndex(this->documentRow(entry->docEntry), 0, nullptr);
+
+    return this->indexOf(entry->docEntry, entry->parentId);
+}
+
+int DocumentTreeItemModel::rowCount(const QModelIndex& parent) const
+{
+    if (!parent.isValid())
+        return int(m_vecDocEntry.size());
+
+    if (parent.column() != 0)
+        return 0;
+
+    const ChildrenEntry* entry = this->childrenEntry(parent);
+    return entry ? int(entry->vecChildId.size()) : 0;
+}
+
+int DocumentTreeItemModel::columnCount(const QModelIndex& /*parent*/) const
+{
+    return 1;
+}
+
+bool DocumentTreeItemModel::hasChildren(const QModelIndex& parent) const
+{
+    // Avoid exposing children items just to find if there's any
+    if (!parent.isValid())
+        return !m_vecDocEntry.empty();
+
+    if (parent.column() != 0)
+        return false;
+
+    if (!parent.internalPointer()) {
+        const DocumentEntry* docEntry = m_vecDocEntry.at(parent.row()).get();
+        return !docEntry->entities.vecChildId.empty();
+    }
+
+    auto entry = static_cast<const ChildrenEntry*>(parent.internalPointer());
+    const TreeNodeId holderId = this->childrenHolderNode(entry->docEntry, this->nodeId(parent));
+    return !entry->docEntry->doc->modelTree().nodeIsLeaf(holderId);
+}
+
+QVariant DocumentTreeItemModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid())
+        return {};
+
+    if (!index.internalPointer()) {
+        const DocumentPtr doc = this->document(index);
+        if (!doc)
+            return {};
+
+        if (role == ItemTypeRole)
+            return ItemType_Document;
+        else if (role == ItemDocumentRole)
+            return QVariant::fromValue(doc);
+
+        return m_vecDocEntry.at(index.row())->builder->documentData(doc, role);
+    }
+
+    const DocumentTreeNode node = this->documentTreeNode(index);
+    if (!node.isValid())
+        return {};
+
+    if (role == ItemTypeRole) {
+        return node.document()->modelTree().nodeIsRoot(node.id()) ?
+                    ItemType_DocumentEntity : ItemType_DocumentTreeNode;
+    }
+    else if (role == ItemDocumentTreeNodeRole) {
+        return QVariant::fromValue(node);
+    }
+    else if (role == Qt::CheckStateRole) {
+        const GuiDocument* guiDoc = m_guiApp ? m_guiApp->findGuiDocument(node.document()) : nullptr;
+        return guiDoc ? QtCoreUtils::toQtCheckState(guiDoc->nodeVisibleState(node.id())) : QVariant();
+    }
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    return this->entityBuilder(entry->docEntry, node.id())->documentTreeNodeData(node, role);
+}
+
+bool DocumentTreeItemModel::setData(const QModelIndex& index, const QVariant& value, int role)
+{
+    if (role != Qt::CheckStateRole)
+        return false;
+
+    const DocumentTreeNode node = this->documentTreeNode(index);
+    GuiDocument* guiDoc = m_guiApp && node.isValid() ? m_guiApp->findGuiDocument(node.document()) : nullptr;
+    if (!guiDoc)
+        return false;
+
+    const auto checkState = QtCoreUtils::toCheckState(Qt::CheckState(value.toInt()));
+    if (checkState == CheckState::Partially)
+        return false;
+
+    // Check state of a selected item is applied to all the selected tree nodes of the document
+    std::vector<TreeNodeId> vecNodeId;
+    const ApplicationItemSelectionModel* selectionModel = m_guiApp->selectionModel();
+    if (selectionModel->isSelected(node)) {
+        for (const ApplicationItem& item : selectionModel->selectedItems()) {
+            if (item.isDocumentTreeNode() && item.document() == node.document())
+                vecNodeId.push_back(item.documentTreeNode().id());
+        }
+    }
+    else {
+        vecNodeId.push_back(node.id());
+    }
+
+    // Views are then notified by refreshCheckStates() with the nodes actually changed
+    guiDoc->setNodesVisible(vecNodeId, checkState == CheckState::On);
+    guiDoc->graphicsScene()->redraw();
+    return true;
+}
+
+Qt::ItemFlags DocumentTreeItemModel::flags(const QModelIndex& index) const
+{
+    Qt::ItemFlags itemFlags = QAbstractItemModel::flags(index);
+    if (index.isValid() && index.internalPointer())
+        itemFlags |= Qt::ItemIsUserCheckable;
+
+    return itemFlags;
+}
+
+int DocumentTreeItemModel::documentRow(const DocumentEntry* docEntry) const
+{
+    auto itFound = std::find_if(m_vecDocEntry.cbegin(), m_vecDocEntry.cend(), [=](const auto& entry) {
+        return entry.get() == docEntry;
+    });
+    return itFound != m_vecDocEntry.cend() ? int(itFound - m_vecDocEntry.cbegin()) : -1;
+}
+
+DocumentTreeItemModel::DocumentEntry* DocumentTreeItemModel::findDocumentEntry(const DocumentPtr& doc) const
+{
+    auto itFound = std::find_if(m_vecDocEntry.cbegin(), m_vecDocEntry.cend(), [&](const auto& entry) {
+        return entry->doc == doc;
+    });
+    return itFound != m_vecDocEntry.cend() ? itFound->get() : nullptr;
+}
+
+DocumentTreeItemModel::ChildrenEntry* DocumentTreeItemModel::childrenEntry(const QModelIndex& index) const
+{
+    if (!index.isValid())
+        return nullptr;
+
+    if (!index.internalPointer()) {
+        const bool isValidRow = index.row() < int(m_vecDocEntry.size());
+        return isValidRow ? &m_vecDocEntry.at(index.row())->entities : nullptr;
+    }
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    return this->childrenEntry(entry->docEntry, this->nodeId(index));
+}
+
+DocumentTreeItemModel::ChildrenEntry* DocumentTreeItemModel::childrenEntry(
+        DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    if (nodeId == 0)
+        return &docEntry->entities;
+
+    std::unique_ptr<ChildrenEntry>& entry = docEntry->mapChildren[nodeId];
+    if (!entry) {
+        entry = std::make_unique<ChildrenEntry>();
+        entry->docEntry = docEntry;
+        entry->parentId = nodeId;
+        const Tree<TDF_Label>& modelTree = docEntry->doc->modelTree();
+        const TreeNodeId holderId = this->childrenHolderNode(docEntry, nodeId);
+        visitDirectChildren(holderId, modelTree, [&](TreeNodeId childId) {
+            docEntry->mapRow[childId] = int(entry->vecChildId.size());
+            entry->vecChildId.push_back(childId);
+        });
+    }
+
+    return entry.get();
+}
+
+QModelIndex DocumentTreeItemModel::indexOf(DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    // Exposes the items of the parent node if not already done
+    ChildrenEntry* entry = this->childrenEntry(docEntry, this->displayedParentNode(docEntry, nodeId));
+    auto itRow = docEntry->mapRow.find(nodeId);
+    if (itRow == docEntry->mapRow.cend())
+        return {};
+
+    return this->createIndex(itRow->second, 0, entry);
+}
+
+TreeNodeId DocumentTreeItemModel::nodeId(const QModelIndex& index) const
+{
+    if (!index.isValid() || !index.internalPointer())
+        return 0;
+
+    auto entry = static_cast<const ChildrenEntry*>(index.internalPointer());
+    return index.row() < int(entry->vecChildId.size()) ? entry->vecChildId.at(index.row()) : 0;
+}
+
+WidgetModelTreeBuilder* DocumentTreeItemModel::findSupportBuilder(const DocumentPtr& doc) const
+{
+    Expects(!m_vecBuilder.empty());
+    auto it = std::find_if(
+                std::next(m_vecBuilder.cbegin()),
+                m_vecBuilder.cend(),
+                [=](const WidgetModelTreeBuilder* builder) { return builder->supportsDocument(doc); });
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+WidgetModelTreeBuilder* DocumentTreeItemModel::findSupportBuilder(const DocumentTreeNode& entityNode) const
+{
+    Expects(!m_vecBuilder.empty());
+    Expects(entityNode.isValid());
+    auto it = std::find_if(
+                std::next(m_vecBuilder.cbegin()),
+                m_vecBuilder.cend(),
+                [&](const WidgetModelTreeBuilder* builder) { return builder->supportsDocumentTreeNode(entityNode); });
+    return it != m_vecBuilder.cend() ? *it : m_vecBuilder.front();
+}
+
+WidgetModelTreeBuilder* DocumentTreeItemModel::entityBuilder(const DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    const TreeNodeId entityId = docEntry->doc->modelTree().nodeRoot(nodeId);
+    auto itFound = docEntry->mapEntityBuilder.find(entityId);
+    return itFound != docEntry->mapEntityBuilder.cend() ? itFound->second : m_vecBuilder.front();
+}
+
+TreeNodeId DocumentTreeItemModel::childrenHolderNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    const DocumentTreeNode node(docEntry->doc, nodeId);
+    return this->entityBuilder(docEntry, nodeId)->childrenHolderNode(node);
+}
+
+TreeNodeId DocumentTreeItemModel::displayedNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    const TreeNodeId parentId = docEntry->doc->modelTree().nodeParent(nodeId);
+    if (parentId != 0 && this->childrenHolderNode(docEntry, parentId) == nodeId)
+        return parentId; // Node merged with its parent
+
+    return nodeId;
+}
+
+TreeNodeId DocumentTreeItemModel::displayedParentNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const
+{
+    const TreeNodeId parentId = docEntry->doc->modelTree().nodeParent(nodeId);
+    return parentId != 0 ? this->displayedNode(docEntry, parentId) : 0;
+}
+
+void DocumentTreeItemModel::emitDataChanged(ChildrenEntry* entry, const QVector<int>& roles)
+{
+    if (entry->vecChildId.empty())
+        return;
+
+    const int lastRow = int(entry->vecChildId.size()) - 1;
+    emit this->dataChanged(this->createIndex(0, 0, entry), this->createIndex(lastRow, 0, entry), roles);
+}
+
+} // namespace Mayo
@@ -0,0 +1,130 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/document_ptr.h"
+#include "../base/document_tree_node.h"
+#include "../base/global.h"
+#include "../base/span.h"
+
+#include <QtCore/QAbstractItemModel>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class GuiApplication;
+class WidgetModelTreeBuilder;
+
+// Provides the documents and their model trees(see Document::modelTree()) as a Qt item model
+//
+// Items are created lazily: the children of an item are retrieved from the model tree only once
+// they're requested by the view(typically when the item is expanded). Data of items(text, icon,
+// ...) isn't stored but computed on demand by the builder supporting the owner entity
+// Mapping between TreeNodeId and QModelIndex is O(1) for the items already exposed
+class DocumentTreeItemModel : public QAbstractItemModel {
+public:
+    enum ItemRole {
+        ItemTypeRole = Qt::UserRole + 1,
+        ItemDocumentRole,
+        ItemDocumentTreeNodeRole
+    };
+
+    enum ItemType {
+        ItemType_Unknown = 0,
+        ItemType_Document = 0x01,
+        ItemType_DocumentTreeNode = 0x02,
+        ItemType_DocumentEntity = 0x10 | ItemType_DocumentTreeNode
+    };
+
+    DocumentTreeItemModel(QObject* parent = nullptr);
+    ~DocumentTreeItemModel();
+
+    // Needed for the check state of tree node items(ie visibility of the graphics objects)
+    void setGuiApplication(GuiApplication* guiApp) { m_guiApp = guiApp; }
+
+    // First builder added is the fallback one, used when no other builder supports a document or
+    // an entity. Builders aren't owned by the item model
+    void addBuilder(WidgetModelTreeBuilder* builder);
+
+    void appendDocument(const DocumentPtr& doc);
+    void removeDocument(const DocumentPtr& doc);
+    void appendDocumentEntity(const DocumentTreeNode& entityNode);
+    void removeDocumentEntity(const DocumentTreeNode& entityNode);
+
+    // Notifies views that data of the items has changed(ie text after some label was renamed)
+    void refreshItems();
+    void refreshItems(const DocumentPtr& doc);
+    // Only the items exposed so far that display one of 'spanLabel'(either as their own label or
+    // the label of the tree node merged with them) are notified
+    void refreshItems(const DocumentPtr& doc, Span<const TDF_Label> spanLabel);
+    void refreshCheckStates(const DocumentPtr& doc, const std::unordered_map<TreeNodeId, CheckState>& mapNodeState);
+
+    // Index of the item displaying a document or a tree node. Tree nodes merged with their parent
+    // item(see WidgetModelTreeBuilder::childrenHolderNode()) are mapped to that parent item
+    QModelIndex indexOf(const DocumentPtr& doc) const;
+    QModelIndex indexOf(const DocumentTreeNode& node) const;
+
+    ItemType itemType(const QModelIndex& index) const;
+    DocumentPtr document(const QModelIndex& index) const; // Null if not a document item
+    DocumentTreeNode documentTreeNode(const QModelIndex& index) const; // Null if not a tree node item
+
+    // QAbstractItemModel
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& index) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+    bool setData(const QModelIndex& index, const QVariant& value, int role) override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+private:
+    struct DocumentEntry;
+
+    // Children items of a document item(then 'parentId' is null) or tree node item
+    struct ChildrenEntry {
+        DocumentEntry* docEntry = nullptr;
+        TreeNodeId parentId = 0;
+        std::vector<TreeNodeId> vecChildId;
+    };
+
+    struct DocumentEntry {
+        DocumentPtr doc;
+        WidgetModelTreeBuilder* builder = nullptr;
+        ChildrenEntry entities;
+        std::unordered_map<TreeNodeId, WidgetModelTreeBuilder*> mapEntityBuilder;
+        // Children of the tree node items requested so far
+        std::unordered_map<TreeNodeId, std::unique_ptr<ChildrenEntry>> mapChildren;
+        // Row of the tree node items exposed so far(ie contained in 'entities' and 'mapChildren')
+        std::unordered_map<TreeNodeId, int> mapRow;
+    };
+
+    int documentRow(const DocumentEntry* docEntry) const;
+    DocumentEntry* findDocumentEntry(const DocumentPtr& doc) const;
+    ChildrenEntry* childrenEntry(const QModelIndex& index) const;
+    ChildrenEntry* childrenEntry(DocumentEntry* docEntry, TreeNodeId nodeId) const;
+    QModelIndex indexOf(DocumentEntry* docEntry, TreeNodeId nodeId) const;
+    TreeNodeId nodeId(const QModelIndex& index) const;
+
+    WidgetModelTreeBuilder* findSupportBuilder(const DocumentPtr& doc) const;
+    WidgetModelTreeBuilder* findSupportBuilder(const DocumentTreeNode& entityNode) const;
+    WidgetModelTreeBuilder* entityBuilder(const DocumentEntry* docEntry, TreeNodeId nodeId) const;
+
+    TreeNodeId childrenHolderNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const;
+    TreeNodeId displayedNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const;
+    TreeNodeId displayedParentNode(const DocumentEntry* docEntry, TreeNodeId nodeId) const;
+
+    void emitDataChanged(ChildrenEntry* entry, const QVector<int>& roles = {});
+
+    GuiApplication* m_guiApp = nullptr;
+    std::vector<WidgetModelTreeBuilder*> m_vecBuilder;
+    std::vector<std::unique_ptr<DocumentEntry>> m_vecDocEntry;
+};
+
+} // namespace Mayo
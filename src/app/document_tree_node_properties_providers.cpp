@@ -6,6 +6,7 @@
 
 #include "document_tree_node_properties_providers.h"
 
+#include "../base/application.h"
 #include "../base/caf_utils.h"
 #include "../base/label_data.h"
 #include "../base/triangulation_annex_data.h"
@@ -24,14 +25,17 @@
 #include <Bnd_Box.hxx>
 #include <TDataStd_Name.hxx>
 #include <QtCore/QStringList>
+#include <memory>
 
 namespace Mayo {
 
 class XCaf_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroupSignals {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::XCaf_DocumentTreeNodeProperties)
 public:
-    Properties(const DocumentTreeNode& treeNode)
-        : m_label(treeNode.label())
+    Properties(const DocumentTreeNode& treeNode, MassPropertiesCache* massPropsCache, TaskManager* taskMgr)
+        : m_label(treeNode.label()),
+          m_massPropsCache(massPropsCache),
+          m_taskMgr(taskMgr)
     {
         const TDF_Label& label = m_label;
         const XCaf& xcaf = treeNode.document()->xcaf();
@@ -161,6 +165,23 @@ public:
             this->removeProperty(&m_propertyReferredColor);
         }
 
+        // Computed mass properties
+        {
+            const std::optional<MassProperties> massProps = m_massPropsCache->find(label);
+            if (massProps) {
+                this->removeProperty(&m_propertyMassStatus);
+                this->setMassProperties(*massProps);
+                if (!massProps->mass) {
+                    this->removeProperty(&m_propertyMass);
+                    this->removeProperty(&m_propertyCenterOfMass);
+                    this->removeProperty(&m_propertyInertiaMoments);
+                }
+            }
+            else {
+                this->startMassPropertiesComputation();
+            }
+        }
+
         for (Property* prop : this->properties())
             prop->setUserReadOnly(true);
 
@@ -168,6 +189,13 @@ public:
         m_propertyReferredName.setUserReadOnly(false);
     }
 
+    ~Properties()
+    {
+        m_connTaskEnded.disconnect();
+        if (m_isMassPropertiesPending)
+            m_taskMgr->requestAbort(m_massPropsTaskId);
+    }
+
     void onPropertyChanged(Property* prop) override
     {
         if (prop == &m_propertyName)
@@ -178,6 +206,62 @@ public:
         PropertyGroupSignals::onPropertyChanged(prop);
     }
 
+    void startMassPropertiesComputation()
+    {
+        m_propertyMassStatus.setValue(std::string(textIdTr("Computing...")));
+        m_isMassPropertiesPending = true;
+        // OCAF data is queried here(main thread), the task only computes the properties of the
+        // collected shapes
+        const MassPropertiesCache::PartsInput parts = m_massPropsCache->missingParts(m_label);
+        MassPropertiesCache* cache = m_massPropsCache;
+        m_massPropsTaskId = m_taskMgr->newTask([=](TaskProgress* progress) {
+            cache->computeParts(parts, progress);
+        });
+
+        // Slot is queued to the main thread and might be called after destruction of this object,
+        // hence the guard token
+        const std::weak_ptr<bool> guard = m_guardToken;
+        m_connTaskEnded = m_taskMgr->signalEnded.connectSlot([=](TaskId taskId) {
+            if (!guard.expired() && taskId == m_massPropsTaskId)
+                this->onMassPropertiesComputed();
+        });
+        m_taskMgr->run(m_massPropsTaskId);
+    }
+
+    void onMassPropertiesComputed()
+    {
+        m_isMassPropertiesPending = false;
+        const std::optional<MassProperties> massProps = m_massPropsCache->find(m_label);
+        {
+            // All values are changed at once, listeners(eg properties editor) are notified below
+            Mayo_PropertyChangedBlocker(this);
+            if (massProps) {
+                this->setMassProperties(*massProps);
+                if (massProps->mass)
+                    m_propertyMassStatus.setValue(std::string(textIdTr("Complete")));
+                else
+                    m_propertyMassStatus.setValue(std::string(textIdTr("No mass, material density is missing")));
+            }
+            else {
+                m_propertyMassStatus.setValue(std::string(textIdTr("Not available")));
+            }
+        }
+
+        this->signalPropertyChanged.send(&m_propertyMassStatus);
+    }
+
+    void setMassProperties(const MassProperties& massProps)
+    {
+        m_propertyComputedCentroid.setValue(massProps.centroid);
+        m_propertyComputedArea.setQuantity(massProps.area);
+        m_propertyComputedVolume.setQuantity(massProps.volume);
+        if (massProps.mass) {
+            m_propertyMass.setQuantity(*massProps.mass);
+            m_propertyCenterOfMass.setValue(massProps.centerOfMass);
+            m_propertyInertiaMoments.setValue(gp_Vec{ massProps.principalMomentsOfInertia() });
+        }
+    }
+
     PropertyString m_propertyName{ this, textId("Name") };
     PropertyString m_propertyShapeType{ this, textId("Shape") };
     PropertyString m_propertyXdeShapeKind{ this, textId("XdeShape") };
@@ -196,10 +280,37 @@ public:
     PropertyArea m_propertyReferredValidationArea{ this, textId("ProductArea") };
     PropertyVolume m_propertyReferredValidationVolume{ this, textId("ProductVolume") };
 
+    PropertyString m_propertyMassStatus{ this, textId("MassProperties") };
+    PropertyOccPnt m_propertyComputedCentroid{ this, textId("ComputedCentroid") };
+    PropertyArea m_propertyComputedArea{ this, textId("ComputedArea") };
+    PropertyVolume m_propertyComputedVolume{ this, textId("ComputedVolume") };
+    PropertyMass m_propertyMass{ this, textId("Mass") };
+    PropertyOccPnt m_propertyCenterOfMass{ this, textId("CenterOfMass") };
+    PropertyOccVec m_propertyInertiaMoments{ this, textId("PrincipalMomentsOfInertia") }; // kg.mm²
+
     TDF_Label m_label;
     TDF_Label m_labelReferred;
+
+    MassPropertiesCache* m_massPropsCache = nullptr;
+    TaskManager* m_taskMgr = nullptr;
+    TaskId m_massPropsTaskId = 0;
+    bool m_isMassPropertiesPending = false;
+    std::shared_ptr<bool> m_guardToken = std::make_shared<bool>(true);
+    SignalConnectionHandle m_connTaskEnded;
 };
 
+XCaf_DocumentTreeNodePropertiesProvider::XCaf_DocumentTreeNodePropertiesProvider()
+{
+    m_connDocumentAboutToClose = Application::instance()->signalDocumentAboutToClose.connectSlot([=](const DocumentPtr& doc) {
+        m_massPropsCache.clear(doc->GetData());
+    });
+}
+
+XCaf_DocumentTreeNodePropertiesProvider::~XCaf_DocumentTreeNodePropertiesProvider()
+{
+    m_connDocumentAboutToClose.disconnect();
+}
+
 bool XCaf_DocumentTreeNodePropertiesProvider::supports(const DocumentTreeNode& treeNode) const
 {
     return GraphicsShapeObjectDriver::shapeSupportStatus(treeNode.label()) == GraphicsObjectDriver::Support::Complete;
@@ -211,7 +322,7 @@ XCaf_DocumentTreeNodePropertiesProvider::properties(const DocumentTreeNode& tree
     if (!treeNode.isValid())
         return {};
 
-    return std::make_unique<Properties>(treeNode);
+    return std::make_unique<Properties>(treeNode, &m_massPropsCache, &m_taskMgr);
 }
 
 class Mesh_DocumentTreeNodePropertiesProvider::Properties : public PropertyGroupSignals {
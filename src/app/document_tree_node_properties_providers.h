@@ -7,19 +7,31 @@
 #pragma once
 
 #include "../base/document_tree_node_properties_provider.h"
+#include "../base/mass_properties.h"
 #include "../base/property_builtins.h"
+#include "../base/signal.h"
+#include "../base/task_manager.h"
 
 #include <TDF_Label.hxx>
 
 namespace Mayo {
 
+// Provides properties of XCAF entities
+// Mass properties are computed in background, they are cached so selecting again the same entity
+// or another instance of the same product gives immediate results
 class XCaf_DocumentTreeNodePropertiesProvider : public DocumentTreeNodePropertiesProvider {
 public:
+    XCaf_DocumentTreeNodePropertiesProvider();
+    ~XCaf_DocumentTreeNodePropertiesProvider();
+
     bool supports(const DocumentTreeNode& treeNode) const override;
     std::unique_ptr<PropertyGroupSignals> properties(const DocumentTreeNode& treeNode) const override;
 
 private:
     class Properties;
+    mutable MassPropertiesCache m_massPropsCache;
+    mutable TaskManager m_taskMgr;
+    SignalConnectionHandle m_connDocumentAboutToClose;
 };
 
 class Mesh_DocumentTreeNodePropertiesProvider : public DocumentTreeNodePropertiesProvider {
@@ -0,0 +1,286 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "io_worker_process.h"
+
+#include "app_module.h"
+#include "filepath_conv.h"
+#include "qsettings_storage.h"
+#include "qstring_conv.h"
+#include "../base/application.h"
+#include "../base/document.h"
+#include "../base/io_system.h"
+#include "../base/messenger.h"
+#include "../base/task_manager.h"
+#include "../base/task_progress.h"
+#include "../base/text_id.h"
+#include "../base/tkernel_utils.h"
+
+#include <BinXCAFDrivers_DocumentRetrievalDriver.hxx>
+#include <BinXCAFDrivers_DocumentStorageDriver.hxx>
+#include <TDocStd_Application.hxx>
+#include <XCAFDoc_DocumentTool.hxx>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QProcess>
+#include <QtCore/QTemporaryFile>
+
+#include <fmt/format.h>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+namespace Mayo {
+
+namespace IO {
+
+// Settings values stored in memory, see WorkerProcessFactoryReader::settingsSnapshot()
+class MemorySettingsStorage : public Settings::Storage {
+public:
+    bool contains(std::string_view key) const override {
+        return m_mapValue.find(std::string(key)) != m_mapValue.cend();
+    }
+
+    Settings::Variant value(std::string_view key) const override {
+        auto itFound = m_mapValue.find(std::string(key));
+        return itFound != m_mapValue.cend() ? itFound->second : Settings::Variant();
+    }
+
+    void setValue(std::string_view key, const Settings::Variant& value) override {
+        m_mapValue.insert_or_assign(std::string(key), value);
+    }
+
+    void sync() override {}
+
+    void copyTo(Settings::Storage* target) const {
+        for (const auto& [key, value] : m_mapValue)
+            target->setValue(key, value);
+
+        target->sync();
+    }
+
+private:
+    std::unordered_map<std::string, Settings::Variant> m_mapValue;
+};
+
+namespace {
+
+const char strProgressPrefix[] = "progress:";
+
+class WorkerProcessReader : public Reader {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::WorkerProcessReader)
+public:
+    WorkerProcessReader(std::shared_ptr<const MemorySettingsStorage> settings)
+        : m_settings(std::move(settings))
+    {}
+
+    bool readFile(const FilePath& fp, TaskProgress* progress) override;
+    TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
+
+    // Reader parameters are part of the application settings given to the worker process
+    void applyProperties(const PropertyGroup* /*params*/) override {}
+
+private:
+    bool error(std::string_view msg);
+
+    std::shared_ptr<const MemorySettingsStorage> m_settings;
+    QTemporaryFile m_fileSettings{ QDir::temp().filePath("mayo_XXXXXX.ini") };
+    QTemporaryFile m_fileOutput{ QDir::temp().filePath("mayo_XXXXXX.myb") };
+};
+
+bool WorkerProcessReader::readFile(const FilePath& fp, TaskProgress* progress)
+{
+    if (!m_fileSettings.open() || !m_fileOutput.open())
+        return this->error(textIdTr("Can't create temporary files"));
+
+    // Files are just reserved, they will be written by QSettings and the worker process
+    m_fileSettings.close();
+    m_fileOutput.close();
+    if (m_settings) {
+        // Settings were captured in their owner thread, this only copies the values
+        QSettingsStorage storage(m_fileSettings.fileName(), QSettings::IniFormat);
+        m_settings->copyTo(&storage);
+    }
+
+    QProcess process;
+    process.setProgram(QCoreApplication::applicationFilePath());
+    process.setArguments({
+                "--io-worker", m_fileOutput.fileName(),
+                "--settings", m_fileSettings.fileName(),
+                filepathTo<QString>(fp)
+    });
+    process.start();
+    if (!process.waitForStarted())
+        return this->error(to_stdString(process.errorString()));
+
+    auto fnReadProgress = [&]{
+        while (process.canReadLine()) {
+            const QByteArray line = process.readLine().trimmed();
+            if (line.startsWith(strProgressPrefix) && progress)
+                progress->setValue(line.mid(int(sizeof(strProgressPrefix)) - 1).toInt());
+        }
+    };
+    while (!process.waitForFinished(100) && process.state() != QProcess::NotRunning) {
+        if (TaskProgress::isAbortRequested(progress)) {
+            process.kill();
+            process.waitForFinished();
+            return false;
+        }
+
+        fnReadProgress();
+    }
+
+    fnReadProgress();
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != EXIT_SUCCESS) {
+        const QString strError = QString::fromUtf8(process.readAllStandardError()).trimmed();
+        return this->error(!strError.isEmpty() ? to_stdString(strError) : textIdTr("Worker process failed"));
+    }
+
+    return true;
+}
+
+TDF_LabelSequence WorkerProcessReader::transfer(DocumentPtr doc, TaskProgress* progress)
+{
+    // Private OCAF application, so the document read isn't part of Mayo's application session
+    Handle_TDocStd_Application occApp = new TDocStd_Application;
+    occApp->DefineFormat(
+                Document::NameFormatBinary, "", "myb",
+                new BinXCAFDrivers_DocumentRetrievalDriver,
+                new BinXCAFDrivers_DocumentStorageDriver
+    );
+    Handle_TDocStd_Document workerDoc;
+    const PCDM_ReaderStatus status = occApp->Open(
+                filepathTo<TCollection_ExtendedString>(filepathFrom(m_fileOutput.fileName())), workerDoc
+    );
+    if (status != PCDM_RS_OK || !workerDoc) {
+        this->error(textIdTr("Can't read document produced by worker process"));
+        return {};
+    }
+
+    TDF_LabelSequence seqLabelFreeShape;
+    XCAFDoc_DocumentTool::ShapeTool(workerDoc->Main())->GetFreeShapes(seqLabelFreeShape);
+    const TDF_LabelSequence seqLabelEntity = doc->xcaf().copyShapes(seqLabelFreeShape);
+    occApp->Close(workerDoc);
+    if (progress)
+        progress->setValue(100);
+
+    return seqLabelEntity;
+}
+
+bool WorkerProcessReader::error(std::string_view msg)
+{
+    if (this->messenger())
+        this->messenger()->emitError(msg);
+
+    return false;
+}
+
+bool isWorkerFormat(Format format)
+{
+    return format == Format_STEP || format == Format_IGES;
+}
+
+} // namespace
+
+WorkerProcessFactoryReader::WorkerProcessFactoryReader(
+        std::unique_ptr<FactoryReader> factory, Settings* settings, std::function<bool()> fnIsEnabled)
+    : m_factory(std::move(factory)),
+      m_settings(settings),
+      m_fnIsEnabled(std::move(fnIsEnabled))
+{
+    if (!m_settings)
+        return;
+
+    // Connection isn't released, Settings object might be destroyed first(see ~AppModule())
+    std::weak_ptr<bool> aliveToken = m_aliveToken;
+    m_settings->signalChanged.connectSlot([=](Property*) {
+        if (!aliveToken.expired())
+            this->captureSettings();
+    });
+    this->captureSettings();
+}
+
+Span<const Format> WorkerProcessFactoryReader::formats() const
+{
+    return m_factory->formats();
+}
+
+std::unique_ptr<Reader> WorkerProcessFactoryReader::create(Format format) const
+{
+    if (isWorkerFormat(format) && WorkerProcessFactoryReader::isSupported() && m_fnIsEnabled && m_fnIsEnabled()) {
+        std::lock_guard<std::mutex> lock(m_mutexSettingsSnapshot);
+        return std::make_unique<WorkerProcessReader>(m_settingsSnapshot);
+    }
+
+    return m_factory->create(format);
+}
+
+std::unique_ptr<PropertyGroup> WorkerProcessFactoryReader::createProperties(Format format, PropertyGroup* parentGroup) const
+{
+    return m_factory->createProperties(format, parentGroup);
+}
+
+bool WorkerProcessFactoryReader::isSupported()
+{
+    // Merging into target document requires XCAFDoc_Editor::CloneShapeLabel()
+    return OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0);
+}
+
+std::shared_ptr<const Settings::Storage> WorkerProcessFactoryReader::settingsSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutexSettingsSnapshot);
+    return m_settingsSnapshot;
+}
+
+void WorkerProcessFactoryReader::captureSettings()
+{
+    // Snapshots are immutable: readers still using the previous one aren't affected
+    auto snapshot = std::make_shared<MemorySettingsStorage>();
+    m_settings->saveAs(snapshot.get(), &AppModule::excludeSettingPredicate);
+    std::lock_guard<std::mutex> lock(m_mutexSettingsSnapshot);
+    m_settingsSnapshot = std::move(snapshot);
+}
+
+} // namespace IO
+
+int ioWorker_exec(Application* app, const FilePath& fileInput, const FilePath& fileOutput)
+{
+    auto appModule = AppModule::get();
+    MessengerByCallback messenger([](Messenger::MessageType msgType, std::string_view text) {
+        if (msgType == Messenger::MessageType::Error)
+            std::cerr << text << std::endl;
+    });
+
+    DocumentPtr doc = app->newDocument();
+    bool okImport = false;
+    TaskManager taskMgr;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        okImport = appModule->ioSystem()->importInDocument()
+                .targetDocument(doc)
+                .withFilepath(fileInput)
+                .withParametersProvider(appModule)
+                .withMessenger(&messenger)
+                .withTaskProgress(progress)
+                .execute();
+    });
+    taskMgr.signalProgressChanged.connectSlot([](TaskId, int pct) {
+        std::cout << IO::strProgressPrefix << pct << std::endl;
+    });
+    taskMgr.exec(taskId);
+    if (!okImport)
+        return EXIT_FAILURE;
+
+    const PCDM_StoreStatus status = app->SaveAs(doc, filepathTo<TCollection_ExtendedString>(fileOutput));
+    if (status != PCDM_SS_OK) {
+        std::cerr << fmt::format("Failed to save document [path={}]", fileOutput.u8string()) << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+} // namespace Mayo
@@ -0,0 +1,74 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/filepath.h"
+#include "../base/io_reader.h"
+#include "../base/settings.h"
+
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace Mayo {
+
+class Application;
+
+namespace IO {
+
+class MemorySettingsStorage;
+
+// Decorates a FactoryReader so that STEP/IGES files are read within separate worker processes
+//
+// OpenCascade STEP/IGES readers rely on global state(eg Interface_Static) so reading such files
+// is serialized even when importing many files "in parallel". A worker process(the same
+// executable run with hidden option --io-worker) reads and transfers the file into a standalone
+// document saved in binary OCAF format, which is then merged into the target document
+//
+// When worker processes are disabled(see 'fnIsEnabled') or not supported, readers are created by
+// the decorated factory
+//
+// Application settings given to the worker processes are captured each time they change, in the
+// thread owning 'settings'. Readers run within import tasks, so they only access that snapshot
+class WorkerProcessFactoryReader : public FactoryReader {
+public:
+    WorkerProcessFactoryReader(
+            std::unique_ptr<FactoryReader> factory,
+            Settings* settings,
+            std::function<bool()> fnIsEnabled
+    );
+
+    Span<const Format> formats() const override;
+    std::unique_ptr<Reader> create(Format format) const override;
+    std::unique_ptr<PropertyGroup> createProperties(Format format, PropertyGroup* parentGroup) const override;
+
+    // Requires OpenCascade >= v7.6.0
+    static bool isSupported();
+
+    // Settings as captured the last time they changed. Can be called from any thread
+    std::shared_ptr<const Settings::Storage> settingsSnapshot() const;
+
+private:
+    void captureSettings();
+
+    std::unique_ptr<FactoryReader> m_factory;
+    Settings* m_settings = nullptr;
+    std::function<bool()> m_fnIsEnabled;
+    std::shared_ptr<const MemorySettingsStorage> m_settingsSnapshot;
+    mutable std::mutex m_mutexSettingsSnapshot;
+    std::shared_ptr<bool> m_aliveToken = std::make_shared<bool>(true);
+};
+
+} // namespace IO
+
+// Entry point of a worker process: imports file 'fileInput' into a new document which is then
+// saved in binary OCAF format to 'fileOutput'
+// Progress is reported on standard output, one "progress:<pct>" line per change
+// Returns the exit code of the process
+int ioWorker_exec(Application* app, const FilePath& fileInput, const FilePath& fileOutput);
+
+} // namespace Mayo
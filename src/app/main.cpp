@@ -22,6 +22,7 @@
 #include "../gui/gui_application.h"
 #include "app_module.h"
 #include "cli_export.h"
+#include "io_worker_process.h"
 #include "console.h"
 #include "document_tree_node_properties_providers.h"
 #include "filepath_conv.h"
@@ -80,6 +81,7 @@ struct CommandLineArguments {
     std::vector<FilePath> listFilepathToExport;
     std::vector<FilePath> listFilepathToOpen;
     bool cliProgressReport = true;
+    FilePath filepathIoWorkerOutput;
 };
 
 class LogMessageHandler {
@@ -214,6 +216,13 @@ static CommandLineArguments processCommandLine()
                 Main::tr("Disable progress reporting in console output(CLI-mode only)"));
     cmdParser.addOption(cmdCliNoProgress);
 
+    QCommandLineOption cmdIoWorker(
+                QStringList{ "io-worker" },
+                Main::tr("Run as import worker process, output document is written to filepath"),
+                Main::tr("filepath"));
+    cmdIoWorker.setFlags(QCommandLineOption::HiddenFromHelp); // Internal use only
+    cmdParser.addOption(cmdIoWorker);
+
     cmdParser.addPositionalArgument(
                 Main::tr("files"),
                 Main::tr("Files to open at startup, optionally"),
@@ -252,6 +261,8 @@ static CommandLineArguments processCommandLine()
     args.includeDebugLogs = cmdParser.isSet(cmdDebugLogs);
 #endif
     args.cliProgressReport = !cmdParser.isSet(cmdCliNoProgress);
+    if (cmdParser.isSet(cmdIoWorker))
+        args.filepathIoWorkerOutput = filepathFrom(cmdParser.value(cmdIoWorker));
 
     return args;
 }
@@ -456,7 +467,12 @@ static int runApp(QCoreApplication* qtApp)
     // Register I/O objects
     IO::System* ioSystem = appModule->ioSystem();
     ioSystem->addFactoryReader(std::make_unique<IO::DxfFactoryReader>());
-    ioSystem->addFactoryReader(std::make_unique<IO::OccFactoryReader>());
+    const bool isIoWorker = !args.filepathIoWorkerOutput.empty();
+    ioSystem->addFactoryReader(std::make_unique<IO::WorkerProcessFactoryReader>(
+                std::make_unique<IO::OccFactoryReader>(),
+                appModule->settings(),
+                [=]{ return !isIoWorker && appModule->properties()->importInWorkerProcesses.value(); }
+    ));
     ioSystem->addFactoryReader(std::make_unique<IO::OffFactoryReader>());
     ioSystem->addFactoryReader(std::make_unique<IO::PlyFactoryReader>());
     ioSystem->addFactoryWriter(std::make_unique<IO::OccFactoryWriter>());
@@ -468,6 +484,17 @@ static int runApp(QCoreApplication* qtApp)
     appModule->properties()->IO_bindParameters(ioSystem);
     appModule->properties()->retranslate();
 
+    // Process worker mode(see IO::WorkerProcessFactoryReader)
+    if (isIoWorker) {
+        if (args.listFilepathToOpen.size() != 1)
+            fnCriticalExit(Main::tr("Import worker expects a single input file"));
+
+        guiApp->setAutomaticDocumentMapping(false); // GuiDocument objects aren't needed
+        appModule->settings()->resetAll();
+        fnLoadAppSettings(appModule->settings());
+        return ioWorker_exec(app, args.listFilepathToOpen.front(), args.filepathIoWorkerOutput);
+    }
+
     // Process CLI
     if (!args.listFilepathToExport.empty()) {
         if (args.listFilepathToOpen.empty())
@@ -552,7 +579,9 @@ int main(int argc, char* argv[])
     QCoreApplication::setOrganizationDomain("www.fougue.pro");
     QCoreApplication::setApplicationName("Mayo");
     QCoreApplication::setApplicationVersion(QString::fromUtf8(Mayo::strVersion));
-    const bool isAppCliMode = fnArgsContainAnyOf({ "-e", "--export", "-h", "--help", "-v", "--version" });
+    const bool isAppCliMode = fnArgsContainAnyOf({
+        "-e", "--export", "-h", "--help", "-v", "--version", "--io-worker"
+    });
     std::unique_ptr<QCoreApplication> ptrApp(
             isAppCliMode ? new QCoreApplication(argc, argv) : new QApplication(argc, argv)
     );
@@ -91,11 +91,15 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
     this->addCommand<CommandChangeDisplayMode>("change-display-mode", m_ui->menu_Display);
     this->addCommand<CommandToggleOriginTrihedron>("toggle-origin-trihedron");
     this->addCommand<CommandTogglePerformanceStats>("toggle-performance-stats");
+    this->addCommand<CommandStopLoadingMeshes>("stop-loading-meshes");
     this->addCommand<CommandZoomInCurrentDocument>("current-doc-zoom-in");
     this->addCommand<CommandZoomOutCurrentDocument>("current-doc-zoom-out");
     // "Tools" commands
     this->addCommand<CommandSaveViewImage>("save-view-image");
     this->addCommand<CommandInspectXde>("inspect-xde");
+    this->addCommand<CommandRemeshDocument>("remesh-doc");
+    this->addCommand<CommandClearanceAnalysis>("clearance-analysis");
+    this->addCommand<CommandInterferenceAnalysis>("interference-analysis");
     this->addCommand<CommandEditOptions>("edit-options");
     // "Window" commands
     this->addCommand<CommandLeftSidebarWidgetToggle>("toggle-left-sidebar");
@@ -128,6 +132,7 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
         menu->addAction(fnGetAction("change-display-mode"));
         menu->addAction(fnGetAction("toggle-origin-trihedron"));
         menu->addAction(fnGetAction("toggle-performance-stats"));
+        menu->addAction(fnGetAction("stop-loading-meshes"));
         menu->addSeparator();
         menu->addAction(fnGetAction("current-doc-zoom-in"));
         menu->addAction(fnGetAction("current-doc-zoom-out"));
@@ -137,6 +142,9 @@ MainWindow::MainWindow(GuiApplication* guiApp, QWidget *parent)
         auto menu = m_ui->menu_Tools;
         menu->addAction(fnGetAction("save-view-image"));
         menu->addAction(fnGetAction("inspect-xde"));
+        menu->addAction(fnGetAction("remesh-doc"));
+        menu->addAction(fnGetAction("clearance-analysis"));
+        menu->addAction(fnGetAction("interference-analysis"));
         menu->addSeparator();
         menu->addAction(fnGetAction("edit-options"));
     }
@@ -336,7 +344,10 @@ void MainWindow::onApplicationItemSelectionChanged()
             auto dataProps = AppModule::get()->properties(docTreeNode);
             if (dataProps) {
                 uiProps->editProperties(dataProps.get(), uiProps->addGroup(tr("Data")));
-                dataProps->signalPropertyChanged.connectSlot([=]{ uiModelTree->refreshItemText(appItem); });
+                dataProps->signalPropertyChanged.connectSlot([=]{
+                    uiModelTree->refreshItemText(appItem);
+                    uiProps->refreshPropertyValues();
+                });
                 m_ptrCurrentNodeDataProperties = std::move(dataProps);
             }
 
@@ -414,6 +425,12 @@ void MainWindow::onGuiDocumentAdded(GuiDocument* guiDoc)
     auto widgetCtrl = widget->controller();
     widgetCtrl->setInstantZoomFactor(appProps->instantZoomFactor);
     widgetCtrl->setNavigationStyle(appProps->navigationStyle);
+    guiDoc->setMeshLevelsOfDetailParameters([=](const TopoDS_Shape& shape) {
+        return appModule->brepMeshParameters(shape);
+    });
+    guiDoc->setMeshLevelsOfDetailEnabled(appProps->meshingLevelsOfDetail);
+    guiDoc->setInteractionCullingSize(appProps->navigationCullingSize);
+    guiDoc->setPointCloudMaxPointBudget(appProps->pointCloudMaxPointCount * 1000000);
     if (appProps->defaultShowOriginTrihedron) {
         guiDoc->toggleOriginTrihedronVisibility();
         gfxScene->redraw();
@@ -424,19 +441,31 @@ void MainWindow::onGuiDocumentAdded(GuiDocument* guiDoc)
             widgetCtrl->setInstantZoomFactor(appProps->instantZoomFactor);
         else if (setting == &appProps->navigationStyle)
             widgetCtrl->setNavigationStyle(appProps->navigationStyle);
+        else if (setting == &appProps->meshingLevelsOfDetail)
+            guiDoc->setMeshLevelsOfDetailEnabled(appProps->meshingLevelsOfDetail);
+        else if (setting == &appProps->navigationCullingSize)
+            guiDoc->setInteractionCullingSize(appProps->navigationCullingSize);
+        else if (setting == &appProps->pointCloudMaxPointCount)
+            guiDoc->setPointCloudMaxPointBudget(appProps->pointCloudMaxPointCount * 1000000);
     });
 
     // React to mouse move in 3D view:
     //   * update highlighting
-    //   * compute and display 3D mouse coordinates(by silent picking)
+    //   * compute and display 3D mouse coordinates(by silent picking, skipped when the spatial
+    //     index of graphics objects tells there is nothing under the mouse)
     widgetCtrl->signalMouseMoved.connectSlot([=](int xPos, int yPos) {
         const double dpRatio = this->devicePixelRatioF();
         gfxScene->highlightAt(xPos * dpRatio, yPos * dpRatio, guiDoc->v3dView());
         widget->view()->redraw();
         auto selector = gfxScene->mainSelector();
-        selector->Pick(xPos, yPos, guiDoc->v3dView());
+        bool isPicked = false;
+        if (guiDoc->hasGraphicsObjectAt(xPos, yPos)) {
+            selector->Pick(xPos, yPos, guiDoc->v3dView());
+            isPicked = selector->NbPicked() > 0;
+        }
+
         const gp_Pnt pos3d =
-                selector->NbPicked() > 0 ?
+                isPicked ?
                     selector->PickedPoint(1) :
                     GraphicsUtils::V3dView_to3dPosition(guiDoc->v3dView(), xPos, yPos);
         m_ui->label_ValuePosX->setText(QString::number(pos3d.X(), 'f', 3));
@@ -0,0 +1,98 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "measure_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <tuple>
+#include <utility>
+
+namespace Mayo {
+
+namespace {
+
+// Returns the coefficients of the 3x4 matrix of transformation 'trsf', suited for comparison
+std::array<double, 12> trsfValues(const gp_Trsf& trsf)
+{
+    std::array<double, 12> values;
+    for (int row = 1; row <= 3; ++row) {
+        for (int col = 1; col <= 4; ++col)
+            values.at((row - 1) * 4 + (col - 1)) = trsf.Value(row, col);
+    }
+
+    return values;
+}
+
+// Returns the values of 'key' to be compared, owners of symmetric measures being ordered by address
+auto keyValues(const MeasureKey& key)
+{
+    const MeasureOwnerState* state1 = &key.state1;
+    const MeasureOwnerState* state2 = &key.state2;
+    const GraphicsOwnerPtr* owner1 = &key.owner1;
+    const GraphicsOwnerPtr* owner2 = &key.owner2;
+    if (MeasureCache::isSymmetric(key.type) && owner2->get() < owner1->get()) {
+        std::swap(owner1, owner2);
+        std::swap(state1, state2);
+    }
+
+    return std::make_tuple(
+                key.type, key.tool, owner1->get(), owner2->get(),
+                trsfValues(state1->trsf), state1->graphicsData.get(),
+                trsfValues(state2->trsf), state2->graphicsData.get()
+    );
+}
+
+} // namespace
+
+MeasureCache::MeasureCache(size_t maxCount)
+    : m_maxCount(std::max<size_t>(maxCount, 1))
+{
+}
+
+const MeasureResult* MeasureCache::find(const MeasureKey& key)
+{
+    auto itFound = m_mapResult.find(key);
+    if (itFound == m_mapResult.end())
+        return nullptr;
+
+    itFound->second.lastUseStamp = ++m_useStamp;
+    return &itFound->second.result;
+}
+
+void MeasureCache::add(const MeasureKey& key, const MeasureResult& result)
+{
+    auto itFound = m_mapResult.find(key);
+    if (itFound == m_mapResult.end()) {
+        // Keep the cache bounded, it holds references to graphics owners and data
+        while (m_mapResult.size() >= m_maxCount) {
+            auto itOldest = std::min_element(
+                        m_mapResult.begin(), m_mapResult.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.second.lastUseStamp < rhs.second.lastUseStamp;
+            });
+            m_mapResult.erase(itOldest);
+        }
+
+        itFound = m_mapResult.insert({ key, Entry{} }).first;
+    }
+
+    itFound->second.result = result;
+    itFound->second.lastUseStamp = ++m_useStamp;
+}
+
+bool MeasureCache::isSymmetric(MeasureType type)
+{
+    return type == MeasureType::MinDistance || type == MeasureType::Angle;
+}
+
+bool MeasureCache::KeyLess::operator()(const MeasureKey& lhs, const MeasureKey& rhs) const
+{
+    // Note: owners and graphics data are kept alive by the cache keys, so their addresses can't
+    //       be reused
+    return keyValues(lhs) < keyValues(rhs);
+}
+
+} // namespace Mayo
@@ -0,0 +1,75 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../graphics/graphics_owner_ptr.h"
+#include "../measure/measure_tool.h"
+#include "../measure/measure_type.h"
+
+#include <QtCore/QString>
+#include <Standard_Transient.hxx>
+#include <gp_Trsf.hxx>
+#include <cstdint>
+#include <map>
+
+namespace Mayo {
+
+// State of a graphics entity when a measure is requested, the measure value depends on it
+struct MeasureOwnerState {
+    gp_Trsf trsf; // Placement of the graphics entity
+    // Data of the graphics object that can be replaced while the entity remains the same(eg mesh
+    // preview completed with full resolution data)
+    Handle_Standard_Transient graphicsData;
+};
+
+// Identifies a measure of one or two graphics entities
+struct MeasureKey {
+    MeasureType type = MeasureType::None;
+    const IMeasureTool* tool = nullptr;
+    GraphicsOwnerPtr owner1;
+    GraphicsOwnerPtr owner2; // Null for measures involving a single entity
+    MeasureOwnerState state1;
+    MeasureOwnerState state2;
+};
+
+// Outcome of a measure computation, 'errorMessage' is empty on success
+struct MeasureResult {
+    MeasureValue value;
+    QString errorMessage;
+};
+
+// Cache of computed measures, least recently used entries are evicted when the cache is full
+// Owners of symmetric measures(minimum distance, angle) are not ordered: measure of A->B is found
+// for B->A
+// Note: graphics owners and data are kept alive by the cache
+class MeasureCache {
+public:
+    MeasureCache(size_t maxCount = 256);
+
+    const MeasureResult* find(const MeasureKey& key);
+    void add(const MeasureKey& key, const MeasureResult& result);
+
+    size_t count() const { return m_mapResult.size(); }
+    size_t maxCount() const { return m_maxCount; }
+
+    static bool isSymmetric(MeasureType type);
+
+private:
+    struct KeyLess {
+        bool operator()(const MeasureKey& lhs, const MeasureKey& rhs) const;
+    };
+    struct Entry {
+        MeasureResult result;
+        uint64_t lastUseStamp = 0;
+    };
+
+    std::map<MeasureKey, Entry, KeyLess> m_mapResult;
+    uint64_t m_useStamp = 0;
+    size_t m_maxCount = 0;
+};
+
+} // namespace Mayo
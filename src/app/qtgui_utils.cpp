@@ -188,6 +188,15 @@ Quantity_Color toPreferredColorSpace(const QColor& c)
 }
 
 QPixmap toQPixmap(const Image_PixMap& pixmap)
+{
+    const QImage img = toQImage(pixmap);
+    if (img.isNull())
+        return {};
+
+    return QPixmap::fromImage(img);
+}
+
+QImage toQImage(const Image_PixMap& pixmap)
 {
     auto fnToQImageFormat = [](Image_Format occFormat) {
         switch (occFormat) {
@@ -204,10 +213,8 @@ QPixmap toQPixmap(const Image_PixMap& pixmap)
                      int(pixmap.Height()),
                      int(pixmap.SizeRowBytes()),
                      fnToQImageFormat(pixmap.Format()));
-    if (img.isNull())
-        return {};
-
-    return QPixmap::fromImage(img);
+    // QImage doesn't own 'pixmap' data
+    return img.copy();
 }
 
 } // namespace QtGuiUtils
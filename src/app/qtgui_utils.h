@@ -14,6 +14,7 @@
 #include <QtGui/QColor>
 #include <QtGui/QFont>
 #include <QtGui/QGradient>
+#include <QtGui/QImage>
 #include <QtGui/QPixmap>
 class QScreen;
 
@@ -37,6 +38,7 @@ Quantity_Color toPreferredColorSpace(const QColor& c);
 
 // Image conversion
 QPixmap toQPixmap(const Image_PixMap& pixmap);
+QImage toQImage(const Image_PixMap& pixmap); // Deep copy, can be called from any thread
 
 // Returns linear interpolated color between 'a' and 'b' at parameter 't'
 QColor lerp(const QColor& a, const QColor& b, double t);
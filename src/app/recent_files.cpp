@@ -6,56 +6,103 @@
 
 #include "recent_files.h"
 
+#include "../base/document.h"
 #include "../base/meta_enum.h"
 #include "../graphics/graphics_utils.h"
 #include "../gui/gui_document.h"
-#include "../io_image/io_image.h"
 #include "filepath_conv.h"
 #include "qstring_conv.h"
 #include "qtgui_utils.h"
-#include "theme.h"
 
 #include <fmt/format.h>
 #include <QtCore/QtDebug>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
 
 namespace Mayo {
 
-bool RecentFile::recordThumbnail(GuiDocument* guiDoc, QSize size)
+Handle_Image_AlienPixMap RecentFile::renderThumbnail(
+        GuiDocument* guiDoc, const IO::ImageWriter::Parameters& params) const
 {
     if (!guiDoc)
-        return false;
+        return {};
 
     if (!filepathEquivalent(this->filepath, guiDoc->document()->filePath())) {
         qDebug() << fmt::format("Filepath mismatch with GUI document\n"
                                       "    Function: {}\n    Filepath: {}\n    Document: {}",
                                 Q_FUNC_INFO, this->filepath.u8string(), guiDoc->document()->filePath().u8string())
                     .c_str();
-        return false;
+        return {};
     }
 
-    if (this->thumbnailTimestamp == RecentFile::timestampLastModified(this->filepath))
-        return true;
-
-    IO::ImageWriter::Parameters params;
-    params.width = size.width();
-    params.height = size.height();
-    params.backgroundColor = QtGuiUtils::toPreferredColorSpace(mayoTheme()->color(Theme::Color::Palette_Window));
     Handle_Image_AlienPixMap pixmap = IO::ImageWriter::createImage(guiDoc, params);
-    if (!pixmap) {
+    if (!pixmap)
         qDebug() << "Empty pixmap returned by IO::ImageWriter::createImage()";
+
+    return pixmap;
+}
+
+bool RecentFile::saveThumbnail(const Handle_Image_AlienPixMap& pixmap) const
+{
+    if (!pixmap)
         return false;
-    }
 
     GraphicsUtils::ImagePixmap_flipY(*pixmap);
     Image_PixMap::SwapRgbaBgra(*pixmap);
-    this->thumbnail = QtGuiUtils::toQPixmap(*pixmap);
-    this->thumbnailTimestamp = RecentFile::timestampLastModified(this->filepath);
+    const QImage image = QtGuiUtils::toQImage(*pixmap);
+    if (image.isNull())
+        return false;
+
+    const QDir dirStore(filepathTo<QString>(RecentFile::thumbnailStoreDirectory()));
+    if (!dirStore.mkpath(".") || !image.save(filepathTo<QString>(this->thumbnailFilepath()), "PNG"))
+        return false;
+
+    // Remove outdated thumbnails of the file
+    const QString strThumbnailFileName = filepathTo<QString>(this->thumbnailFilepath().filename());
+    const QString strPrefix = strThumbnailFileName.left(strThumbnailFileName.indexOf('_') + 1);
+    for (const QString& strFileName : dirStore.entryList({ strPrefix + "*" }, QDir::Files)) {
+        if (strFileName != strThumbnailFileName)
+            QFile::remove(dirStore.filePath(strFileName));
+    }
+
     return true;
 }
 
+QPixmap RecentFile::loadThumbnail() const
+{
+    QPixmap pixmap;
+    if (pixmap.load(filepathTo<QString>(this->thumbnailFilepath())))
+        return pixmap;
+
+    if (!this->thumbnail.isNull() && this->thumbnailTimestamp == RecentFile::timestampLastModified(this->filepath))
+        return this->thumbnail;
+
+    return {};
+}
+
 bool RecentFile::isThumbnailOutOfSync() const
 {
-    return this->thumbnailTimestamp != RecentFile::timestampLastModified(this->filepath);
+    return !filepathExists(this->thumbnailFilepath());
+}
+
+FilePath RecentFile::thumbnailFilepath() const
+{
+    const QByteArray pathHash = QCryptographicHash::hash(
+                filepathTo<QString>(this->filepath).toUtf8(), QCryptographicHash::Md5
+    );
+    const QString strFileName =
+            QString("%1_%2.png")
+            .arg(QString::fromLatin1(pathHash.toHex()))
+            .arg(RecentFile::timestampLastModified(this->filepath));
+    return RecentFile::thumbnailStoreDirectory() / filepathFrom(strFileName);
+}
+
+FilePath RecentFile::thumbnailStoreDirectory()
+{
+    const QString strCacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    return filepathFrom(QDir(strCacheDir).filePath("thumbnails"));
 }
 
 int64_t RecentFile::timestampLastModified(const FilePath& fp)
@@ -79,11 +126,18 @@ bool operator==(const RecentFile& lhs, const RecentFile& rhs)
             && lhs.thumbnailTimestamp == rhs.thumbnailTimestamp;
 }
 
+// Data layout is the one of previous versions, so settings can be exchanged with them
+// Inline thumbnail is written only while the thumbnail store doesn't have an up to date one
 QDataStream& operator<<(QDataStream& stream, const RecentFile& recentFile)
 {
+    const bool isThumbnailInStore = !recentFile.isThumbnailOutOfSync();
     stream << filepathTo<QString>(recentFile.filepath);
-    stream << recentFile.thumbnail;
-    stream << qint64(recentFile.thumbnailTimestamp);
+    stream << (isThumbnailInStore ? QPixmap() : recentFile.thumbnail);
+    const int64_t timestamp =
+            isThumbnailInStore ?
+                RecentFile::timestampLastModified(recentFile.filepath) :
+                recentFile.thumbnailTimestamp;
+    stream << qint64(timestamp);
     return stream;
 }
 
@@ -125,7 +179,7 @@ QDataStream& operator>>(QDataStream& stream, RecentFiles& recentFiles)
 
         RecentFile recent;
         stream >> recent;
-        if (!recent.filepath.empty() && recent.thumbnailTimestamp != 0)
+        if (!recent.filepath.empty())
             recentFiles.push_back(std::move(recent));
     }
 
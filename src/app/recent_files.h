@@ -9,20 +9,35 @@
 #include "../base/filepath.h"
 #include "../base/property_builtins.h"
 
+#include "../io_image/io_image.h"
+
 #include <QtGui/QPixmap>
 #include <vector>
 class QDataStream;
 
 namespace Mayo {
 
-class GuiDocument;
-
+// Thumbnails of recent files are stored as individual image files in a cache directory(the
+// "thumbnail store"), file names being derived from the path and last modification time of the
+// recent file. Thus thumbnails are loaded only when needed and outdated thumbnails are never found
 struct RecentFile {
     FilePath filepath;
+    // Thumbnail kept inline in settings by previous versions, used until the thumbnail store has one
     QPixmap thumbnail;
     int64_t thumbnailTimestamp = 0;
-    bool recordThumbnail(GuiDocument* guiDoc, QSize size);
+
+    // Renders the graphics scene of 'guiDoc'(document of 'filepath') in an offscreen view, so the
+    // presentations already computed are reused. To be called from the GUI thread
+    Handle_Image_AlienPixMap renderThumbnail(GuiDocument* guiDoc, const IO::ImageWriter::Parameters& params) const;
+    // Encodes 'pixmap'(returned by renderThumbnail()) and saves it into the thumbnail store, can be
+    // called from any thread. Note: data of 'pixmap' is modified
+    bool saveThumbnail(const Handle_Image_AlienPixMap& pixmap) const;
+    // Thumbnail from store, or the inline one if still up to date. Null pixmap if there is none
+    QPixmap loadThumbnail() const;
     bool isThumbnailOutOfSync() const;
+    FilePath thumbnailFilepath() const; // Path of the thumbnail file in store, which might not exist
+
+    static FilePath thumbnailStoreDirectory();
     static int64_t timestampLastModified(const FilePath& fp);
 };
 
@@ -23,6 +23,7 @@
 #include <QtCore/QtDebug>
 #include <QtCore/QAbstractAnimation>
 #include <QtCore/QEasingCurve>
+#include <QtCore/QTimer>
 #include <QtGui/QPainter>
 #include <QtGui/QGuiApplication>
 #include <QtWidgets/QBoxLayout>
@@ -160,6 +161,25 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
     layoutBtns->addWidget(m_btnMeasure);
     m_widgetBtns = this->createWidgetPanelContainer(widgetBtnsContents);
 
+    // Points of big point clouds are progressively refined while the view is idle. While the view
+    // is moved, displayed points follow the camera with the low budget
+    m_timerPointCloudRefine = new QTimer(this);
+    m_timerPointCloudRefine->setInterval(100);
+    QObject::connect(m_timerPointCloudRefine, &QTimer::timeout, this, [=]{
+        if (m_guiDoc->isViewInteractionActive())
+            m_guiDoc->updatePointCloudLevelsOfDetail();
+        else if (!m_guiDoc->refinePointCloudLevelsOfDetail())
+            m_timerPointCloudRefine->stop();
+    });
+
+    // Hidden lines are updated once the camera animation is over
+    m_timerHiddenLineRemoval = new QTimer(this);
+    m_timerHiddenLineRemoval->setSingleShot(true);
+    m_timerHiddenLineRemoval->setInterval(100);
+    QObject::connect(m_timerHiddenLineRemoval, &QTimer::timeout, this, [=]{
+        m_guiDoc->updateHiddenLineRemoval();
+    });
+
     auto gfxScene = m_guiDoc->graphicsScene();
     QObject::connect(m_btnFitAll, &ButtonFlat::clicked, this, [=]{
         m_guiDoc->runViewCameraAnimation(&GraphicsUtils::V3dView_fitAll);
@@ -176,14 +196,46 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
                 m_btnMeasure, &ButtonFlat::checked,
                 this, &WidgetGuiDocument::toggleWidgetMeasure
     );
-    m_controller->signalDynamicActionStarted.connectSlot([=]{ m_guiDoc->stopViewCameraAnimation(); });
-    m_controller->signalViewScaled.connectSlot([=]{ m_guiDoc->stopViewCameraAnimation(); });
+    // Box selection doesn't move the view
+    m_controller->signalDynamicActionStarted.connectSlot([=](V3dViewController::DynamicAction action) {
+        if (action == V3dViewController::DynamicAction::BoxSelection)
+            return;
+
+        m_guiDoc->stopViewCameraAnimation();
+        m_guiDoc->setViewInteractionActive(true);
+        this->restartPointCloudRefinement();
+    });
+    m_controller->signalViewScaled.connectSlot([=]{
+        m_guiDoc->stopViewCameraAnimation();
+        m_guiDoc->updateMeshLevelsOfDetail();
+        this->restartPointCloudRefinement();
+    });
+    m_controller->signalDynamicActionEnded.connectSlot([=](V3dViewController::DynamicAction action) {
+        if (action == V3dViewController::DynamicAction::BoxSelection)
+            return;
+
+        m_guiDoc->setViewInteractionActive(false);
+        m_guiDoc->updateMeshLevelsOfDetail();
+        m_guiDoc->updateHiddenLineRemoval();
+        this->restartPointCloudRefinement();
+    });
+    m_guiDoc->signalGraphicsBoundingBoxChanged.connectSlot([=](const Bnd_Box&) {
+        this->restartPointCloudRefinement();
+    });
     m_controller->signalMouseButtonClicked.connectSlot([=](Aspect_VKeyMouse btn) {
         if (btn == Aspect_VKeyMouse_LeftButton && !m_guiDoc->processAction(gfxScene->currentHighlightedOwner())) {
             gfxScene->select();
             m_qtOccView->redraw();
         }
     });
+    m_controller->signalBoxSelected.connectSlot([=](int xMin, int yMin, int xMax, int yMax) {
+        const double dpRatio = m_guiDoc->devicePixelRatio();
+        const std::vector<GraphicsObjectPtr> vecObject = m_guiDoc->graphicsObjectsInside(
+                    xMin * dpRatio, yMin * dpRatio, xMax * dpRatio, yMax * dpRatio
+        );
+        gfxScene->selectObjects(vecObject);
+        m_qtOccView->redraw();
+    });
     m_controller->signalMultiSelectionToggled.connectSlot([=](bool on) {
         auto mode = on ? GraphicsScene::SelectionMode::Multi : GraphicsScene::SelectionMode::Single;
         gfxScene->setSelectionMode(mode);
@@ -191,8 +243,11 @@ WidgetGuiDocument::WidgetGuiDocument(GuiDocument* guiDoc, QWidget* parent)
 
     m_guiDoc->viewCameraAnimation()->setBackend(std::make_unique<QtAnimationBackend>(QEasingCurve::OutExpo));
     m_guiDoc->viewCameraAnimation()->setRenderFunction([=](const Handle_V3d_View& view){
-        if (view == m_qtOccView->v3dView())
+        if (view == m_qtOccView->v3dView()) {
             m_qtOccView->redraw();
+            if (m_guiDoc->isHiddenLineRemovalActive())
+                m_timerHiddenLineRemoval->start();
+        }
     });
 }
 
@@ -280,6 +335,12 @@ void WidgetGuiDocument::toggleWidgetMeasure(bool on)
     this->updageWidgetPanelControls(m_widgetMeasure, m_btnMeasure);
 }
 
+void WidgetGuiDocument::restartPointCloudRefinement()
+{
+    m_guiDoc->resetPointCloudLevelsOfDetail();
+    m_timerPointCloudRefine->start();
+}
+
 void WidgetGuiDocument::exclusiveButtonCheck(ButtonFlat* btnCheck)
 {
     if (!btnCheck || !btnCheck->isChecked())
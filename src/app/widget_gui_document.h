@@ -13,6 +13,7 @@
 #include <QtWidgets/QWidget>
 #include <V3d_TypeOfOrientation.hxx>
 #include <vector>
+class QTimer;
 
 namespace Mayo {
 
@@ -46,6 +47,7 @@ private:
     void toggleWidgetClipPlanes(bool on);
     void toggleWidgetExplode(bool on);
     void toggleWidgetMeasure(bool on);
+    void restartPointCloudRefinement();
     void exclusiveButtonCheck(ButtonFlat* btn);
 
     void recreateMenuViewProjections(QWidget* container);
@@ -62,6 +64,8 @@ private:
     WidgetClipPlanes* m_widgetClipPlanes = nullptr;
     WidgetExplodeAssembly* m_widgetExplodeAsm = nullptr;
     WidgetMeasure* m_widgetMeasure = nullptr;
+    QTimer* m_timerPointCloudRefine = nullptr;
+    QTimer* m_timerHiddenLineRemoval = nullptr;
     QRect m_rectControls;
 
     ButtonFlat* m_btnFitAll = nullptr;
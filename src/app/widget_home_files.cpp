@@ -84,8 +84,11 @@ public:
             pixmap = fnPixmap(mayoTheme()->icon(Theme::Icon::OpenFiles), 128, 96);
         }
         else {
+            // Thumbnail file is loaded only when the item is painted
             const RecentFile* recentFile = AppModule::get()->findRecentFile(filepathFrom(url));
-            pixmap = recentFile ? recentFile->thumbnail : QPixmap();
+            if (recentFile)
+                pixmap = recentFile->loadThumbnail();
+
             if (pixmap.isNull()) {
                 const QIcon icon = m_fileIconProvider.icon(QFileInfo(url));
                 pixmap = fnPixmap(icon, 64, 64);
@@ -106,6 +109,18 @@ public:
         this->endResetModel();
     }
 
+    void onThumbnailRecorded(const FilePath& fp)
+    {
+        for (int row = 0; row < m_storage->count(); ++row) {
+            const HomeFileItem* item = m_storage->at(row);
+            if (item->type == HomeFileItem::Type::RecentFile && filepathEquivalent(item->filepath, fp)) {
+                QPixmapCache::remove(item->imageUrl);
+                const QModelIndex indexItem = this->index(row, 0);
+                emit this->dataChanged(indexItem, indexItem);
+            }
+        }
+    }
+
 private:
     void reloadRecentFiles()
     {
@@ -226,6 +241,7 @@ WidgetHomeFiles::WidgetHomeFiles(QWidget* parent)
         if (setting == &appModule->properties()->recentFiles)
             model->reload();
     });
+    appModule->signalRecentFileThumbnailRecorded.connectSlot(&HomeFilesModel::onThumbnailRecorded, model);
 }
 
 void WidgetHomeFiles::resizeEvent(QResizeEvent* event)
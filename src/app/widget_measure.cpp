@@ -10,13 +10,19 @@
 #include "theme.h"
 #include "ui_widget_measure.h"
 
+#include "../base/application.h"
 #include "../base/unit_system.h"
 #include "../gui/gui_document.h"
 #include "../measure/measure_tool_brep.h"
+#include "../measure/measure_tool_mesh.h"
 
+#include <QtCore/QPointer>
 #include <QtCore/QtDebug>
 #include <QtGui/QFontDatabase>
+#include <MeshVS_Mesh.hxx>
+#include <Standard_Failure.hxx>
 
+#include <algorithm>
 #include <cmath>
 #include <codecvt>
 #include <vector>
@@ -46,6 +52,21 @@ IMeasureTool* findSupportingMeasureTool(const GraphicsObjectPtr& gfxObject, Meas
     return nullptr;
 }
 
+// Returns the tool object adapted for the graphics entity 'owner' and measure type
+IMeasureTool* findSupportingMeasureTool(const GraphicsOwnerPtr& owner, MeasureType measureType)
+{
+    auto gfxObject = owner ? GraphicsObjectPtr::DownCast(owner->Selectable()) : GraphicsObjectPtr();
+    return gfxObject ? findSupportingMeasureTool(gfxObject, measureType) : nullptr;
+}
+
+// Returns the graphics data of 'owner' which can be replaced while 'owner' remains the same
+// Currently this is the data source of mesh objects(see MeshPreviewController)
+Handle_Standard_Transient graphicsData(const GraphicsOwnerPtr& owner)
+{
+    auto mesh = owner ? Handle_MeshVS_Mesh::DownCast(owner->Selectable()) : Handle_MeshVS_Mesh();
+    return mesh ? mesh->GetDataSource() : Handle_Standard_Transient();
+}
+
 // Helper function to iterate and execute function 'fn' on all the graphics objects owned by a
 // measure display
 template<typename Function>
@@ -71,8 +92,14 @@ WidgetMeasure::WidgetMeasure(GuiDocument* guiDoc, QWidget* parent)
       m_ui(new Ui_WidgetMeasure),
       m_guiDoc(guiDoc)
 {
-    if (getMeasureTools().empty())
+    if (getMeasureTools().empty()) {
         getMeasureTools().push_back(std::make_unique<MeasureToolBRep>());
+        getMeasureTools().push_back(std::make_unique<MeasureToolMesh>());
+        // Cached mesh data mustn't keep the meshes of closed documents alive
+        Application::instance()->signalDocumentAboutToClose.connectSlot([](const DocumentPtr&) {
+            MeasureToolMesh::clearCache();
+        });
+    }
 
     m_ui->setupUi(this);
     QObject::connect(
@@ -92,12 +119,26 @@ WidgetMeasure::WidgetMeasure(GuiDocument* guiDoc, QWidget* parent)
                 this, &WidgetMeasure::onMeasureUnitsChanged
     );
 
+    // Slot might be called after destruction of the widget(it's queued when the signal is emitted
+    // from a worker thread), hence the guard pointer
+    QPointer<WidgetMeasure> guard(this);
+    m_connTaskEnded = m_taskMgr.signalEnded.connectSlot([=](TaskId taskId) {
+        if (guard)
+            guard->onMeasureTaskEnded(taskId);
+    });
+
     this->onMeasureTypeChanged(m_ui->combo_MeasureType->currentIndex());
     this->updateMessagePanel();
 }
 
 WidgetMeasure::~WidgetMeasure()
 {
+    // Computations in progress are interrupted, so destruction of 'm_taskMgr' doesn't wait for them
+    // to complete
+    m_connTaskEnded.disconnect();
+    for (const auto& [taskId, batch] : m_mapTaskBatch)
+        m_taskMgr.requestAbort(taskId);
+
     delete m_ui;
 }
 
@@ -111,6 +152,7 @@ void WidgetMeasure::setMeasureOn(bool on)
                 gfxScene->signalSelectionChanged.connectSlot(&WidgetMeasure::onGraphicsSelectionChanged, this);
     }
     else {
+        this->abortMeasureComputation();
         gfxScene->foreachDisplayedObject([=](const GraphicsObjectPtr& gfxObject) {
             gfxScene->deactivateObjectSelection(gfxObject);
             gfxScene->activateObjectSelection(gfxObject, 0);
@@ -198,15 +240,19 @@ void WidgetMeasure::onMeasureTypeChanged(int id)
             m_tool = findSupportingMeasureTool(gfxObject, measureType);
     });
 
-    // Apply 3D selection modes required by the measure tool
+    this->abortMeasureComputation();
+
+    // Apply 3D selection modes required by the measure tool of each object(shapes and meshes are
+    // handled by different tools)
     gfxScene->clearSelection();
     gfxScene->foreachDisplayedObject([=](const GraphicsObjectPtr& gfxObject) {
         if (GuiDocument::isAisViewCubeObject(gfxObject))
             return; // Skip
 
         gfxScene->deactivateObjectSelection(gfxObject);
-        if (m_tool) {
-            for (GraphicsObjectSelectionMode mode : m_tool->selectionModes(measureType))
+        const IMeasureTool* tool = findSupportingMeasureTool(gfxObject, measureType);
+        if (tool) {
+            for (GraphicsObjectSelectionMode mode : tool->selectionModes(measureType))
                 gfxScene->activateObjectSelection(gfxObject, mode);
         }
     });
@@ -284,64 +330,198 @@ void WidgetMeasure::onGraphicsSelectionChanged()
     m_guiDoc->graphicsScene()->redraw();
     m_errorMessage.clear();
 
+    // Results of computation in progress would be outdated
+    this->abortMeasureComputation();
+
     // Exit if no measure tool available
-    if (!m_tool)
+    if (!m_tool) {
+        this->updateMessagePanel();
         return;
-
-    // Holds MeasureDisplay objects created for new selected graphics
-    std::vector<IMeasureDisplayPtr> vecNewMeasureDisplay;
-
-    // Helper to ease addition(registration) of MeasureDisplay object
-    auto fnAddMeasureDisplay = [&](
-            std::unique_ptr<IMeasureDisplay> ptr,
-            std::initializer_list<GraphicsOwnerPtr> listOwner)
-    {
-        if (ptr) {
-            vecNewMeasureDisplay.push_back(std::move(ptr));
-            for (const GraphicsOwnerPtr& owner : listOwner)
-                this->addLink(owner, vecNewMeasureDisplay.back());
-        }
-    };
+    }
 
     const MeasureType measureType = this->currentMeasureType();
-    // Create MeasureDisplay objects needing a newly single selected graphics object
+    std::vector<MeasureRequest> vecRequest;
+    // Measures needing a newly single selected graphics object
     for (const GraphicsOwnerPtr& owner : vecNewSelected) {
-        try {
-            const MeasureValue value = IMeasureTool_computeValue(*m_tool, measureType, owner);
-            if (MeasureValue_isValid(value))
-                fnAddMeasureDisplay(BaseMeasureDisplay::createFrom(measureType, value), { owner });
-        } catch (const IMeasureError& err) {
-            m_errorMessage = to_QString(err.message());
-        }
+        const IMeasureTool* tool = findSupportingMeasureTool(owner, measureType);
+        if (tool)
+            vecRequest.push_back(makeMeasureRequest(measureType, owner, {}, tool));
     }
 
-    // Create MeasureDisplay objects needing currently two selected graphics objects
+    // Measure needing currently two selected graphics objects
+    // Note: 'owner2' not supported by the tool of 'owner1' is reported as a measure error
     if (m_vecSelectedOwner.size() == 2) {
         const GraphicsOwnerPtr& owner1 = m_vecSelectedOwner.front();
         const GraphicsOwnerPtr& owner2 = m_vecSelectedOwner.back();
-        try {
-            const MeasureValue value = IMeasureTool_computeValue(*m_tool, measureType, owner1, owner2);
-            if (MeasureValue_isValid(value))
-                fnAddMeasureDisplay(BaseMeasureDisplay::createFrom(measureType, value), { owner1, owner2 });
-        } catch (const IMeasureError& err) {
-            m_errorMessage = to_QString(err.message());
-        }
+        const IMeasureTool* tool = findSupportingMeasureTool(owner1, measureType);
+        if (tool)
+            vecRequest.push_back(makeMeasureRequest(measureType, owner1, owner2, tool));
     }
 
-    // Display new measure graphics objects
-    for (IMeasureDisplayPtr& measure : vecNewMeasureDisplay) {
-        measure->update(this->currentMeasureDisplayConfig());
-        foreachGraphicsObject(measure, [=](const GraphicsObjectPtr& gfxObject) {
-            gfxObject->SetZLayer(Graphic3d_ZLayerId_Topmost);
-            gfxScene->addObject(gfxObject);
-        });
+    // Apply cached results, the others are computed in background
+    std::vector<MeasureRequest> vecRequestToCompute;
+    for (MeasureRequest& request : vecRequest) {
+        const MeasureResult* cachedResult = m_measureCache.find(request);
+        if (cachedResult) {
+            this->applyMeasureResult(request, *cachedResult);
+        }
+        else {
+            request.snapshot1 = request.tool->snapshotOwner(request.owner1);
+            if (request.owner2) {
+                const IMeasureTool* tool2 = findSupportingMeasureTool(request.owner2, request.type);
+                request.snapshot2 = (tool2 ? tool2 : request.tool)->snapshotOwner(request.owner2);
+            }
 
-        m_vecMeasureDisplay.push_back(std::move(measure));
+            vecRequestToCompute.push_back(std::move(request));
+        }
     }
 
+    if (!vecRequestToCompute.empty())
+        this->startMeasureComputation(std::move(vecRequestToCompute));
+
+    gfxScene->redraw();
     this->updateMessagePanel();
 }
 
+MeasureResult WidgetMeasure::computeMeasure(const MeasureRequest& request, TaskProgress* progress)
+{
+    MeasureResult result;
+    try {
+        if (request.snapshot2)
+            result.value = IMeasureTool_computeValue(*request.tool, request.type, request.snapshot1, request.snapshot2, progress);
+        else
+            result.value = IMeasureTool_computeValue(*request.tool, request.type, request.snapshot1);
+    } catch (const IMeasureError& err) {
+        result.errorMessage = to_QString(err.message());
+    } catch (const Standard_Failure& err) {
+        result.errorMessage = to_QString(err.GetMessageString());
+    }
+
+    return result;
+}
+
+void WidgetMeasure::startMeasureComputation(std::vector<MeasureRequest> vecRequest)
+{
+    auto batch = std::make_shared<MeasureBatch>();
+    batch->vecRequest = std::move(vecRequest);
+    batch->vecResult.resize(batch->vecRequest.size());
+    const TaskId taskId = m_taskMgr.newTask([=](TaskProgress* progress) {
+        for (size_t i = 0; i < batch->vecRequest.size(); ++i) {
+            if (progress->isAbortRequested())
+                return;
+
+            MeasureResult result = WidgetMeasure::computeMeasure(batch->vecRequest.at(i), progress);
+            // Interrupted computation, its result mustn't be cached
+            if (progress->isAbortRequested())
+                return;
+
+            batch->vecResult.at(i) = std::move(result);
+        }
+    });
+    m_mapTaskBatch.insert({ taskId, batch });
+    m_currentTaskId = taskId;
+    m_isMeasurePending = true;
+    m_taskMgr.run(taskId);
+}
+
+void WidgetMeasure::abortMeasureComputation()
+{
+    // Measures already computed by the task will be cached but not displayed, the one in progress
+    // is interrupted if the measure tool supports it(eg BRep minimum distance)
+    if (m_isMeasurePending) {
+        m_taskMgr.requestAbort(m_currentTaskId);
+        m_isMeasurePending = false;
+    }
+}
+
+void WidgetMeasure::onMeasureTaskEnded(TaskId taskId)
+{
+    auto itBatch = m_mapTaskBatch.find(taskId);
+    if (itBatch == m_mapTaskBatch.end())
+        return;
+
+    const std::shared_ptr<MeasureBatch> batch = itBatch->second;
+    m_mapTaskBatch.erase(itBatch);
+
+    const bool isCurrentTask = m_isMeasurePending && taskId == m_currentTaskId;
+    for (size_t i = 0; i < batch->vecRequest.size(); ++i) {
+        const std::optional<MeasureResult>& result = batch->vecResult.at(i);
+        if (!result)
+            continue; // Skipped because of abort
+
+        const MeasureRequest& request = batch->vecRequest.at(i);
+        m_measureCache.add(request, *result);
+        if (isCurrentTask && this->isMeasureRequestSelected(request))
+            this->applyMeasureResult(request, *result);
+    }
+
+    if (isCurrentTask) {
+        m_isMeasurePending = false;
+        m_guiDoc->graphicsScene()->redraw();
+        this->updateMessagePanel();
+    }
+}
+
+void WidgetMeasure::applyMeasureResult(const MeasureRequest& request, const MeasureResult& result)
+{
+    if (!result.errorMessage.isEmpty()) {
+        m_errorMessage = result.errorMessage;
+        return;
+    }
+
+    if (!MeasureValue_isValid(result.value))
+        return;
+
+    IMeasureDisplayPtr measure = BaseMeasureDisplay::createFrom(request.type, result.value);
+    if (!measure)
+        return;
+
+    this->addLink(request.owner1, measure);
+    if (request.owner2)
+        this->addLink(request.owner2, measure);
+
+    measure->update(this->currentMeasureDisplayConfig());
+    auto gfxScene = m_guiDoc->graphicsScene();
+    foreachGraphicsObject(measure, [=](const GraphicsObjectPtr& gfxObject) {
+        gfxObject->SetZLayer(Graphic3d_ZLayerId_Topmost);
+        gfxScene->addObject(gfxObject);
+    });
+
+    m_vecMeasureDisplay.push_back(std::move(measure));
+}
+
+bool WidgetMeasure::isMeasureRequestSelected(const MeasureRequest& request) const
+{
+    if (request.type != this->currentMeasureType())
+        return false;
+
+    auto fnIsSelected = [=](const GraphicsOwnerPtr& owner) {
+        return std::find(m_vecSelectedOwner.begin(), m_vecSelectedOwner.end(), owner) != m_vecSelectedOwner.end();
+    };
+    if (request.owner2)
+        return m_vecSelectedOwner.size() == 2 && fnIsSelected(request.owner1) && fnIsSelected(request.owner2);
+    else
+        return fnIsSelected(request.owner1);
+}
+
+WidgetMeasure::MeasureRequest WidgetMeasure::makeMeasureRequest(
+        MeasureType type,
+        const GraphicsOwnerPtr& owner1,
+        const GraphicsOwnerPtr& owner2,
+        const IMeasureTool* tool)
+{
+    MeasureRequest request;
+    request.type = type;
+    request.owner1 = owner1;
+    request.owner2 = owner2;
+    request.tool = tool;
+    request.state1 = { owner1->Location().Transformation(), graphicsData(owner1) };
+    if (owner2)
+        request.state2 = { owner2->Location().Transformation(), graphicsData(owner2) };
+
+    return request;
+}
+
 void WidgetMeasure::updateMessagePanel()
 {
     // Clear message panel
@@ -369,7 +549,10 @@ void WidgetMeasure::updateMessagePanel()
                     .arg(mayoTheme()->color(msgTextColorRole).name(),
                          mayoTheme()->color(msgBackgroundColorRole).name())
         );
-        const QString msg = m_errorMessage.isEmpty() ? tr("Select entities to measure") : m_errorMessage;
+        QString msg = m_errorMessage;
+        if (msg.isEmpty())
+            msg = m_isMeasurePending ? tr("Computing measure...") : tr("Select entities to measure");
+
         labelMessage->setText(msg);
     }
     else {
@@ -397,6 +580,9 @@ void WidgetMeasure::updateMessagePanel()
                 fnAddMeasureText(sumMeasure);
             }
         }
+
+        if (m_isMeasurePending)
+            m_ui->layout_Message->addWidget(new QLabel(tr("Computing measure..."), m_ui->widget_Message));
     }
 
     emit this->sizeAdjustmentRequested();
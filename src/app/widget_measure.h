@@ -6,12 +6,16 @@
 
 #pragma once
 
+#include "measure_cache.h"
 #include "../base/signal.h"
+#include "../base/task_manager.h"
 #include "../measure/measure_display.h"
 #include "../measure/measure_tool.h"
 
 #include <QtWidgets/QWidget>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -20,6 +24,9 @@ namespace Mayo {
 
 class GuiDocument;
 
+// Measure values are computed in background threads, computation in progress being dropped when
+// graphics selection changes. Computed values are cached, so selecting again some entities gives
+// instant results
 class WidgetMeasure : public QWidget {
     Q_OBJECT
 public:
@@ -47,6 +54,28 @@ private:
 
     void onGraphicsSelectionChanged();
 
+    // Measure computation of one or two graphics entities
+    struct MeasureRequest : public MeasureKey {
+        // Copies of the owners actually used for computation(see IMeasureTool::snapshotOwner())
+        GraphicsOwnerPtr snapshot1;
+        GraphicsOwnerPtr snapshot2;
+    };
+
+    // Must be called in the main thread, as graphics entities are accessed
+    static MeasureRequest makeMeasureRequest(
+            MeasureType type,
+            const GraphicsOwnerPtr& owner1,
+            const GraphicsOwnerPtr& owner2,
+            const IMeasureTool* tool
+    );
+
+    static MeasureResult computeMeasure(const MeasureRequest& request, TaskProgress* progress);
+    void startMeasureComputation(std::vector<MeasureRequest> vecRequest);
+    void abortMeasureComputation();
+    void onMeasureTaskEnded(TaskId taskId);
+    void applyMeasureResult(const MeasureRequest& request, const MeasureResult& result);
+    bool isMeasureRequestSelected(const MeasureRequest& request) const;
+
     void updateMessagePanel();
 
     using IMeasureDisplayPtr = std::unique_ptr<IMeasureDisplay>;
@@ -70,6 +99,19 @@ private:
     IMeasureTool* m_tool = nullptr;
     QString m_errorMessage;
     SignalConnectionHandle m_connGraphicsSelectionChanged;
+
+    MeasureCache m_measureCache;
+
+    // Measures computed by a background task
+    struct MeasureBatch {
+        std::vector<MeasureRequest> vecRequest;
+        std::vector<std::optional<MeasureResult>> vecResult; // Same size as 'vecRequest'
+    };
+    TaskManager m_taskMgr;
+    std::map<TaskId, std::shared_ptr<MeasureBatch>> m_mapTaskBatch;
+    TaskId m_currentTaskId = 0;
+    bool m_isMeasurePending = false; // Results of task 'm_currentTaskId' are awaited
+    SignalConnectionHandle m_connTaskEnded;
 };
 
 } // namespace Mayo
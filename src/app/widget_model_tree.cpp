@@ -9,25 +9,19 @@
 #include "../base/application.h"
 #include "../base/application_item_selection_model.h"
 #include "../base/document.h"
-#include "../base/settings.h"
+#include "../base/xcaf.h"
 #include "../gui/gui_application.h"
+#include "document_tree_item_model.h"
 #include "item_view_buttons.h"
-#include "qtcore_utils.h"
 #include "theme.h"
+#include "ui_widget_model_tree.h"
 #include "widget_model_tree_builder.h"
 
-#include <QtCore/QtDebug>
-#include <QtCore/QMetaType>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
+#include <QtCore/QItemSelection>
 
 #include <gsl/util>
-#include <cassert>
 #include <memory>
-#include <unordered_map>
-
-Q_DECLARE_METATYPE(Mayo::DocumentPtr)
-Q_DECLARE_METATYPE(Mayo::DocumentTreeNode)
+#include <vector>
 
 namespace Mayo {
 namespace Internal {
@@ -41,89 +35,6 @@ static std::vector<WidgetModelTree::BuilderPtr>& arrayPrototypeBuilder()
     return vecPtrBuilder;
 }
 
-class TreeWidget : public QTreeWidget {
-public:
-    TreeWidget(QWidget* parent = nullptr)
-        : QTreeWidget(parent)
-    { }
-
-    QModelIndex indexFromItem(QTreeWidgetItem* item, int column = 0) const {
-        return QTreeWidget::indexFromItem(item, column);
-    }
-
-    QTreeWidgetItem* itemFromIndex(const QModelIndex& index) const {
-        return QTreeWidget::itemFromIndex(index);
-    }
-};
-
-} // namespace Internal
-} // namespace Mayo
-#include "ui_widget_model_tree.h"
-
-namespace Mayo {
-
-namespace Internal {
-
-enum TreeItemRole {
-    TreeItemTypeRole = Qt::UserRole + 1,
-    TreeItemDocumentRole,
-    TreeItemDocumentTreeNodeRole
-};
-
-enum TreeItemType {
-    TreeItemType_Unknown = 0,
-    TreeItemType_Document = 0x01,
-    TreeItemType_DocumentTreeNode = 0x02,
-    TreeItemType_DocumentEntity = 0x10 | TreeItemType_DocumentTreeNode
-};
-
-static TreeItemType treeItemType(const QTreeWidgetItem* treeItem)
-{
-    const QVariant varType = treeItem->data(0, TreeItemTypeRole);
-    return varType.isValid() ?
-                static_cast<Internal::TreeItemType>(varType.toInt()) :
-                Internal::TreeItemType_Unknown;
-}
-
-static DocumentPtr treeItemDocument(const QTreeWidgetItem* treeItem)
-{
-    //Expects(treeItemType(treeItem) == TreeItemType_Document);
-    const QVariant var = treeItem->data(0, TreeItemDocumentRole);
-    return var.isValid() ? var.value<DocumentPtr>() : DocumentPtr();
-}
-
-static DocumentTreeNode treeItemDocumentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    //Expects(treeItemType(treeItem) & TreeItemType_DocumentTreeNode);
-    const QVariant var = treeItem->data(0, TreeItemDocumentTreeNodeRole);
-    return var.isValid() ? var.value<DocumentTreeNode>() : DocumentTreeNode::null();
-}
-
-static void setTreeItemDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc)
-{
-    treeItem->setData(0, TreeItemTypeRole, Internal::TreeItemType_Document);
-    treeItem->setData(0, TreeItemDocumentRole, QVariant::fromValue(doc));
-}
-
-static void setTreeItemDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    const TreeItemType treeItemType =
-            node.isEntity() ? TreeItemType_DocumentEntity : TreeItemType_DocumentTreeNode;
-    treeItem->setData(0, TreeItemTypeRole, treeItemType);
-    treeItem->setData(0, TreeItemDocumentTreeNodeRole, QVariant::fromValue(node));
-}
-
-static ApplicationItem toApplicationItem(const QTreeWidgetItem* treeItem)
-{
-    const TreeItemType type = Internal::treeItemType(treeItem);
-    if (type == TreeItemType_Document)
-        return ApplicationItem(Internal::treeItemDocument(treeItem));
-    else if (type & TreeItemType_DocumentTreeNode)
-        return ApplicationItem(Internal::treeItemDocumentTreeNode(treeItem));
-
-    return ApplicationItem();
-}
-
 } // namespace Internal
 
 WidgetModelTree::WidgetModelTree(QWidget* widget)
@@ -131,14 +42,17 @@ WidgetModelTree::WidgetModelTree(QWidget* widget)
       m_ui(new Ui_WidgetModelTree)
 {
     m_ui->setupUi(this);
-    m_ui->treeWidget_Model->setUniformRowHeights(true);
+    m_itemModel = new DocumentTreeItemModel(this);
     for (const BuilderPtr& ptrBuilder : Internal::arrayPrototypeBuilder()) {
         m_vecBuilder.push_back(ptrBuilder->clone());
-        m_vecBuilder.back()->setTreeWidget(m_ui->treeWidget_Model);
+        m_vecBuilder.back()->setItemModel(m_itemModel);
+        m_itemModel->addBuilder(m_vecBuilder.back().get());
     }
 
+    m_ui->treeView_Model->setModel(m_itemModel);
+
     // Add action "Remove item from document"
-    auto modelTreeBtns = new ItemViewButtons(m_ui->treeWidget_Model, this);
+    auto modelTreeBtns = new ItemViewButtons(m_ui->treeView_Model, this);
     constexpr int idBtnRemove = 1;
     modelTreeBtns->addButton(
                 idBtnRemove,
@@ -146,8 +60,8 @@ WidgetModelTree::WidgetModelTree(QWidget* widget)
                 tr("Remove from document"));
     modelTreeBtns->setButtonDetection(
                 idBtnRemove,
-                Internal::TreeItemTypeRole,
-                QVariant(Internal::TreeItemType_DocumentEntity));
+                DocumentTreeItemModel::ItemTypeRole,
+                QVariant(DocumentTreeItemModel::ItemType_DocumentEntity));
     modelTreeBtns->setButtonDisplayColumn(idBtnRemove, 0);
     modelTreeBtns->setButtonDisplayModes(idBtnRemove, ItemViewButtons::DisplayOnDetection);
     modelTreeBtns->setButtonItemSide(idBtnRemove, ItemViewButtons::ItemRightSide);
@@ -158,13 +72,10 @@ WidgetModelTree::WidgetModelTree(QWidget* widget)
                 modelTreeBtns, &ItemViewButtons::buttonClicked,
                 this, [=](int btnId, const QModelIndex& index) {
         if (btnId == idBtnRemove && index.isValid()) {
-            const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-            const DocumentTreeNode entityNode = Internal::treeItemDocumentTreeNode(treeItem);
+            const DocumentTreeNode entityNode = m_itemModel->documentTreeNode(index);
             entityNode.document()->destroyEntity(entityNode.id());
         }
     });
-
-    this->connectTreeModelDataChanged(true);
 }
 
 WidgetModelTree::~WidgetModelTree()
@@ -174,18 +85,22 @@ WidgetModelTree::~WidgetModelTree()
 
 void WidgetModelTree::refreshItemText(const ApplicationItem& appItem)
 {
-    if (appItem.isDocument()) {
-        const DocumentPtr doc = appItem.document();
-        QTreeWidgetItem* treeItem = this->findTreeItem(doc);
-        if (treeItem)
-            this->findSupportBuilder(doc)->refreshTextTreeItem(doc, treeItem);
-    }
-    else if (appItem.isDocumentTreeNode()) {
-        const DocumentTreeNode& node = appItem.documentTreeNode();
-        QTreeWidgetItem* treeItemDocItem = this->findTreeItem(node);
-        if (treeItemDocItem)
-            this->findSupportBuilder(node)->refreshTextTreeItem(node, treeItemDocItem);
+    if (!appItem.isValid())
+        return;
+
+    if (!appItem.isDocumentTreeNode()) {
+        m_itemModel->refreshItems(appItem.document());
+        return;
     }
+
+    // Properties of a reference also rename the referred product, which is displayed by all the
+    // items of its instances
+    const TDF_Label label = appItem.documentTreeNode().label();
+    std::vector<TDF_Label> vecLabel = { label };
+    if (XCaf::isShapeReference(label))
+        vecLabel.push_back(XCaf::shapeReferred(label));
+
+    m_itemModel->refreshItems(appItem.document(), vecLabel);
 }
 
 void WidgetModelTree::registerGuiApplication(GuiApplication* guiApp)
@@ -194,6 +109,7 @@ void WidgetModelTree::registerGuiApplication(GuiApplication* guiApp)
         return;
 
     m_guiApp = guiApp;
+    m_itemModel->setGuiApplication(guiApp);
     auto app = guiApp->application();
     app->signalDocumentAdded.connectSlot(&WidgetModelTree::onDocumentAdded, this);
     app->signalDocumentAboutToClose.connectSlot(&WidgetModelTree::onDocumentAboutToClose, this);
@@ -236,126 +152,33 @@ void WidgetModelTree::addPrototypeBuilder(BuilderPtr builder)
     Internal::arrayPrototypeBuilder().push_back(std::move(builder));
 }
 
-DocumentTreeNode WidgetModelTree::documentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemDocumentTreeNode(treeItem);
-}
-
-void WidgetModelTree::setDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    Internal::setTreeItemDocumentTreeNode(treeItem, node);
-}
-
-void WidgetModelTree::setDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc)
-{
-    Internal::setTreeItemDocument(treeItem, doc);
-}
-
-bool WidgetModelTree::holdsDocument(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemType(treeItem) == Internal::TreeItemType_Document;
-}
-
-bool WidgetModelTree::holdsDocumentTreeNode(const QTreeWidgetItem* treeItem)
-{
-    return Internal::treeItemType(treeItem) & Internal::TreeItemType_DocumentTreeNode;
-}
-
 void WidgetModelTree::onDocumentAdded(const DocumentPtr& doc)
 {
-    auto treeItem = this->findSupportBuilder(doc)->createTreeItem(doc);
-    Internal::setTreeItemDocument(treeItem, doc);
-    Q_ASSERT(Internal::treeItemDocument(treeItem) == doc);
-    m_ui->treeWidget_Model->addTopLevelItem(treeItem);
+    m_itemModel->appendDocument(doc);
 }
 
 void WidgetModelTree::onDocumentAboutToClose(const DocumentPtr& doc)
 {
-    delete this->findTreeItem(doc);
+    m_itemModel->removeDocument(doc);
 }
 
 void WidgetModelTree::onDocumentNameChanged(const DocumentPtr& doc, const std::string& /*name*/)
 {
-    QTreeWidgetItem* treeItem = this->findTreeItem(doc);
-    if (treeItem)
-        this->findSupportBuilder(doc)->refreshTextTreeItem(doc, treeItem);
-}
-
-QTreeWidgetItem* WidgetModelTree::loadDocumentEntity(const DocumentTreeNode& node)
-{
-    Expects(node.isEntity());
-    auto treeItem = this->findSupportBuilder(node)->createTreeItem(node);
-    Internal::setTreeItemDocumentTreeNode(treeItem, node);
-    return treeItem;
-}
-
-QTreeWidgetItem* WidgetModelTree::findTreeItem(const DocumentPtr& doc) const
-{
-    for (int i = 0; i < m_ui->treeWidget_Model->topLevelItemCount(); ++i) {
-        QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->topLevelItem(i);
-        if (Internal::treeItemDocument(treeItem) == doc)
-            return treeItem;
-    }
-
-    return nullptr;
-}
-
-QTreeWidgetItem* WidgetModelTree::findTreeItem(const DocumentTreeNode& node) const
-{
-    QTreeWidgetItem* treeItemDoc = this->findTreeItem(node.document());
-    if (treeItemDoc) {
-        for (QTreeWidgetItemIterator it(treeItemDoc); *it; ++it) {
-            if (Internal::treeItemDocumentTreeNode(*it) == node)
-                return *it;
-        }
-    }
-
-    return nullptr;
-}
-
-WidgetModelTreeBuilder* WidgetModelTree::findSupportBuilder(const DocumentPtr& doc) const
-{
-    auto it = std::find_if(
-                std::next(m_vecBuilder.cbegin()),
-                m_vecBuilder.cend(),
-                [=](const BuilderPtr& builder) { return builder->supportsDocument(doc); });
-    return it != m_vecBuilder.cend() ? it->get() : m_vecBuilder.front().get();
-}
-
-WidgetModelTreeBuilder* WidgetModelTree::findSupportBuilder(const DocumentTreeNode& node) const
-{
-    Expects(node.isValid());
-    auto it = std::find_if(
-                std::next(m_vecBuilder.cbegin()),
-                m_vecBuilder.cend(),
-                [=](const BuilderPtr& builder) { return builder->supportsDocumentTreeNode(node); });
-    return it != m_vecBuilder.cend() ? it->get() : m_vecBuilder.front().get();
+    const QModelIndex indexDoc = m_itemModel->indexOf(doc);
+    emit m_itemModel->dataChanged(indexDoc, indexDoc);
 }
 
 void WidgetModelTree::onDocumentEntityAdded(const DocumentPtr& doc, TreeNodeId entityId)
 {
-    QTreeWidgetItem* treeDocEntity = this->loadDocumentEntity({ doc, entityId });
-    QTreeWidgetItem* treeDoc = this->findTreeItem(doc);
-    if (treeDoc) {
-        treeDoc->addChild(treeDocEntity);
-        treeDoc->setExpanded(true);
-    }
+    m_itemModel->appendDocumentEntity({ doc, entityId });
+    m_ui->treeView_Model->expand(m_itemModel->indexOf(doc));
 }
 
 void WidgetModelTree::onDocumentEntityAboutToBeDestroyed(const DocumentPtr& doc, TreeNodeId entityId)
 {
-    QTreeWidgetItem* treeItem = this->findTreeItem({ doc, entityId });
-    delete treeItem;
+    m_itemModel->removeDocumentEntity({ doc, entityId });
 }
 
-//void WidgetModelTree::onDocumentItemPropertyChanged(
-//        DocumentItem* docItem, Property* prop)
-//{
-//    QTreeWidgetItem* treeItem = this->findTreeItem(docItem);
-//    if (treeItem && prop == &docItem->propertyLabel)
-//        this->findSupportBuilder(docItem)->refreshTextTreeItem(docItem, treeItem);
-//}
-
 void WidgetModelTree::onTreeWidgetDocumentSelectionChanged(
         const QItemSelection& selected, const QItemSelection& deselected)
 {
@@ -365,15 +188,11 @@ void WidgetModelTree::onTreeWidgetDocumentSelectionChanged(
     std::vector<ApplicationItem> vecDeselected;
     vecSelected.reserve(listSelectedIndex.size());
     vecDeselected.reserve(listDeselectedIndex.size());
-    for (const QModelIndex& index : listSelectedIndex) {
-        const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-        vecSelected.push_back(Internal::toApplicationItem(treeItem));
-    }
+    for (const QModelIndex& index : listSelectedIndex)
+        vecSelected.push_back(this->toApplicationItem(index));
 
-    for (const QModelIndex& index : listDeselectedIndex) {
-        const QTreeWidgetItem* treeItem = m_ui->treeWidget_Model->itemFromIndex(index);
-        vecDeselected.push_back(Internal::toApplicationItem(treeItem));
-    }
+    for (const QModelIndex& index : listDeselectedIndex)
+        vecDeselected.push_back(this->toApplicationItem(index));
 
     m_guiApp->selectionModel()->add(vecSelected);
     m_guiApp->selectionModel()->remove(vecDeselected);
@@ -385,42 +204,34 @@ void WidgetModelTree::onApplicationItemSelectionModelChanged(
     this->connectTreeWidgetDocumentSelectionChanged(false);
     auto _ = gsl::finally([=] { this->connectTreeWidgetDocumentSelectionChanged(true); });
 
-    auto fnSetSelected = [=](Span<const ApplicationItem> spanAppItem, bool on) {
+    // Items of the tree nodes are exposed if not already done(see DocumentTreeItemModel::indexOf())
+    auto fnItemSelection = [=](Span<const ApplicationItem> spanAppItem) {
+        QItemSelection selection;
         for (const ApplicationItem& appItem : spanAppItem) {
             if (!appItem.isDocumentTreeNode())
                 continue;
 
-            QTreeWidgetItem* treeItem = this->findTreeItem(appItem.documentTreeNode());
-            if (!treeItem)
-                continue;
-
-            treeItem->setSelected(on);
-            if (on)
-                m_ui->treeWidget_Model->scrollToItem(treeItem);
+            const QModelIndex index = m_itemModel->indexOf(appItem.documentTreeNode());
+            if (index.isValid())
+                selection.select(index, index);
         }
-    };
 
-    fnSetSelected(selected, true);
-    fnSetSelected(deselected, false);
-}
+        return selection;
+    };
 
-void WidgetModelTree::connectTreeModelDataChanged(bool on)
-{
-    if (on) {
-        m_connTreeModelDataChanged = QObject::connect(
-                    m_ui->treeWidget_Model->model(), &QAbstractItemModel::dataChanged,
-                    this, &WidgetModelTree::onTreeModelDataChanged, Qt::UniqueConnection);
-    }
-    else {
-        QObject::disconnect(m_connTreeModelDataChanged);
-    }
+    QItemSelectionModel* treeSelectionModel = m_ui->treeView_Model->selectionModel();
+    treeSelectionModel->select(fnItemSelection(deselected), QItemSelectionModel::Deselect);
+    const QItemSelection selection = fnItemSelection(selected);
+    treeSelectionModel->select(selection, QItemSelectionModel::Select);
+    if (!selection.isEmpty())
+        m_ui->treeView_Model->scrollTo(selection.last().topLeft());
 }
 
 void WidgetModelTree::connectTreeWidgetDocumentSelectionChanged(bool on)
 {
     if (on) {
         m_connTreeWidgetDocumentSelectionChanged = QObject::connect(
-                    m_ui->treeWidget_Model->selectionModel(), &QItemSelectionModel::selectionChanged,
+                    m_ui->treeView_Model->selectionModel(), &QItemSelectionModel::selectionChanged,
                     this, &WidgetModelTree::onTreeWidgetDocumentSelectionChanged,
                     Qt::UniqueConnection);
     }
@@ -429,53 +240,21 @@ void WidgetModelTree::connectTreeWidgetDocumentSelectionChanged(bool on)
     }
 }
 
-void WidgetModelTree::onTreeModelDataChanged(
-        const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles)
-{
-    if (roles.contains(Qt::CheckStateRole) && topLeft == bottomRight) {
-        const QModelIndex& indexItem = topLeft;
-        const auto qtCheckState = Qt::CheckState(indexItem.data(Qt::CheckStateRole).toInt());
-        const auto checkState = QtCoreUtils::toCheckState(qtCheckState);
-        if (checkState == CheckState::Partially)
-            return;
-
-        const QVariant var = indexItem.data(Internal::TreeItemDocumentTreeNodeRole);
-        auto treeNode = var.isValid() ? var.value<DocumentTreeNode>() : DocumentTreeNode::null();
-        if (!treeNode.isValid())
-            return;
-
-        GuiDocument* guiDoc = m_guiApp->findGuiDocument(treeNode.document());
-        if (!guiDoc)
-            return;
-
-        guiDoc->setNodeVisible(treeNode.id(), checkState == CheckState::On ? true : false);
-        guiDoc->graphicsScene()->redraw();
-    }
-}
-
 void WidgetModelTree::onNodesVisibilityChanged(
         const GuiDocument* guiDoc, const std::unordered_map<TreeNodeId, CheckState>& mapNodeId)
 {
-    QTreeWidgetItem* treeItemDoc = this->findTreeItem(guiDoc->document());
-    if (!treeItemDoc)
-        return;
+    m_itemModel->refreshCheckStates(guiDoc->document(), mapNodeId);
+}
 
-    this->connectTreeModelDataChanged(false);
-    auto _ = gsl::finally([=]{ this->connectTreeModelDataChanged(true); });
-
-    auto localMapNodeId = mapNodeId;
-    for (QTreeWidgetItemIterator it(treeItemDoc); *it; ++it) {
-        QTreeWidgetItem* treeItem = *it;
-        const DocumentTreeNode docTreeNode = Internal::treeItemDocumentTreeNode(treeItem);
-        auto itNodeVisibleState = localMapNodeId.find(docTreeNode.id());
-        if (itNodeVisibleState != localMapNodeId.cend()) {
-            treeItem->setCheckState(0, QtCoreUtils::toQtCheckState(itNodeVisibleState->second));
-            localMapNodeId.erase(itNodeVisibleState);
-        }
+ApplicationItem WidgetModelTree::toApplicationItem(const QModelIndex& index) const
+{
+    const DocumentTreeItemModel::ItemType type = m_itemModel->itemType(index);
+    if (type == DocumentTreeItemModel::ItemType_Document)
+        return ApplicationItem(m_itemModel->document(index));
+    else if (type & DocumentTreeItemModel::ItemType_DocumentTreeNode)
+        return ApplicationItem(m_itemModel->documentTreeNode(index));
 
-        if (localMapNodeId.empty())
-            return;
-    }
+    return ApplicationItem();
 }
 
 } // namespace Mayo
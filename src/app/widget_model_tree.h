@@ -13,13 +13,13 @@
 #include <QtWidgets/QWidget>
 #include <functional>
 class QItemSelection;
-class QTreeWidget;
-class QTreeWidgetItem;
+class QModelIndex;
 
 #include <memory>
 
 namespace Mayo {
 
+class DocumentTreeItemModel;
 class GuiApplication;
 class WidgetModelTreeBuilder;
 
@@ -47,13 +47,6 @@ public:
     // For builders
     static void addPrototypeBuilder(BuilderPtr builder);
 
-    static DocumentTreeNode documentTreeNode(const QTreeWidgetItem* treeItem);
-    static void setDocumentTreeNode(QTreeWidgetItem* treeItem, const DocumentTreeNode& node);
-    static void setDocument(QTreeWidgetItem* treeItem, const DocumentPtr& doc);
-
-    static bool holdsDocument(const QTreeWidgetItem* treeItem);
-    static bool holdsDocumentTreeNode(const QTreeWidgetItem* treeItem);
-
 private:
     void onDocumentAdded(const DocumentPtr& doc);
     void onDocumentAboutToClose(const DocumentPtr& doc);
@@ -66,27 +59,17 @@ private:
     void onApplicationItemSelectionModelChanged(
             Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected);
 
-    void connectTreeModelDataChanged(bool on);
     void connectTreeWidgetDocumentSelectionChanged(bool on);
 
-    void onTreeModelDataChanged(
-            const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles);
     void onNodesVisibilityChanged(
             const GuiDocument* guiDoc, const std::unordered_map<TreeNodeId, CheckState>& mapNodeId);
 
-    QTreeWidgetItem* loadDocumentEntity(const DocumentTreeNode& entityNode);
-
-    QTreeWidgetItem* findTreeItem(const DocumentPtr& doc) const;
-    QTreeWidgetItem* findTreeItem(const DocumentTreeNode& node) const;
-
-    WidgetModelTreeBuilder* findSupportBuilder(const DocumentPtr& doc) const;
-    WidgetModelTreeBuilder* findSupportBuilder(const DocumentTreeNode& entityNode) const;
+    ApplicationItem toApplicationItem(const QModelIndex& index) const;
 
     class Ui_WidgetModelTree* m_ui = nullptr;
     GuiApplication* m_guiApp = nullptr;
+    DocumentTreeItemModel* m_itemModel = nullptr;
     std::vector<BuilderPtr> m_vecBuilder;
-    QString m_refItemTextTemplate;
-    QMetaObject::Connection m_connTreeModelDataChanged;
     QMetaObject::Connection m_connTreeWidgetDocumentSelectionChanged;
 };
 
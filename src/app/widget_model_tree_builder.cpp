@@ -14,8 +14,7 @@
 #include "widget_model_tree.h"
 #include "theme.h"
 
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItem>
+#include <QtGui/QIcon>
 
 namespace Mayo {
 
@@ -23,32 +22,26 @@ WidgetModelTreeBuilder::~WidgetModelTreeBuilder()
 {
 }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem)
+QVariant WidgetModelTreeBuilder::documentData(const DocumentPtr& doc, int role) const
 {
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(to_QString(doc->name())));
-}
+    switch (role) {
+    case Qt::DisplayRole:
+        return WidgetModelTreeBuilder::labelText(to_QString(doc->name()));
+    case Qt::DecorationRole:
+        return mayoTheme()->icon(Theme::Icon::File);
+    case Qt::ToolTipRole:
+        return filepathTo<QString>(doc->filePath());
+    }
 
-void WidgetModelTreeBuilder::refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
-{
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
+    return {};
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentPtr& doc)
+QVariant WidgetModelTreeBuilder::documentTreeNodeData(const DocumentTreeNode& node, int role) const
 {
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(to_QString(doc->name())));
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::File));
-    treeItem->setToolTip(0, filepathTo<QString>(doc->filePath()));
-    return treeItem;
-}
+    if (role == Qt::DisplayRole)
+        return WidgetModelTreeBuilder::labelText(node.label());
 
-QTreeWidgetItem* WidgetModelTreeBuilder::createTreeItem(const DocumentTreeNode& node)
-{
-    auto treeItem = new QTreeWidgetItem;
-    treeItem->setText(0, WidgetModelTreeBuilder::labelText(node.label()));
-    treeItem->setFlags(treeItem->flags() | Qt::ItemIsUserCheckable);
-    treeItem->setCheckState(0, Qt::Checked);
-    return treeItem;
+    return {};
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder::clone() const
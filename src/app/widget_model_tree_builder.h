@@ -12,13 +12,14 @@
 #include "widget_model_tree.h"
 #include <vector>
 #include <QtCore/QString>
+#include <QtCore/QVariant>
 class QAction;
 class QObject;
-class QTreeWidget;
-class QTreeWidgetItem;
 
 namespace Mayo {
 
+class DocumentTreeItemModel;
+
 // TODO Rename Builder -> Extension ?
 class WidgetModelTreeBuilder {
 public:
@@ -27,14 +28,17 @@ public:
     virtual bool supportsDocument(const DocumentPtr&) const { return true; }
     virtual bool supportsDocumentTreeNode(const DocumentTreeNode&) const { return true; }
 
-    virtual void refreshTextTreeItem(const DocumentPtr& doc, QTreeWidgetItem* treeItem);
-    virtual void refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem);
+    // Data of the item displaying a document or a tree node, for 'role'(see Qt::ItemDataRole)
+    // Called on demand for the visible items only, so must not traverse the model tree
+    virtual QVariant documentData(const DocumentPtr& doc, int role) const;
+    virtual QVariant documentTreeNodeData(const DocumentTreeNode& node, int role) const;
 
-    virtual QTreeWidgetItem* createTreeItem(const DocumentPtr& doc);
-    virtual QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node);
+    // Tree node whose children are displayed as the children of 'node' item. This allows to merge
+    // an item with its single child node, by default it's 'node' itself
+    virtual TreeNodeId childrenHolderNode(const DocumentTreeNode& node) const { return node.id(); }
 
-    QTreeWidget* treeWidget() const { return m_treeWidget; }
-    void setTreeWidget(QTreeWidget* tree) { m_treeWidget = tree; }
+    DocumentTreeItemModel* itemModel() const { return m_itemModel; }
+    void setItemModel(DocumentTreeItemModel* model) { m_itemModel = model; }
 
     virtual WidgetModelTree_UserActions createUserActions(QObject* /*parent*/) { return {}; }
 
@@ -46,7 +50,7 @@ protected:
     static QString labelText(const TDF_Label& label);
 
 private:
-    QTreeWidget* m_treeWidget = nullptr;
+    DocumentTreeItemModel* m_itemModel = nullptr;
 };
 
 } // namespace Mayo
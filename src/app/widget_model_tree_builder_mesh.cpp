@@ -10,7 +10,7 @@
 #include "theme.h"
 #include "widget_model_tree.h"
 
-#include <QtWidgets/QTreeWidgetItem>
+#include <QtGui/QIcon>
 
 namespace Mayo {
 
@@ -19,13 +19,12 @@ bool WidgetModelTreeBuilder_Mesh::supportsDocumentTreeNode(const DocumentTreeNod
     return GraphicsMeshObjectDriver::meshSupportStatus(node.label()) == GraphicsObjectDriver::Support::Complete;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Mesh::createTreeItem(const DocumentTreeNode& node)
+QVariant WidgetModelTreeBuilder_Mesh::documentTreeNodeData(const DocumentTreeNode& node, int role) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
+    if (role == Qt::DecorationRole)
+        return mayoTheme()->icon(Theme::Icon::ItemMesh);
 
-    auto treeItem = WidgetModelTreeBuilder::createTreeItem(node);
-    treeItem->setIcon(0, mayoTheme()->icon(Theme::Icon::ItemMesh));
-    return treeItem;
+    return WidgetModelTreeBuilder::documentTreeNodeData(node, role);
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Mesh::clone() const
@@ -13,7 +13,7 @@ namespace Mayo {
 class WidgetModelTreeBuilder_Mesh : public WidgetModelTreeBuilder {
 public:
     bool supportsDocumentTreeNode(const DocumentTreeNode& node) const override;
-    QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node) override;
+    QVariant documentTreeNodeData(const DocumentTreeNode& node, int role) const override;
     std::unique_ptr<WidgetModelTreeBuilder> clone() const override;
 };
 
@@ -9,18 +9,15 @@
 #include "../graphics/graphics_shape_object_driver.h"
 #include "../gui/gui_application.h"
 #include "app_module.h"
+#include "document_tree_item_model.h"
 #include "qtcore_utils.h"
 #include "qstring_conv.h"
 #include "theme.h"
 #include "widget_model_tree.h"
 
 #include <QActionGroup> // WARNING Qt5 <QtWidgets/...> / Qt6 <QtGui/...>
-#include <QtWidgets/QTreeWidget>
-#include <QtWidgets/QTreeWidgetItemIterator>
 
 #include <fmt/format.h>
-#include <unordered_map>
-#include <unordered_set>
 
 namespace Mayo {
 
@@ -85,34 +82,34 @@ bool WidgetModelTreeBuilder_Xde::supportsDocumentTreeNode(const DocumentTreeNode
     return GraphicsShapeObjectDriver::shapeSupportStatus(node.label()) == GraphicsObjectDriver::Support::Complete;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshTextTreeItem(
-        const DocumentTreeNode& node, QTreeWidgetItem* treeItem)
+QVariant WidgetModelTreeBuilder_Xde::documentTreeNodeData(const DocumentTreeNode& node, int role) const
 {
-    const TDF_Label labelNode = node.label();
-    TDF_LabelSequence seqLabelRefresh;
-    if (XCaf::isShapeReference(labelNode)
-            && Module::get()->instanceNameTemplate().contains("%product"))
-    {
-        XCAFDoc_ShapeTool::GetUsers(
-                    XCaf::shapeReferred(labelNode),
-                    seqLabelRefresh,
-                    false /* don't get sub children */);
-    }
-    else {
-        seqLabelRefresh.Append(labelNode);
+    if (role != Qt::DisplayRole && role != Qt::DecorationRole)
+        return {};
+
+    // Item of a merged reference displays the referred shape(product)
+    const TDF_Label label = node.label();
+    const bool isMergedRef = this->isMergedReference(node);
+    if (role == Qt::DisplayRole) {
+        if (isMergedRef)
+            return this->referenceItemText(label, XCaf::shapeReferred(label));
+        else
+            return to_QString(CafUtils::labelAttrStdName(label));
     }
 
-    for (const TDF_Label& labelRefresh : seqLabelRefresh) {
-        QTreeWidgetItem* treeItemLabel = this->findTreeItem(treeItem, labelRefresh);
-        if (treeItemLabel)
-            this->refreshXdeAssemblyNodeItemText(treeItemLabel);
-    }
+    const QIcon icon = Module::shapeIcon(isMergedRef ? XCaf::shapeReferred(label) : label);
+    return !icon.isNull() ? QVariant(icon) : QVariant();
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::createTreeItem(const DocumentTreeNode& node)
+TreeNodeId WidgetModelTreeBuilder_Xde::childrenHolderNode(const DocumentTreeNode& node) const
 {
-    Expects(this->supportsDocumentTreeNode(node));
-    return this->buildXdeTree(nullptr, node);
+    if (this->isMergedReference(node)) {
+        const TreeNodeId productNodeId = node.document()->modelTree().nodeChildFirst(node.id());
+        if (productNodeId != 0)
+            return productNodeId;
+    }
+
+    return node.id();
 }
 
 WidgetModelTree_UserActions WidgetModelTreeBuilder_Xde::createUserActions(QObject *parent)
@@ -143,72 +140,6 @@ WidgetModelTree_UserActions WidgetModelTreeBuilder_Xde::createUserActions(QObjec
     return userActions;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::guiCreateXdeTreeNode(
-        QTreeWidgetItem* guiParentNode, const DocumentTreeNode& node)
-{
-    auto guiNode = new QTreeWidgetItem(guiParentNode);
-    const QString stdName = to_QString(CafUtils::labelAttrStdName(node.label()));
-    guiNode->setText(0, stdName);
-    WidgetModelTree::setDocumentTreeNode(guiNode, node);
-    const QIcon icon = Module::shapeIcon(node.label());
-    if (!icon.isNull())
-        guiNode->setIcon(0, icon);
-
-    return guiNode;
-}
-
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::buildXdeTree(
-        QTreeWidgetItem* treeItem, const DocumentTreeNode& node)
-{
-    Expects(node.isEntity());
-
-    std::unordered_map<TreeNodeId, QTreeWidgetItem*> mapNodeIdToTreeItem;
-    std::unordered_set<TreeNodeId> setReferenceNodeId;
-    const DocumentPtr doc = node.document();
-    const Tree<TDF_Label>& modelTree = doc->modelTree();
-    traverseTree(node.id(), modelTree, [&](TreeNodeId itNodeId) {
-        const TreeNodeId nodeParentId = modelTree.nodeParent(itNodeId);
-        auto itParentFound = mapNodeIdToTreeItem.find(nodeParentId);
-        QTreeWidgetItem* guiParentNode =
-                itParentFound != mapNodeIdToTreeItem.end() ? itParentFound->second : treeItem;
-        if (m_isMergeXdeReferredShapeOn) {
-            const TDF_Label& nodeLabel = modelTree.nodeData(itNodeId);
-            if (XCaf::isShapeReference(nodeLabel)) {
-                mapNodeIdToTreeItem[itNodeId] = guiParentNode;
-                setReferenceNodeId.insert(itNodeId);
-            }
-            else {
-                auto guiNode = new QTreeWidgetItem(guiParentNode);
-                QString guiNodeText = to_QString(CafUtils::labelAttrStdName(nodeLabel));
-                TreeNodeId guiNodeId = itNodeId;
-                if (setReferenceNodeId.find(nodeParentId) != setReferenceNodeId.cend()) {
-                    const TDF_Label& refLabel = modelTree.nodeData(nodeParentId);
-                    guiNodeText = this->referenceItemText(refLabel, nodeLabel);
-                    guiNodeId = nodeParentId;
-                    if (!guiParentNode)
-                        mapNodeIdToTreeItem[nodeParentId] = guiNode;
-                }
-
-                guiNode->setText(0, guiNodeText);
-                WidgetModelTree::setDocumentTreeNode(guiNode, DocumentTreeNode(doc, guiNodeId));
-                const QIcon icon = Module::shapeIcon(nodeLabel);
-                if (!icon.isNull())
-                    guiNode->setIcon(0, icon);
-
-                guiNode->setFlags(guiNode->flags() | Qt::ItemIsUserCheckable);
-                guiNode->setCheckState(0, Qt::Checked);
-                mapNodeIdToTreeItem[itNodeId] = guiNode;
-            }
-        }
-        else {
-            auto guiNode = ThisType::guiCreateXdeTreeNode(guiParentNode, { doc, itNodeId });
-            mapNodeIdToTreeItem[itNodeId] = guiNode;
-        }
-    });
-
-    return mapNodeIdToTreeItem.find(node.id())->second;
-}
-
 QByteArray WidgetModelTreeBuilder_Xde::instanceNameFormat() const
 {
     return QtCoreUtils::QByteArray_frowRawData(Module::get()->instanceNameFormat.name());
@@ -220,10 +151,8 @@ void WidgetModelTreeBuilder_Xde::setInstanceNameFormat(const QByteArray& format)
         return;
 
     Module::get()->instanceNameFormat.setValueByName(format.constData());
-    for (QTreeWidgetItemIterator it(this->treeWidget()); *it; ++it) {
-        if (WidgetModelTree::holdsDocumentTreeNode(*it))
-            this->refreshXdeAssemblyNodeItemText(*it);
-    }
+    if (this->itemModel())
+        this->itemModel()->refreshItems();
 }
 
 std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() const
@@ -233,19 +162,9 @@ std::unique_ptr<WidgetModelTreeBuilder> WidgetModelTreeBuilder_Xde::clone() cons
     return builder;
 }
 
-void WidgetModelTreeBuilder_Xde::refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item)
+bool WidgetModelTreeBuilder_Xde::isMergedReference(const DocumentTreeNode& node) const
 {
-    const DocumentTreeNode docTreeNode = WidgetModelTree::documentTreeNode(item);
-    const TDF_Label label = docTreeNode.label();
-    if (XCaf::isShapeReference(label)) {
-        const TDF_Label& instanceLabel = label;
-        const TDF_Label productLabel = XCaf::shapeReferred(instanceLabel);
-        const QString itemText = this->referenceItemText(instanceLabel, productLabel);
-        item->setText(0, itemText);
-    }
-    else {
-        item->setText(0, to_QString(CafUtils::labelAttrStdName(label)));
-    }
+    return m_isMergeXdeReferredShapeOn && XCaf::isShapeReference(node.label());
 }
 
 QString WidgetModelTreeBuilder_Xde::referenceItemText(
@@ -260,19 +179,4 @@ QString WidgetModelTreeBuilder_Xde::referenceItemText(
     return itemText;
 }
 
-QTreeWidgetItem* WidgetModelTreeBuilder_Xde::findTreeItem(
-        QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const
-{
-    if (!parentTreeItem)
-        return nullptr;
-
-    for (QTreeWidgetItemIterator it(parentTreeItem); *it; ++it) {
-        const DocumentTreeNode node = WidgetModelTree::documentTreeNode(*it);
-        if (node.label() == label)
-            return *it;
-    }
-
-    return nullptr;
-}
-
 } // namespace Mayo
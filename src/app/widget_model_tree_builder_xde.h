@@ -15,8 +15,8 @@ class WidgetModelTreeBuilder_Xde : public WidgetModelTreeBuilder {
     MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::WidgetModelTreeBuilder_Xde)
 public:
     bool supportsDocumentTreeNode(const DocumentTreeNode& node) const override;
-    void refreshTextTreeItem(const DocumentTreeNode& node, QTreeWidgetItem* treeItem) override;
-    QTreeWidgetItem* createTreeItem(const DocumentTreeNode& node) override;
+    QVariant documentTreeNodeData(const DocumentTreeNode& node, int role) const override;
+    TreeNodeId childrenHolderNode(const DocumentTreeNode& node) const override;
 
     WidgetModelTree_UserActions createUserActions(QObject* parent) override;
 
@@ -25,15 +25,9 @@ public:
 private:
     class Module;
 
-    using ThisType = WidgetModelTreeBuilder_Xde;
-
-    static QTreeWidgetItem* guiCreateXdeTreeNode(
-            QTreeWidgetItem* guiParentNode, const DocumentTreeNode& node);
-
-    QTreeWidgetItem* buildXdeTree(QTreeWidgetItem* treeItem, const DocumentTreeNode& node);
-    void refreshXdeAssemblyNodeItemText(QTreeWidgetItem* item);
+    // Is 'node' a reference merged with its referred shape(product) node?
+    bool isMergedReference(const DocumentTreeNode& node) const;
     QString referenceItemText(const TDF_Label& instanceLabel, const TDF_Label& productLabel) const;
-    QTreeWidgetItem* findTreeItem(QTreeWidgetItem* parentTreeItem, const TDF_Label& label) const;
 
     QByteArray instanceNameFormat() const;
     void setInstanceNameFormat(const QByteArray& format);
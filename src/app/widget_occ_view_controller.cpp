@@ -153,6 +153,8 @@ void WidgetOccViewController::startDynamicAction(V3dViewController::DynamicActio
         this->setViewCursor(Qt::SizeVerCursor);
     else if (action == DynamicAction::WindowZoom)
         this->setViewCursor(Qt::SizeBDiagCursor);
+    else if (action == DynamicAction::BoxSelection)
+        this->setViewCursor(Qt::CrossCursor);
 
     V3dViewController::startDynamicAction(action);
 }
@@ -267,6 +269,8 @@ void WidgetOccViewController::handleMouseMove(const QMouseEvent* event)
         this->zoom(prevPos, currPos);
     else if (m_actionMatcher->matchWindowZoom())
         this->windowZoomRubberBand(currPos);
+    else if (m_actionMatcher->matchBoxSelection())
+        this->boxSelectionRubberBand(currPos);
     else
         this->signalMouseMoved.send(currPos.x, currPos.y);
 }
@@ -285,8 +289,11 @@ void WidgetOccViewController::handleMouseButtonRelease(const QMouseEvent* event)
 
     m_inputSequence.release(event->button());
     const bool hadDynamicAction = this->hasCurrentDynamicAction();
+    const Position currPos = toPosition(m_occView->widget()->mapFromGlobal(event->globalPos()));
     if (this->isWindowZoomingStarted())
-        this->windowZoom(toPosition(m_occView->widget()->mapFromGlobal(event->globalPos())));
+        this->windowZoom(currPos);
+    else if (this->isBoxSelectionStarted())
+        this->boxSelection(currPos);
 
     this->stopDynamicAction();
     if (!hadDynamicAction)
@@ -302,6 +309,11 @@ void WidgetOccViewController::handleMouseWheel(const QWheelEvent* event)
         this->zoomOut();
 }
 
+bool WidgetOccViewController::ActionMatcher::matchBoxSelection() const
+{
+    return this->inputs.equal({ Qt::Key_Shift, Qt::LeftButton });
+}
+
 class WidgetOccViewController::Mayo_ActionMatcher : public ActionMatcher {
 public:
     Mayo_ActionMatcher(const InputSequence* seq) : ActionMatcher(seq) {}
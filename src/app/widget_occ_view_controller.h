@@ -101,6 +101,8 @@ private:
         virtual bool matchPan() const = 0;
         virtual bool matchZoom() const = 0;
         virtual bool matchWindowZoom() const = 0;
+        // Same for all navigation styles by default: Shift + left mouse button
+        virtual bool matchBoxSelection() const;
 
         virtual void onInputPrePush(Input) {}
         virtual void onInputPreRelease(Input) {}
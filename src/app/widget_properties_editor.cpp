@@ -100,6 +100,12 @@ void WidgetPropertiesEditor::clear()
     d->ui->treeWidget_Browser->clear();
 }
 
+void WidgetPropertiesEditor::refreshPropertyValues()
+{
+    d->ui->treeWidget_Browser->viewport()->update();
+    d->ui->treeWidget_Browser->resizeColumnToContents(1);
+}
+
 void WidgetPropertiesEditor::setPropertyEnabled(const Property* prop, bool on)
 {
     QTreeWidgetItem* treeItem = d->findTreeItem(prop);
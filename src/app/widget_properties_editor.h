@@ -28,6 +28,9 @@ public:
     void editProperty(Property* prop, Group* grp = nullptr);
     void clear();
 
+    // Repaints property values, needed when edited properties are changed from outside the editor
+    void refreshPropertyValues();
+
     void setPropertyEnabled(const Property* prop, bool on);
     void setPropertySelectable(const Property* prop, bool on);
 
@@ -250,7 +250,7 @@ void Application::notifyDocumentAboutToClose(Document::Identifier docIdent)
 void Application::addDocument(const DocumentPtr& doc)
 {
     if (!doc.IsNull()) {
-        doc->setIdentifier(d->m_seqDocumentIdentifier.fetch_add(1));
+        doc->setIdentifier(this->newDocumentIdentifier());
         d->m_mapIdentifierDocument.insert({ doc->identifier(), doc });
         this->InitDocument(doc);
         doc->initXCaf();
@@ -271,6 +271,11 @@ void Application::addDocument(const DocumentPtr& doc)
     }
 }
 
+Document::Identifier Application::newDocumentIdentifier()
+{
+    return d->m_seqDocumentIdentifier.fetch_add(1);
+}
+
 Application::DocumentIterator::DocumentIterator(const ApplicationPtr& app)
     : DocumentIterator(app.get())
 {
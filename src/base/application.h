@@ -90,6 +90,7 @@ private: // Implementation
     Application();
     void notifyDocumentAboutToClose(Document::Identifier docIdent);
     void addDocument(const DocumentPtr& doc);
+    Document::Identifier newDocumentIdentifier();
 
     struct Private;
     Private* const d = nullptr;
@@ -32,3 +32,16 @@ private:
 };
 
 } // namespace Mayo
+
+namespace std {
+
+// Specialization of C++11 std::hash<> functor for ApplicationItem
+template<> struct hash<Mayo::ApplicationItem> {
+    inline size_t operator()(const Mayo::ApplicationItem& item) const {
+        const Mayo::Document* doc = item.document().get();
+        const size_t nodeId = item.isDocumentTreeNode() ? item.documentTreeNode().id() : 0;
+        return hash<const Mayo::Document*>{}(doc) ^ (hash<size_t>{}(nodeId) << 1);
+    }
+};
+
+} // namespace std
@@ -10,13 +10,18 @@
 #include "signal.h"
 #include "span.h"
 
+#include <unordered_set>
+#include <vector>
+
 namespace Mayo {
 
+// Selection of application items, kept in insertion order
+// Membership is hash-indexed so queries and batch operations are linear in the number of items given
 class ApplicationItemSelectionModel {
 public:
     Span<const ApplicationItem> selectedItems() const;
 
-    bool isSelected(const ApplicationItem& item);
+    bool isSelected(const ApplicationItem& item) const;
 
     void add(const ApplicationItem& item);
     void add(Span<ApplicationItem> vecItem);
@@ -31,6 +36,7 @@ public:
 
 private:
     std::vector<ApplicationItem> m_vecSelectedItem;
+    std::unordered_set<ApplicationItem> m_setSelectedItem;
 };
 
 } // namespace Mayo
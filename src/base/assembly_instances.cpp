@@ -0,0 +1,118 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "assembly_instances.h"
+#include "caf_utils.h"
+#include "document.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRepBndLib.hxx>
+#include <OSD_Parallel.hxx>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Mayo {
+
+AssemblyInstances AssemblyInstances::collect(
+        const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId, TaskProgress* progress
+    )
+{
+    AssemblyInstances result;
+    result.m_doc = doc;
+    if (!doc)
+        return result;
+
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<Instance> vecInstance;
+    std::vector<TDF_Label> vecProduct;
+    std::unordered_map<TDF_Label, int> mapProductIndex; // Index in vecProduct
+    std::vector<int> vecInstanceProduct;
+    auto fnAddLeaves = [&](TreeNodeId startNodeId) {
+        traverseTree(startNodeId, modelTree, [&](TreeNodeId nodeId) {
+            const TDF_Label& label = modelTree.nodeData(nodeId);
+            if (!modelTree.nodeIsLeaf(nodeId) || !XCaf::isShapeSimple(label))
+                return;
+
+            const TreeNodeId parentNodeId = modelTree.nodeParent(nodeId);
+            const bool isReferenced = parentNodeId != 0 && XCaf::isShapeReference(modelTree.nodeData(parentNodeId));
+            Instance instance;
+            instance.treeNodeId = isReferenced ? parentNodeId : nodeId;
+            instance.productLabel = label;
+            instance.location = XCaf::shapeAbsoluteLocation(modelTree, nodeId);
+            auto [it, isNewProduct] = mapProductIndex.insert({ label, int(vecProduct.size()) });
+            if (isNewProduct)
+                vecProduct.push_back(label);
+
+            vecInstance.push_back(std::move(instance));
+            vecInstanceProduct.push_back(it->second);
+        });
+    };
+
+    if (spanNodeId.empty()) {
+        for (TreeNodeId rootNodeId : modelTree.roots())
+            fnAddLeaves(rootNodeId);
+    }
+    else {
+        // Nodes below some other selected node are already visited with that node
+        const std::unordered_set<TreeNodeId> setNodeId(spanNodeId.begin(), spanNodeId.end());
+        auto fnHasSelectedAncestor = [&](TreeNodeId nodeId) {
+            for (TreeNodeId id = modelTree.nodeParent(nodeId); id != 0; id = modelTree.nodeParent(id)) {
+                if (setNodeId.find(id) != setNodeId.cend())
+                    return true;
+            }
+
+            return false;
+        };
+        std::unordered_set<TreeNodeId> setVisitedNodeId;
+        for (TreeNodeId nodeId : spanNodeId) {
+            if (!fnHasSelectedAncestor(nodeId) && setVisitedNodeId.insert(nodeId).second)
+                fnAddLeaves(nodeId);
+        }
+    }
+
+    // Compute bounding boxes of products, existing triangulations are used when available
+    std::vector<Bnd_Box> vecProductBndBox(vecProduct.size());
+    std::atomic<int> productDoneCount = 0;
+    std::mutex mutexProgress;
+    OSD_Parallel::For(0, int(vecProduct.size()), [&](int i) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        BRepBndLib::Add(XCaf::shape(vecProduct.at(i)), vecProductBndBox.at(i), true/*useTriangulation*/);
+        const int doneCount = ++productDoneCount;
+        if (progress) {
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            progress->setValue((100 * doneCount) / int(vecProduct.size()));
+        }
+    });
+
+    std::vector<Bnd_Box> vecBndBox;
+    vecBndBox.reserve(vecInstance.size());
+    for (size_t i = 0; i < vecInstance.size(); ++i) {
+        const Bnd_Box& productBndBox = vecProductBndBox.at(vecInstanceProduct.at(i));
+        if (productBndBox.IsVoid())
+            continue;
+
+        Instance& instance = vecInstance.at(i);
+        instance.bndBox = productBndBox.Transformed(instance.location.Transformation());
+        vecBndBox.push_back(instance.bndBox);
+        result.m_vecInstance.push_back(std::move(instance));
+    }
+
+    result.m_bvh = BoxBvh(std::move(vecBndBox));
+    return result;
+}
+
+TopoDS_Shape AssemblyInstances::instanceShape(int i) const
+{
+    const Instance& instance = m_vecInstance.at(i);
+    return XCaf::shape(instance.productLabel).Moved(instance.location);
+}
+
+} // namespace Mayo
@@ -0,0 +1,63 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "box_bvh.h"
+#include "document_ptr.h"
+#include "libtree.h"
+#include "span.h"
+
+#include <Bnd_Box.hxx>
+#include <TDF_Label.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Shape.hxx>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Flattened view of the simple shapes(parts) placed in the assemblies of a document
+//
+// Each instance is a leaf of the model tree associated to a simple shape, along with its absolute
+// location and absolute bounding box. Bounding box of a product shape is computed once whatever
+// the count of its instances, and then transformed by the instance location
+// Instances are indexed by a bounding volume hierarchy, see bvh()
+class AssemblyInstances {
+public:
+    struct Instance {
+        // Reference node if the part is a component of some assembly, the part node otherwise
+        TreeNodeId treeNodeId = 0;
+        TDF_Label productLabel;
+        TopLoc_Location location;
+        Bnd_Box bndBox;
+    };
+
+    AssemblyInstances() = default;
+
+    // Collects the instances found below tree nodes 'spanNodeId', all the document if empty
+    // Each instance is collected once, even if 'spanNodeId' contains some node and its ancestor
+    // Parts having a void bounding box(ie no geometry) are discarded
+    static AssemblyInstances collect(
+            const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId = {}, TaskProgress* progress = nullptr
+    );
+
+    const DocumentPtr& document() const { return m_doc; }
+    Span<const Instance> instances() const { return m_vecInstance; }
+    const Instance& instance(int i) const { return m_vecInstance.at(i); }
+    const BoxBvh& bvh() const { return m_bvh; }
+
+    // Shape of product moved to the absolute location of instance 'i'
+    TopoDS_Shape instanceShape(int i) const;
+
+private:
+    DocumentPtr m_doc;
+    std::vector<Instance> m_vecInstance;
+    BoxBvh m_bvh;
+};
+
+} // namespace Mayo
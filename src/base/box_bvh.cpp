@@ -0,0 +1,451 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "box_bvh.h"
+#include "bnd_utils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+
+namespace Mayo {
+
+namespace {
+
+bool isNear(const Bnd_Box& lhs, const Bnd_Box& rhs, double gap)
+{
+    if (lhs.IsVoid() || rhs.IsVoid())
+        return false;
+
+    const BndBoxCoords lhsCoords = BndBoxCoords::get(lhs);
+    const BndBoxCoords rhsCoords = BndBoxCoords::get(rhs);
+    return lhsCoords.xmin <= rhsCoords.xmax + gap && rhsCoords.xmin <= lhsCoords.xmax + gap
+            && lhsCoords.ymin <= rhsCoords.ymax + gap && rhsCoords.ymin <= lhsCoords.ymax + gap
+            && lhsCoords.zmin <= rhsCoords.zmax + gap && rhsCoords.zmin <= lhsCoords.zmax + gap;
+}
+
+// Signed distance from 'plane' to the center of 'box', and radius of 'box' projected on plane normal
+std::pair<double, double> planeBoxDistanceRadius(const gp_Pln& plane, const Bnd_Box& box)
+{
+    double a, b, c, d;
+    plane.Coefficients(a, b, c, d);
+    const BndBoxCoords coords = BndBoxCoords::get(box);
+    const gp_Pnt center = coords.center();
+    const double radius =
+            0.5 * (std::abs(a) * (coords.xmax - coords.xmin)
+                   + std::abs(b) * (coords.ymax - coords.ymin)
+                   + std::abs(c) * (coords.zmax - coords.zmin));
+    return { a * center.X() + b * center.Y() + c * center.Z() + d, radius };
+}
+
+} // namespace
+
+BoxBvh::BoxBvh(std::vector<Bnd_Box> vecBox, int maxItemCountPerLeaf)
+    : m_maxItemCountPerLeaf(std::max(1, maxItemCountPerLeaf)),
+      m_vecItemBox(std::move(vecBox))
+{
+    m_vecItemIndex.resize(m_vecItemBox.size());
+    for (int i = 0; i < int(m_vecItemIndex.size()); ++i)
+        m_vecItemIndex.at(i) = i;
+
+    if (!m_vecItemBox.empty()) {
+        m_vecNode.reserve(2 * m_vecItemBox.size() / m_maxItemCountPerLeaf + 1);
+        this->buildNode(0, int(m_vecItemIndex.size()));
+    }
+}
+
+Span<const int> BoxBvh::nodeItems(const Node& node) const
+{
+    return Span<const int>(m_vecItemIndex).subspan(node.itemFirst, node.itemCount);
+}
+
+void BoxBvh::visitPairs(double gap, const std::function<void(int, int)>& fn) const
+{
+    if (!m_vecNode.empty())
+        this->visitPairs(0, gap, fn);
+}
+
+void BoxBvh::refit()
+{
+    // Children nodes are always located after their parent
+    for (auto it = m_vecNode.rbegin(); it != m_vecNode.rend(); ++it) {
+        Node& node = *it;
+        node.bndBox.SetVoid();
+        if (node.isLeaf()) {
+            for (int i : this->nodeItems(node))
+                BndUtils::add(&node.bndBox, m_vecItemBox.at(i));
+        }
+        else {
+            BndUtils::add(&node.bndBox, m_vecNode.at(node.childLeft).bndBox);
+            BndUtils::add(&node.bndBox, m_vecNode.at(node.childRight).bndBox);
+        }
+    }
+}
+
+void BoxBvh::visitIntersecting(const Bnd_Box& box, const std::function<void(int)>& fn) const
+{
+    if (box.IsVoid())
+        return;
+
+    this->visitItems([&](const Bnd_Box& itemBox) { return BoxBvh::isIntersecting(itemBox, box); }, fn);
+}
+
+void BoxBvh::visitIntersecting(const gp_Pln& plane, const std::function<void(int)>& fn) const
+{
+    this->visitItems([&](const Bnd_Box& itemBox) { return BoxBvh::isIntersecting(itemBox, plane); }, fn);
+}
+
+void BoxBvh::visitInside(Span<const gp_Pln> spanPlane, const std::function<void(int)>& fn) const
+{
+    this->visitItems([&](const Bnd_Box& itemBox) { return BoxBvh::isInside(itemBox, spanPlane); }, fn);
+}
+
+int BoxBvh::findNearest(
+        const gp_Lin& ray, const std::function<double(int)>& fnItemDistance, double* ptrDistance
+    ) const
+{
+    // Best-first traversal, nodes are visited by increasing entry distance
+    using NodeDistance = std::pair<double, int>;
+    std::priority_queue<NodeDistance, std::vector<NodeDistance>, std::greater<NodeDistance>> queueNode;
+    if (!m_vecNode.empty()) {
+        const double distance = BoxBvh::rayEntryDistance(ray, m_vecNode.front().bndBox);
+        if (distance >= 0)
+            queueNode.push({ distance, 0 });
+    }
+
+    int nearestItem = -1;
+    double nearestDistance = std::numeric_limits<double>::max();
+    while (!queueNode.empty() && queueNode.top().first < nearestDistance) {
+        const Node& node = m_vecNode.at(queueNode.top().second);
+        queueNode.pop();
+        if (node.isLeaf()) {
+            for (int i : this->nodeItems(node)) {
+                const double boxDistance = BoxBvh::rayEntryDistance(ray, m_vecItemBox.at(i));
+                if (boxDistance < 0 || boxDistance >= nearestDistance)
+                    continue;
+
+                const double distance = fnItemDistance ? fnItemDistance(i) : boxDistance;
+                if (distance >= 0 && distance < nearestDistance) {
+                    nearestItem = i;
+                    nearestDistance = distance;
+                }
+            }
+        }
+        else {
+            for (int iChild : { node.childLeft, node.childRight }) {
+                const double distance = BoxBvh::rayEntryDistance(ray, m_vecNode.at(iChild).bndBox);
+                if (distance >= 0 && distance < nearestDistance)
+                    queueNode.push({ distance, iChild });
+            }
+        }
+    }
+
+    if (ptrDistance && nearestItem >= 0)
+        *ptrDistance = nearestDistance;
+
+    return nearestItem;
+}
+
+void BoxBvh::visitItems(
+        const std::function<bool(const Bnd_Box&)>& fnBoxTest, const std::function<void(int)>& fn
+    ) const
+{
+    if (m_vecNode.empty())
+        return;
+
+    std::vector<int> stackNode = { 0 };
+    while (!stackNode.empty()) {
+        const Node& node = m_vecNode.at(stackNode.back());
+        stackNode.pop_back();
+        if (node.bndBox.IsVoid() || !fnBoxTest(node.bndBox))
+            continue;
+
+        if (node.isLeaf()) {
+            for (int i : this->nodeItems(node)) {
+                const Bnd_Box& itemBox = m_vecItemBox.at(i);
+                if (!itemBox.IsVoid() && fnBoxTest(itemBox))
+                    fn(i);
+            }
+        }
+        else {
+            stackNode.push_back(node.childLeft);
+            stackNode.push_back(node.childRight);
+        }
+    }
+}
+
+void BoxBvh::visitNearest(
+        const std::function<double(const Bnd_Box&)>& fnBoxDistance,
+        const std::function<double(int)>& fnItem
+    ) const
+{
+    if (m_vecNode.empty() || m_vecNode.front().bndBox.IsVoid())
+        return;
+
+    struct StackItem {
+        int node;
+        double lowerBound;
+    };
+
+    double bestDistance = std::numeric_limits<double>::max();
+    std::vector<StackItem> stack = { { 0, fnBoxDistance(m_vecNode.front().bndBox) } };
+    while (!stack.empty()) {
+        const StackItem stackItem = stack.back();
+        stack.pop_back();
+        if (stackItem.lowerBound >= bestDistance)
+            continue;
+
+        const Node& node = m_vecNode.at(stackItem.node);
+        if (node.isLeaf()) {
+            for (int i : this->nodeItems(node)) {
+                const Bnd_Box& itemBox = m_vecItemBox.at(i);
+                if (!itemBox.IsVoid() && fnBoxDistance(itemBox) < bestDistance)
+                    bestDistance = std::min(bestDistance, fnItem(i));
+            }
+
+            continue;
+        }
+
+        StackItem children[2];
+        int childCount = 0;
+        for (int iChild : { node.childLeft, node.childRight }) {
+            const Bnd_Box& childBox = m_vecNode.at(iChild).bndBox;
+            if (!childBox.IsVoid())
+                children[childCount++] = { iChild, fnBoxDistance(childBox) };
+        }
+
+        // Closest child is pushed last, so it's visited first
+        if (childCount == 2 && children[0].lowerBound < children[1].lowerBound)
+            std::swap(children[0], children[1]);
+
+        for (int i = 0; i < childCount; ++i)
+            stack.push_back(children[i]);
+    }
+}
+
+void BoxBvh::visitNearestPairs(
+        const BoxBvh& bvh1,
+        const BoxBvh& bvh2,
+        const std::function<double(const Bnd_Box&, const Bnd_Box&)>& fnBoxDistance,
+        const std::function<double(int, int)>& fnItemPair
+    )
+{
+    if (bvh1.m_vecNode.empty() || bvh2.m_vecNode.empty())
+        return;
+
+    const Bnd_Box& rootBox1 = bvh1.m_vecNode.front().bndBox;
+    const Bnd_Box& rootBox2 = bvh2.m_vecNode.front().bndBox;
+    if (rootBox1.IsVoid() || rootBox2.IsVoid())
+        return;
+
+    struct StackItem {
+        int node1;
+        int node2;
+        double lowerBound;
+    };
+
+    double bestDistance = std::numeric_limits<double>::max();
+    std::vector<StackItem> stack = { { 0, 0, fnBoxDistance(rootBox1, rootBox2) } };
+    while (!stack.empty()) {
+        const StackItem stackItem = stack.back();
+        stack.pop_back();
+        if (stackItem.lowerBound >= bestDistance)
+            continue;
+
+        const Node& node1 = bvh1.m_vecNode.at(stackItem.node1);
+        const Node& node2 = bvh2.m_vecNode.at(stackItem.node2);
+        if (node1.isLeaf() && node2.isLeaf()) {
+            for (int i : bvh1.nodeItems(node1)) {
+                for (int j : bvh2.nodeItems(node2)) {
+                    if (!bvh1.m_vecItemBox.at(i).IsVoid() && !bvh2.m_vecItemBox.at(j).IsVoid())
+                        bestDistance = std::min(bestDistance, fnItemPair(i, j));
+                }
+            }
+
+            continue;
+        }
+
+        // Descend into the largest node
+        const bool splitNode1 =
+                !node1.isLeaf()
+                && (node2.isLeaf() || node1.bndBox.SquareExtent() >= node2.bndBox.SquareExtent());
+        StackItem children[2];
+        int childCount = 0;
+        for (int iChild : { splitNode1 ? node1.childLeft : node2.childLeft,
+                            splitNode1 ? node1.childRight : node2.childRight })
+        {
+            const int iNode1 = splitNode1 ? iChild : stackItem.node1;
+            const int iNode2 = splitNode1 ? stackItem.node2 : iChild;
+            const Bnd_Box& box1 = bvh1.m_vecNode.at(iNode1).bndBox;
+            const Bnd_Box& box2 = bvh2.m_vecNode.at(iNode2).bndBox;
+            if (!box1.IsVoid() && !box2.IsVoid())
+                children[childCount++] = { iNode1, iNode2, fnBoxDistance(box1, box2) };
+        }
+
+        // Closest pair is pushed last, so it's visited first
+        if (childCount == 2 && children[0].lowerBound < children[1].lowerBound)
+            std::swap(children[0], children[1]);
+
+        for (int i = 0; i < childCount; ++i)
+            stack.push_back(children[i]);
+    }
+}
+
+bool BoxBvh::isIntersecting(const Bnd_Box& itemBox, const Bnd_Box& box)
+{
+    return isNear(itemBox, box, 0.);
+}
+
+bool BoxBvh::isIntersecting(const Bnd_Box& itemBox, const gp_Pln& plane)
+{
+    if (itemBox.IsVoid())
+        return false;
+
+    const auto [distance, radius] = planeBoxDistanceRadius(plane, itemBox);
+    return std::abs(distance) <= radius;
+}
+
+bool BoxBvh::isInside(const Bnd_Box& itemBox, Span<const gp_Pln> spanPlane)
+{
+    if (itemBox.IsVoid())
+        return false;
+
+    for (const gp_Pln& plane : spanPlane) {
+        const auto [distance, radius] = planeBoxDistanceRadius(plane, itemBox);
+        if (distance + radius < 0)
+            return false;
+    }
+
+    return true;
+}
+
+double BoxBvh::rayEntryDistance(const gp_Lin& ray, const Bnd_Box& box)
+{
+    if (box.IsVoid())
+        return -1.;
+
+    const BndBoxCoords coords = BndBoxCoords::get(box);
+    const double boxMin[] = { coords.xmin, coords.ymin, coords.zmin };
+    const double boxMax[] = { coords.xmax, coords.ymax, coords.zmax };
+    double tmin = 0.;
+    double tmax = std::numeric_limits<double>::max();
+    for (int i = 0; i < 3; ++i) {
+        const double origin = ray.Location().Coord(i + 1);
+        const double dir = ray.Direction().Coord(i + 1);
+        if (std::abs(dir) < 1e-12) {
+            if (origin < boxMin[i] || origin > boxMax[i])
+                return -1.;
+        }
+        else {
+            double t1 = (boxMin[i] - origin) / dir;
+            double t2 = (boxMax[i] - origin) / dir;
+            if (t1 > t2)
+                std::swap(t1, t2);
+
+            tmin = std::max(tmin, t1);
+            tmax = std::min(tmax, t2);
+            if (tmin > tmax)
+                return -1.;
+        }
+    }
+
+    return tmin;
+}
+
+int BoxBvh::buildNode(int itemFirst, int itemLast)
+{
+    const int nodeIndex = int(m_vecNode.size());
+    m_vecNode.emplace_back();
+    Bnd_Box nodeBox;
+    Bnd_Box centerBox;
+    for (int i = itemFirst; i < itemLast; ++i) {
+        const Bnd_Box& itemBox = m_vecItemBox.at(m_vecItemIndex.at(i));
+        if (!itemBox.IsVoid()) {
+            BndUtils::add(&nodeBox, itemBox);
+            centerBox.Add(BndBoxCoords::get(itemBox).center());
+        }
+    }
+
+    m_vecNode.at(nodeIndex).bndBox = nodeBox;
+    m_vecNode.at(nodeIndex).itemFirst = itemFirst;
+    m_vecNode.at(nodeIndex).itemCount = itemLast - itemFirst;
+    if (itemLast - itemFirst <= m_maxItemCountPerLeaf || centerBox.IsVoid())
+        return nodeIndex;
+
+    // Split along the longest axis of the box enclosing the item centers
+    const BndBoxCoords centerCoords = BndBoxCoords::get(centerBox);
+    const double dx = centerCoords.xmax - centerCoords.xmin;
+    const double dy = centerCoords.ymax - centerCoords.ymin;
+    const double dz = centerCoords.zmax - centerCoords.zmin;
+    const int axis = dx >= dy && dx >= dz ? 0 : (dy >= dz ? 1 : 2);
+    auto fnCenterCoord = [&](int itemIndex) {
+        const Bnd_Box& itemBox = m_vecItemBox.at(itemIndex);
+        return !itemBox.IsVoid() ? BndBoxCoords::get(itemBox).center().Coord(axis + 1) : 0.;
+    };
+
+    const int itemMid = itemFirst + (itemLast - itemFirst) / 2;
+    std::nth_element(
+                m_vecItemIndex.begin() + itemFirst,
+                m_vecItemIndex.begin() + itemMid,
+                m_vecItemIndex.begin() + itemLast,
+                [&](int lhs, int rhs) { return fnCenterCoord(lhs) < fnCenterCoord(rhs); }
+    );
+
+    // Note: m_vecNode might be reallocated by recursive calls, so node can't be referenced here
+    const int childLeft = this->buildNode(itemFirst, itemMid);
+    const int childRight = this->buildNode(itemMid, itemLast);
+    m_vecNode.at(nodeIndex).childLeft = childLeft;
+    m_vecNode.at(nodeIndex).childRight = childRight;
+    return nodeIndex;
+}
+
+void BoxBvh::visitPairs(int iNode, double gap, const std::function<void(int, int)>& fn) const
+{
+    const Node& node = m_vecNode.at(iNode);
+    if (node.isLeaf()) {
+        const Span<const int> spanItem = this->nodeItems(node);
+        for (auto it1 = spanItem.begin(); it1 != spanItem.end(); ++it1) {
+            for (auto it2 = std::next(it1); it2 != spanItem.end(); ++it2) {
+                if (isNear(m_vecItemBox.at(*it1), m_vecItemBox.at(*it2), gap))
+                    fn(std::min(*it1, *it2), std::max(*it1, *it2));
+            }
+        }
+    }
+    else {
+        this->visitPairs(node.childLeft, gap, fn);
+        this->visitPairs(node.childRight, gap, fn);
+        this->visitPairs(node.childLeft, node.childRight, gap, fn);
+    }
+}
+
+void BoxBvh::visitPairs(int iNode1, int iNode2, double gap, const std::function<void(int, int)>& fn) const
+{
+    const Node& node1 = m_vecNode.at(iNode1);
+    const Node& node2 = m_vecNode.at(iNode2);
+    if (!isNear(node1.bndBox, node2.bndBox, gap))
+        return;
+
+    if (node1.isLeaf() && node2.isLeaf()) {
+        for (int i1 : this->nodeItems(node1)) {
+            for (int i2 : this->nodeItems(node2)) {
+                if (isNear(m_vecItemBox.at(i1), m_vecItemBox.at(i2), gap))
+                    fn(std::min(i1, i2), std::max(i1, i2));
+            }
+        }
+    }
+    else if (node2.isLeaf() || (!node1.isLeaf() && node1.itemCount >= node2.itemCount)) {
+        // Descend into the biggest node
+        this->visitPairs(node1.childLeft, iNode2, gap, fn);
+        this->visitPairs(node1.childRight, iNode2, gap, fn);
+    }
+    else {
+        this->visitPairs(iNode1, node2.childLeft, gap, fn);
+        this->visitPairs(iNode1, node2.childRight, gap, fn);
+    }
+}
+
+} // namespace Mayo
@@ -0,0 +1,128 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+
+#include <Bnd_Box.hxx>
+#include <gp_Lin.hxx>
+#include <gp_Pln.hxx>
+#include <functional>
+#include <vector>
+
+namespace Mayo {
+
+// Bounding volume hierarchy over a set of axis-aligned boxes(items)
+//
+// Binary tree built top-down, boxes of a node being split at the median of their centers along the
+// longest axis. Allows to find the pairs of items close to each other, or the items intersecting
+// some region without testing all the items
+// Void boxes are accepted but never reported
+// Boxes of items can be changed afterwards with setItemBox() and refit(), hierarchy is then kept as
+// is so a new BoxBvh should rather be built if items moved a lot
+class BoxBvh {
+public:
+    struct Node {
+        Bnd_Box bndBox;
+        int childLeft = -1; // Index of the left child node, -1 for a leaf node
+        int childRight = -1;
+        int itemFirst = 0; // Position in the internal array of item indexes
+        int itemCount = 0;
+
+        bool isLeaf() const { return childLeft < 0; }
+    };
+
+    BoxBvh() = default;
+    BoxBvh(std::vector<Bnd_Box> vecBox, int maxItemCountPerLeaf = 4);
+
+    int itemCount() const { return int(m_vecItemBox.size()); }
+    const Bnd_Box& itemBox(int i) const { return m_vecItemBox.at(i); }
+
+    // Replaces the box of item 'i', refit() has to be called before any query
+    void setItemBox(int i, const Bnd_Box& box) { m_vecItemBox.at(i) = box; }
+    // Recomputes the boxes of the nodes from the boxes of the items
+    void refit();
+
+    // Box enclosing all the items
+    Bnd_Box boundingBox() const { return !m_vecNode.empty() ? m_vecNode.front().bndBox : Bnd_Box{}; }
+
+    // Nodes of the hierarchy, root node is at index 0
+    Span<const Node> nodes() const { return m_vecNode; }
+
+    // Indexes of the items owned by leaf 'node'
+    Span<const int> nodeItems(const Node& node) const;
+
+    // Calls 'fn(i, j)'(with i < j) for each pair of items whose boxes are separated by less than 'gap'
+    // Distance between boxes is evaluated per axis, so some reported pairs might actually be farther
+    void visitPairs(double gap, const std::function<void(int, int)>& fn) const;
+
+    // Calls 'fn(i)' for each item whose box intersects 'box'
+    void visitIntersecting(const Bnd_Box& box, const std::function<void(int)>& fn) const;
+
+    // Calls 'fn(i)' for each item whose box intersects 'plane'
+    void visitIntersecting(const gp_Pln& plane, const std::function<void(int)>& fn) const;
+
+    // Calls 'fn(i)' for each item whose box isn't completely outside the convex volume bounded by
+    // 'spanPlane'(eg view frustum). Inside of a plane is the side its normal points to
+    // Some reported items might actually be outside, near the corners of the volume
+    void visitInside(Span<const gp_Pln> spanPlane, const std::function<void(int)>& fn) const;
+
+    // Finds the item the nearest to the origin of 'ray', considering only items whose box is crossed
+    // by 'ray'. Function 'fnItemDistance(i)' gives the exact distance from ray origin to item 'i',
+    // negative if 'ray' misses the item. If null then distance to the item box is used
+    // Returns -1 if no item was found, otherwise distance to the item is written in 'ptrDistance'
+    int findNearest(
+            const gp_Lin& ray,
+            const std::function<double(int)>& fnItemDistance = nullptr,
+            double* ptrDistance = nullptr
+    ) const;
+
+    // Calls 'fn(i)' for each item whose box passes 'fnBoxTest', nodes failing 'fnBoxTest' are skipped
+    void visitItems(
+            const std::function<bool(const Bnd_Box&)>& fnBoxTest, const std::function<void(int)>& fn
+    ) const;
+
+    // Nearest item query by branch and bound, closest nodes being visited first
+    // Function 'fnBoxDistance(box)' gives a lower bound of the distance between the query and
+    // anything inside 'box'(any increasing function of the distance is fine, eg squared distance)
+    // Function 'fnItem(i)' processes item 'i' and returns the best distance found so far, nodes and
+    // items farther than this distance are skipped
+    void visitNearest(
+            const std::function<double(const Bnd_Box&)>& fnBoxDistance,
+            const std::function<double(int)>& fnItem
+    ) const;
+
+    // Same as visitNearest() but for the pairs of items of 'bvh1' and 'bvh2'
+    // Function 'fnBoxDistance(box1, box2)' gives a lower bound of the distance between anything
+    // inside 'box1' of 'bvh1' and anything inside 'box2' of 'bvh2'
+    // Function 'fnItemPair(i, j)' processes item 'i' of 'bvh1' and item 'j' of 'bvh2'
+    static void visitNearestPairs(
+            const BoxBvh& bvh1,
+            const BoxBvh& bvh2,
+            const std::function<double(const Bnd_Box&, const Bnd_Box&)>& fnBoxDistance,
+            const std::function<double(int, int)>& fnItemPair
+    );
+
+    // Box tests of the queries above, so items not stored in a BoxBvh can be tested the same way
+    static bool isIntersecting(const Bnd_Box& itemBox, const Bnd_Box& box);
+    static bool isIntersecting(const Bnd_Box& itemBox, const gp_Pln& plane);
+    static bool isInside(const Bnd_Box& itemBox, Span<const gp_Pln> spanPlane);
+    // Distance along 'ray' where it enters 'box'(zero if origin is inside), negative if missed
+    static double rayEntryDistance(const gp_Lin& ray, const Bnd_Box& box);
+
+private:
+    int buildNode(int itemFirst, int itemLast);
+    void visitPairs(int iNode, double gap, const std::function<void(int, int)>& fn) const;
+    void visitPairs(int iNode1, int iNode2, double gap, const std::function<void(int, int)>& fn) const;
+
+    int m_maxItemCountPerLeaf = 4;
+    std::vector<Bnd_Box> m_vecItemBox;
+    std::vector<int> m_vecItemIndex;
+    std::vector<Node> m_vecNode;
+};
+
+} // namespace Mayo
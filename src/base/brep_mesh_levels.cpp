@@ -0,0 +1,121 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "brep_mesh_levels.h"
+
+#include "brep_utils.h"
+
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRep_Tool.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+
+namespace Mayo {
+
+namespace {
+
+struct LevelCoefficients {
+    double chordalDeflection;
+    double angularDeflection;
+};
+
+LevelCoefficients levelCoefficients(BRepMeshLevels::Level level)
+{
+    switch (level) {
+    case BRepMeshLevels::Level_Coarse: return { 4, 2 };
+    case BRepMeshLevels::Level_Normal: return { 1, 1 };
+    case BRepMeshLevels::Level_Fine: return { 1/4., 1/2. };
+    }
+
+    return { 1, 1 };
+}
+
+} // namespace
+
+BRepMeshLevels::BRepMeshLevels(const TopoDS_Shape& shape, const OccBRepMeshParameters& baseParams)
+    : m_shape(shape),
+      m_baseParams(baseParams)
+{
+    LevelData& normalData = m_arrayLevel.at(Level_Normal);
+    normalData.shape = shape;
+    TopExp::MapShapes(shape, normalData.mapSubShape);
+
+    TopExp_Explorer expl(shape, TopAbs_FACE);
+    m_isSupported = expl.More();
+    for (; expl.More() && m_isSupported; expl.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expl.Current());
+        TopLoc_Location locFace;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, locFace);
+        m_isSupported = !triangulation.IsNull() && BRepUtils::isGeometric(face);
+        if (m_isSupported)
+            m_normalDeflection = std::max(m_normalDeflection, triangulation->Deflection());
+    }
+
+    m_isSupported = m_isSupported && m_normalDeflection > 0;
+}
+
+bool BRepMeshLevels::hasLevel(Level level) const
+{
+    return !m_arrayLevel.at(level).shape.IsNull();
+}
+
+const TopoDS_Shape& BRepMeshLevels::levelShape(Level level) const
+{
+    return m_arrayLevel.at(level).shape;
+}
+
+TopoDS_Shape BRepMeshLevels::levelSubShape(Level level, const TopoDS_Shape& subShape) const
+{
+    const int index = m_arrayLevel.at(Level_Normal).mapSubShape.FindIndex(subShape);
+    const TopTools_IndexedMapOfShape& mapLevelSubShape = m_arrayLevel.at(level).mapSubShape;
+    if (index <= 0 || index > mapLevelSubShape.Extent())
+        return {};
+
+    return mapLevelSubShape.FindKey(index);
+}
+
+OccBRepMeshParameters BRepMeshLevels::levelParameters(Level level) const
+{
+    const LevelCoefficients coeffs = levelCoefficients(level);
+    OccBRepMeshParameters params = m_baseParams;
+    // Chordal deflection is the actual one of the shape mesh, so it's already absolute
+    params.Deflection = coeffs.chordalDeflection * m_normalDeflection;
+    params.Angle = coeffs.angularDeflection * m_baseParams.Angle;
+    params.Relative = false;
+    return params;
+}
+
+BRepMeshLevels::LevelData BRepMeshLevels::computeLevel(
+        const TopoDS_Shape& shape, const OccBRepMeshParameters& params, TaskProgress* progress)
+{
+    constexpr bool copyGeometry = true;
+    constexpr bool copyMesh = false;
+    BRepBuilderAPI_Copy copier(shape, copyGeometry, copyMesh);
+    LevelData data;
+    data.shape = copier.Shape();
+    BRepUtils::computeMesh(data.shape, params, progress);
+    // Copy has the same structure as 'shape', so sub-shapes are explored in the same order
+    TopExp::MapShapes(data.shape, data.mapSubShape);
+    return data;
+}
+
+void BRepMeshLevels::setLevel(Level level, LevelData&& data)
+{
+    const int subShapeCount = m_arrayLevel.at(Level_Normal).mapSubShape.Extent();
+    if (level == Level_Normal || data.shape.IsNull() || data.mapSubShape.Extent() != subShapeCount)
+        return;
+
+    m_arrayLevel.at(level) = std::move(data);
+}
+
+double BRepMeshLevels::deflectionCoefficient(Level level)
+{
+    return levelCoefficients(level).chordalDeflection;
+}
+
+} // namespace Mayo
@@ -0,0 +1,86 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "occ_brep_mesh_parameters.h"
+
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS_Shape.hxx>
+#include <array>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Provides several meshes(levels of detail) of a BRep shape, for display purpose only
+//
+// Level_Normal is the shape itself, with the mesh it holds when BRepMeshLevels object is constructed
+// Other levels are copies of the shape meshed on demand, with chordal deflection derived from the
+// mesh of Level_Normal and angular deflection derived from the base meshing parameters
+// The shape itself is never modified: graphics presentations are computed from the shape of a
+// level(see levelShape()), so meshes used by other operations(exports, measures, ...) aren't affected
+//
+// Computation of a level is split to allow execution in a worker thread:
+//     * levelParameters() must be called in the thread owning the BRepMeshLevels object
+//     * computeLevel() doesn't access the BRepMeshLevels object and can run in any thread
+//     * setLevel() stores the result and must be called in the thread owning the object
+class BRepMeshLevels {
+public:
+    enum Level { Level_Coarse, Level_Normal, Level_Fine };
+    static constexpr int LevelCount = 3;
+
+    // Shape of a level and all its sub-shapes, which are indexed in the same order as the
+    // sub-shapes of the initial shape(see TopExp::MapShapes())
+    struct LevelData {
+        TopoDS_Shape shape;
+        TopTools_IndexedMapOfShape mapSubShape;
+    };
+
+    BRepMeshLevels() = default;
+    // 'baseParams' are the meshing parameters the shape was meshed with
+    BRepMeshLevels(const TopoDS_Shape& shape, const OccBRepMeshParameters& baseParams);
+
+    const TopoDS_Shape& shape() const { return m_shape; }
+
+    // Whether levels can be computed for the shape. This requires the shape to be meshed and all
+    // faces to rely on geometric surfaces
+    bool isSupported() const { return m_isSupported; }
+
+    bool hasLevel(Level level) const;
+
+    // Shape of 'level', null if not available yet
+    const TopoDS_Shape& levelShape(Level level) const;
+
+    // Sub-shape of levelShape() matching 'subShape' of the initial shape, null if not found
+    TopoDS_Shape levelSubShape(Level level, const TopoDS_Shape& subShape) const;
+
+    // Meshing parameters suited to compute 'level'
+    OccBRepMeshParameters levelParameters(Level level) const;
+
+    // Meshes a copy of 'shape' and maps its sub-shapes. Can be safely called from any thread as
+    // long as 'shape' isn't modified meanwhile
+    static LevelData computeLevel(
+            const TopoDS_Shape& shape,
+            const OccBRepMeshParameters& params,
+            TaskProgress* progress = nullptr
+    );
+
+    // Stores 'data' as the shape of 'level', typically the one returned by computeLevel()
+    void setLevel(Level level, LevelData&& data);
+
+    // Scale factor to be applied to the chordal deflection of Level_Normal to get 'level'
+    static double deflectionCoefficient(Level level);
+
+private:
+    TopoDS_Shape m_shape;
+    OccBRepMeshParameters m_baseParams;
+    std::array<LevelData, LevelCount> m_arrayLevel;
+    double m_normalDeflection = 0.;
+    bool m_isSupported = false;
+};
+
+} // namespace Mayo
@@ -12,13 +12,19 @@
 #  include "occ_progress_indicator.h"
 #endif
 
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRep_Builder.hxx>
 #include <BRep_Tool.hxx>
 #include <BRepTools.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
 #include <TopoDS_Compound.hxx>
+#include <TopoDS_Iterator.hxx>
 #include <climits>
+#include <numeric>
 #include <sstream>
+#include <vector>
 
 namespace Mayo {
 
@@ -88,4 +94,143 @@ void BRepUtils::computeMesh(
     MAYO_UNUSED(mesher);
 }
 
+BRepUtils::RemeshData BRepUtils::computeRemesh(
+        const TopoDS_Shape& shape,
+        const OccBRepMeshParameters& params,
+        double maxFinerRatio,
+        TaskProgress* progress)
+{
+    // Chordal deflection can't be compared when it's relative to the size of edges
+    auto fnFaceNeedsRemesh = [&](const TopoDS_Face& face) {
+        TopLoc_Location locFace;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, locFace);
+        if (!triangulation || params.Relative)
+            return true;
+
+        constexpr double tolerance = 1e-3; // Relative
+        const double triDeflection = triangulation->Deflection();
+        return triDeflection > params.Deflection * (1 + tolerance)
+                || triDeflection * maxFinerRatio < params.Deflection * (1 - tolerance);
+    };
+
+    // Unique geometric faces of 'shape'
+    TopTools_IndexedMapOfShape mapFace;
+    TopoDS_Compound compFace = BRepUtils::makeEmptyCompound();
+    BRep_Builder builder;
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        const TopoDS_Face face = TopoDS::Face(expl.Current().Located(TopLoc_Location()));
+        if (BRepUtils::isGeometric(face) && mapFace.FindIndex(face) == 0) {
+            mapFace.Add(face);
+            builder.Add(compFace, face);
+        }
+    }
+
+    // Group faces connected through shared edges, meshes of the faces within a group have to be
+    // computed all together otherwise polygons of shared edges wouldn't match
+    std::vector<int> vecFaceGroup(mapFace.Extent() + 1);
+    std::iota(vecFaceGroup.begin(), vecFaceGroup.end(), 0);
+    auto fnFindGroup = [&](int iFace) {
+        while (vecFaceGroup.at(iFace) != iFace)
+            iFace = vecFaceGroup.at(iFace) = vecFaceGroup.at(vecFaceGroup.at(iFace));
+
+        return iFace;
+    };
+
+    TopTools_IndexedDataMapOfShapeListOfShape mapEdgeFaces;
+    TopExp::MapShapesAndAncestors(compFace, TopAbs_EDGE, TopAbs_FACE, mapEdgeFaces);
+    for (int i = 1; i <= mapEdgeFaces.Extent(); ++i) {
+        const TopTools_ListOfShape& listFace = mapEdgeFaces.FindFromIndex(i);
+        const int iFirstGroup = fnFindGroup(mapFace.FindIndex(listFace.First()));
+        for (const TopoDS_Shape& face : listFace)
+            vecFaceGroup.at(fnFindGroup(mapFace.FindIndex(face))) = iFirstGroup;
+    }
+
+    std::vector<bool> vecGroupRemesh(vecFaceGroup.size(), false);
+    for (int iFace = 1; iFace <= mapFace.Extent(); ++iFace) {
+        if (fnFaceNeedsRemesh(TopoDS::Face(mapFace.FindKey(iFace))))
+            vecGroupRemesh.at(fnFindGroup(iFace)) = true;
+    }
+
+    RemeshData data;
+    TopoDS_Compound compFaceRemesh = BRepUtils::makeEmptyCompound();
+    for (int iFace = 1; iFace <= mapFace.Extent(); ++iFace) {
+        if (vecGroupRemesh.at(fnFindGroup(iFace))) {
+            data.mapFace.Add(mapFace.FindKey(iFace));
+            builder.Add(compFaceRemesh, mapFace.FindKey(iFace));
+        }
+    }
+
+    if (data.mapFace.IsEmpty())
+        return data;
+
+    // Surfaces and curves are shared with the source shape but not meshes, all target faces are
+    // meshed at once so meshing algorithm can process them in parallel
+    constexpr bool copyGeometry = false;
+    constexpr bool copyMesh = false;
+    BRepBuilderAPI_Copy copier(compFaceRemesh, copyGeometry, copyMesh);
+    data.meshedFaces = copier.Shape();
+    BRepTools::Clean(data.meshedFaces); // Just in case copy references meshes of the source
+    BRepUtils::computeMesh(data.meshedFaces, params, progress);
+    return data;
+}
+
+void BRepUtils::applyRemesh(const RemeshData& data)
+{
+    if (data.mapFace.IsEmpty() || data.meshedFaces.IsNull())
+        return;
+
+    // Faces of 'data' are complete groups of connected faces, so cleaning them doesn't affect
+    // polygons of edges used by other faces
+    TopoDS_Compound compFace = BRepUtils::makeEmptyCompound();
+    BRep_Builder builder;
+    for (int iFace = 1; iFace <= data.mapFace.Extent(); ++iFace)
+        builder.Add(compFace, data.mapFace.FindKey(iFace));
+
+    BRepTools::Clean(compFace);
+    int iFace = 1;
+    for (TopoDS_Iterator itFace(data.meshedFaces); itFace.More() && iFace <= data.mapFace.Extent(); itFace.Next()) {
+        const TopoDS_Face& meshedFace = TopoDS::Face(itFace.Value());
+        const TopoDS_Face& face = TopoDS::Face(data.mapFace.FindKey(iFace++));
+        TopLoc_Location locFace;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(meshedFace, locFace);
+        if (!triangulation)
+            continue;
+
+        builder.UpdateFace(face, triangulation);
+        // Edges of the copy are explored in the same order as the ones of the source face
+        TopExp_Explorer explMeshedEdge(meshedFace, TopAbs_EDGE);
+        TopExp_Explorer explEdge(face, TopAbs_EDGE);
+        for (; explMeshedEdge.More() && explEdge.More(); explMeshedEdge.Next(), explEdge.Next()) {
+            const TopoDS_Edge& meshedEdge = TopoDS::Edge(explMeshedEdge.Current());
+            const TopoDS_Edge& edge = TopoDS::Edge(explEdge.Current());
+            if (BRep_Tool::IsClosed(meshedEdge, meshedFace)) {
+                const TopoDS_Edge meshedEdgeFwd = TopoDS::Edge(meshedEdge.Oriented(TopAbs_FORWARD));
+                const TopoDS_Edge meshedEdgeRev = TopoDS::Edge(meshedEdge.Oriented(TopAbs_REVERSED));
+                builder.UpdateEdge(
+                            edge,
+                            BRep_Tool::PolygonOnTriangulation(meshedEdgeFwd, triangulation, locFace),
+                            BRep_Tool::PolygonOnTriangulation(meshedEdgeRev, triangulation, locFace),
+                            triangulation,
+                            locFace
+                );
+            }
+            else {
+                const auto polygon = BRep_Tool::PolygonOnTriangulation(meshedEdge, triangulation, locFace);
+                builder.UpdateEdge(edge, polygon, triangulation, locFace);
+            }
+        }
+    }
+}
+
+TopTools_IndexedMapOfShape BRepUtils::remesh(
+        const TopoDS_Shape& shape,
+        const OccBRepMeshParameters& params,
+        double maxFinerRatio,
+        TaskProgress* progress)
+{
+    const RemeshData data = BRepUtils::computeRemesh(shape, params, maxFinerRatio, progress);
+    BRepUtils::applyRemesh(data);
+    return data.mapFace;
+}
+
 } // namespace Mayo
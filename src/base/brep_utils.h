@@ -9,6 +9,7 @@
 #include "occ_brep_mesh_parameters.h"
 
 #include <Poly_Triangulation.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <TopoDS_Face.hxx>
 #include <TopExp_Explorer.hxx>
 #include <TopoDS.hxx>
@@ -62,6 +63,40 @@ struct BRepUtils {
             const OccBRepMeshParameters& params,
             TaskProgress* progress = nullptr
     );
+
+    // Faces to be meshed again along with their new mesh(see computeRemesh())
+    struct RemeshData {
+        // Faces of the source shape to be updated(with identity location)
+        TopTools_IndexedMapOfShape mapFace;
+        // Meshed copy of the faces, sub-shapes are explored in the same order as 'mapFace' ones
+        TopoDS_Shape meshedFaces;
+    };
+
+    // Computes again mesh of the faces of 'shape' whose triangulation doesn't conform to the chordal
+    // deflection of 'params', ie faces not meshed, meshed coarser than required or meshed finer than
+    // required by more than 'maxFinerRatio'
+    // To keep meshes conformal, all faces connected to these ones through shared edges are meshed
+    // again as well
+    // Faces are meshed once whatever the count of their locations within 'shape'
+    // Meshing is done on a copy: 'shape' isn't modified so this function can run in a worker thread
+    static RemeshData computeRemesh(
+            const TopoDS_Shape& shape,
+            const OccBRepMeshParameters& params,
+            double maxFinerRatio = 4.,
+            TaskProgress* progress = nullptr
+    );
+
+    // Replaces triangulations of the faces(and polygons of their edges) in 'data' by the ones
+    // computed with computeRemesh()
+    static void applyRemesh(const RemeshData& data);
+
+    // Combination of computeRemesh() and applyRemesh(), returns the re-meshed faces
+    static TopTools_IndexedMapOfShape remesh(
+            const TopoDS_Shape& shape,
+            const OccBRepMeshParameters& params,
+            double maxFinerRatio = 4.,
+            TaskProgress* progress = nullptr
+    );
 };
 
 
@@ -9,8 +9,12 @@
 #include "application.h"
 #include "caf_utils.h"
 #include "cpp_utils.h"
+#include <TDF_AttributeIterator.hxx>
 #include <TDF_ChildIterator.hxx>
+#include <TDF_CopyLabel.hxx>
+#include <TDF_RelocationTable.hxx>
 #include <TDF_TagSource.hxx>
+#include <TDocStd_Owner.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
 
 namespace Mayo {
@@ -180,6 +184,72 @@ void Document::destroyEntity(TreeNodeId entityTreeNodeId)
     m_modelTree.removeRoot(entityTreeNodeId);
 }
 
+DocumentPtr Document::newScratchDocument() const
+{
+    DocumentPtr doc = new Document(m_app);
+    doc->setIdentifier(m_app->newDocumentIdentifier());
+    m_app->InitDocument(doc);
+    doc->initXCaf();
+    return doc;
+}
+
+void Document::closeScratchDocument(const DocumentPtr& doc)
+{
+    if (!doc)
+        return;
+
+    // Same as TDocStd_Application::Close(), except that the document isn't part of the session
+    // Owner attribute refers to the document, so this reference cycle has to be broken
+    Handle_TDocStd_Owner owner;
+    if (doc->rootLabel().FindAttribute(TDocStd_Owner::GetID(), owner))
+        owner->SetDocument(Handle_TDocStd_Document());
+
+    doc->BeforeClose();
+    doc->rootLabel().ForgetAllAttributes(true/*clearChildren*/);
+}
+
+TDF_LabelSequence Document::copyEntities(const TDF_LabelSequence& seqLabelSrc)
+{
+    // Shared by all copied attributes, so references between them are relocated consistently
+    Handle_TDF_RelocationTable relocTable = new TDF_RelocationTable;
+    TDF_LabelSequence seqLabelCopy;
+    for (const TDF_Label& labelSrc : seqLabelSrc) {
+        TDF_Label labelCopy;
+        if (XCaf::isShape(labelSrc)) {
+            const TDF_LabelSequence seqShapeCopy = m_xcaf.copyShapes(CafUtils::makeLabelSequence({ labelSrc }));
+            if (seqShapeCopy.IsEmpty())
+                continue;
+
+            // Attach attributes unknown to XCAF(eg TriangulationAnnexData)
+            labelCopy = seqShapeCopy.First();
+            relocTable->SetRelocation(labelSrc, labelCopy);
+            for (TDF_AttributeIterator it(labelSrc); it.More(); it.Next()) {
+                const Handle_TDF_Attribute attrSrc = it.Value();
+                if (labelCopy.IsAttribute(attrSrc->ID()))
+                    continue;
+
+                Handle_TDF_Attribute attrCopy = attrSrc->NewEmpty();
+                labelCopy.AddAttribute(attrCopy);
+                relocTable->SetRelocation(attrSrc, attrCopy);
+                attrSrc->Paste(attrCopy, relocTable);
+            }
+        }
+        else {
+            labelCopy = this->newEntityLabel();
+            TDF_CopyLabel copier(labelSrc, labelCopy);
+            copier.Perform();
+            if (!copier.IsDone()) {
+                labelCopy.ForgetAllAttributes();
+                continue;
+            }
+        }
+
+        seqLabelCopy.Append(labelCopy);
+    }
+
+    return seqLabelCopy;
+}
+
 void Document::BeforeClose()
 {
     TDocStd_Document::BeforeClose();
@@ -14,6 +14,7 @@
 #include "signal.h"
 #include "xcaf.h"
 
+#include <Poly_Triangulation.hxx>
 #include <string>
 #include <string_view>
 
@@ -64,11 +65,33 @@ public:
     void addEntityTreeNode(const TDF_Label& label);
     void destroyEntity(TreeNodeId entityTreeNodeId);
 
+    // Creates an empty document bound to the same application but not registered into it(not part
+    // of the session, no signals emitted). It still gets a unique identifier
+    // Typical use is as the private target of an operation run concurrently, the resulting entities
+    // being then merged with copyEntities()
+    // Must be called in the thread owning the application, not concurrently
+    DocumentPtr newScratchDocument() const;
+
+    // Closes a document created with newScratchDocument() and releases its data
+    // Entities copied from 'doc' with copyEntities() aren't affected
+    static void closeScratchDocument(const DocumentPtr& doc);
+
+    // Copies entities owned by another document as new entities of this document
+    // Underlying data(shapes, triangulations, ...) is shared, not duplicated
+    // Returned labels aren't added to the model tree, see addEntityTreeNode()
+    // Copy of shape entities requires OpenCascade >= v7.6.0, see XCaf::copyShapes()
+    TDF_LabelSequence copyEntities(const TDF_LabelSequence& seqLabelSrc);
+
     // Signals
     Signal<const std::string&> signalNameChanged;
     Signal<const FilePath&> signalFilePathChanged;
     Signal<TreeNodeId> signalEntityAdded;
     Signal<TreeNodeId> signalEntityAboutToBeDestroyed;
+    // Emitted while a file is being imported, with a coarse mesh of its contents to be displayed
+    // until the imported entities are added(see IO::System::Args_ImportInDocument::previewMeshMaxTriangleCount)
+    // Emitted again with a null mesh once the preview is obsolete
+    // Might be emitted from a thread other than the one owning the document
+    Signal<const FilePath&, const Handle_Poly_Triangulation&> signalImportPreviewMeshChanged;
 
 public: // -- from TDocStd_Document
     void BeforeClose() override;
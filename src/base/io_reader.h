@@ -11,6 +11,7 @@
 #include "io_format.h"
 #include "messenger_client.h"
 #include "span.h"
+#include <Poly_Triangulation.hxx>
 #include <TDF_LabelSequence.hxx>
 #include <memory>
 
@@ -33,6 +34,13 @@ public:
     // Returns 'true' on success
     virtual bool readFile(const FilePath& fp, TaskProgress* progress) = 0;
 
+    // Quickly reads a coarse mesh(at most 'maxTriangleCount' triangles) of the file at path 'fp',
+    // meant to be displayed while the file is read with readFile() and transferred
+    // Returns null if not supported(default) or if the file isn't big enough to need a preview
+    virtual Handle_Poly_Triangulation readPreviewMesh(const FilePath& /*fp*/, int /*maxTriangleCount*/) {
+        return {};
+    }
+
     // Converts data read during readFile() step into document 'doc' using indicator to report progress
     // Returns the list of entities added to document 'doc'
     virtual TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) = 0;
@@ -18,6 +18,7 @@
 #include "tkernel_utils.h"
 
 #include <fmt/format.h>
+#include <gsl/util>
 #include <algorithm>
 #include <array>
 #include <fstream>
@@ -39,6 +40,22 @@ bool containsFormat(Span<const Format> spanFormat, Format format)
     return itFormat != spanFormat.end();
 }
 
+// Whether entities of a scratch document can be merged into another document
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+constexpr bool isScratchDocumentMergeSupported = true;
+#else
+constexpr bool isScratchDocumentMergeSupported = false; // Requires XCAFDoc_Editor::CloneShapeLabel()
+#endif
+
+// Whether readers of 'format' can transfer concurrently into separate documents, entities are then
+// merged into the target document(see Document::copyEntities())
+// OpenCascade STEP/IGES transfer relies on global state so it has to stay serialized
+bool isTransferInScratchDocumentSupported(Format format)
+{
+    return isScratchDocumentMergeSupported
+            && (format == Format_GLTF || format == Format_OBJ || format == Format_PLY || format == Format_OFF);
+}
+
 } // namespace
 
 void System::addFormatProbe(const FormatProbe& probe)
@@ -177,6 +194,8 @@ bool System::importInDocument(const Args_ImportInDocument& args)
     // NOTE
     // Maybe STEP/IGES CAF ReadFile() can be run concurrently(they should)
     // But concurrent calls to Transfer() to the same target Document must be serialized
+    // When importing many files, readers supporting it transfer concurrently into their own scratch
+    // Document, then only the merge into the target Document is serialized
 
     DocumentPtr doc = args.targetDocument;
     const auto listFilepath = args.filepaths;
@@ -192,8 +211,11 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         Format fileFormat = Format_Unknown;
         TaskProgress* progress = nullptr;
         TaskId taskId = 0;
+        DocumentPtr scratchDoc;
         TDF_LabelSequence seqTransferredEntity;
         bool readSuccess = false;
+        bool hasPreviewMesh = false;
+        bool transferredInScratchDoc = false;
         bool transferred = false;
     };
 
@@ -231,24 +253,46 @@ bool System::importInDocument(const Args_ImportInDocument& args)
                         args.parametersProvider->findReaderParameters(taskData.fileFormat));
         }
 
+        if (args.previewMeshMaxTriangleCount > 0) {
+            const Handle_Poly_Triangulation previewMesh =
+                    taskData.reader->readPreviewMesh(taskData.filepath, args.previewMeshMaxTriangleCount);
+            if (previewMesh) {
+                doc->signalImportPreviewMeshChanged.send(taskData.filepath, previewMesh);
+                taskData.hasPreviewMesh = true;
+            }
+        }
+
         if (!taskData.reader->readFile(taskData.filepath, &progress))
             return fnReadFileError(taskData.filepath, textIdTr("File read problem"));
 
         return true;
     };
-    auto fnTransfer = [&](TaskData& taskData) {
+    auto fnDiscardPreviewMesh = [&](TaskData& taskData) {
+        if (taskData.hasPreviewMesh) {
+            doc->signalImportPreviewMeshChanged.send(taskData.filepath, Handle_Poly_Triangulation());
+            taskData.hasPreviewMesh = false;
+        }
+    };
+    auto fnTransfer = [&](TaskData& taskData, DocumentPtr targetDoc) {
         int portionSize = 60;
         if (fnEntityPostProcessRequired(taskData.fileFormat))
             portionSize *= (100 - args.entityPostProcessProgressSize) / 100.;
 
         TaskProgress progress(taskData.progress, portionSize, textIdTr("Transferring file"));
         if (taskData.reader && !TaskProgress::isAbortRequested(&progress)) {
-            taskData.seqTransferredEntity = taskData.reader->transfer(doc, &progress);
+            taskData.seqTransferredEntity = taskData.reader->transfer(targetDoc, &progress);
             if (taskData.seqTransferredEntity.IsEmpty())
                 fnAddError(taskData.filepath, textIdTr("File transfer problem"));
         }
+    };
+    auto fnMergeScratchDocument = [&](TaskData& taskData) {
+        if (taskData.seqTransferredEntity.IsEmpty())
+            return;
 
-        taskData.transferred = true;
+        const TDF_LabelSequence seqScratchEntity = taskData.seqTransferredEntity;
+        taskData.seqTransferredEntity = doc->copyEntities(seqScratchEntity);
+        if (taskData.seqTransferredEntity.Size() != seqScratchEntity.Size())
+            fnAddError(taskData.filepath, textIdTr("File transfer problem"));
     };
     auto fnPostProcess = [&](TaskData& taskData) {
         if (!fnEntityPostProcessRequired(taskData.fileFormat))
@@ -271,11 +315,12 @@ bool System::importInDocument(const Args_ImportInDocument& args)
 
     if (listFilepath.size() == 1) { // Single file case
         TaskData taskData;
+        auto _ = gsl::finally([&]{ fnDiscardPreviewMesh(taskData); });
         taskData.filepath = listFilepath.front();
         taskData.progress = rootProgress;
         ok = fnReadFile(taskData);
         if (ok) {
-            fnTransfer(taskData);
+            fnTransfer(taskData, doc);
             fnPostProcess(taskData);
             fnAddModelTreeEntities(taskData);
         }
@@ -283,6 +328,13 @@ bool System::importInDocument(const Args_ImportInDocument& args)
     else { // Many files case
         std::vector<TaskData> vecTaskData;
         vecTaskData.resize(listFilepath.size());
+        // Scratch documents are closed once all tasks are finished(see 'childTaskManager' destructor)
+        auto _ = gsl::finally([&]{
+            for (TaskData& taskData : vecTaskData) {
+                Document::closeScratchDocument(taskData.scratchDoc);
+                fnDiscardPreviewMesh(taskData);
+            }
+        });
 
         TaskManager childTaskManager;
         childTaskManager.signalProgressChanged.connectSlot([&](TaskId, int) {
@@ -292,9 +344,18 @@ bool System::importInDocument(const Args_ImportInDocument& args)
         // Read files
         for (TaskData& taskData : vecTaskData) {
             taskData.filepath = listFilepath[&taskData - &vecTaskData.front()];
+            // Created here as Document::newScratchDocument() isn't thread-safe. File format isn't
+            // known yet, so the scratch document might end unused
+            if (isScratchDocumentMergeSupported)
+                taskData.scratchDoc = doc->newScratchDocument();
+
             taskData.taskId = childTaskManager.newTask([&](TaskProgress* progressChild) {
                 taskData.progress = progressChild;
                 taskData.readSuccess = fnReadFile(taskData);
+                if (taskData.readSuccess && isTransferInScratchDocumentSupported(taskData.fileFormat)) {
+                    fnTransfer(taskData, taskData.scratchDoc);
+                    taskData.transferredInScratchDoc = true;
+                }
             });
         }
 
@@ -310,11 +371,18 @@ bool System::importInDocument(const Args_ImportInDocument& args)
 
             if (it != vecTaskData.end()) {
                 if (it->readSuccess) {
-                    fnTransfer(*it);
+                    if (it->transferredInScratchDoc)
+                        fnMergeScratchDocument(*it);
+                    else
+                        fnTransfer(*it, doc);
+
                     fnPostProcess(*it);
                     fnAddModelTreeEntities(*it);
                 }
 
+                fnDiscardPreviewMesh(*it);
+
+                it->transferred = true;
                 --taskDataCount;
             }
         } // endwhile
@@ -519,6 +587,13 @@ System::Operation_ImportInDocument::withEntityPostProcessInfoProgress(int progre
     return *this;
 }
 
+System::Operation_ImportInDocument::Operation&
+System::Operation_ImportInDocument::withPreviewMesh(int maxTriangleCount)
+{
+    m_args.previewMeshMaxTriangleCount = maxTriangleCount;
+    return *this;
+}
+
 bool System::Operation_ImportInDocument::execute() {
     return m_system.importInDocument(m_args);
 }
@@ -90,6 +90,10 @@ public:
         // Optional: title of the whole post-process operation
         std::string entityPostProcessProgressStep;
 
+        // Optional: when > 0, readers supporting it first read a preview mesh(at most this count of
+        //           triangles) of the files, reported by Document::signalImportPreviewMeshChanged
+        int previewMeshMaxTriangleCount = 0;
+
         // Optional: the messenger object used to report any additional infos, warnings and errors
         Messenger* messenger = nullptr;
 
@@ -140,6 +144,7 @@ public:
         Operation& withEntityPostProcess(std::function<void(TDF_Label, TaskProgress*)> fn);
         Operation& withEntityPostProcessRequiredIf(std::function<bool(Format)> fn);
         Operation& withEntityPostProcessInfoProgress(int progressSize, std::string_view progressStep);
+        Operation& withPreviewMesh(int maxTriangleCount);
 
         Operation& withMessenger(Messenger* messenger);
         Operation& withTaskProgress(TaskProgress* progress);
@@ -0,0 +1,272 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mass_properties.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <OSD_Parallel.hxx>
+#include <math_Jacobi.hxx>
+#include <math_Matrix.hxx>
+
+#include <atomic>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+// Matrix of inertia 'inertia' at center of mass moved by vector 'd'(parallel axis theorem)
+gp_Mat shiftedInertia(const gp_Mat& inertia, double mass, const gp_XYZ& d)
+{
+    gp_Mat res = inertia;
+    const double sqrDist = d.SquareModulus();
+    for (int i = 1; i <= 3; ++i) {
+        for (int j = 1; j <= 3; ++j) {
+            const double delta = (i == j ? sqrDist : 0.) - d.Coord(i) * d.Coord(j);
+            res.SetValue(i, j, res.Value(i, j) + mass * delta);
+        }
+    }
+
+    return res;
+}
+
+// Visits products located below 'label', references being resolved
+template<typename Function>
+void visitProducts(const TDF_Label& label, std::unordered_set<TDF_Label>* setVisited, Function fn)
+{
+    const TDF_Label product = XCaf::isShapeReference(label) ? XCaf::shapeReferred(label) : label;
+    if (!setVisited->insert(product).second)
+        return;
+
+    if (!fn(product))
+        return;
+
+    if (XCaf::isShapeAssembly(product)) {
+        for (const TDF_Label& component : XCaf::shapeComponents(product))
+            visitProducts(component, setVisited, fn);
+    }
+}
+
+} // namespace
+
+MassProperties MassProperties::fromShape(const TopoDS_Shape& shape, QuantityDensity density)
+{
+    GProp_GProps volumeProps;
+    GProp_GProps surfaceProps;
+    BRepGProp::VolumeProperties(shape, volumeProps);
+    BRepGProp::SurfaceProperties(shape, surfaceProps);
+
+    MassProperties props;
+    props.volume = volumeProps.Mass() * Quantity_CubicMillimeter;
+    props.area = surfaceProps.Mass() * Quantity_SquareMillimeter;
+    props.centroid = volumeProps.Mass() > 0 ? volumeProps.CentreOfMass() : surfaceProps.CentreOfMass();
+    if (density.value() > 0) {
+        // Volume is in mm³ and density in kg/m³
+        const double densityKgPerMm3 = density.value() * 1e-9;
+        props.mass = volumeProps.Mass() * densityKgPerMm3 * Quantity_Kilogram;
+        props.centerOfMass = volumeProps.CentreOfMass();
+        props.inertia = volumeProps.MatrixOfInertia() * densityKgPerMm3;
+    }
+
+    return props;
+}
+
+void MassProperties::add(const MassProperties& other)
+{
+    // Centroids are weighted by volumes, or by areas if no volume at all
+    const bool hasVolume = this->volume.value() > 0 || other.volume.value() > 0;
+    const double weight1 = hasVolume ? this->volume.value() : this->area.value();
+    const double weight2 = hasVolume ? other.volume.value() : other.area.value();
+    if (weight1 + weight2 > 0) {
+        const gp_XYZ sum = this->centroid.XYZ() * weight1 + other.centroid.XYZ() * weight2;
+        this->centroid = sum / (weight1 + weight2);
+    }
+
+    this->volume = this->volume + other.volume;
+    this->area = this->area + other.area;
+    if (this->mass && other.mass) {
+        const double mass1 = this->mass->value();
+        const double mass2 = other.mass->value();
+        gp_XYZ com = this->centerOfMass.XYZ();
+        if (mass1 + mass2 > 0)
+            com = (this->centerOfMass.XYZ() * mass1 + other.centerOfMass.XYZ() * mass2) / (mass1 + mass2);
+
+        this->inertia =
+                shiftedInertia(this->inertia, mass1, this->centerOfMass.XYZ() - com)
+                + shiftedInertia(other.inertia, mass2, other.centerOfMass.XYZ() - com);
+        this->mass = (mass1 + mass2) * Quantity_Kilogram;
+        this->centerOfMass = com;
+    }
+    else {
+        this->mass.reset();
+    }
+}
+
+MassProperties MassProperties::transformed(const gp_Trsf& trsf) const
+{
+    const double scale = std::abs(trsf.ScaleFactor());
+    MassProperties props = *this;
+    props.volume = this->volume * (scale * scale * scale);
+    props.area = this->area * (scale * scale);
+    props.centroid = this->centroid.Transformed(trsf);
+    if (this->mass) {
+        const gp_Mat rotation = trsf.HVectorialPart();
+        props.mass = *this->mass * (scale * scale * scale);
+        props.centerOfMass = this->centerOfMass.Transformed(trsf);
+        props.inertia = rotation * this->inertia * rotation.Transposed() * std::pow(scale, 5);
+    }
+
+    return props;
+}
+
+gp_XYZ MassProperties::principalMomentsOfInertia() const
+{
+    math_Matrix mat(1, 3, 1, 3);
+    for (int i = 1; i <= 3; ++i) {
+        for (int j = 1; j <= 3; ++j)
+            mat(i, j) = this->inertia.Value(i, j);
+    }
+
+    const math_Jacobi jacobi(mat);
+    if (!jacobi.IsDone())
+        return {};
+
+    return { jacobi.Value(1), jacobi.Value(2), jacobi.Value(3) };
+}
+
+std::optional<MassProperties> MassPropertiesCache::compute(const TDF_Label& label, TaskProgress* progress)
+{
+    if (!this->computeParts(this->missingParts(label), progress))
+        return {};
+
+    return this->find(label);
+}
+
+MassPropertiesCache::PartsInput MassPropertiesCache::missingParts(const TDF_Label& label)
+{
+    PartsInput parts;
+    parts.data = label.Data();
+    std::unordered_set<TDF_Label> setVisited;
+    visitProducts(label, &setVisited, [&](const TDF_Label& product) {
+        if (this->findProduct(product))
+            return false; // Up to date, nothing to compute below 'product'
+
+        if (!XCaf::isShapeAssembly(product)) {
+            parts.vecLabel.push_back(product);
+            parts.vecShape.push_back(XCaf::shape(product));
+            parts.vecDensity.push_back(XCaf::shapeMaterialDensity(product));
+        }
+
+        return true;
+    });
+
+    return parts;
+}
+
+bool MassPropertiesCache::computeParts(const PartsInput& parts, TaskProgress* progress)
+{
+    const int partCount = int(parts.vecLabel.size());
+    std::atomic<int> partDoneCount = 0;
+    std::mutex mutexProgress;
+    OSD_Parallel::For(0, partCount, [&](int i) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        const MassProperties props = MassProperties::fromShape(parts.vecShape.at(i), parts.vecDensity.at(i));
+        if (TaskProgress::isAbortRequested(progress))
+            return; // Document might be closing, don't fill the cache anymore
+
+        {
+            const Entry entry{ parts.vecShape.at(i), props, parts.data.get() };
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_mapProductEntry.insert_or_assign(parts.vecLabel.at(i), entry);
+        }
+
+        const int doneCount = ++partDoneCount;
+        if (progress) {
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            progress->setValue((100 * doneCount) / partCount);
+        }
+    });
+
+    return !TaskProgress::isAbortRequested(progress);
+}
+
+std::optional<MassProperties> MassPropertiesCache::find(const TDF_Label& label)
+{
+    if (XCaf::isShapeReference(label)) {
+        const std::optional<MassProperties> props = this->find(XCaf::shapeReferred(label));
+        if (props)
+            return props->transformed(XCaf::shapeReferenceLocation(label).Transformation());
+
+        return {};
+    }
+
+    std::optional<MassProperties> props = this->findProduct(label);
+    if (props || !XCaf::isShapeAssembly(label))
+        return props;
+
+    // Combine properties of the components
+    bool isFirstComponent = true;
+    props = MassProperties{};
+    for (const TDF_Label& component : XCaf::shapeComponents(label)) {
+        const std::optional<MassProperties> componentProps = this->find(component);
+        if (!componentProps)
+            return {};
+
+        if (isFirstComponent)
+            props = componentProps;
+        else
+            props->add(*componentProps);
+
+        isFirstComponent = false;
+    }
+
+    this->insertProduct(label, *props);
+    return props;
+}
+
+void MassPropertiesCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapProductEntry.clear();
+}
+
+void MassPropertiesCache::clear(const Handle_TDF_Data& data)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto it = m_mapProductEntry.begin(); it != m_mapProductEntry.end(); ) {
+        if (it->second.data == data.get())
+            it = m_mapProductEntry.erase(it);
+        else
+            ++it;
+    }
+}
+
+std::optional<MassProperties> MassPropertiesCache::findProduct(const TDF_Label& label)
+{
+    const TopoDS_Shape shape = XCaf::shape(label);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto itFound = m_mapProductEntry.find(label);
+    if (itFound == m_mapProductEntry.end() || !itFound->second.shape.IsEqual(shape))
+        return {};
+
+    return itFound->second.props;
+}
+
+void MassPropertiesCache::insertProduct(const TDF_Label& label, const MassProperties& props)
+{
+    const TopoDS_Shape shape = XCaf::shape(label);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mapProductEntry.insert_or_assign(label, Entry{ shape, props, label.Data() });
+}
+
+} // namespace Mayo
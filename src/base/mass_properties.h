@@ -0,0 +1,108 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "caf_utils.h"
+#include "quantity.h"
+
+#include <TDF_Data.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Mat.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Trsf.hxx>
+
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Mass properties of a part or an assembly
+struct MassProperties {
+    QuantityVolume volume{0.};
+    QuantityArea area{0.};
+    // Center of volume, or center of area for shapes without volume(eg shells)
+    gp_Pnt centroid;
+
+    // Mass related properties are only available if material density is defined for all the parts
+    std::optional<QuantityMass> mass;
+    gp_Pnt centerOfMass;
+    // Matrix of inertia at center of mass, in kg.mm²
+    gp_Mat inertia;
+
+    // Computes properties of 'shape' made of material with 'density'(mass is unknown if null)
+    static MassProperties fromShape(const TopoDS_Shape& shape, QuantityDensity density);
+
+    // Properties of the union of this and 'other'(which must not overlap)
+    void add(const MassProperties& other);
+
+    // Properties once moved with 'trsf', a rigid transformation possibly with uniform scaling
+    MassProperties transformed(const gp_Trsf& trsf) const;
+
+    // Eigen values of the matrix of inertia
+    gp_XYZ principalMomentsOfInertia() const;
+};
+
+// Computes mass properties of XCAF entities(parts, assemblies and references)
+//
+// Properties of each part are computed once, in parallel, and are stored in cache. Properties of
+// an assembly are then obtained by combining the properties of its components moved to their
+// locations, so an assembly made of many instances of the same part doesn't require more
+// computations. Combined properties of assemblies are also stored in cache.
+// Cache entries are keyed by product labels, they get outdated as soon as the shape of a product
+// is modified
+// Functions of this class are thread-safe, but the ones taking labels access OCAF data so they must
+// be called in the thread owning the document. Computation can be split to run in a worker thread:
+//     * missingParts() collects the inputs in the thread owning the document
+//     * computeParts() doesn't access OCAF data and can run in any thread
+//     * find() then combines the properties in the thread owning the document
+class MassPropertiesCache {
+public:
+    // Parts whose properties are missing in cache, with the data needed to compute them
+    struct PartsInput {
+        Handle_TDF_Data data; // Data framework the parts belong to
+        std::vector<TDF_Label> vecLabel;
+        std::vector<TopoDS_Shape> vecShape;
+        std::vector<QuantityDensity> vecDensity;
+    };
+
+    // Returns properties of 'label', missing properties are computed
+    // Returns an empty object if computation was aborted
+    std::optional<MassProperties> compute(const TDF_Label& label, TaskProgress* progress = nullptr);
+
+    // Returns the parts below 'label' whose properties have to be computed
+    PartsInput missingParts(const TDF_Label& label);
+
+    // Computes properties of 'parts' and stores them in cache
+    // Returns false if computation was aborted
+    bool computeParts(const PartsInput& parts, TaskProgress* progress = nullptr);
+
+    // Returns properties of 'label' only if they can be obtained from cache
+    std::optional<MassProperties> find(const TDF_Label& label);
+
+    void clear();
+    // Erases the entries of the labels belonging to 'data'(eg on document closing)
+    void clear(const Handle_TDF_Data& data);
+
+private:
+    std::optional<MassProperties> findProduct(const TDF_Label& label);
+    void insertProduct(const TDF_Label& label, const MassProperties& props);
+
+    struct Entry {
+        TopoDS_Shape shape; // Shape of the product at the time properties were computed
+        MassProperties props;
+        const TDF_Data* data = nullptr; // Owner of the product label
+    };
+    std::unordered_map<TDF_Label, Entry> m_mapProductEntry;
+    std::mutex m_mutex;
+};
+
+} // namespace Mayo
@@ -20,14 +20,18 @@
 #  include <XCAFDoc_VisMaterial.hxx>
 #endif
 
+#include <algorithm>
 #include <optional>
+#include <unordered_map>
+#include <vector>
 
 namespace Mayo {
 
 // Provides mesh access to a TopoDS_Face object stored within XCAF document
 class XCafFace_MeshAccess : public IMeshAccess {
 public:
-    XCafFace_MeshAccess(const DocumentTreeNode& treeNode, const TopoDS_Face& face)
+    // 'locShape' is the absolute location of the shape of 'treeNode'
+    XCafFace_MeshAccess(const DocumentTreeNode& treeNode, const TopoDS_Face& face, const TopLoc_Location& locShape)
     {
         const DocumentPtr& doc = treeNode.document();
         const TDF_Label labelNode = treeNode.label();
@@ -46,7 +50,6 @@ public:
                 m_nodeColors = annexData->nodeColors();
         }
 
-        const TopLoc_Location locShape = XCaf::shapeAbsoluteLocation(doc->modelTree(), treeNode.id());
         TopLoc_Location locFace;
         m_triangulation = BRep_Tool::Triangulation(face, locFace);
         m_location = locShape * locFace;
@@ -66,10 +69,19 @@ public:
         return m_location;
     }
 
+    // Color of the whole face, if any
+    const std::optional<Quantity_Color>& faceColor() const {
+        return m_faceColor;
+    }
+
     const Handle(Poly_Triangulation)& triangulation() const override {
         return m_triangulation;
     }
 
+    void setLocation(const TopLoc_Location& loc) {
+        m_location = loc;
+    }
+
 private:
     static std::optional<Quantity_Color> findShapeColor(const DocumentPtr& doc, const TDF_Label& labelShape)
     {
@@ -104,10 +116,94 @@ void IMeshAccess_visitMeshes(
             fnCallback(mesh);
     };
     if (XCaf::isShape(treeNode.label())) {
+        const TopLoc_Location locShape = XCaf::shapeAbsoluteLocation(treeNode.document()->modelTree(), treeNode.id());
         BRepUtils::forEachSubFace(XCaf::shape(treeNode.label()), [&](const TopoDS_Face& face) {
-            fnProxyCallback(XCafFace_MeshAccess(treeNode, face));
+            fnProxyCallback(XCafFace_MeshAccess(treeNode, face, locShape));
         });
     }
 }
 
+// Mesh shared by instances, see IMeshAccess_visitMeshInstances()
+class XCafFace_MeshInstancesAccess : public IMeshInstancesAccess {
+public:
+    XCafFace_MeshInstancesAccess(const DocumentTreeNode& treeNode, const TopoDS_Face& face)
+        : m_mesh(treeNode, face, TopLoc_Location())
+    {
+        // Face location is part of the instance locations
+        m_mesh.setLocation(TopLoc_Location());
+    }
+
+    const IMeshAccess& mesh() const override { return m_mesh; }
+    const std::optional<Quantity_Color>& faceColor() const { return m_mesh.faceColor(); }
+    Span<const TopLoc_Location> instanceLocations() const override { return m_vecInstanceLocation; }
+
+    void addInstance(const TopLoc_Location& loc) { m_vecInstanceLocation.push_back(loc); }
+
+private:
+    XCafFace_MeshAccess m_mesh;
+    std::vector<TopLoc_Location> m_vecInstanceLocation;
+};
+
+void IMeshAccess_visitMeshInstances(
+        Span<const DocumentTreeNode> spanTreeNode,
+        std::function<void(const IMeshInstancesAccess&)> fnCallback)
+{
+    if (!fnCallback)
+        return;
+
+    // Group tree nodes by product, faces of a product are then explored only once
+    struct Product {
+        DocumentTreeNode treeNode; // First tree node found
+        std::vector<TopLoc_Location> vecLocation; // Absolute locations of all the tree nodes
+    };
+    std::vector<Product> vecProduct;
+    std::unordered_map<TDF_Label, size_t> mapProductIndex;
+    for (const DocumentTreeNode& treeNode : spanTreeNode) {
+        if (!treeNode.isValid() || !XCaf::isShape(treeNode.label()))
+            continue;
+
+        auto [it, isNewProduct] = mapProductIndex.insert({ treeNode.label(), vecProduct.size() });
+        if (isNewProduct)
+            vecProduct.push_back({ treeNode, {} });
+
+        const TopLoc_Location loc = XCaf::shapeAbsoluteLocation(treeNode.document()->modelTree(), treeNode.id());
+        vecProduct.at(it->second).vecLocation.push_back(loc);
+    }
+
+    for (const Product& product : vecProduct) {
+        // Faces of the product sharing the same triangulation and the same color, in order of
+        // first occurrence. Faces having different colors are kept apart, so each one is visited
+        // with its own color
+        std::vector<XCafFace_MeshInstancesAccess> vecMesh;
+        std::unordered_map<const Poly_Triangulation*, std::vector<size_t>> mapMeshIndices;
+        BRepUtils::forEachSubFace(XCaf::shape(product.treeNode.label()), [&](const TopoDS_Face& face) {
+            TopLoc_Location locFace;
+            const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, locFace);
+            if (!triangulation)
+                return;
+
+            XCafFace_MeshInstancesAccess faceMesh(product.treeNode, face);
+            std::vector<size_t>& vecMeshIndex = mapMeshIndices[triangulation.get()];
+            auto itMeshIndex = std::find_if(vecMeshIndex.cbegin(), vecMeshIndex.cend(), [&](size_t index) {
+                return vecMesh.at(index).faceColor() == faceMesh.faceColor();
+            });
+            size_t meshIndex = vecMesh.size();
+            if (itMeshIndex != vecMeshIndex.cend()) {
+                meshIndex = *itMeshIndex;
+            }
+            else {
+                vecMeshIndex.push_back(meshIndex);
+                vecMesh.push_back(std::move(faceMesh));
+            }
+
+            XCafFace_MeshInstancesAccess& mesh = vecMesh.at(meshIndex);
+            for (const TopLoc_Location& locProduct : product.vecLocation)
+                mesh.addInstance(locProduct * locFace);
+        });
+
+        for (const XCafFace_MeshInstancesAccess& mesh : vecMesh)
+            fnCallback(mesh);
+    }
+}
+
 } // namespace Mayo
@@ -7,6 +7,7 @@
 #pragma once
 
 // Base
+#include "span.h"
 class DocumentTreeNode;
 
 // OpenCascade
@@ -35,4 +36,21 @@ void IMeshAccess_visitMeshes(
         std::function<void(const IMeshAccess&)> fnCallback
 );
 
+// Provides access to a mesh shared by many instances
+// Mesh location() is identity, placements of the instances are given by instanceLocations()
+class IMeshInstancesAccess {
+public:
+    virtual const IMeshAccess& mesh() const = 0;
+    virtual Span<const TopLoc_Location> instanceLocations() const = 0;
+};
+
+// Iterates over meshes from `spanTreeNode`, grouping faces having the same underlying
+// Poly_Triangulation and the same color within the same product(tree node label). Calls
+// `fnCallback` once per group, so a mesh instantiated N times is visited once with N instance locations
+// Typically `spanTreeNode` contains the leaf nodes of the items to be processed
+void IMeshAccess_visitMeshInstances(
+        Span<const DocumentTreeNode> spanTreeNode,
+        std::function<void(const IMeshInstancesAccess&)> fnCallback
+);
+
 } // namespace Mayo
@@ -0,0 +1,617 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_decimation.h"
+
+#include "document_tree_node.h"
+#include "mesh_access.h"
+#include "mesh_utils.h"
+#include "task_progress.h"
+
+#include <OSD_Parallel.hxx>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <queue>
+
+namespace Mayo {
+
+namespace {
+
+// Symmetric 4x4 matrix of a quadric error metric, stored as its upper triangle
+struct Quadric {
+    std::array<double, 10> m = {};
+
+    // Quadric of the squared distance to plane 'n.p + d = 0', 'n' being a unit vector
+    static Quadric fromPlane(const gp_XYZ& n, double d) {
+        const double a = n.X();
+        const double b = n.Y();
+        const double c = n.Z();
+        return Quadric{{ a*a, a*b, a*c, a*d, b*b, b*c, b*d, c*c, c*d, d*d }};
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        for (size_t i = 0; i < m.size(); ++i)
+            m[i] += other.m[i];
+
+        return *this;
+    }
+
+    double error(const gp_XYZ& p) const {
+        const double x = p.X();
+        const double y = p.Y();
+        const double z = p.Z();
+        return m[0]*x*x + 2*m[1]*x*y + 2*m[2]*x*z + 2*m[3]*x
+                + m[4]*y*y + 2*m[5]*y*z + 2*m[6]*y
+                + m[7]*z*z + 2*m[8]*z
+                + m[9];
+    }
+};
+
+// Squared distance from point 'p' to triangle 'abc'(see "Real-Time Collision Detection", C. Ericson)
+double squareDistancePointTriangle(const gp_XYZ& p, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+{
+    const gp_XYZ ab = b - a;
+    const gp_XYZ ac = c - a;
+    const gp_XYZ ap = p - a;
+    const double d1 = ab.Dot(ap);
+    const double d2 = ac.Dot(ap);
+    if (d1 <= 0. && d2 <= 0.)
+        return ap.SquareModulus();
+
+    const gp_XYZ bp = p - b;
+    const double d3 = ab.Dot(bp);
+    const double d4 = ac.Dot(bp);
+    if (d3 >= 0. && d4 <= d3)
+        return bp.SquareModulus();
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0. && d1 >= 0. && d3 <= 0.)
+        return (p - (a + (d1 / (d1 - d3)) * ab)).SquareModulus();
+
+    const gp_XYZ cp = p - c;
+    const double d5 = ab.Dot(cp);
+    const double d6 = ac.Dot(cp);
+    if (d6 >= 0. && d5 <= d6)
+        return cp.SquareModulus();
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0. && d2 >= 0. && d6 <= 0.)
+        return (p - (a + (d2 / (d2 - d6)) * ac)).SquareModulus();
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0. && (d4 - d3) >= 0. && (d5 - d6) >= 0.)
+        return (p - (b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b))).SquareModulus();
+
+    const double denom = 1. / (va + vb + vc);
+    const double v = vb * denom;
+    const double w = vc * denom;
+    return (p - (a + v * ab + w * ac)).SquareModulus();
+}
+
+// Collapse of node 'from' into node 'to', stamps are used to detect outdated collapses
+struct Collapse {
+    double error;
+    int from;
+    int to;
+    int fromStamp;
+    int toStamp;
+
+    bool operator>(const Collapse& other) const { return this->error > other.error; }
+};
+
+class Decimator {
+public:
+    using NodeColor = std::optional<Quantity_Color>;
+    using FunctionProgress = std::function<bool(int)>; // Returns false to abort
+
+    Decimator(const Handle_Poly_Triangulation& mesh, std::vector<NodeColor>&& vecNodeColor)
+        : m_vecNodeColor(std::move(vecNodeColor))
+    {
+        const int nodeCount = mesh->NbNodes();
+        m_vecNode.reserve(nodeCount);
+        for (int i = 1; i <= nodeCount; ++i)
+            m_vecNode.push_back(mesh->Node(i).XYZ());
+
+        m_vecTriangle.reserve(mesh->NbTriangles());
+        for (const Poly_Triangle& tri : MeshUtils::triangles(mesh)) {
+            int v1, v2, v3;
+            tri.Get(v1, v2, v3);
+            m_vecTriangle.push_back({ v1 - 1, v2 - 1, v3 - 1 });
+        }
+    }
+
+    MeshDecimation::Result run(const MeshDecimation::Options& options, const FunctionProgress& fnProgress);
+
+private:
+    bool isCollapsible(int from, int to) const;
+    bool isCollapseValid(int from, int to) const;
+    double squareDeviation(int from, int to) const;
+    void collapse(int from, int to);
+    void pushCollapse(int from, int to);
+    bool hasSameColor(int i, int j) const;
+
+    static uint64_t edgeKey(int a, int b) {
+        return (uint64_t(std::min(a, b)) << 32) | uint64_t(std::max(a, b));
+    }
+
+    std::vector<gp_XYZ> m_vecNode;
+    std::vector<NodeColor> m_vecNodeColor;
+    std::vector<MeshUtils::Triangle> m_vecTriangle;
+    std::vector<bool> m_vecTriangleAlive;
+    std::vector<std::vector<int>> m_vecNodeTriangles;
+    std::vector<Quadric> m_vecQuadric;
+    std::vector<int> m_vecStamp;
+    std::vector<bool> m_vecNodeAlive;
+    std::vector<bool> m_vecNodeLocked;
+    // Input nodes removed by the collapses into each node, only used when maximum error is enabled
+    std::vector<std::vector<int>> m_vecNodeRemoved;
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> m_queue;
+    MeshDecimation::Options m_options;
+};
+
+MeshDecimation::Result Decimator::run(const MeshDecimation::Options& options, const FunctionProgress& fnProgress)
+{
+    m_options = options;
+    const int nodeCount = int(m_vecNode.size());
+    const int triangleCount = int(m_vecTriangle.size());
+    m_vecTriangleAlive.assign(triangleCount, true);
+    m_vecNodeTriangles.assign(nodeCount, {});
+    m_vecQuadric.assign(nodeCount, {});
+    m_vecStamp.assign(nodeCount, 0);
+    m_vecNodeAlive.assign(nodeCount, true);
+    m_vecNodeLocked.assign(nodeCount, false);
+    m_vecNodeRemoved.assign(options.maxError > 0. ? nodeCount : 0, {});
+
+    // Quadrics of triangle planes, and count of triangles per edge to find boundaries
+    std::unordered_map<uint64_t, int> mapEdgeTriangleCount;
+    for (int itri = 0; itri < triangleCount; ++itri) {
+        const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+        const gp_XYZ& p0 = m_vecNode.at(tri[0]);
+        const gp_XYZ normal = (m_vecNode.at(tri[1]) - p0).Crossed(m_vecNode.at(tri[2]) - p0);
+        const double normalLength = normal.Modulus();
+        if (normalLength > 0.) {
+            const gp_XYZ n = normal / normalLength;
+            const Quadric q = Quadric::fromPlane(n, -n.Dot(p0));
+            for (int inode : tri)
+                m_vecQuadric.at(inode) += q;
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            m_vecNodeTriangles.at(tri[i]).push_back(itri);
+            ++mapEdgeTriangleCount[edgeKey(tri[i], tri[(i + 1) % 3])];
+        }
+    }
+
+    // Boundary edges are constrained by planes perpendicular to their triangle, so collapses don't
+    // move boundaries much. Boundary nodes are locked if requested
+    for (const MeshUtils::Triangle& tri : m_vecTriangle) {
+        const gp_XYZ& p0 = m_vecNode.at(tri[0]);
+        const gp_XYZ normal = (m_vecNode.at(tri[1]) - p0).Crossed(m_vecNode.at(tri[2]) - p0);
+        for (int i = 0; i < 3; ++i) {
+            const int a = tri[i];
+            const int b = tri[(i + 1) % 3];
+            if (mapEdgeTriangleCount.at(edgeKey(a, b)) == 2)
+                continue;
+
+            const gp_XYZ edge = m_vecNode.at(b) - m_vecNode.at(a);
+            const gp_XYZ edgeNormal = edge.Crossed(normal);
+            const double edgeNormalLength = edgeNormal.Modulus();
+            if (edgeNormalLength > 0.) {
+                const gp_XYZ n = edgeNormal / edgeNormalLength;
+                Quadric q = Quadric::fromPlane(n, -n.Dot(m_vecNode.at(a)));
+                for (double& coeff : q.m)
+                    coeff *= 100.;
+
+                m_vecQuadric.at(a) += q;
+                m_vecQuadric.at(b) += q;
+            }
+
+            if (options.preserveBoundaries) {
+                m_vecNodeLocked.at(a) = true;
+                m_vecNodeLocked.at(b) = true;
+            }
+        }
+    }
+
+    for (const MeshUtils::Triangle& tri : m_vecTriangle) {
+        for (int i = 0; i < 3; ++i) {
+            this->pushCollapse(tri[i], tri[(i + 1) % 3]);
+            this->pushCollapse(tri[(i + 1) % 3], tri[i]);
+        }
+    }
+
+    // Collapse edges, cheapest first
+    const int targetTriangleCount = int(std::clamp(options.targetRatio, 0., 1.) * triangleCount);
+    const double maxSquareError = options.maxError > 0. ? options.maxError * options.maxError : -1.;
+    int aliveTriangleCount = triangleCount;
+    int collapseCount = 0;
+    while (aliveTriangleCount > targetTriangleCount && !m_queue.empty()) {
+        const Collapse candidate = m_queue.top();
+        m_queue.pop();
+        const bool isOutdated =
+                !m_vecNodeAlive.at(candidate.from)
+                || !m_vecNodeAlive.at(candidate.to)
+                || m_vecStamp.at(candidate.from) != candidate.fromStamp
+                || m_vecStamp.at(candidate.to) != candidate.toStamp;
+        if (isOutdated || !this->isCollapseValid(candidate.from, candidate.to))
+            continue;
+
+        if (maxSquareError >= 0. && this->squareDeviation(candidate.from, candidate.to) > maxSquareError)
+            continue;
+
+        for (int itri : m_vecNodeTriangles.at(candidate.from)) {
+            const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+            if (m_vecTriangleAlive.at(itri) && std::find(tri.cbegin(), tri.cend(), candidate.to) != tri.cend())
+                --aliveTriangleCount;
+        }
+
+        this->collapse(candidate.from, candidate.to);
+        if (++collapseCount % 1000 == 0) {
+            const int pct = (100 * (triangleCount - aliveTriangleCount)) / std::max(triangleCount - targetTriangleCount, 1);
+            if (fnProgress && !fnProgress(std::min(pct, 100)))
+                return {};
+        }
+    }
+
+    // Build output mesh, nodes are kept in input order
+    std::vector<int> vecNewIndex(nodeCount, -1);
+    MeshDecimation::Result result;
+    for (int itri = 0; itri < triangleCount; ++itri) {
+        if (m_vecTriangleAlive.at(itri)) {
+            for (int inode : m_vecTriangle.at(itri))
+                vecNewIndex.at(inode) = 0;
+        }
+    }
+
+    for (int inode = 0; inode < nodeCount; ++inode) {
+        if (vecNewIndex.at(inode) == 0) {
+            vecNewIndex.at(inode) = int(result.sourceNodes.size());
+            result.sourceNodes.push_back(inode);
+        }
+    }
+
+    result.mesh = new Poly_Triangulation(int(result.sourceNodes.size()), aliveTriangleCount, false/*!hasUvNodes*/);
+    for (size_t i = 0; i < result.sourceNodes.size(); ++i)
+        MeshUtils::setNode(result.mesh, int(i) + 1, m_vecNode.at(result.sourceNodes.at(i)));
+
+    int iNewTriangle = 0;
+    for (int itri = 0; itri < triangleCount; ++itri) {
+        if (m_vecTriangleAlive.at(itri)) {
+            const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+            const Poly_Triangle newTri(
+                        vecNewIndex.at(tri[0]) + 1, vecNewIndex.at(tri[1]) + 1, vecNewIndex.at(tri[2]) + 1
+            );
+            MeshUtils::setTriangle(result.mesh, ++iNewTriangle, newTri);
+        }
+    }
+
+    if (fnProgress)
+        fnProgress(100);
+
+    return result;
+}
+
+bool Decimator::isCollapsible(int from, int to) const
+{
+    return from != to
+            && !m_vecNodeLocked.at(from)
+            && (!m_options.preserveColors || this->hasSameColor(from, to));
+}
+
+bool Decimator::isCollapseValid(int from, int to) const
+{
+    // Link condition: nodes adjacent to both 'from' and 'to' must be the opposite nodes of the
+    // triangles sharing edge 'from-to', otherwise the collapse would create a non-manifold mesh
+    std::vector<int> vecFromNeighbour;
+    std::vector<int> vecToNeighbour;
+    int sharedTriangleCount = 0;
+    for (int itri : m_vecNodeTriangles.at(from)) {
+        if (!m_vecTriangleAlive.at(itri))
+            continue;
+
+        const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+        if (std::find(tri.cbegin(), tri.cend(), to) != tri.cend())
+            ++sharedTriangleCount;
+
+        vecFromNeighbour.insert(vecFromNeighbour.end(), tri.cbegin(), tri.cend());
+    }
+
+    for (int itri : m_vecNodeTriangles.at(to)) {
+        if (m_vecTriangleAlive.at(itri)) {
+            const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+            vecToNeighbour.insert(vecToNeighbour.end(), tri.cbegin(), tri.cend());
+        }
+    }
+
+    auto fnSortUnique = [=](std::vector<int>& vec) {
+        std::sort(vec.begin(), vec.end());
+        vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+        vec.erase(std::remove_if(vec.begin(), vec.end(), [=](int i) { return i == from || i == to; }), vec.end());
+    };
+    fnSortUnique(vecFromNeighbour);
+    fnSortUnique(vecToNeighbour);
+    std::vector<int> vecCommonNeighbour;
+    std::set_intersection(
+                vecFromNeighbour.cbegin(), vecFromNeighbour.cend(),
+                vecToNeighbour.cbegin(), vecToNeighbour.cend(),
+                std::back_inserter(vecCommonNeighbour)
+    );
+    if (sharedTriangleCount == 0 || int(vecCommonNeighbour.size()) != sharedTriangleCount)
+        return false;
+
+    // Moved triangles must not flip nor become degenerate
+    const gp_XYZ& pntTo = m_vecNode.at(to);
+    for (int itri : m_vecNodeTriangles.at(from)) {
+        const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+        if (!m_vecTriangleAlive.at(itri) || std::find(tri.cbegin(), tri.cend(), to) != tri.cend())
+            continue;
+
+        std::array<gp_XYZ, 3> pnts = { m_vecNode.at(tri[0]), m_vecNode.at(tri[1]), m_vecNode.at(tri[2]) };
+        const gp_XYZ normalBefore = (pnts[1] - pnts[0]).Crossed(pnts[2] - pnts[0]);
+        for (int i = 0; i < 3; ++i) {
+            if (tri[i] == from)
+                pnts[i] = pntTo;
+        }
+
+        const gp_XYZ normalAfter = (pnts[1] - pnts[0]).Crossed(pnts[2] - pnts[0]);
+        const double lengthProduct = normalBefore.Modulus() * normalAfter.Modulus();
+        if (lengthProduct <= 0. || normalBefore.Dot(normalAfter) < 0.2 * lengthProduct)
+            return false;
+    }
+
+    return true;
+}
+
+// Largest squared distance between the input nodes removed by collapsing 'from' into 'to'(ie
+// 'from' and the nodes previously collapsed into it) and the triangles moved by the collapse
+double Decimator::squareDeviation(int from, int to) const
+{
+    std::vector<std::array<gp_XYZ, 3>> vecMovedTriangle;
+    for (int itri : m_vecNodeTriangles.at(from)) {
+        const MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+        if (!m_vecTriangleAlive.at(itri) || std::find(tri.cbegin(), tri.cend(), to) != tri.cend())
+            continue;
+
+        std::array<gp_XYZ, 3> pnts;
+        for (int i = 0; i < 3; ++i)
+            pnts[i] = m_vecNode.at(tri[i] == from ? to : tri[i]);
+
+        vecMovedTriangle.push_back(pnts);
+    }
+
+    auto fnSquareDistance = [&](const gp_XYZ& pnt) {
+        if (vecMovedTriangle.empty())
+            return (pnt - m_vecNode.at(to)).SquareModulus();
+
+        double minSquareDist = std::numeric_limits<double>::max();
+        for (const std::array<gp_XYZ, 3>& tri : vecMovedTriangle)
+            minSquareDist = std::min(minSquareDist, squareDistancePointTriangle(pnt, tri[0], tri[1], tri[2]));
+
+        return minSquareDist;
+    };
+
+    double maxSquareDist = fnSquareDistance(m_vecNode.at(from));
+    for (int inode : m_vecNodeRemoved.at(from))
+        maxSquareDist = std::max(maxSquareDist, fnSquareDistance(m_vecNode.at(inode)));
+
+    return maxSquareDist;
+}
+
+void Decimator::collapse(int from, int to)
+{
+    std::vector<int>& vecToTriangle = m_vecNodeTriangles.at(to);
+    for (int itri : m_vecNodeTriangles.at(from)) {
+        if (!m_vecTriangleAlive.at(itri))
+            continue;
+
+        MeshUtils::Triangle& tri = m_vecTriangle.at(itri);
+        if (std::find(tri.cbegin(), tri.cend(), to) != tri.cend()) {
+            m_vecTriangleAlive.at(itri) = false;
+        }
+        else {
+            std::replace(tri.begin(), tri.end(), from, to);
+            vecToTriangle.push_back(itri);
+        }
+    }
+
+    m_vecNodeTriangles.at(from).clear();
+    m_vecNodeAlive.at(from) = false;
+    vecToTriangle.erase(
+                std::remove_if(vecToTriangle.begin(), vecToTriangle.end(), [&](int itri) {
+                    return !m_vecTriangleAlive.at(itri);
+                }),
+                vecToTriangle.end()
+    );
+    m_vecQuadric.at(to) += m_vecQuadric.at(from);
+    ++m_vecStamp.at(to);
+    if (!m_vecNodeRemoved.empty()) {
+        std::vector<int>& vecToRemoved = m_vecNodeRemoved.at(to);
+        std::vector<int>& vecFromRemoved = m_vecNodeRemoved.at(from);
+        vecToRemoved.push_back(from);
+        vecToRemoved.insert(vecToRemoved.end(), vecFromRemoved.cbegin(), vecFromRemoved.cend());
+        vecFromRemoved = {};
+    }
+
+    // Costs of collapses involving 'to' have changed
+    for (int itri : vecToTriangle) {
+        for (int inode : m_vecTriangle.at(itri)) {
+            if (inode != to) {
+                this->pushCollapse(inode, to);
+                this->pushCollapse(to, inode);
+            }
+        }
+    }
+}
+
+void Decimator::pushCollapse(int from, int to)
+{
+    if (!this->isCollapsible(from, to))
+        return;
+
+    Quadric q = m_vecQuadric.at(from);
+    q += m_vecQuadric.at(to);
+    const double error = std::max(q.error(m_vecNode.at(to)), 0.);
+    m_queue.push({ error, from, to, m_vecStamp.at(from), m_vecStamp.at(to) });
+}
+
+bool Decimator::hasSameColor(int i, int j) const
+{
+    if (m_vecNodeColor.empty())
+        return true;
+
+    const Decimator::NodeColor& lhs = m_vecNodeColor.at(i);
+    const Decimator::NodeColor& rhs = m_vecNodeColor.at(j);
+    if (lhs.has_value() != rhs.has_value())
+        return false;
+
+    return !lhs.has_value() || lhs->IsEqual(rhs.value());
+}
+
+std::vector<Decimator::NodeColor> nodeColors(const IMeshAccess& mesh)
+{
+    std::vector<Decimator::NodeColor> vecNodeColor;
+    vecNodeColor.reserve(mesh.triangulation()->NbNodes());
+    for (int i = 0; i < mesh.triangulation()->NbNodes(); ++i)
+        vecNodeColor.push_back(mesh.nodeColor(i));
+
+    return vecNodeColor;
+}
+
+bool isSameNodeColors(Span<const Decimator::NodeColor> lhs, Span<const Decimator::NodeColor> rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const auto& lhsColor, const auto& rhsColor) {
+        if (lhsColor.has_value() != rhsColor.has_value())
+            return false;
+
+        return !lhsColor.has_value() || lhsColor->IsEqual(rhsColor.value());
+    });
+}
+
+} // namespace
+
+MeshDecimation::Result MeshDecimation::run(
+        const Handle_Poly_Triangulation& mesh,
+        const Options& options,
+        const std::function<std::optional<Quantity_Color>(int)>& fnNodeColor,
+        TaskProgress* progress
+    )
+{
+    if (!mesh)
+        return {};
+
+    std::vector<Decimator::NodeColor> vecNodeColor;
+    if (fnNodeColor) {
+        vecNodeColor.reserve(mesh->NbNodes());
+        for (int i = 0; i < mesh->NbNodes(); ++i)
+            vecNodeColor.push_back(fnNodeColor(i));
+    }
+
+    Decimator decimator(mesh, std::move(vecNodeColor));
+    return decimator.run(options, [=](int pct) {
+        if (progress)
+            progress->setValue(pct);
+
+        return !TaskProgress::isAbortRequested(progress);
+    });
+}
+
+MeshDecimation::Result MeshDecimation::run(const IMeshAccess& mesh, const Options& options, TaskProgress* progress)
+{
+    return MeshDecimation::run(mesh.triangulation(), options, [&](int i) { return mesh.nodeColor(i); }, progress);
+}
+
+MeshDecimation::ResultMap MeshDecimation::runParallel(
+        Span<const DocumentTreeNode> spanTreeNode, const Options& options, TaskProgress* progress
+    )
+{
+    // Mesh data is gathered beforehand, IMeshAccess objects are only valid within the visit
+    // A triangulation is decimated once per distinct node colors, colors constraining the collapses
+    struct MeshItem {
+        Handle_Poly_Triangulation triangulation;
+        std::vector<Decimator::NodeColor> vecNodeColor;
+    };
+    std::vector<MeshItem> vecMeshItem;
+    std::unordered_map<const Poly_Triangulation*, std::vector<int>> mapTriangulationItems;
+    IMeshAccess_visitMeshInstances(spanTreeNode, [&](const IMeshInstancesAccess& meshInstances) {
+        const IMeshAccess& mesh = meshInstances.mesh();
+        const Handle_Poly_Triangulation& triangulation = mesh.triangulation();
+        if (!triangulation)
+            return;
+
+        MeshItem item;
+        item.triangulation = triangulation;
+        if (options.preserveColors)
+            item.vecNodeColor = nodeColors(mesh);
+
+        std::vector<int>& vecItemIndex = mapTriangulationItems[triangulation.get()];
+        for (int i : vecItemIndex) {
+            if (isSameNodeColors(vecMeshItem.at(i).vecNodeColor, item.vecNodeColor))
+                return;
+        }
+
+        vecItemIndex.push_back(int(vecMeshItem.size()));
+        vecMeshItem.push_back(std::move(item));
+    });
+
+    std::vector<Result> vecResult(vecMeshItem.size());
+    std::atomic<int> meshDoneCount = 0;
+    std::mutex mutexProgress;
+    OSD_Parallel::For(0, int(vecMeshItem.size()), [&](int i) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        // Node colors are copied as they're kept in the results
+        const MeshItem& item = vecMeshItem.at(i);
+        Decimator decimator(item.triangulation, std::vector<Decimator::NodeColor>(item.vecNodeColor));
+        vecResult.at(i) = decimator.run(options, [=](int) { return !TaskProgress::isAbortRequested(progress); });
+        const int doneCount = ++meshDoneCount;
+        if (progress) {
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            progress->setValue((100 * doneCount) / int(vecMeshItem.size()));
+        }
+    });
+
+    // Failed decimations aren't recorded, input meshes are then used as is
+    ResultMap mapResult;
+    for (size_t i = 0; i < vecMeshItem.size(); ++i) {
+        if (vecResult.at(i).mesh) {
+            MeshItem& item = vecMeshItem.at(i);
+            ResultMap::Variant variant;
+            variant.vecNodeColor = std::move(item.vecNodeColor);
+            variant.result = std::move(vecResult.at(i));
+            mapResult.m_mapTriangulationVariants[item.triangulation.get()].push_back(std::move(variant));
+        }
+    }
+
+    return mapResult;
+}
+
+const MeshDecimation::Result* MeshDecimation::ResultMap::find(const IMeshAccess& mesh) const
+{
+    auto itFound = m_mapTriangulationVariants.find(mesh.triangulation().get());
+    if (itFound == m_mapTriangulationVariants.cend())
+        return nullptr;
+
+    const std::vector<Variant>& vecVariant = itFound->second;
+    if (vecVariant.size() == 1 && vecVariant.front().vecNodeColor.empty())
+        return &vecVariant.front().result; // Colors not preserved
+
+    const std::vector<Decimator::NodeColor> vecNodeColor = nodeColors(mesh);
+    for (const Variant& variant : vecVariant) {
+        if (isSameNodeColors(variant.vecNodeColor, vecNodeColor))
+            return &variant.result;
+    }
+
+    return nullptr;
+}
+
+} // namespace Mayo
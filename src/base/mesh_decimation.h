@@ -0,0 +1,87 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+
+#include <Poly_Triangulation.hxx>
+#include <Quantity_Color.hxx>
+
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class DocumentTreeNode;
+class IMeshAccess;
+class TaskProgress;
+
+// Simplification of triangle meshes by successive edge collapses, cheapest collapses first
+//
+// Cost of a collapse is given by quadric error metrics(Garland-Heckbert): each node accumulates
+// the planes of its incident triangles, error being the sum of squared distances to these planes
+// A collapsed node is merged into one of its neighbours(no new node is created), so output nodes
+// are a subset of input nodes and node attributes like colors are simply carried over
+class MeshDecimation {
+public:
+    struct Options {
+        // Count of triangles to keep relative to the input count, in [0, 1]
+        double targetRatio = 0.5;
+        // Maximum distance between a removed input node and the simplified surface, disabled if zero
+        // Checked when the node is removed, against the triangles moved by the collapse
+        double maxError = 0.;
+        // Nodes on open boundaries(and non-manifold edges) are kept
+        bool preserveBoundaries = true;
+        // Nodes having different colors are never merged
+        bool preserveColors = true;
+    };
+
+    struct Result {
+        // Decimated mesh, null if decimation failed
+        Handle_Poly_Triangulation mesh;
+        // Output node at index i is input node 'sourceNodes[i]'(zero-based indices)
+        std::vector<int> sourceNodes;
+    };
+
+    // Decimates 'mesh', optional 'fnNodeColor' provides color of input nodes(zero-based indices)
+    static Result run(
+            const Handle_Poly_Triangulation& mesh,
+            const Options& options,
+            const std::function<std::optional<Quantity_Color>(int)>& fnNodeColor = nullptr,
+            TaskProgress* progress = nullptr
+    );
+
+    static Result run(const IMeshAccess& mesh, const Options& options, TaskProgress* progress = nullptr);
+
+    // Results of runParallel() for the visited meshes
+    // A triangulation visited with different node colors(eg shared by faces of different colors) has
+    // one result per color variant when colors are preserved
+    class ResultMap {
+    public:
+        // Result for 'mesh'(as visited with IMeshAccess_visitMeshInstances()), null if none
+        const Result* find(const IMeshAccess& mesh) const;
+        bool empty() const { return m_mapTriangulationVariants.empty(); }
+
+    private:
+        friend class MeshDecimation;
+        struct Variant {
+            std::vector<std::optional<Quantity_Color>> vecNodeColor; // Empty if colors not preserved
+            Result result;
+        };
+        std::unordered_map<const Poly_Triangulation*, std::vector<Variant>> m_mapTriangulationVariants;
+    };
+
+    // Decimates in parallel the meshes visited with IMeshAccess_visitMeshInstances(), each mesh being
+    // processed by a separate task
+    static ResultMap runParallel(
+            Span<const DocumentTreeNode> spanTreeNode, const Options& options, TaskProgress* progress = nullptr
+    );
+};
+
+} // namespace Mayo
@@ -6,11 +6,118 @@
 
 #include "mesh_utils.h"
 #include "math_utils.h"
+#include "unit_system.h"
+#include <Bnd_Box.hxx>
+#include <OSD_Parallel.hxx>
+#include <Precision.hxx>
 #include <Standard_Version.hxx>
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <tuple>
+#include <unordered_map>
 
 namespace Mayo {
 
+namespace {
+
+// Are triangles 'tri1' and 'tri2' separated once projected on 'axis'?
+bool isSeparatingAxis(const gp_XYZ& axis, const gp_XYZ* tri1, const gp_XYZ* tri2, double tolerance)
+{
+    const double axisLength = axis.Modulus();
+    if (axisLength < 1e-12) // Degenerated axis, meaningless
+        return false;
+
+    const auto [min1, max1] = std::minmax({ axis.Dot(tri1[0]), axis.Dot(tri1[1]), axis.Dot(tri1[2]) });
+    const auto [min2, max2] = std::minmax({ axis.Dot(tri2[0]), axis.Dot(tri2[1]), axis.Dot(tri2[2]) });
+    const double gap = tolerance * axisLength;
+    return min2 > max1 + gap || min1 > max2 + gap;
+}
+
+// Cell of the spatial hash grid used to weld nodes
+struct GridCell {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+
+    bool operator==(const GridCell& other) const {
+        return this->x == other.x && this->y == other.y && this->z == other.z;
+    }
+
+    bool operator<(const GridCell& other) const {
+        return std::tie(this->x, this->y, this->z) < std::tie(other.x, other.y, other.z);
+    }
+};
+
+struct GridCellHash {
+    size_t operator()(const GridCell& cell) const {
+        // Large primes from "Optimized Spatial Hashing for Collision Detection of Deformable Objects"
+        const auto h = uint64_t(cell.x) * 73856093u ^ uint64_t(cell.y) * 19349663u ^ uint64_t(cell.z) * 83492791u;
+        return size_t(h);
+    }
+};
+
+// Spreads the 21 lower bits of 'v' so there are two zero bits between each of them
+uint64_t spreadBits3(uint64_t v)
+{
+    v &= 0x1FFFFF;
+    v = (v | v << 32) & 0x1F00000000FFFF;
+    v = (v | v << 16) & 0x1F0000FF0000FF;
+    v = (v | v << 8)  & 0x100F00F00F00F00F;
+    v = (v | v << 4)  & 0x10C30C30C30C30C3;
+    v = (v | v << 2)  & 0x1249249249249249;
+    return v;
+}
+
+// Sorts triangles along the Morton curve(Z-order) of their centers
+void sortTrianglesByMortonCode(
+        std::vector<MeshUtils::Triangle>* ptrVecTriangle, const std::function<gp_Pnt(int)>& fnNode
+    )
+{
+    std::vector<MeshUtils::Triangle>& vecTriangle = *ptrVecTriangle;
+    const int triangleCount = int(vecTriangle.size());
+    std::vector<gp_XYZ> vecCenter(triangleCount);
+    OSD_Parallel::For(0, triangleCount, [&](int i) {
+        const MeshUtils::Triangle& tri = vecTriangle.at(i);
+        vecCenter.at(i) = (fnNode(tri[0]).XYZ() + fnNode(tri[1]).XYZ() + fnNode(tri[2]).XYZ()) / 3.;
+    });
+
+    Bnd_Box box;
+    for (const gp_XYZ& center : vecCenter)
+        box.Add(gp_Pnt(center));
+
+    if (box.IsVoid())
+        return;
+
+    const gp_XYZ cornerMin = box.CornerMin().XYZ();
+    const gp_XYZ boxSize = box.CornerMax().XYZ() - cornerMin;
+    const double maxCoord = double(0x1FFFFF);
+    auto fnQuantize = [=](double value, double size) {
+        return size > 0 ? uint64_t(std::clamp(value / size, 0., 1.) * maxCoord) : uint64_t(0);
+    };
+
+    std::vector<std::pair<uint64_t, int>> vecCodeTriangle(triangleCount);
+    OSD_Parallel::For(0, triangleCount, [&](int i) {
+        const gp_XYZ pos = vecCenter.at(i) - cornerMin;
+        const uint64_t code =
+                spreadBits3(fnQuantize(pos.X(), boxSize.X()))
+                | spreadBits3(fnQuantize(pos.Y(), boxSize.Y())) << 1
+                | spreadBits3(fnQuantize(pos.Z(), boxSize.Z())) << 2;
+        vecCodeTriangle.at(i) = { code, i };
+    });
+
+    std::sort(vecCodeTriangle.begin(), vecCodeTriangle.end());
+    std::vector<MeshUtils::Triangle> vecSortedTriangle;
+    vecSortedTriangle.reserve(triangleCount);
+    for (const auto& [code, i] : vecCodeTriangle)
+        vecSortedTriangle.push_back(vecTriangle.at(i));
+
+    vecTriangle = std::move(vecSortedTriangle);
+}
+
+} // namespace
+
 double MeshUtils::triangleSignedVolume(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3)
 {
     return p1.Dot(p2.Crossed(p3)) / 6.0f;
@@ -68,6 +175,40 @@ double MeshUtils::triangulationArea(const Handle_Poly_Triangulation& triangulati
     return area;
 }
 
+bool MeshUtils::trianglesIntersect(
+        const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3,
+        const gp_XYZ& q1, const gp_XYZ& q2, const gp_XYZ& q3,
+        double tolerance)
+{
+    // Separating axis test: triangles don't intersect if their projections on one of the candidate
+    // axes are disjoint. Axes normal to the edges within the triangle planes handle coplanar triangles
+    const gp_XYZ tri1[] = { p1, p2, p3 };
+    const gp_XYZ tri2[] = { q1, q2, q3 };
+    const gp_XYZ edges1[] = { p2 - p1, p3 - p2, p1 - p3 };
+    const gp_XYZ edges2[] = { q2 - q1, q3 - q2, q1 - q3 };
+    const gp_XYZ normal1 = edges1[0].Crossed(edges1[1]);
+    const gp_XYZ normal2 = edges2[0].Crossed(edges2[1]);
+    if (isSeparatingAxis(normal1, tri1, tri2, tolerance) || isSeparatingAxis(normal2, tri1, tri2, tolerance))
+        return false;
+
+    for (const gp_XYZ& edge1 : edges1) {
+        for (const gp_XYZ& edge2 : edges2) {
+            if (isSeparatingAxis(edge1.Crossed(edge2), tri1, tri2, tolerance))
+                return false;
+        }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        if (isSeparatingAxis(normal1.Crossed(edges1[i]), tri1, tri2, tolerance)
+                || isSeparatingAxis(normal2.Crossed(edges2[i]), tri1, tri2, tolerance))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void MeshUtils::setNode(const Handle_Poly_Triangulation& triangulation, int index, const gp_Pnt& pnt)
 {
 #if OCC_VERSION_HEX >= 0x070600
@@ -108,6 +249,34 @@ void MeshUtils::allocateNormals(const Handle_Poly_Triangulation& triangulation)
 #endif
 }
 
+gp_Vec MeshUtils::normal(const Handle_Poly_Triangulation& triangulation, int index)
+{
+#if OCC_VERSION_HEX >= 0x070600
+    return gp_Vec(triangulation->Normal(index));
+#else
+    const TShort_Array1OfShortReal& normals = triangulation->Normals();
+    return gp_Vec(normals.Value(index * 3 - 2), normals.Value(index * 3 - 1), normals.Value(index * 3));
+#endif
+}
+
+gp_Pnt2d MeshUtils::uvNode(const Handle_Poly_Triangulation& triangulation, int index)
+{
+#if OCC_VERSION_HEX >= 0x070600
+    return triangulation->UVNode(index);
+#else
+    return triangulation->UVNodes().Value(index);
+#endif
+}
+
+void MeshUtils::setUvNode(const Handle_Poly_Triangulation& triangulation, int index, const gp_Pnt2d& uv)
+{
+#if OCC_VERSION_HEX >= 0x070600
+    triangulation->SetUVNode(index, uv);
+#else
+    triangulation->ChangeUVNodes().ChangeValue(index) = uv;
+#endif
+}
+
 // Adapted from http://cs.smith.edu/~jorourke/Code/polyorient.C
 MeshUtils::Orientation MeshUtils::orientation(const AdaptorPolyline2d& polyline)
 {
@@ -182,4 +351,325 @@ gp_Vec MeshUtils::directionAt(const AdaptorPolyline3d& polyline, int i)
     return gp_Vec();
 }
 
+std::vector<int> MeshUtils::weldNodes(
+        int nodeCount,
+        const std::function<gp_Pnt(int)>& fnNode,
+        double tolerance,
+        const std::function<bool(int, int)>& fnCanMerge
+    )
+{
+    std::vector<int> vecTarget(std::max(nodeCount, 0));
+    std::iota(vecTarget.begin(), vecTarget.end(), 0);
+    if (nodeCount < 2)
+        return vecTarget;
+
+    std::vector<gp_XYZ> vecCoords(nodeCount);
+    OSD_Parallel::For(0, nodeCount, [&](int i) { vecCoords.at(i) = fnNode(i).XYZ(); });
+    Bnd_Box box;
+    for (const gp_XYZ& coords : vecCoords)
+        box.Add(gp_Pnt(coords));
+
+    // Cells not smaller than 'tolerance' so nodes to be merged are in the same or adjacent cells
+    // Lower bound on cell size avoids overflow of cell coordinates
+    double cellSize = std::max(tolerance, 1e-9 * std::sqrt(box.SquareExtent()));
+    if (cellSize <= 0.)
+        cellSize = 1.;
+
+    const gp_XYZ cornerMin = box.CornerMin().XYZ();
+    std::vector<GridCell> vecCell(nodeCount);
+    OSD_Parallel::For(0, nodeCount, [&](int i) {
+        const gp_XYZ pos = (vecCoords.at(i) - cornerMin) / cellSize;
+        vecCell.at(i) = { int64_t(pos.X()), int64_t(pos.Y()), int64_t(pos.Z()) };
+    });
+
+    // Sort nodes by cell then index, so nodes of a cell are a contiguous range in ascending order
+    std::vector<int> vecSortedNode(vecTarget);
+    std::sort(vecSortedNode.begin(), vecSortedNode.end(), [&](int lhs, int rhs) {
+        const GridCell& lhsCell = vecCell.at(lhs);
+        const GridCell& rhsCell = vecCell.at(rhs);
+        return lhsCell == rhsCell ? lhs < rhs : lhsCell < rhsCell;
+    });
+
+    std::unordered_map<GridCell, std::pair<int, int>, GridCellHash> mapCellRange;
+    for (int i = 0; i < nodeCount; ) {
+        const GridCell& cell = vecCell.at(vecSortedNode.at(i));
+        int j = i + 1;
+        while (j < nodeCount && vecCell.at(vecSortedNode.at(j)) == cell)
+            ++j;
+
+        mapCellRange.insert({ cell, { i, j } });
+        i = j;
+    }
+
+    // Lowest index of the nodes within tolerance of node 'i' and accepted by 'fnAccept', among the
+    // nodes of lower index. Returns 'i' if none
+    const double sqTolerance = tolerance * tolerance;
+    const int64_t cellRadius = tolerance > 0. ? 1 : 0;
+    auto fnFindNeighbor = [&](int i, const std::function<bool(int)>& fnAccept) {
+        const GridCell& cell = vecCell.at(i);
+        const gp_XYZ& coords = vecCoords.at(i);
+        int found = i;
+        for (int64_t dx = -cellRadius; dx <= cellRadius; ++dx) {
+            for (int64_t dy = -cellRadius; dy <= cellRadius; ++dy) {
+                for (int64_t dz = -cellRadius; dz <= cellRadius; ++dz) {
+                    auto itRange = mapCellRange.find({ cell.x + dx, cell.y + dy, cell.z + dz });
+                    if (itRange == mapCellRange.cend())
+                        continue;
+
+                    const auto [begin, end] = itRange->second;
+                    for (int k = begin; k < end && vecSortedNode.at(k) < found; ++k) {
+                        const int candidate = vecSortedNode.at(k);
+                        if ((vecCoords.at(candidate) - coords).SquareModulus() <= sqTolerance && fnAccept(candidate)) {
+                            found = candidate;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        return found;
+    };
+
+    // Each node is first merged into the node of lowest index found within tolerance
+    OSD_Parallel::For(0, nodeCount, [&](int i) {
+        vecTarget.at(i) = fnFindNeighbor(i, [&](int candidate) { return !fnCanMerge || fnCanMerge(candidate, i); });
+    });
+
+    // Targets have lower indices, so a single ascending pass resolves chains of merged nodes
+    // Neither the tolerance nor 'fnCanMerge'(eg crease angle) are transitive: a node is merged only
+    // if the final node of the chain accepts it, otherwise another neighbor is looked for
+    auto fnCanMergeInto = [&](int keptNode, int i) {
+        return (vecCoords.at(keptNode) - vecCoords.at(i)).SquareModulus() <= sqTolerance
+                && (!fnCanMerge || fnCanMerge(keptNode, i));
+    };
+    for (int i = 0; i < nodeCount; ++i) {
+        const int target = vecTarget.at(i);
+        if (target == i)
+            continue;
+
+        const int keptNode = vecTarget.at(target);
+        if (keptNode == target || fnCanMergeInto(keptNode, i)) {
+            vecTarget.at(i) = keptNode;
+        }
+        else {
+            const int neighbor = fnFindNeighbor(i, [&](int candidate) {
+                return fnCanMergeInto(vecTarget.at(candidate), i);
+            });
+            vecTarget.at(i) = neighbor != i ? vecTarget.at(neighbor) : i;
+        }
+    }
+
+    return vecTarget;
+}
+
+MeshUtils::CleanupResult MeshUtils::cleanup(
+        int nodeCount,
+        const std::function<gp_Pnt(int)>& fnNode,
+        Span<const Triangle> spanTriangle,
+        const CleanupOptions& options
+    )
+{
+    CleanupResult result;
+    std::vector<int> vecTarget;
+    if (options.weldNodes) {
+        vecTarget = MeshUtils::weldNodes(nodeCount, fnNode, options.weldTolerance, options.fnCanMergeNodes);
+    }
+    else {
+        vecTarget.resize(nodeCount);
+        std::iota(vecTarget.begin(), vecTarget.end(), 0);
+    }
+
+    for (int i = 0; i < nodeCount; ++i) {
+        if (vecTarget.at(i) != i)
+            ++result.mergedNodeCount;
+    }
+
+    // Remap triangles to merged nodes
+    result.triangles.reserve(spanTriangle.size());
+    for (const Triangle& tri : spanTriangle) {
+        const Triangle newTri = { vecTarget.at(tri[0]), vecTarget.at(tri[1]), vecTarget.at(tri[2]) };
+        const bool isDegenerate = newTri[0] == newTri[1] || newTri[1] == newTri[2] || newTri[2] == newTri[0];
+        if (isDegenerate && options.removeDegenerateTriangles)
+            ++result.removedTriangleCount;
+        else
+            result.triangles.push_back(newTri);
+    }
+
+    if (options.reorderForLocality)
+        sortTrianglesByMortonCode(&result.triangles, fnNode);
+
+    // Renumber referenced nodes, in order of first use if reordering otherwise in input order
+    std::vector<int> vecNewIndex(nodeCount, -1);
+    auto fnAddNode = [&](int inode) {
+        if (vecNewIndex.at(inode) < 0) {
+            vecNewIndex.at(inode) = int(result.sourceNodes.size());
+            result.sourceNodes.push_back(inode);
+        }
+    };
+    if (options.reorderForLocality) {
+        for (const Triangle& tri : result.triangles) {
+            for (int inode : tri)
+                fnAddNode(inode);
+        }
+    }
+    else {
+        std::vector<bool> vecReferenced(nodeCount, false);
+        for (const Triangle& tri : result.triangles) {
+            for (int inode : tri)
+                vecReferenced.at(inode) = true;
+        }
+
+        for (int i = 0; i < nodeCount; ++i) {
+            if (vecReferenced.at(i))
+                fnAddNode(i);
+        }
+    }
+
+    for (Triangle& tri : result.triangles) {
+        for (int& inode : tri)
+            inode = vecNewIndex.at(inode);
+    }
+
+    return result;
+}
+
+Handle_Poly_Triangulation MeshUtils::cleanup(
+        const Handle_Poly_Triangulation& mesh,
+        const CleanupOptions& options,
+        CleanupResult* ptrResult
+    )
+{
+    if (!mesh)
+        return mesh;
+
+    std::vector<Triangle> vecTriangle;
+    vecTriangle.reserve(mesh->NbTriangles());
+    for (const Poly_Triangle& tri : MeshUtils::triangles(mesh)) {
+        int v1, v2, v3;
+        tri.Get(v1, v2, v3);
+        vecTriangle.push_back({ v1 - 1, v2 - 1, v3 - 1 });
+    }
+
+    auto fnNode = [&](int i) -> gp_Pnt { return mesh->Node(i + 1); };
+
+    // Nodes separated by a crease or a UV seam aren't merged
+    const int nodeCount = mesh->NbNodes();
+    const bool hasNormals = mesh->HasNormals();
+    const bool hasUvNodes = mesh->HasUVNodes();
+    std::vector<gp_Vec> vecNormal;
+    if (hasNormals) {
+        vecNormal.resize(nodeCount);
+        for (int i = 0; i < nodeCount; ++i)
+            vecNormal.at(i) = MeshUtils::normal(mesh, i + 1);
+    }
+
+    CleanupOptions meshOptions = options;
+    if (hasNormals || hasUvNodes) {
+        const double creaseAngle = UnitSystem::radians(options.creaseAngle);
+        meshOptions.fnCanMergeNodes = [&](int i, int j) {
+            if (options.fnCanMergeNodes && !options.fnCanMergeNodes(i, j))
+                return false;
+
+            if (hasNormals) {
+                const gp_Vec& ni = vecNormal.at(i);
+                const gp_Vec& nj = vecNormal.at(j);
+                const bool isCrease =
+                        ni.SquareMagnitude() > 0. && nj.SquareMagnitude() > 0. && ni.Angle(nj) > creaseAngle;
+                if (isCrease)
+                    return false;
+            }
+
+            return !hasUvNodes
+                    || MeshUtils::uvNode(mesh, i + 1).IsEqual(MeshUtils::uvNode(mesh, j + 1), Precision::PConfusion());
+        };
+    }
+
+    // Reordering alone isn't worth rebuilding the mesh, so it's done only if the mesh is modified
+    meshOptions.reorderForLocality = false;
+    CleanupResult result = MeshUtils::cleanup(nodeCount, fnNode, vecTriangle, meshOptions);
+    const bool isUnchanged =
+            result.mergedNodeCount == 0
+            && result.removedTriangleCount == 0
+            && int(result.sourceNodes.size()) == nodeCount;
+    if (!isUnchanged && options.reorderForLocality) {
+        meshOptions.reorderForLocality = true;
+        result = MeshUtils::cleanup(nodeCount, fnNode, vecTriangle, meshOptions);
+    }
+
+    Handle_Poly_Triangulation newMesh = mesh;
+    if (!isUnchanged) {
+        const int newNodeCount = int(result.sourceNodes.size());
+        const int newTriangleCount = int(result.triangles.size());
+        newMesh = new Poly_Triangulation(newNodeCount, newTriangleCount, hasUvNodes);
+        newMesh->Deflection(mesh->Deflection());
+        if (hasNormals)
+            MeshUtils::allocateNormals(newMesh);
+
+        for (int i = 0; i < newNodeCount; ++i) {
+            const int sourceNode = result.sourceNodes.at(i);
+            MeshUtils::setNode(newMesh, i + 1, fnNode(sourceNode));
+            if (hasNormals) {
+                const gp_Vec& n = vecNormal.at(sourceNode);
+                MeshUtils::setNormal(newMesh, i + 1, Poly_Triangulation_NormalType(n.X(), n.Y(), n.Z()));
+            }
+
+            if (hasUvNodes)
+                MeshUtils::setUvNode(newMesh, i + 1, MeshUtils::uvNode(mesh, sourceNode + 1));
+        }
+
+        for (int i = 0; i < newTriangleCount; ++i) {
+            const Triangle& tri = result.triangles.at(i);
+            MeshUtils::setTriangle(newMesh, i + 1, { tri[0] + 1, tri[1] + 1, tri[2] + 1 });
+        }
+    }
+
+    if (ptrResult) {
+        result.triangles.clear();
+        *ptrResult = std::move(result);
+    }
+
+    return newMesh;
+}
+
+Handle_Poly_Triangulation MeshUtils::sampledMesh(
+        const Handle_Poly_Triangulation& mesh, int maxTriangleCount, std::vector<int>* ptrVecSourceNode
+    )
+{
+    const int triangleCount = mesh->NbTriangles();
+    if (maxTriangleCount <= 0 || triangleCount <= 0)
+        return new Poly_Triangulation(0, 0, false/*!hasUvNodes*/);
+
+    const int step = (triangleCount + maxTriangleCount - 1) / maxTriangleCount;
+    std::vector<Poly_Triangle> vecTriangle;
+    vecTriangle.reserve(triangleCount / step + 1);
+    std::unordered_map<int, int> mapPreviewNode; // Source node -> preview node(one-based indices)
+    mapPreviewNode.reserve(2 * vecTriangle.capacity());
+    const Poly_Array1OfTriangle& triangles = MeshUtils::triangles(mesh);
+    for (int i = triangles.Lower(); i <= triangles.Upper(); i += step) {
+        int nodes[3];
+        triangles(i).Get(nodes[0], nodes[1], nodes[2]);
+        for (int& node : nodes) {
+            auto [it, isNewNode] = mapPreviewNode.insert({ node, int(ptrVecSourceNode->size()) + 1 });
+            if (isNewNode)
+                ptrVecSourceNode->push_back(node - 1);
+
+            node = it->second;
+        }
+
+        vecTriangle.emplace_back(nodes[0], nodes[1], nodes[2]);
+    }
+
+    Handle_Poly_Triangulation preview = new Poly_Triangulation(
+                int(ptrVecSourceNode->size()), int(vecTriangle.size()), false/*!hasUvNodes*/
+    );
+    for (int i = 0; i < int(ptrVecSourceNode->size()); ++i)
+        MeshUtils::setNode(preview, i + 1, mesh->Node(ptrVecSourceNode->at(i) + 1));
+
+    for (int i = 0; i < int(vecTriangle.size()); ++i)
+        MeshUtils::setTriangle(preview, i + 1, vecTriangle.at(i));
+
+    return preview;
+}
+
 } // namespace Mayo
@@ -6,9 +6,18 @@
 
 #pragma once
 
+#include "quantity.h"
+#include "span.h"
+
 #include <Poly_Triangulation.hxx>
 #include <Standard_Version.hxx>
-class gp_XYZ;
+#include <gp_Pnt.hxx>
+#include <gp_Pnt2d.hxx>
+#include <gp_Vec.hxx>
+
+#include <array>
+#include <functional>
+#include <vector>
 
 namespace Mayo {
 
@@ -16,6 +25,14 @@ struct MeshUtils {
     static double triangleSignedVolume(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3);
     static double triangleArea(const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3);
 
+    // Do triangles (p1, p2, p3) and (q1, q2, q3) intersect or touch? Triangles separated by less
+    // than 'tolerance' are considered touching. Coplanar triangles are supported
+    static bool trianglesIntersect(
+            const gp_XYZ& p1, const gp_XYZ& p2, const gp_XYZ& p3,
+            const gp_XYZ& q1, const gp_XYZ& q2, const gp_XYZ& q3,
+            double tolerance = 0.
+    );
+
     static double triangulationVolume(const Handle_Poly_Triangulation& triangulation);
     static double triangulationArea(const Handle_Poly_Triangulation& triangulation);
 
@@ -29,6 +46,9 @@ struct MeshUtils {
     static void setTriangle(const Handle_Poly_Triangulation& triangulation, int index, const Poly_Triangle& triangle);
     static void setNormal(const Handle_Poly_Triangulation& triangulation, int index, const Poly_Triangulation_NormalType& n);
     static void allocateNormals(const Handle_Poly_Triangulation& triangulation);
+    static gp_Vec normal(const Handle_Poly_Triangulation& triangulation, int index);
+    static gp_Pnt2d uvNode(const Handle_Poly_Triangulation& triangulation, int index);
+    static void setUvNode(const Handle_Poly_Triangulation& triangulation, int index, const gp_Pnt2d& uv);
 
     static const Poly_Array1OfTriangle& triangles(const Handle_Poly_Triangulation& triangulation) {
 #if OCC_VERSION_HEX < 0x070600
@@ -61,6 +81,77 @@ struct MeshUtils {
 
     static Orientation orientation(const AdaptorPolyline2d& polyline);
     static gp_Vec directionAt(const AdaptorPolyline3d& polyline, int i);
+
+    // Triangle as a triplet of zero-based node indices
+    using Triangle = std::array<int, 3>;
+
+    struct CleanupOptions {
+        // Merge nodes closer than 'weldTolerance'(only exactly coincident nodes if zero)
+        bool weldNodes = true;
+        double weldTolerance = 0.;
+        // Optional, nodes are merged only if this function returns true(eg nodes having the same
+        // color). It must be thread-safe and symmetric
+        std::function<bool(int, int)> fnCanMergeNodes;
+        // Poly_Triangulation overload only: nodes whose normals form an angle greater than this one
+        // aren't merged, so sharp edges keep their shading. Nodes having different UV coordinates
+        // aren't merged either
+        QuantityAngle creaseAngle = 30 * Quantity_Degree;
+        // Remove triangles having repeated nodes, typically once nodes are welded
+        bool removeDegenerateTriangles = true;
+        // Sort triangles along a space-filling curve and renumber nodes in order of first use, so
+        // triangles close in space are also close in memory(better vertex cache locality)
+        // Poly_Triangulation overload only applies it to meshes modified by the other operations
+        bool reorderForLocality = false;
+    };
+
+    struct CleanupResult {
+        // Output node at index i is input node 'sourceNodes[i]'
+        std::vector<int> sourceNodes;
+        // Output triangles, referencing output nodes
+        std::vector<Triangle> triangles;
+        int mergedNodeCount = 0;
+        int removedTriangleCount = 0;
+    };
+
+    // Merges nodes closer than 'tolerance', candidate nodes are found with a spatial hash grid
+    // Returns for each node the index of the node it's merged into, which has a lower index(node i
+    // is kept when result[i] == i). A node is merged only if it's within 'tolerance' of the kept
+    // node and accepted by 'fnCanMerge' against it, so merging doesn't chain across rejected pairs
+    // Optional 'fnCanMerge' restricts merging, see CleanupOptions::fnCanMergeNodes
+    // Functions 'fnNode' and 'fnCanMerge' are called concurrently, they must be thread-safe
+    static std::vector<int> weldNodes(
+            int nodeCount,
+            const std::function<gp_Pnt(int)>& fnNode,
+            double tolerance,
+            const std::function<bool(int, int)>& fnCanMerge = nullptr
+    );
+
+    // Cleans up the mesh defined by 'nodeCount' nodes and triangles 'spanTriangle'
+    // Nodes not referenced by output triangles are discarded
+    static CleanupResult cleanup(
+            int nodeCount,
+            const std::function<gp_Pnt(int)>& fnNode,
+            Span<const Triangle> spanTriangle,
+            const CleanupOptions& options
+    );
+
+    // Same as above but operating on 'mesh', returns a new triangulation or 'mesh' itself if no node
+    // was merged nor dropped and no triangle removed
+    // Normals and UV nodes are transferred to the new triangulation
+    // Optional 'ptrResult' receives the node mapping and statistics(not the triangles)
+    static Handle_Poly_Triangulation cleanup(
+            const Handle_Poly_Triangulation& mesh,
+            const CleanupOptions& options,
+            CleanupResult* ptrResult = nullptr
+    );
+
+    // Mesh made of evenly sampled triangles of 'mesh', at most 'maxTriangleCount'
+    // Only the nodes used by the sampled triangles are kept, 'ptrVecSourceNode' receives their indices
+    // in 'mesh'(zero-based)
+    // This is linear in the count of sampled triangles, so fast whatever the size of 'mesh'
+    static Handle_Poly_Triangulation sampledMesh(
+            const Handle_Poly_Triangulation& mesh, int maxTriangleCount, std::vector<int>* ptrVecSourceNode
+    );
 };
 
 } // namespace Mayo
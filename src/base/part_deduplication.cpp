@@ -0,0 +1,526 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "part_deduplication.h"
+#include "caf_utils.h"
+#include "document.h"
+#include "task_progress.h"
+#include "xcaf.h"
+
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepGProp.hxx>
+#include <BRep_Tool.hxx>
+#include <GProp_GProps.hxx>
+#include <GProp_PrincipalProps.hxx>
+#include <OSD_Parallel.hxx>
+#include <TDataStd_Name.hxx>
+#include <TDataStd_TreeNode.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopoDS.hxx>
+#include <XCAFDoc.hxx>
+#include <XCAFDoc_Location.hxx>
+#if OCC_VERSION_HEX >= 0x070500
+#  include <XCAFDoc_VisMaterial.hxx>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Mayo {
+
+namespace {
+
+// Mass properties are only used to filter candidates, so they are compared loosely: results of
+// numerical integration depend on the parameterization of surfaces
+const double massPropertiesRelativeTolerance = 1e-4;
+
+// Principal moments closer than this(relative to the greatest moment) are considered equal
+const double principalMomentsRelativeTolerance = 1e-3;
+
+// Maximum count of canonical frames tried when looking for the transformation between two shapes
+const int maxCandidateFrameCount = 64;
+
+// Face centroids come from numerical integration, so they're compared more loosely than vertices
+const double faceCentroidToleranceFactor = 100.;
+
+bool fuzzyEqual(double lhs, double rhs, double tolerance)
+{
+    return std::abs(lhs - rhs) <= tolerance;
+}
+
+// Adds 'dir' to 'vecDir' if not already there(within angular tolerance)
+void addUniqueDirection(std::vector<gp_Dir>* vecDir, const gp_Dir& dir)
+{
+    auto itFound = std::find_if(vecDir->cbegin(), vecDir->cend(), [&](const gp_Dir& other) {
+        return other.IsEqual(dir, Precision::Angular());
+    });
+    if (itFound == vecDir->cend())
+        vecDir->push_back(dir);
+}
+
+// Directions from 'origin' to the farthest vertices
+std::vector<gp_Dir> farthestDirections(const gp_Pnt& origin, const std::vector<gp_Pnt>& vertices, double tolerance)
+{
+    double maxDist = 0.;
+    for (const gp_Pnt& pnt : vertices)
+        maxDist = std::max(maxDist, origin.Distance(pnt));
+
+    std::vector<gp_Dir> vecDir;
+    if (maxDist > tolerance) {
+        for (const gp_Pnt& pnt : vertices) {
+            if (fuzzyEqual(origin.Distance(pnt), maxDist, tolerance))
+                addUniqueDirection(&vecDir, gp_Vec(origin, pnt));
+        }
+    }
+
+    return vecDir;
+}
+
+// Directions perpendicular to 'axis' and pointing to the vertices which are the farthest from 'axis'
+std::vector<gp_Dir> farthestRadialDirections(const gp_Ax1& axis, const std::vector<gp_Pnt>& vertices, double tolerance)
+{
+    auto fnRadialVector = [&](const gp_Pnt& pnt) {
+        const gp_Vec vec(axis.Location(), pnt);
+        return vec - gp_Vec(axis.Direction()) * vec.Dot(gp_Vec(axis.Direction()));
+    };
+
+    double maxDist = 0.;
+    for (const gp_Pnt& pnt : vertices)
+        maxDist = std::max(maxDist, fnRadialVector(pnt).Magnitude());
+
+    std::vector<gp_Dir> vecDir;
+    if (maxDist > tolerance) {
+        for (const gp_Pnt& pnt : vertices) {
+            const gp_Vec vec = fnRadialVector(pnt);
+            if (fuzzyEqual(vec.Magnitude(), maxDist, tolerance))
+                addUniqueDirection(&vecDir, vec);
+        }
+    }
+
+    return vecDir;
+}
+
+// Is each point of 'vecPnt' within 'tolerance' of some point in 'vecSortedPnt'(sorted by X) ?
+bool pointsMatch(const std::vector<gp_Pnt>& vecPnt, const std::vector<gp_Pnt>& vecSortedPnt, double tolerance)
+{
+    const double sqrTolerance = tolerance * tolerance;
+    for (const gp_Pnt& pnt : vecPnt) {
+        auto it = std::lower_bound(
+                    vecSortedPnt.cbegin(), vecSortedPnt.cend(), pnt.X() - tolerance,
+                    [](const gp_Pnt& lhs, double x) { return lhs.X() < x; }
+        );
+        bool found = false;
+        for (; !found && it != vecSortedPnt.cend() && it->X() <= pnt.X() + tolerance; ++it)
+            found = it->SquareDistance(pnt) <= sqrTolerance;
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+std::vector<gp_Pnt> sortedPoints(std::vector<gp_Pnt> vecPnt)
+{
+    std::sort(vecPnt.begin(), vecPnt.end(), [](const gp_Pnt& lhs, const gp_Pnt& rhs) {
+        return lhs.X() < rhs.X();
+    });
+    return vecPnt;
+}
+
+// Makes 'component' refer to shape 'referred' with 'location', other attributes of 'component' are
+// left untouched
+// This is what (private) XCAFDoc_ShapeTool::MakeReference() does
+void redirectComponent(const TDF_Label& component, const TDF_Label& referred, const TopLoc_Location& location)
+{
+    XCAFDoc_Location::Set(component, location);
+    Handle_TDataStd_TreeNode referredNode = TDataStd_TreeNode::Set(referred, XCAFDoc::ShapeRefGUID());
+    Handle_TDataStd_TreeNode componentNode = TDataStd_TreeNode::Set(component, XCAFDoc::ShapeRefGUID());
+    componentNode->Remove();
+    referredNode->Prepend(componentNode);
+}
+
+// Attributes a part must share with another one to be merged
+struct PartAppearance {
+    std::optional<Quantity_Color> color;
+    double materialDensity = 0.;
+    TDF_LabelSequence seqLayer;
+#if OCC_VERSION_HEX >= 0x070500
+    Handle_XCAFDoc_VisMaterial visMaterial;
+#endif
+
+    bool operator==(const PartAppearance& other) const
+    {
+        if (this->color != other.color || this->materialDensity != other.materialDensity)
+            return false;
+
+#if OCC_VERSION_HEX >= 0x070500
+        if (this->visMaterial != other.visMaterial)
+            return false;
+#endif
+
+        if (this->seqLayer.Size() != other.seqLayer.Size())
+            return false;
+
+        return std::equal(this->seqLayer.begin(), this->seqLayer.end(), other.seqLayer.begin());
+    }
+};
+
+struct Part {
+    TDF_Label label;
+    TopoDS_Shape shape;
+    std::vector<TDF_Label> vecComponent; // Components referring to the part
+    PartAppearance appearance;
+    ShapeFingerprint fingerprint;
+    double tolerance = 0.;
+    int masterIndex = -1; // Index of the identical part replacing this one, -1 if none
+    gp_Trsf trsfFromMaster;
+};
+
+// Collects the simple shapes referred by components of the assemblies located below 'label'
+void collectParts(
+        const TDF_Label& label,
+        const XCaf& xcaf,
+        std::unordered_set<TDF_Label>* setVisited,
+        std::unordered_map<TDF_Label, int>* mapPartIndex,
+        std::vector<Part>* vecPart
+    )
+{
+    const TDF_Label product = XCaf::isShapeReference(label) ? XCaf::shapeReferred(label) : label;
+    if (!XCaf::isShapeAssembly(product) || !setVisited->insert(product).second)
+        return;
+
+    for (const TDF_Label& component : XCaf::shapeComponents(product)) {
+        const TDF_Label referred = XCaf::shapeReferred(component);
+        if (XCaf::isShapeAssembly(referred)) {
+            collectParts(referred, xcaf, setVisited, mapPartIndex, vecPart);
+            continue;
+        }
+
+        // Parts with sub-shape labels(eg face colors) or own location are left unchanged
+        const TopoDS_Shape shape = XCaf::shape(referred);
+        if (!XCaf::isShapeSimple(referred)
+                || shape.IsNull()
+                || !shape.Location().IsIdentity()
+                || !XCaf::shapeSubs(referred).IsEmpty())
+        {
+            continue;
+        }
+
+        auto [it, isNewPart] = mapPartIndex->insert({ referred, int(vecPart->size()) });
+        if (isNewPart) {
+            Part part;
+            part.label = referred;
+            part.shape = shape;
+            if (xcaf.hasShapeColor(referred))
+                part.appearance.color = xcaf.shapeColor(referred);
+
+            part.appearance.materialDensity = XCaf::shapeMaterialDensity(referred).value();
+            part.appearance.seqLayer = xcaf.layers(referred);
+#if OCC_VERSION_HEX >= 0x070500
+            part.appearance.visMaterial = xcaf.visMaterialTool()->GetShapeMaterial(referred);
+#endif
+            vecPart->push_back(std::move(part));
+        }
+
+        vecPart->at(it->second).vecComponent.push_back(component);
+    }
+}
+
+} // namespace
+
+ShapeFingerprint ShapeFingerprint::compute(const TopoDS_Shape& shape)
+{
+    ShapeFingerprint fp;
+    GProp_GProps surfaceProps;
+    for (int type = TopAbs_SOLID; type <= TopAbs_VERTEX; ++type) {
+        TopTools_IndexedMapOfShape mapShape;
+        TopExp::MapShapes(shape, TopAbs_ShapeEnum(type), mapShape);
+        fp.subShapeCounts.at(type - TopAbs_SOLID) = mapShape.Extent();
+        if (type == TopAbs_FACE) {
+            for (const TopoDS_Shape& face : mapShape) {
+                const BRepAdaptor_Surface surface(TopoDS::Face(face), false/*restrictToBoundaries*/);
+                ++fp.surfaceTypeCounts.at(surface.GetType());
+                GProp_GProps faceProps;
+                BRepGProp::SurfaceProperties(face, faceProps);
+                fp.faceCentroids.push_back(faceProps.CentreOfMass());
+                surfaceProps.Add(faceProps);
+            }
+        }
+        else if (type == TopAbs_VERTEX) {
+            for (const TopoDS_Shape& vertex : mapShape)
+                fp.vertices.push_back(BRep_Tool::Pnt(TopoDS::Vertex(vertex)));
+        }
+    }
+
+    GProp_GProps volumeProps;
+    BRepGProp::VolumeProperties(shape, volumeProps);
+    fp.volume = volumeProps.Mass();
+    fp.area = surfaceProps.Mass();
+
+    const GProp_GProps& props = std::abs(fp.volume) > Precision::Confusion() ? volumeProps : surfaceProps;
+    fp.centroid = props.CentreOfMass();
+    const GProp_PrincipalProps principalProps = props.PrincipalProperties();
+    struct MomentAxis { double moment; gp_Dir axis; };
+    std::array<MomentAxis, 3> arrayMomentAxis = {};
+    principalProps.Moments(arrayMomentAxis[0].moment, arrayMomentAxis[1].moment, arrayMomentAxis[2].moment);
+    arrayMomentAxis[0].axis = principalProps.FirstAxisOfInertia();
+    arrayMomentAxis[1].axis = principalProps.SecondAxisOfInertia();
+    arrayMomentAxis[2].axis = principalProps.ThirdAxisOfInertia();
+    std::sort(arrayMomentAxis.begin(), arrayMomentAxis.end(), [](const MomentAxis& lhs, const MomentAxis& rhs) {
+        return lhs.moment < rhs.moment;
+    });
+    for (int i = 0; i < 3; ++i) {
+        fp.principalMoments.at(i) = arrayMomentAxis.at(i).moment;
+        fp.principalAxes.at(i) = arrayMomentAxis.at(i).axis;
+    }
+
+    return fp;
+}
+
+bool ShapeFingerprint::hasSameTopology(const ShapeFingerprint& other) const
+{
+    return this->subShapeCounts == other.subShapeCounts
+            && this->surfaceTypeCounts == other.surfaceTypeCounts;
+}
+
+bool ShapeFingerprint::hasSameMassProperties(const ShapeFingerprint& other, double relativeTolerance) const
+{
+    auto fnEqual = [=](double lhs, double rhs, double scale) {
+        return fuzzyEqual(lhs, rhs, relativeTolerance * std::max(scale, Precision::Confusion()));
+    };
+
+    const double momentScale = std::max(std::abs(this->principalMoments.at(2)), std::abs(other.principalMoments.at(2)));
+    return fnEqual(this->volume, other.volume, std::max(std::abs(this->volume), std::abs(other.volume)))
+            && fnEqual(this->area, other.area, std::max(this->area, other.area))
+            && fnEqual(this->principalMoments.at(0), other.principalMoments.at(0), momentScale)
+            && fnEqual(this->principalMoments.at(1), other.principalMoments.at(1), momentScale)
+            && fnEqual(this->principalMoments.at(2), other.principalMoments.at(2), momentScale);
+}
+
+std::vector<gp_Ax3> ShapeFingerprint::canonicalFrames(double tolerance, int maxCount) const
+{
+    std::vector<gp_Ax3> vecFrame;
+    auto fnAddFrames = [&](const gp_Dir& dirZ, const std::vector<gp_Dir>& vecDirX) {
+        for (const gp_Dir& dirX : vecDirX) {
+            if (int(vecFrame.size()) < maxCount)
+                vecFrame.emplace_back(this->centroid, dirZ, dirX);
+        }
+    };
+    auto fnAddFramesAroundAxis = [&](const gp_Dir& dirZ) {
+        std::vector<gp_Dir> vecDirX = farthestRadialDirections(gp_Ax1(this->centroid, dirZ), this->vertices, tolerance);
+        if (vecDirX.empty()) // All vertices on the axis
+            vecDirX.push_back(gp_Ax2(this->centroid, dirZ).XDirection());
+
+        fnAddFrames(dirZ, vecDirX);
+    };
+
+    const std::array<double, 3>& moments = this->principalMoments;
+    const std::array<gp_Dir, 3>& axes = this->principalAxes;
+    const double momentTolerance = principalMomentsRelativeTolerance * std::abs(moments.at(2));
+    const bool isEqualMoments01 = fuzzyEqual(moments.at(0), moments.at(1), momentTolerance);
+    const bool isEqualMoments12 = fuzzyEqual(moments.at(1), moments.at(2), momentTolerance);
+    if (!isEqualMoments01 && !isEqualMoments12) {
+        // Principal axes are defined up to their orientation
+        for (const gp_Dir& dirZ : { axes.at(0), axes.at(0).Reversed() })
+            fnAddFrames(dirZ, { axes.at(1), axes.at(1).Reversed() });
+    }
+    else if (isEqualMoments01 != isEqualMoments12) {
+        // Rotational symmetry of inertia around the axis having a distinct moment
+        const gp_Dir& axis = isEqualMoments01 ? axes.at(2) : axes.at(0);
+        fnAddFramesAroundAxis(axis);
+        fnAddFramesAroundAxis(axis.Reversed());
+    }
+    else {
+        // Isotropic inertia(eg cube or sphere), rely only on vertices
+        std::vector<gp_Dir> vecDirZ = farthestDirections(this->centroid, this->vertices, tolerance);
+        if (vecDirZ.empty())
+            vecDirZ.push_back(gp::DZ());
+
+        for (const gp_Dir& dirZ : vecDirZ)
+            fnAddFramesAroundAxis(dirZ);
+    }
+
+    return vecFrame;
+}
+
+std::optional<gp_Trsf> ShapeFingerprint::findTransformation(
+        const ShapeFingerprint& from, const ShapeFingerprint& to, double tolerance
+    )
+{
+    if (from.vertices.size() != to.vertices.size() || from.faceCentroids.size() != to.faceCentroids.size())
+        return {};
+
+    const std::vector<gp_Ax3> vecFromFrame = from.canonicalFrames(tolerance, 1);
+    if (vecFromFrame.empty())
+        return {};
+
+    const std::vector<gp_Pnt> vecToSortedVertex = sortedPoints(to.vertices);
+    const std::vector<gp_Pnt> vecToSortedFaceCentroid = sortedPoints(to.faceCentroids);
+    auto fnTransformed = [](const std::vector<gp_Pnt>& vecPnt, const gp_Trsf& trsf) {
+        std::vector<gp_Pnt> vecMovedPnt;
+        vecMovedPnt.reserve(vecPnt.size());
+        for (const gp_Pnt& pnt : vecPnt)
+            vecMovedPnt.push_back(pnt.Transformed(trsf));
+
+        return vecMovedPnt;
+    };
+
+    const double faceCentroidTolerance = faceCentroidToleranceFactor * tolerance;
+    for (const gp_Ax3& toFrame : to.canonicalFrames(tolerance, maxCandidateFrameCount)) {
+        gp_Trsf trsf;
+        trsf.SetDisplacement(vecFromFrame.front(), toFrame);
+        if (pointsMatch(fnTransformed(from.vertices, trsf), vecToSortedVertex, tolerance)
+                && pointsMatch(fnTransformed(from.faceCentroids, trsf), vecToSortedFaceCentroid, faceCentroidTolerance))
+        {
+            return trsf;
+        }
+    }
+
+    return {};
+}
+
+PartDeduplication::Result PartDeduplication::run(
+        const TDF_Label& label, const Options& options, TaskProgress* progress
+    )
+{
+    Result result;
+    const DocumentPtr doc = Document::findFrom(label);
+    if (!doc)
+        return result;
+
+    XCaf& xcaf = doc->xcaf();
+    std::vector<Part> vecPart;
+    {
+        std::unordered_set<TDF_Label> setVisited;
+        std::unordered_map<TDF_Label, int> mapPartIndex;
+        collectParts(label, xcaf, &setVisited, &mapPartIndex, &vecPart);
+    }
+
+    result.partCount = int(vecPart.size());
+    if (vecPart.size() < 2)
+        return result;
+
+    // Compute fingerprints
+    {
+        TaskProgress fingerprintProgress(progress, 80);
+        std::atomic<int> partDoneCount = 0;
+        std::mutex mutexProgress;
+        OSD_Parallel::For(0, int(vecPart.size()), [&](int i) {
+            if (TaskProgress::isAbortRequested(progress))
+                return;
+
+            Part& part = vecPart.at(i);
+            part.fingerprint = ShapeFingerprint::compute(part.shape);
+            Bnd_Box bndBox;
+            BRepBndLib::Add(part.shape, bndBox);
+            const double partSize = !bndBox.IsVoid() ? std::sqrt(bndBox.SquareExtent()) : 0.;
+            part.tolerance = std::max(options.relativeTolerance * partSize, Precision::Confusion());
+            const int doneCount = ++partDoneCount;
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            fingerprintProgress.setValue((100 * doneCount) / int(vecPart.size()));
+        });
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return result;
+
+    // Group parts having the same topology, then find identical parts within each group
+    std::vector<std::vector<int>> vecTopologyGroup;
+    for (const Part& part : vecPart) {
+        auto itGroup = std::find_if(vecTopologyGroup.begin(), vecTopologyGroup.end(), [&](const std::vector<int>& group) {
+            return vecPart.at(group.front()).fingerprint.hasSameTopology(part.fingerprint);
+        });
+        if (itGroup == vecTopologyGroup.end())
+            itGroup = vecTopologyGroup.insert(vecTopologyGroup.end(), std::vector<int>{});
+
+        itGroup->push_back(int(&part - vecPart.data()));
+    }
+
+    std::vector<const std::vector<int>*> vecPartGroup;
+    for (const std::vector<int>& vecPartIndex : vecTopologyGroup) {
+        if (vecPartIndex.size() > 1)
+            vecPartGroup.push_back(&vecPartIndex);
+    }
+
+    {
+        TaskProgress matchProgress(progress, 15);
+        std::atomic<int> groupDoneCount = 0;
+        std::mutex mutexProgress;
+        OSD_Parallel::For(0, int(vecPartGroup.size()), [&](int iGroup) {
+            std::vector<int> vecMasterIndex;
+            for (int partIndex : *vecPartGroup.at(iGroup)) {
+                if (TaskProgress::isAbortRequested(progress))
+                    return;
+
+                Part& part = vecPart.at(partIndex);
+                for (int masterIndex : vecMasterIndex) {
+                    const Part& master = vecPart.at(masterIndex);
+                    if (!(part.appearance == master.appearance)
+                            || !part.fingerprint.hasSameMassProperties(master.fingerprint, massPropertiesRelativeTolerance))
+                    {
+                        continue;
+                    }
+
+                    const double tolerance = std::max(part.tolerance, master.tolerance);
+                    const auto trsf = ShapeFingerprint::findTransformation(master.fingerprint, part.fingerprint, tolerance);
+                    if (trsf) {
+                        part.masterIndex = masterIndex;
+                        part.trsfFromMaster = *trsf;
+                        break;
+                    }
+                }
+
+                if (part.masterIndex < 0)
+                    vecMasterIndex.push_back(partIndex);
+            }
+
+            const int doneCount = ++groupDoneCount;
+            std::lock_guard<std::mutex> lock(mutexProgress);
+            matchProgress.setValue((100 * doneCount) / int(vecPartGroup.size()));
+        });
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return result;
+
+    // Redirect components referring to duplicated parts to their identical part
+    // Color, material, layers and visual material of the duplicated part are the same as the ones
+    // of the identical part(see PartAppearance), only its name has to be moved onto the components
+    Handle_XCAFDoc_ShapeTool shapeTool = xcaf.shapeTool();
+    bool isAssemblyModified = false;
+    for (const Part& part : vecPart) {
+        if (part.masterIndex < 0)
+            continue;
+
+        const TDF_Label& labelMaster = vecPart.at(part.masterIndex).label;
+        for (const TDF_Label& component : part.vecComponent) {
+            const TopLoc_Location location = XCaf::shapeReferenceLocation(component) * TopLoc_Location(part.trsfFromMaster);
+            if (!component.IsAttribute(TDataStd_Name::GetID()) && part.label.IsAttribute(TDataStd_Name::GetID()))
+                TDataStd_Name::Set(component, CafUtils::labelAttrStdName(part.label));
+
+            redirectComponent(component, labelMaster, location);
+            isAssemblyModified = true;
+        }
+
+        // Fails if the part is referred outside of 'label'
+        if (shapeTool->RemoveShape(part.label))
+            ++result.mergedPartCount;
+    }
+
+    if (isAssemblyModified)
+        shapeTool->UpdateAssemblies();
+
+    return result;
+}
+
+} // namespace Mayo
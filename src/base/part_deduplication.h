@@ -0,0 +1,91 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include <GeomAbs_SurfaceType.hxx>
+#include <TDF_Label.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Ax3.hxx>
+#include <gp_Pnt.hxx>
+#include <gp_Trsf.hxx>
+
+#include <array>
+#include <optional>
+#include <vector>
+
+namespace Mayo {
+
+class TaskProgress;
+
+// Geometric fingerprint of a shape, invariant by rigid transformations
+//
+// Two shapes having equal fingerprints are candidates to be the same shape at different locations,
+// findTransformation() is then used to confirm that and get the transformation between them
+struct ShapeFingerprint {
+    // Count of unique sub-shapes, indexed by TopAbs_ShapeEnum(compounds and compsolids excluded)
+    std::array<int, 6> subShapeCounts = {};
+    // Count of faces, indexed by GeomAbs_SurfaceType
+    std::array<int, GeomAbs_OtherSurface + 1> surfaceTypeCounts = {};
+
+    // Volume properties, or surface properties if the shape has no volume
+    double volume = 0;
+    double area = 0;
+    gp_Pnt centroid;
+    // Principal moments of inertia in ascending order, along with the matching principal axes
+    std::array<double, 3> principalMoments = {};
+    std::array<gp_Dir, 3> principalAxes;
+
+    std::vector<gp_Pnt> vertices;
+    // Centroid of each face, catches shapes having the same vertices but different face geometry
+    std::vector<gp_Pnt> faceCentroids;
+
+    static ShapeFingerprint compute(const TopoDS_Shape& shape);
+
+    bool hasSameTopology(const ShapeFingerprint& other) const;
+
+    // Are volume, area and principal moments equal within 'relativeTolerance' ?
+    bool hasSameMassProperties(const ShapeFingerprint& other, double relativeTolerance) const;
+
+    // Canonical frames of the shape: origin at centroid, axes derived from principal axes or from
+    // vertices when principal moments are equal(eg shapes with rotational symmetry)
+    // At most 'maxCount' candidate frames are returned
+    std::vector<gp_Ax3> canonicalFrames(double tolerance, int maxCount) const;
+
+    // Finds the transformation moving shape 'from' onto shape 'to', vertices and face centroids of
+    // both shapes have to match within 'tolerance'. Returns an empty object if there is no such rigid
+    // transformation
+    static std::optional<gp_Trsf> findTransformation(
+            const ShapeFingerprint& from, const ShapeFingerprint& to, double tolerance
+    );
+};
+
+// Merges identical parts of XCAF assemblies, so they are shared as a single product referenced by
+// many instances
+//
+// This typically applies to "flattened" assemblies where each instance of some part(eg screws)
+// comes as a separate product with geometry already placed in assembly coordinates
+// Fingerprints of the parts are computed in parallel, the parts are then grouped when their
+// geometry is the same, material, color and visual material being equal
+// Components referring to a merged part are redirected in place to the identical part, so their
+// order and attributes(name, colors, layers, visual material, ...) are kept
+class PartDeduplication {
+public:
+    struct Options {
+        // Tolerance relative to the size of the parts, used to compare geometries
+        double relativeTolerance = 1e-6;
+    };
+
+    struct Result {
+        int partCount = 0; // Count of parts analyzed
+        int mergedPartCount = 0; // Count of parts replaced by instances of identical parts and removed
+    };
+
+    // Processes the assemblies located below 'label'
+    static Result run(const TDF_Label& label, const Options& options = {}, TaskProgress* progress = nullptr);
+};
+
+} // namespace Mayo
@@ -32,6 +32,10 @@ PointCloudDataPtr PointCloudData::Set(const TDF_Label& label, const Handle(Graph
 {
     PointCloudDataPtr data = PointCloudData::Set(label);
     data->m_points = points;
+    data->m_octree.reset();
+    if (!points.IsNull() && PointCloudOctree::isWorthBuilding(points->VertexNumber()))
+        data->m_octree = std::make_shared<PointCloudOctree>(points);
+
     return data;
 }
 
@@ -43,8 +47,10 @@ const Standard_GUID& PointCloudData::ID() const
 void PointCloudData::Restore(const Handle(TDF_Attribute)& attribute)
 {
     auto data = PointCloudDataPtr::DownCast(attribute);
-    if (data)
+    if (data) {
         m_points = data->m_points;
+        m_octree = data->m_octree;
+    }
 }
 
 Handle(TDF_Attribute) PointCloudData::NewEmpty() const
@@ -55,8 +61,10 @@ Handle(TDF_Attribute) PointCloudData::NewEmpty() const
 void PointCloudData::Paste(const Handle(TDF_Attribute)& into, const Handle(TDF_RelocationTable)&) const
 {
     auto data = PointCloudDataPtr::DownCast(into);
-    if (data)
+    if (data) {
         data->m_points = m_points;
+        data->m_octree = m_octree;
+    }
 }
 
 Standard_OStream& PointCloudData::Dump(Standard_OStream& ostr) const
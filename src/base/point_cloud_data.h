@@ -6,8 +6,11 @@
 
 #pragma once
 
+#include "point_cloud_octree.h"
+
 #include <Graphic3d_ArrayOfPoints.hxx>
 #include <TDF_Attribute.hxx>
+#include <memory>
 
 namespace Mayo {
 
@@ -21,10 +24,15 @@ class PointCloudData : public TDF_Attribute {
 public:
     static const Standard_GUID& GetID();
     static PointCloudDataPtr Set(const TDF_Label& label);
+    // Spatial octree of the points is also built in case the point cloud is big enough, see
+    // PointCloudOctree::isWorthBuilding()
     static PointCloudDataPtr Set(const TDF_Label& label, const Handle(Graphic3d_ArrayOfPoints)& points);
 
     const Handle(Graphic3d_ArrayOfPoints)& points() const { return m_points; }
 
+    // Might be null, octree is then not available for points()
+    const std::shared_ptr<const PointCloudOctree>& octree() const { return m_octree; }
+
     // -- from TDF_Attribute
     const Standard_GUID& ID() const override;
     void Restore(const Handle(TDF_Attribute)& attribute) override;
@@ -36,6 +44,7 @@ public:
 
 private:
     Handle(Graphic3d_ArrayOfPoints) m_points;
+    std::shared_ptr<const PointCloudOctree> m_octree;
 };
 
 } // namespace Mayo
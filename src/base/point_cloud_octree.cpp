@@ -0,0 +1,104 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "point_cloud_octree.h"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Mayo {
+
+PointCloudOctree::PointCloudOctree(const Handle(Graphic3d_ArrayOfPoints)& points, const Parameters& params)
+    : m_points(points),
+      m_params(params)
+{
+    const int pointCount = !points.IsNull() ? points->VertexNumber() : 0;
+    if (pointCount <= 0)
+        return;
+
+    m_vecPointIndex.resize(pointCount);
+    std::iota(m_vecPointIndex.begin(), m_vecPointIndex.end(), 1);
+
+    Node root;
+    for (int i = 1; i <= pointCount; ++i)
+        root.bndBox.Add(points->Vertice(i));
+
+    m_vecNode.push_back(root);
+    this->buildNode(0, 0, pointCount);
+}
+
+Span<const int> PointCloudOctree::nodePointIndices(const Node& node) const
+{
+    return Span<const int>(m_vecPointIndex).subspan(node.pointFirst, node.pointCount);
+}
+
+bool PointCloudOctree::isWorthBuilding(int pointCount)
+{
+    return pointCount > 1000000;
+}
+
+void PointCloudOctree::buildNode(int nodeIndex, int pointFirst, int pointLast)
+{
+    const int depth = m_vecNode.at(nodeIndex).depth;
+    const int pointCount = pointLast - pointFirst;
+    m_vecNode.at(nodeIndex).children.fill(-1);
+    m_vecNode.at(nodeIndex).pointFirst = pointFirst;
+    if (pointCount <= m_params.maxPointCountPerNode || depth >= m_params.maxDepth) {
+        m_vecNode.at(nodeIndex).pointCount = pointCount;
+        return;
+    }
+
+    // Keep an evenly distributed subsample in this node, moved at the front of the range
+    const int sampleCount = m_params.maxPointCountPerNode;
+    const int stride = pointCount / sampleCount;
+    auto itFirst = m_vecPointIndex.begin() + pointFirst;
+    for (int i = 0; i < sampleCount; ++i)
+        std::swap(*(itFirst + i), *(itFirst + i * stride));
+
+    m_vecNode.at(nodeIndex).pointCount = sampleCount;
+
+    // Distribute remaining points into octants, partitioning successively along X, Y and Z
+    double xMin, yMin, zMin, xMax, yMax, zMax;
+    m_vecNode.at(nodeIndex).bndBox.Get(xMin, yMin, zMin, xMax, yMax, zMax);
+    const double center[] = { (xMin + xMax) / 2., (yMin + yMax) / 2., (zMin + zMax) / 2. };
+    auto fnPartition = [&](auto itBegin, auto itEnd, int axis) {
+        return std::partition(itBegin, itEnd, [&](int index) {
+            return m_points->Vertice(index).Coord(axis + 1) < center[axis];
+        });
+    };
+
+    std::array<decltype(itFirst), 9> itBounds;
+    itBounds[0] = itFirst + sampleCount;
+    itBounds[8] = m_vecPointIndex.begin() + pointLast;
+    itBounds[4] = fnPartition(itBounds[0], itBounds[8], 0);
+    itBounds[2] = fnPartition(itBounds[0], itBounds[4], 1);
+    itBounds[6] = fnPartition(itBounds[4], itBounds[8], 1);
+    for (int i = 0; i < 8; i += 2)
+        itBounds[i + 1] = fnPartition(itBounds[i], itBounds[i + 2], 2);
+
+    // Octant 'i' is on the upper side of X if bit 2 is set, Y for bit 1 and Z for bit 0
+    for (int i = 0; i < 8; ++i) {
+        if (itBounds[i] == itBounds[i + 1])
+            continue;
+
+        Node child;
+        child.depth = depth + 1;
+        child.bndBox.Update(
+                    (i & 4) ? center[0] : xMin, (i & 2) ? center[1] : yMin, (i & 1) ? center[2] : zMin,
+                    (i & 4) ? xMax : center[0], (i & 2) ? yMax : center[1], (i & 1) ? zMax : center[2]
+        );
+        const int childIndex = int(m_vecNode.size());
+        m_vecNode.push_back(child);
+        m_vecNode.at(nodeIndex).children.at(i) = childIndex;
+        this->buildNode(
+                    childIndex,
+                    int(itBounds[i] - m_vecPointIndex.begin()),
+                    int(itBounds[i + 1] - m_vecPointIndex.begin())
+        );
+    }
+}
+
+} // namespace Mayo
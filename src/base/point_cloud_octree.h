@@ -0,0 +1,60 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "span.h"
+
+#include <Bnd_Box.hxx>
+#include <Graphic3d_ArrayOfPoints.hxx>
+#include <array>
+#include <vector>
+
+namespace Mayo {
+
+// Spatial octree over the points of a point cloud
+//
+// Each node stores an evenly subsampled set of the points located in its cell, the remaining points
+// being distributed to the children nodes. So each point belongs to exactly one node and displaying
+// the nodes from the root down to some depth gives a progressively refined point cloud
+class PointCloudOctree {
+public:
+    struct Node {
+        Bnd_Box bndBox;
+        int depth = 0;
+        std::array<int, 8> children; // Indexes of the child nodes, -1 if no child
+        int pointFirst = 0; // Position in the internal array of point indexes
+        int pointCount = 0;
+    };
+
+    struct Parameters {
+        int maxPointCountPerNode = 16384;
+        int maxDepth = 12;
+    };
+
+    PointCloudOctree(const Handle(Graphic3d_ArrayOfPoints)& points, const Parameters& params = {});
+
+    const Handle(Graphic3d_ArrayOfPoints)& points() const { return m_points; }
+
+    // Nodes of the octree, root node is at index 0
+    Span<const Node> nodes() const { return m_vecNode; }
+
+    // Indexes(starting at 1) of the points in points() owned by 'node'
+    Span<const int> nodePointIndices(const Node& node) const;
+
+    // Whether a point cloud of 'pointCount' points is big enough to be worth an octree
+    static bool isWorthBuilding(int pointCount);
+
+private:
+    void buildNode(int nodeIndex, int pointFirst, int pointLast);
+
+    Handle(Graphic3d_ArrayOfPoints) m_points;
+    Parameters m_params;
+    std::vector<Node> m_vecNode;
+    std::vector<int> m_vecPointIndex;
+};
+
+} // namespace Mayo
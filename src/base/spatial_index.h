@@ -0,0 +1,265 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "bnd_utils.h"
+#include "box_bvh.h"
+#include "span.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+// Maintains a BoxBvh over a dynamic set of boxes identified by keys of type 'Key'
+//
+// Changes are applied incrementally: box of an indexed item is updated in place and the hierarchy
+// is refitted, removed items are kept as void boxes and new items are first stored in a pending
+// list tested linearly(with the same box tests as BoxBvh). The BoxBvh is rebuilt(lazily, on next
+// query) when the pending items exceed a small fixed count, or when the pending and removed items
+// become too many compared to the indexed ones
+// Queries aren't thread-safe as they might update the internal BoxBvh
+template<typename Key, typename Hash = std::hash<Key>>
+class SpatialIndex {
+public:
+    int itemCount() const { return int(m_mapKeySlot.size()); }
+    bool contains(const Key& key) const { return m_mapKeySlot.find(key) != m_mapKeySlot.cend(); }
+
+    // Adds item 'key', or updates its box if already there
+    void setItem(const Key& key, const Bnd_Box& box);
+    void removeItem(const Key& key);
+    void clear();
+
+    // Box of item 'key', void if not found
+    Bnd_Box itemBox(const Key& key) const;
+
+    // Box enclosing all the items
+    Bnd_Box boundingBox() const;
+
+    // Spatial queries, see BoxBvh for details
+    void visitIntersecting(const Bnd_Box& box, const std::function<void(const Key&)>& fn) const;
+    void visitIntersecting(const gp_Pln& plane, const std::function<void(const Key&)>& fn) const;
+    void visitInside(Span<const gp_Pln> spanPlane, const std::function<void(const Key&)>& fn) const;
+    std::optional<Key> findNearest(
+            const gp_Lin& ray, const std::function<double(const Key&)>& fnItemDistance = nullptr
+    ) const;
+
+private:
+    static constexpr int MaxPendingCount = 32;
+
+    struct Slot {
+        Key key;
+        Bnd_Box box;
+        bool isRemoved = false;
+    };
+
+    void update() const;
+    void visitPendingItems(
+            const std::function<bool(const Bnd_Box&)>& fnBoxTest, const std::function<void(const Key&)>& fn
+    ) const;
+
+    // Slots [0, m_bvhSlotCount) are indexed by m_bvh, the others are pending
+    mutable std::vector<Slot> m_vecSlot;
+    mutable std::unordered_map<Key, int, Hash> m_mapKeySlot;
+    mutable BoxBvh m_bvh;
+    mutable int m_bvhSlotCount = 0;
+    mutable int m_removedSlotCount = 0;
+    mutable bool m_isRefitNeeded = false;
+};
+
+
+
+// --
+// -- Implementation
+// --
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::setItem(const Key& key, const Bnd_Box& box)
+{
+    auto [it, isNewItem] = m_mapKeySlot.insert({ key, int(m_vecSlot.size()) });
+    if (isNewItem) {
+        m_vecSlot.push_back({ key, box });
+        return;
+    }
+
+    m_vecSlot.at(it->second).box = box;
+    if (it->second < m_bvhSlotCount) {
+        m_bvh.setItemBox(it->second, box);
+        m_isRefitNeeded = true;
+    }
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::removeItem(const Key& key)
+{
+    auto itFound = m_mapKeySlot.find(key);
+    if (itFound == m_mapKeySlot.end())
+        return;
+
+    const int slotIndex = itFound->second;
+    m_mapKeySlot.erase(itFound);
+    if (slotIndex < m_bvhSlotCount) {
+        Slot& slot = m_vecSlot.at(slotIndex);
+        slot.box.SetVoid();
+        slot.isRemoved = true;
+        m_bvh.setItemBox(slotIndex, slot.box);
+        m_isRefitNeeded = true;
+        ++m_removedSlotCount;
+    }
+    else {
+        // Pending slot: move the last slot in place of the removed one
+        if (slotIndex != int(m_vecSlot.size()) - 1) {
+            m_vecSlot.at(slotIndex) = std::move(m_vecSlot.back());
+            m_mapKeySlot.at(m_vecSlot.at(slotIndex).key) = slotIndex;
+        }
+
+        m_vecSlot.pop_back();
+    }
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::clear()
+{
+    m_vecSlot.clear();
+    m_mapKeySlot.clear();
+    m_bvh = {};
+    m_bvhSlotCount = 0;
+    m_removedSlotCount = 0;
+    m_isRefitNeeded = false;
+}
+
+template<typename Key, typename Hash>
+Bnd_Box SpatialIndex<Key, Hash>::itemBox(const Key& key) const
+{
+    auto itFound = m_mapKeySlot.find(key);
+    return itFound != m_mapKeySlot.cend() ? m_vecSlot.at(itFound->second).box : Bnd_Box{};
+}
+
+template<typename Key, typename Hash>
+Bnd_Box SpatialIndex<Key, Hash>::boundingBox() const
+{
+    this->update();
+    Bnd_Box box = m_bvh.boundingBox();
+    for (int i = m_bvhSlotCount; i < int(m_vecSlot.size()); ++i)
+        BndUtils::add(&box, m_vecSlot.at(i).box);
+
+    return box;
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::visitIntersecting(
+        const Bnd_Box& box, const std::function<void(const Key&)>& fn
+    ) const
+{
+    this->update();
+    m_bvh.visitIntersecting(box, [&](int i) { fn(m_vecSlot.at(i).key); });
+    this->visitPendingItems([&](const Bnd_Box& itemBox) { return BoxBvh::isIntersecting(itemBox, box); }, fn);
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::visitIntersecting(
+        const gp_Pln& plane, const std::function<void(const Key&)>& fn
+    ) const
+{
+    this->update();
+    m_bvh.visitIntersecting(plane, [&](int i) { fn(m_vecSlot.at(i).key); });
+    this->visitPendingItems([&](const Bnd_Box& itemBox) { return BoxBvh::isIntersecting(itemBox, plane); }, fn);
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::visitInside(
+        Span<const gp_Pln> spanPlane, const std::function<void(const Key&)>& fn
+    ) const
+{
+    this->update();
+    m_bvh.visitInside(spanPlane, [&](int i) { fn(m_vecSlot.at(i).key); });
+    this->visitPendingItems([&](const Bnd_Box& itemBox) { return BoxBvh::isInside(itemBox, spanPlane); }, fn);
+}
+
+template<typename Key, typename Hash>
+std::optional<Key> SpatialIndex<Key, Hash>::findNearest(
+        const gp_Lin& ray, const std::function<double(const Key&)>& fnItemDistance
+    ) const
+{
+    this->update();
+    std::function<double(int)> fnSlotDistance;
+    if (fnItemDistance)
+        fnSlotDistance = [&](int i) { return fnItemDistance(m_vecSlot.at(i).key); };
+
+    double nearestDistance = std::numeric_limits<double>::max();
+    int slotNearest = m_bvh.findNearest(ray, fnSlotDistance, &nearestDistance);
+    // Pending items are tested like the items of a BoxBvh leaf
+    for (int i = m_bvhSlotCount; i < int(m_vecSlot.size()); ++i) {
+        const double boxDistance = BoxBvh::rayEntryDistance(ray, m_vecSlot.at(i).box);
+        if (boxDistance < 0 || boxDistance >= nearestDistance)
+            continue;
+
+        const double distance = fnSlotDistance ? fnSlotDistance(i) : boxDistance;
+        if (distance >= 0 && distance < nearestDistance) {
+            slotNearest = i;
+            nearestDistance = distance;
+        }
+    }
+
+    if (slotNearest < 0)
+        return {};
+
+    return m_vecSlot.at(slotNearest).key;
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::update() const
+{
+    // Pending items are tested one by one on each query, so their count is kept small whatever the
+    // count of indexed items
+    const int pendingCount = int(m_vecSlot.size()) - m_bvhSlotCount;
+    const int maxChangeCount = std::max(MaxPendingCount, m_bvhSlotCount / 4);
+    if (pendingCount > MaxPendingCount || pendingCount + m_removedSlotCount > maxChangeCount) {
+        // Rebuild with the live items only
+        std::vector<Slot> vecSlot;
+        vecSlot.reserve(m_mapKeySlot.size());
+        for (Slot& slot : m_vecSlot) {
+            if (!slot.isRemoved) {
+                m_mapKeySlot.at(slot.key) = int(vecSlot.size());
+                vecSlot.push_back(std::move(slot));
+            }
+        }
+
+        std::vector<Bnd_Box> vecBox;
+        vecBox.reserve(vecSlot.size());
+        for (const Slot& slot : vecSlot)
+            vecBox.push_back(slot.box);
+
+        m_vecSlot = std::move(vecSlot);
+        m_bvh = BoxBvh(std::move(vecBox));
+        m_bvhSlotCount = int(m_vecSlot.size());
+        m_removedSlotCount = 0;
+        m_isRefitNeeded = false;
+    }
+    else if (m_isRefitNeeded) {
+        m_bvh.refit();
+        m_isRefitNeeded = false;
+    }
+}
+
+template<typename Key, typename Hash>
+void SpatialIndex<Key, Hash>::visitPendingItems(
+        const std::function<bool(const Bnd_Box&)>& fnBoxTest, const std::function<void(const Key&)>& fn
+    ) const
+{
+    for (int i = m_bvhSlotCount; i < int(m_vecSlot.size()); ++i) {
+        const Slot& slot = m_vecSlot.at(i);
+        if (!slot.box.IsVoid() && fnBoxTest(slot.box))
+            fn(slot.key);
+    }
+}
+
+} // namespace Mayo
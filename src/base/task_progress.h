@@ -39,7 +39,8 @@ public:
     const TaskProgress* parent() const { return m_parent; }
     TaskProgress* parent() { return m_parent; }
 
-    bool isAbortRequested() const { return m_isAbortRequested; }
+    // Abort requested on this progress or on one of its parents
+    bool isAbortRequested() const;
     static bool isAbortRequested(const TaskProgress* progress);
 
     // Disable copy
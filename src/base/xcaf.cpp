@@ -6,6 +6,7 @@
 
 #include "xcaf.h"
 #include "caf_utils.h"
+#include "global.h"
 #include "math_utils.h"
 
 #include <TDataStd_TreeNode.hxx>
@@ -15,6 +16,9 @@
 #include <XCAFDoc_Area.hxx>
 #include <XCAFDoc_Centroid.hxx>
 #include <XCAFDoc_DocumentTool.hxx>
+#if OCC_VERSION_HEX >= 0x070600
+#  include <XCAFDoc_Editor.hxx>
+#endif
 #include <XCAFDoc_Volume.hxx>
 #include <set>
 
@@ -337,6 +341,35 @@ TDF_LabelSequence XCaf::diffTopLevelFreeShapes(const TDF_LabelSequence& seqOther
     return seqDiff;
 }
 
+TDF_LabelSequence XCaf::copyShapes(const TDF_LabelSequence& seqLabelSrc)
+{
+    TDF_LabelSequence seqLabelCopy;
+#if OCC_VERSION_HEX >= 0x070600
+    Handle_XCAFDoc_ShapeTool dstShapeTool = this->shapeTool();
+    NCollection_DataMap<Handle_XCAFDoc_VisMaterial, Handle_XCAFDoc_VisMaterial> mapVisMaterial;
+    for (const TDF_Label& labelSrc : seqLabelSrc) {
+        // Mapping filled with all the labels cloned(including components and sub-shapes)
+        TDF_LabelDataMap mapLabel;
+        const TDF_Label labelCopy = XCAFDoc_Editor::CloneShapeLabel(
+                    labelSrc, XCAFDoc_DocumentTool::ShapeTool(labelSrc), dstShapeTool, mapLabel
+        );
+        if (labelCopy.IsNull())
+            continue;
+
+        mapLabel.Bind(labelSrc, labelCopy);
+        for (TDF_LabelDataMap::Iterator it(mapLabel); it.More(); it.Next())
+            XCAFDoc_Editor::CloneMetaData(it.Key(), it.Value(), &mapVisMaterial);
+
+        seqLabelCopy.Append(labelCopy);
+    }
+
+    dstShapeTool->UpdateAssemblies();
+#else
+    MAYO_UNUSED(seqLabelSrc);
+#endif
+    return seqLabelCopy;
+}
+
 TreeNodeId XCaf::deepBuildAssemblyTree(TreeNodeId parentNode, const TDF_Label& label)
 {
     Expects(m_modelTree != nullptr);
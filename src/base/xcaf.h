@@ -90,6 +90,12 @@ public:
     // Returns labels of the top-level free shapes that were not found in 'seqOther'
     TDF_LabelSequence diffTopLevelFreeShapes(const TDF_LabelSequence& seqOther) const;
 
+    // Copies shapes 'seqLabelSrc' owned by another XCAF document as new top-level free shapes
+    // Assembly structure, names, colors, layers and materials are copied as well
+    // Returns labels of the new top-level free shapes
+    // Requires OpenCascade >= v7.6.0, returns an empty sequence otherwise
+    TDF_LabelSequence copyShapes(const TDF_LabelSequence& seqLabelSrc);
+
     // --
     // -- XCAFDoc_ColorTool helpers
     // --
@@ -0,0 +1,108 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "ais_hlr_lines.h"
+
+#include "../base/task_progress.h"
+
+#include <HLRAlgo_EdgeIterator.hxx>
+#include <HLRAlgo_Projector.hxx>
+#include <HLRBRep_PolyAlgo.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <gp_Ax2.hxx>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+Handle_Graphic3d_ArrayOfSegments createSegments(const std::vector<gp_Pnt>& vecPoint)
+{
+    if (vecPoint.empty())
+        return {};
+
+    Handle_Graphic3d_ArrayOfSegments segments = new Graphic3d_ArrayOfSegments(int(vecPoint.size()));
+    for (const gp_Pnt& pnt : vecPoint)
+        segments->AddVertex(pnt);
+
+    return segments;
+}
+
+} // namespace
+
+AIS_HlrLines::Lines AIS_HlrLines::computeLines(
+        const TopoDS_Shape& shape, const gp_Dir& viewDirection, TaskProgress* progress)
+{
+    // Main direction of the projector points towards the eye
+    Handle(HLRBRep_PolyAlgo) hider = new HLRBRep_PolyAlgo(shape);
+    hider->Projector(HLRAlgo_Projector(gp_Ax2(gp::Origin(), viewDirection.Reversed())));
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    hider->Update(); // Can't be interrupted
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    std::vector<gp_Pnt> vecVisiblePnt;
+    std::vector<gp_Pnt> vecHiddenPnt;
+    HLRAlgo_EdgeStatus status;
+    TopoDS_Shape edge;
+    Standard_Boolean isReg1, isRegN, isOutLine, isIntLine;
+    int edgeCount = 0;
+    for (hider->InitHide(); hider->MoreHide(); hider->NextHide()) {
+        if (++edgeCount % 1000 == 0 && TaskProgress::isAbortRequested(progress))
+            return {};
+
+        // Pnt1/Pnt2 are the ends of the edge segment in the space of the shape(not projected)
+        const HLRAlgo_BiPoint::PointsT& points = hider->Hide(status, edge, isReg1, isRegN, isOutLine, isIntLine);
+        if (isRegN && !isOutLine)
+            continue; // Smooth edge between faces, drawn only as part of the silhouette
+
+        const gp_XYZ vecSegment = points.Pnt2 - points.Pnt1;
+        double paramStart, paramEnd;
+        Standard_ShortReal tolStart, tolEnd;
+        HLRAlgo_EdgeIterator it;
+        for (it.InitVisible(status); it.MoreVisible(); it.NextVisible()) {
+            it.Visible(paramStart, tolStart, paramEnd, tolEnd);
+            vecVisiblePnt.emplace_back(points.Pnt1 + vecSegment * paramStart);
+            vecVisiblePnt.emplace_back(points.Pnt1 + vecSegment * paramEnd);
+        }
+
+        for (it.InitHidden(status); it.MoreHidden(); it.NextHidden()) {
+            it.Hidden(paramStart, tolStart, paramEnd, tolEnd);
+            vecHiddenPnt.emplace_back(points.Pnt1 + vecSegment * paramStart);
+            vecHiddenPnt.emplace_back(points.Pnt1 + vecSegment * paramEnd);
+        }
+    }
+
+    Lines lines;
+    lines.visible = createSegments(vecVisiblePnt);
+    lines.hidden = createSegments(vecHiddenPnt);
+    return lines;
+}
+
+void AIS_HlrLines::Compute(
+        const Handle(PrsMgr_PresentationManager)&,
+        const Handle(Prs3d_Presentation)& prs,
+        const int mode)
+{
+    if (mode != 0)
+        return;
+
+    auto fnAddGroup = [&](const Handle_Graphic3d_ArrayOfSegments& segments, const Handle_Prs3d_LineAspect& aspect) {
+        if (segments.IsNull())
+            return;
+
+        Handle_Graphic3d_Group group = prs->NewGroup();
+        group->SetPrimitivesAspect(aspect->Aspect());
+        group->AddPrimitiveArray(segments);
+    };
+    fnAddGroup(m_lines.visible, myDrawer->SeenLineAspect());
+    if (myDrawer->DrawHiddenLine())
+        fnAddGroup(m_lines.hidden, myDrawer->HiddenLineAspect());
+}
+
+} // namespace Mayo
@@ -0,0 +1,72 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/tkernel_utils.h"
+
+#include <AIS_InteractiveObject.hxx>
+#include <Graphic3d_ArrayOfSegments.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_PresentationManager.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <TopoDS_Shape.hxx>
+#include <gp_Dir.hxx>
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+#  include <Prs3d_Projector.hxx>
+#endif
+
+namespace Mayo {
+
+// Pre-declarations
+class TaskProgress;
+class AIS_HlrLines;
+DEFINE_STANDARD_HANDLE(AIS_HlrLines, AIS_InteractiveObject)
+
+// Graphics object displaying the lines of a shape resulting from hidden line removal
+//
+// Visible lines are drawn with the "seen line" aspect of the drawer, hidden lines with the "hidden
+// line" aspect if drawing of hidden lines is enabled. The object doesn't provide any selection
+class AIS_HlrLines : public AIS_InteractiveObject {
+public:
+    struct Lines {
+        Handle_Graphic3d_ArrayOfSegments visible;
+        Handle_Graphic3d_ArrayOfSegments hidden;
+    };
+
+    // Computes the visible and hidden lines of 'shape' viewed along 'viewDirection'(parallel
+    // projection). Shape is expected to be meshed, lines are expressed in the space of the shape
+    // Can be safely called from any thread
+    // Abort requests of 'progress' are checked between the stages of the computation, empty lines
+    // are then returned
+    static Lines computeLines(
+            const TopoDS_Shape& shape, const gp_Dir& viewDirection, TaskProgress* progress = nullptr
+    );
+
+    const Lines& lines() const { return m_lines; }
+    void setLines(const Lines& lines) { m_lines = lines; } // Presentation has then to be recomputed
+
+    bool AcceptDisplayMode(const int mode) const override { return mode == 0; }
+    void ComputeSelection(const Handle(SelectMgr_Selection)&, const int) override {}
+
+    DEFINE_STANDARD_RTTI_INLINE(AIS_HlrLines, AIS_InteractiveObject)
+
+protected:
+    void Compute(
+            const Handle(PrsMgr_PresentationManager)& pm,
+            const Handle(Prs3d_Presentation)& prs,
+            const int mode) override;
+
+#if OCC_VERSION_HEX < OCC_VERSION_CHECK(7, 5, 0)
+    void Compute(const Handle(Prs3d_Projector)&, const Handle(Prs3d_Presentation)&) override {}
+#endif
+
+private:
+    Lines m_lines;
+};
+
+} // namespace Mayo
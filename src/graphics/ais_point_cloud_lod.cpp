@@ -0,0 +1,106 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "ais_point_cloud_lod.h"
+
+#include "graphics_utils.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace Mayo {
+
+namespace {
+
+Handle_Graphic3d_ArrayOfPoints createNodesPoints(const PointCloudOctree& octree, Span<const int> spanNodeIndex)
+{
+    const Handle_Graphic3d_ArrayOfPoints& srcPoints = octree.points();
+    int pointCount = 0;
+    for (int nodeIndex : spanNodeIndex)
+        pointCount += octree.nodes()[nodeIndex].pointCount;
+
+    const bool hasColors = srcPoints->HasVertexColors();
+    const bool hasNormals = srcPoints->HasVertexNormals();
+    Handle_Graphic3d_ArrayOfPoints points = new Graphic3d_ArrayOfPoints(pointCount, hasColors, hasNormals);
+    for (int nodeIndex : spanNodeIndex) {
+        for (int srcIndex : octree.nodePointIndices(octree.nodes()[nodeIndex])) {
+            const int index = points->AddVertex(srcPoints->Vertice(srcIndex));
+            if (hasColors)
+                points->SetVertexColor(index, srcPoints->VertexColor(srcIndex));
+
+            if (hasNormals)
+                points->SetVertexNormal(index, srcPoints->VertexNormal(srcIndex));
+        }
+    }
+
+    return points;
+}
+
+} // namespace
+
+AIS_PointCloudLod::AIS_PointCloudLod(const std::shared_ptr<const PointCloudOctree>& octree)
+    : m_octree(octree)
+{
+    // Coarsest level until nodes are selected for some view
+    if (!m_octree->nodes().empty()) {
+        m_vecNodeIndex.push_back(0);
+        m_displayedPointCount = m_octree->nodes()[0].pointCount;
+        this->SetPoints(createNodesPoints(*m_octree, m_vecNodeIndex));
+    }
+}
+
+bool AIS_PointCloudLod::updateNodes(const Handle_V3d_View& view, int pointBudget)
+{
+    const Span<const PointCloudOctree::Node> spanNode = m_octree->nodes();
+    if (spanNode.empty())
+        return false;
+
+    auto fnProjectedSize = [&](int nodeIndex) {
+        Bnd_Box bndBox = spanNode[nodeIndex].bndBox;
+        if (this->HasTransformation())
+            bndBox = bndBox.Transformed(this->Transformation());
+
+        return GraphicsUtils::V3dView_projectedSize(view, bndBox);
+    };
+
+    // Visit nodes by decreasing size on screen, root node is always displayed
+    using SizedNode = std::pair<double, int>;
+    std::priority_queue<SizedNode> queueNode;
+    queueNode.push({ fnProjectedSize(0), 0 });
+    std::vector<int> vecNodeIndex;
+    int pointCount = 0;
+    while (!queueNode.empty()) {
+        const SizedNode sizedNode = queueNode.top();
+        queueNode.pop();
+        const PointCloudOctree::Node& node = spanNode[sizedNode.second];
+        if (!vecNodeIndex.empty() && pointCount + node.pointCount > pointBudget)
+            continue;
+
+        vecNodeIndex.push_back(sizedNode.second);
+        pointCount += node.pointCount;
+        if (node.pointCount >= sizedNode.first * sizedNode.first)
+            continue; // Already more points than pixels covered, no need to refine
+
+        for (int childIndex : node.children) {
+            if (childIndex >= 0) {
+                const double childSize = fnProjectedSize(childIndex);
+                if (childSize > 0.)
+                    queueNode.push({ childSize, childIndex });
+            }
+        }
+    }
+
+    std::sort(vecNodeIndex.begin(), vecNodeIndex.end());
+    if (vecNodeIndex == m_vecNodeIndex)
+        return false;
+
+    m_vecNodeIndex = std::move(vecNodeIndex);
+    m_displayedPointCount = pointCount;
+    this->SetPoints(createNodesPoints(*m_octree, m_vecNodeIndex));
+    return true;
+}
+
+} // namespace Mayo
@@ -0,0 +1,49 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/point_cloud_octree.h"
+
+#include <AIS_PointCloud.hxx>
+#include <V3d_View.hxx>
+#include <memory>
+#include <vector>
+
+namespace Mayo {
+
+// Pre-declarations
+class AIS_PointCloudLod;
+DEFINE_STANDARD_HANDLE(AIS_PointCloudLod, AIS_PointCloud)
+
+// Point cloud object displaying only a subset of the nodes of an octree
+//
+// Nodes are selected with updateNodes() by decreasing size on screen, until the count of points
+// reaches some budget. Nodes out of the view are skipped, so are the children of nodes already
+// having more points than pixels covered on screen
+class AIS_PointCloudLod : public AIS_PointCloud {
+public:
+    AIS_PointCloudLod(const std::shared_ptr<const PointCloudOctree>& octree);
+
+    const std::shared_ptr<const PointCloudOctree>& octree() const { return m_octree; }
+
+    // Count of points currently displayed
+    int displayedPointCount() const { return m_displayedPointCount; }
+
+    // Selects the nodes for the camera of 'view' and within 'pointBudget', then updates the points
+    // of the object accordingly
+    // Returns true if the points have changed, presentation has then to be recomputed
+    bool updateNodes(const Handle_V3d_View& view, int pointBudget);
+
+    DEFINE_STANDARD_RTTI_INLINE(AIS_PointCloudLod, AIS_PointCloud)
+
+private:
+    std::shared_ptr<const PointCloudOctree> m_octree;
+    std::vector<int> m_vecNodeIndex; // Displayed nodes, sorted
+    int m_displayedPointCount = 0;
+};
+
+} // namespace Mayo
@@ -31,6 +31,9 @@ public:
     const TColStd_PackedMapOfInteger& GetAllElements() const override { return m_elements; }
     bool GetNormal(const int Id, const int Max, double& nx, double& ny, double& nz) const override;
 
+    // Source mesh, node and element(triangle) identifiers are the indices in that triangulation
+    const Handle_Poly_Triangulation& triangulation() const { return m_mesh; }
+
 private:
   Handle_Poly_Triangulation m_mesh;
   TColStd_PackedMapOfInteger m_nodes;
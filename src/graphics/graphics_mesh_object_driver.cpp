@@ -10,6 +10,10 @@
 #include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
 #include "../base/label_data.h"
+#include "../base/math_utils.h"
+#include "../base/mesh_decimation.h"
+#include "../base/mesh_utils.h"
+#include "../base/task_progress.h"
 #include "../base/triangulation_annex_data.h"
 #include "../base/property_builtins.h"
 #include "../base/xcaf.h"
@@ -17,17 +21,211 @@
 #include "graphics_utils.h"
 
 #include <BRep_TFace.hxx>
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_Group.hxx>
 #include <MeshVS_DisplayModeFlags.hxx>
 #include <MeshVS_DrawerAttribute.hxx>
 #include <MeshVS_Drawer.hxx>
 #include <MeshVS_Mesh.hxx>
 #include <MeshVS_MeshPrsBuilder.hxx>
 #include <MeshVS_NodalColorPrsBuilder.hxx>
+#include <MeshVS_Tool.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <algorithm>
 
 namespace Mayo {
 
 namespace {
 struct GraphicsMeshObjectDriverI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::GraphicsMeshObjectDriver) };
+
+// Data source of a mesh preview, keeps what's needed to build the full resolution data afterwards
+class GraphicsMeshPreviewDataSource : public GraphicsMeshDataSource {
+public:
+    GraphicsMeshPreviewDataSource(
+            const Handle_Poly_Triangulation& previewMesh,
+            const Handle_Poly_Triangulation& fullMesh,
+            const TriangulationAnnexDataPtr& fullMeshData
+        )
+        : GraphicsMeshDataSource(previewMesh),
+          m_fullMesh(fullMesh),
+          m_fullMeshData(fullMeshData)
+    {
+    }
+
+    const Handle_Poly_Triangulation& fullMesh() const { return m_fullMesh; }
+
+    Span<const Quantity_Color> fullMeshNodeColors() const {
+        return m_fullMeshData ? m_fullMeshData->nodeColors() : Span<const Quantity_Color>{};
+    }
+
+private:
+    Handle_Poly_Triangulation m_fullMesh;
+    TriangulationAnnexDataPtr m_fullMeshData; // Might be null
+};
+
+const GraphicsMeshPreviewDataSource* findPreviewDataSource(const GraphicsObjectPtr& object)
+{
+    auto meshObject = Handle_MeshVS_Mesh::DownCast(object);
+    if (!meshObject)
+        return nullptr;
+
+    return dynamic_cast<const GraphicsMeshPreviewDataSource*>(meshObject->GetDataSource().get());
+}
+
+// Triangle count above which meshes are first displayed with a preview. Decimation of meshes
+// bigger than DefaultValues::maxTriangleCount is a long operation as well, so it's also done when
+// building full resolution data and the preview is enabled whenever decimation is
+int previewTriangleCountThreshold()
+{
+    const GraphicsMeshObjectDriver::DefaultValues& values = GraphicsMeshObjectDriver::defaultValues();
+    if (values.previewTriangleCount > 0 && values.maxTriangleCount > 0)
+        return std::min(values.previewTriangleCount, values.maxTriangleCount);
+
+    return std::max(values.previewTriangleCount, values.maxTriangleCount);
+}
+
+// Mesh actually displayed for 'mesh', ie decimated if bigger than DefaultValues::maxTriangleCount
+// In case of decimation, node colors are remapped into 'ptrVecNodeColor' and 'ptrSpanNodeColor'
+// is updated accordingly
+Handle_Poly_Triangulation displayedMesh(
+        const Handle_Poly_Triangulation& mesh,
+        Span<const Quantity_Color>* ptrSpanNodeColor,
+        std::vector<Quantity_Color>* ptrVecNodeColor,
+        TaskProgress* progress = nullptr
+    )
+{
+    // Lightweight display of huge meshes(eg scans)
+    const int maxTriangleCount = GraphicsMeshObjectDriver::defaultValues().maxTriangleCount;
+    if (maxTriangleCount <= 0 || mesh->NbTriangles() <= maxTriangleCount)
+        return mesh;
+
+    const Span<const Quantity_Color> spanNodeColor = *ptrSpanNodeColor;
+    MeshDecimation::Options options;
+    options.targetRatio = maxTriangleCount / double(mesh->NbTriangles());
+    auto fnNodeColor = [=](int i) -> std::optional<Quantity_Color> {
+        if (!spanNodeColor.empty())
+            return spanNodeColor[i];
+
+        return {};
+    };
+    const MeshDecimation::Result result = MeshDecimation::run(mesh, options, fnNodeColor, progress);
+    if (!result.mesh)
+        return mesh;
+
+    if (!spanNodeColor.empty()) {
+        for (int sourceNode : result.sourceNodes)
+            ptrVecNodeColor->push_back(spanNodeColor[sourceNode]);
+
+        *ptrSpanNodeColor = *ptrVecNodeColor;
+    }
+
+    return result.mesh;
+}
+
+// Presentation builder of mesh 'object', showing node colors if any
+Handle(MeshVS_PrsBuilder) createPrsBuilder(
+        const Handle_MeshVS_Mesh& object, Span<const Quantity_Color> spanNodeColor
+    )
+{
+    if (spanNodeColor.empty())
+        return new MeshVS_MeshPrsBuilder(object);
+
+    auto prsBuilder = new MeshVS_NodalColorPrsBuilder(object, MeshVS_DMF_NodalColorDataPrs | MeshVS_DMF_OCCMask);
+    for (int i = 0; CppUtils::cmpLess(i, spanNodeColor.size()); ++i)
+        prsBuilder->SetColor(i + 1, spanNodeColor[i]);
+
+    return prsBuilder;
+}
+
+// Triangles of 'mesh' ready to be added to a shaded presentation(flat normals, node colors if any)
+// This doesn't depend on any graphics object, so it can be computed in a worker thread
+Handle_Graphic3d_ArrayOfTriangles createShadedTriangles(
+        const Handle_Poly_Triangulation& mesh,
+        Span<const Quantity_Color> spanNodeColor,
+        TaskProgress* progress = nullptr
+    )
+{
+    const int triangleCount = mesh->NbTriangles();
+    const bool hasNodeColors = !spanNodeColor.empty();
+    Handle_Graphic3d_ArrayOfTriangles triangles = new Graphic3d_ArrayOfTriangles(
+                3 * triangleCount, 0, true/*hasNormals*/, hasNodeColors
+    );
+    const Poly_Array1OfTriangle& meshTriangles = MeshUtils::triangles(mesh);
+    for (int i = 1; i <= triangleCount; ++i) {
+        int nodes[3];
+        meshTriangles(i).Get(nodes[0], nodes[1], nodes[2]);
+        const gp_Pnt pnts[3] = { mesh->Node(nodes[0]), mesh->Node(nodes[1]), mesh->Node(nodes[2]) };
+        const gp_Vec vecNormal = gp_Vec(pnts[0], pnts[1]).Crossed(gp_Vec(pnts[0], pnts[2]));
+        const gp_Dir normal = vecNormal.SquareMagnitude() > gp::Resolution() ? gp_Dir(vecNormal) : gp::DZ();
+        for (int j = 0; j < 3; ++j) {
+            const int iVertex = triangles->AddVertex(pnts[j], normal);
+            if (hasNodeColors)
+                triangles->SetVertexColor(iVertex, spanNodeColor[nodes[j] - 1]);
+        }
+
+        if (progress && (i % 65536) == 0) {
+            if (progress->isAbortRequested())
+                return {};
+
+            progress->setValue(MathUtils::toPercent(i, 0, triangleCount));
+        }
+    }
+
+    return triangles;
+}
+
+// Presentation builder adding precomputed shaded triangles(see createShadedTriangles())
+// Computing the presentation is then cheap whatever the size of the mesh. Other display modes and
+// display of nodes are left to other builders
+class GraphicsMeshShadedPrsBuilder : public MeshVS_PrsBuilder {
+public:
+    GraphicsMeshShadedPrsBuilder(
+            const Handle_MeshVS_Mesh& object, const Handle_Graphic3d_ArrayOfTriangles& triangles
+        )
+        : MeshVS_PrsBuilder(object, MeshVS_DMF_Shading, nullptr, -1, MeshVS_BP_User),
+          m_triangles(triangles)
+    {
+    }
+
+    void Build(
+            const Handle(Prs3d_Presentation)& prs,
+            const TColStd_PackedMapOfInteger& ids,
+            TColStd_PackedMapOfInteger& idsToExclude,
+            const bool isElement,
+            const int displayMode
+        ) const override
+    {
+        if (!isElement || !(displayMode & MeshVS_DMF_Shading) || !m_triangles)
+            return;
+
+        const Handle(MeshVS_Drawer) drawer = this->GetDrawer();
+        Handle_Graphic3d_AspectFillArea3d aspect = MeshVS_Tool::CreateAspectFillArea3d(drawer);
+        bool showEdges = false;
+        drawer->GetBoolean(MeshVS_DA_ShowEdges, showEdges);
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
+        aspect->SetDrawEdges(showEdges);
+#else
+        if (showEdges)
+            aspect->SetEdgeOn();
+        else
+            aspect->SetEdgeOff();
+#endif
+        Quantity_Color edgeColor;
+        if (drawer->GetColor(MeshVS_DA_EdgeColor, edgeColor))
+            aspect->SetEdgeColor(edgeColor);
+
+        Handle_Graphic3d_Group group = prs->NewGroup();
+        group->SetPrimitivesAspect(aspect);
+        group->AddPrimitiveArray(m_triangles);
+        // All elements are drawn, other builders have to skip them
+        idsToExclude.Unite(ids);
+    }
+
+private:
+    Handle_Graphic3d_ArrayOfTriangles m_triangles;
+};
+
 } // namespace
 
 GraphicsMeshObjectDriver::GraphicsMeshObjectDriver()
@@ -48,6 +246,7 @@ GraphicsMeshObjectDriver::Support GraphicsMeshObjectDriver::supportStatus(const
 GraphicsObjectPtr GraphicsMeshObjectDriver::createObject(const TDF_Label& label) const
 {
     Handle_Poly_Triangulation polyTri;
+    TriangulationAnnexDataPtr attrMeshData;
     Span<const Quantity_Color> spanNodeColor;
     //const TopLoc_Location* ptrLocationPolyTri = nullptr;
     if (XCaf::isShape(label)) {
@@ -59,7 +258,7 @@ GraphicsObjectPtr GraphicsMeshObjectDriver::createObject(const TDF_Label& label)
                 //ptrLocationPolyTri = &shape.Location();
             }
 
-            auto attrMeshData = CafUtils::findAttribute<TriangulationAnnexData>(label);
+            attrMeshData = CafUtils::findAttribute<TriangulationAnnexData>(label);
             if (attrMeshData)
                 spanNodeColor = attrMeshData->nodeColors();
         }
@@ -67,17 +266,25 @@ GraphicsObjectPtr GraphicsMeshObjectDriver::createObject(const TDF_Label& label)
 
     if (polyTri) {
         Handle_MeshVS_Mesh object = new MeshVS_Mesh;
-        object->SetDataSource(new GraphicsMeshDataSource(polyTri));
-        // meshVisu->AddBuilder(..., false); -> No selection
-        if (!spanNodeColor.empty()) {
-            auto meshPrsBuilder = new MeshVS_NodalColorPrsBuilder(object, MeshVS_DMF_NodalColorDataPrs | MeshVS_DMF_OCCMask);
-            for (int i = 0; CppUtils::cmpLess(i, spanNodeColor.size()); ++i)
-                meshPrsBuilder->SetColor(i + 1, spanNodeColor[i]);
-
-            object->AddBuilder(meshPrsBuilder, true);
+        const int previewTriangleCount = previewTriangleCountThreshold();
+        if (previewTriangleCount > 0 && polyTri->NbTriangles() > previewTriangleCount) {
+            // Huge mesh, full resolution data(possibly decimated) is left to createFullResolutionData()
+            std::vector<int> vecSourceNode;
+            const Handle_Poly_Triangulation previewMesh = MeshUtils::sampledMesh(polyTri, previewTriangleCount, &vecSourceNode);
+            std::vector<Quantity_Color> vecPreviewNodeColor;
+            if (!spanNodeColor.empty()) {
+                vecPreviewNodeColor.reserve(vecSourceNode.size());
+                for (int sourceNode : vecSourceNode)
+                    vecPreviewNodeColor.push_back(spanNodeColor[sourceNode]);
+            }
+
+            object->SetDataSource(new GraphicsMeshPreviewDataSource(previewMesh, polyTri, attrMeshData));
+            object->AddBuilder(createPrsBuilder(object, vecPreviewNodeColor), true);
         }
         else {
-            object->AddBuilder(new MeshVS_MeshPrsBuilder(object), true);
+            object->SetDataSource(new GraphicsMeshDataSource(polyTri));
+            // meshVisu->AddBuilder(..., false); -> No selection
+            object->AddBuilder(createPrsBuilder(object, spanNodeColor), true);
         }
 
         // -- MeshVS_DrawerAttribute
@@ -210,6 +417,63 @@ GraphicsMeshObjectDriver::properties(Span<const GraphicsObjectPtr> spanObject) c
     return std::make_unique<ObjectProperties>(spanObject);
 }
 
+bool GraphicsMeshObjectDriver::isPreviewObject(const GraphicsObjectPtr& object)
+{
+    return findPreviewDataSource(object) != nullptr;
+}
+
+GraphicsMeshObjectDriver::FullResolutionData
+GraphicsMeshObjectDriver::createFullResolutionData(const GraphicsObjectPtr& object, TaskProgress* progress)
+{
+    const GraphicsMeshPreviewDataSource* previewDataSource = findPreviewDataSource(object);
+    if (!previewDataSource)
+        return {};
+
+    Span<const Quantity_Color> spanNodeColor = previewDataSource->fullMeshNodeColors();
+    std::vector<Quantity_Color> vecDisplayedNodeColor;
+    Handle_Poly_Triangulation mesh;
+    {
+        TaskProgress subProgress(progress, 50, GraphicsMeshObjectDriverI18N::textIdTr("Simplify mesh"));
+        mesh = displayedMesh(previewDataSource->fullMesh(), &spanNodeColor, &vecDisplayedNodeColor, &subProgress);
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    // Note: builders are just created here, object is left unchanged until setFullResolutionData()
+    //       Shaded presentation(default display mode) is fully precomputed, so recomputing the
+    //       presentation afterwards in the main thread is cheap
+    FullResolutionData data;
+    data.dataSource = new GraphicsMeshDataSource(mesh);
+    data.prsBuilder = createPrsBuilder(Handle_MeshVS_Mesh::DownCast(object), spanNodeColor);
+    {
+        TaskProgress subProgress(progress, 50, GraphicsMeshObjectDriverI18N::textIdTr("Build presentation"));
+        const Handle_Graphic3d_ArrayOfTriangles triangles = createShadedTriangles(mesh, spanNodeColor, &subProgress);
+        if (triangles)
+            data.shadedPrsBuilder = new GraphicsMeshShadedPrsBuilder(Handle_MeshVS_Mesh::DownCast(object), triangles);
+    }
+
+    if (TaskProgress::isAbortRequested(progress))
+        return {};
+
+    return data;
+}
+
+void GraphicsMeshObjectDriver::setFullResolutionData(const GraphicsObjectPtr& object, const FullResolutionData& data)
+{
+    auto meshObject = Handle_MeshVS_Mesh::DownCast(object);
+    if (!meshObject || !data.dataSource || !data.prsBuilder)
+        return;
+
+    while (meshObject->GetBuildersCount() > 0)
+        meshObject->RemoveBuilder(1);
+
+    meshObject->SetDataSource(data.dataSource);
+    meshObject->AddBuilder(data.prsBuilder, true);
+    if (data.shadedPrsBuilder)
+        meshObject->AddBuilder(data.shadedPrsBuilder, false);
+}
+
 GraphicsMeshObjectDriver::Support GraphicsMeshObjectDriver::meshSupportStatus(const TDF_Label& label)
 {
     const LabelDataFlags flags = findLabelDataFlags(label);
@@ -8,8 +8,13 @@
 
 #include "graphics_object_driver.h"
 
+#include <MeshVS_DataSource.hxx>
+#include <MeshVS_PrsBuilder.hxx>
+
 namespace Mayo {
 
+class TaskProgress;
+
 class GraphicsMeshObjectDriver;
 DEFINE_STANDARD_HANDLE(GraphicsMeshObjectDriver, GraphicsObjectDriver)
 using GraphicsMeshObjectDriverPtr = Handle(GraphicsMeshObjectDriver);
@@ -33,10 +38,34 @@ public:
         Graphic3d_NameOfMaterial material = Graphic3d_NOM_PLASTER;
         Quantity_Color color = Quantity_NOC_BISQUE;
         Quantity_Color edgeColor = Quantity_NOC_BLACK;
+        // Meshes having more triangles are displayed decimated(see MeshDecimation), no limit if zero
+        // Decimation is performed by createFullResolutionData(), so such meshes are first displayed
+        // with a preview even if 'previewTriangleCount' is zero
+        int maxTriangleCount = 0;
+        // Meshes having more triangles are first displayed with a preview made of a sample of their
+        // triangles(at most this count), see createFullResolutionData(). Disabled if zero
+        int previewTriangleCount = 0;
     };
     static const DefaultValues& defaultValues();
     static void setDefaultValues(const DefaultValues& values);
 
+    // -- Progressive display of huge meshes
+    // Graphics object created by createObject() might be a quickly built preview of the mesh. Its
+    // full resolution data is then built with createFullResolutionData(), which is a long operation
+    // not modifying the object so it can be called from a worker thread. The data is finally put in
+    // place with setFullResolutionData() and presentation of the object has to be recomputed
+    struct FullResolutionData {
+        Handle(MeshVS_DataSource) dataSource;
+        Handle(MeshVS_PrsBuilder) prsBuilder;
+        // Builder of the shaded presentation, with triangles already computed
+        Handle(MeshVS_PrsBuilder) shadedPrsBuilder;
+    };
+    static bool isPreviewObject(const GraphicsObjectPtr& object);
+    static FullResolutionData createFullResolutionData(
+            const GraphicsObjectPtr& object, TaskProgress* progress = nullptr
+    );
+    static void setFullResolutionData(const GraphicsObjectPtr& object, const FullResolutionData& data);
+
     DEFINE_STANDARD_RTTI_INLINE(GraphicsMeshObjectDriver, GraphicsObjectDriver)
 
 private:
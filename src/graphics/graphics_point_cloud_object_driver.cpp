@@ -9,6 +9,7 @@
 #include "../base/caf_utils.h"
 #include "../base/label_data.h"
 #include "../base/point_cloud_data.h"
+#include "ais_point_cloud_lod.h"
 
 #include <AIS_PointCloud.hxx>
 
@@ -27,8 +28,16 @@ GraphicsObjectPtr GraphicsPointCloudObjectDriver::createObject(const TDF_Label&
 {
     if (findLabelDataFlags(label) & LabelData_HasPointCloudData) {
         auto attrPointCloudData = CafUtils::findAttribute<PointCloudData>(label);
-        auto object = new AIS_PointCloud;
-        object->SetPoints(attrPointCloudData->points());
+        Handle_AIS_PointCloud object;
+        if (attrPointCloudData->octree()) {
+            // Big point cloud, displayed points are then driven by the view(see GuiDocument)
+            object = new AIS_PointCloudLod(attrPointCloudData->octree());
+        }
+        else {
+            object = new AIS_PointCloud;
+            object->SetPoints(attrPointCloudData->points());
+        }
+
         object->SetOwner(this);
         return object;
     }
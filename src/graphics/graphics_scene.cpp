@@ -227,6 +227,15 @@ void GraphicsScene::setObjectVisible(const GraphicsObjectPtr& object, bool on)
     GraphicsUtils::AisContext_setObjectVisible(d->m_aisContext, object, on);
 }
 
+void GraphicsScene::setObjectPresentationVisible(const GraphicsObjectPtr& object, bool on)
+{
+    if (!object)
+        return;
+
+    const int displayMode = object->HasDisplayMode() ? object->DisplayMode() : d->m_aisContext->DisplayMode();
+    d->m_aisContext->MainPrsMgr()->SetVisibility(object, displayMode, on);
+}
+
 gp_Trsf GraphicsScene::objectTransformation(const GraphicsObjectPtr& object) const
 {
     return d->m_aisContext->Location(object);
@@ -268,6 +277,23 @@ void GraphicsScene::toggleOwnerSelection(const GraphicsOwnerPtr& gfxOwner)
         d->m_aisContext->AddOrRemoveSelected(gfxOwner, false);
 }
 
+void GraphicsScene::selectObjects(Span<const GraphicsObjectPtr> spanObject)
+{
+    if (d->m_selectionMode == SelectionMode::None)
+        return;
+
+    if (d->m_selectionMode == SelectionMode::Single)
+        d->m_aisContext->ClearSelected(false);
+
+    for (const GraphicsObjectPtr& object : spanObject) {
+        const GraphicsOwnerPtr owner = object ? object->GlobalSelOwner() : GraphicsOwnerPtr();
+        if (owner && GraphicsUtils::AisObject_isVisible(object) && !d->m_aisContext->IsSelected(owner))
+            d->m_aisContext->AddOrRemoveSelected(owner, false);
+    }
+
+    this->signalSelectionChanged.send();
+}
+
 void GraphicsScene::highlightAt(int xPos, int yPos, const Handle_V3d_View& view)
 {
     d->m_aisContext->MoveTo(xPos, yPos, view, false);
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "../base/signal.h"
+#include "../base/span.h"
 #include "graphics_object_ptr.h"
 #include "graphics_owner_ptr.h"
 
@@ -62,6 +63,10 @@ public:
     bool isObjectVisible(const GraphicsObjectPtr& object) const;
     void setObjectVisible(const GraphicsObjectPtr& object, bool on);
 
+    // Shows/hides the presentation of an object in its current display mode. Unlike setObjectVisible()
+    // the object stays displayed, so it can still be selected
+    void setObjectPresentationVisible(const GraphicsObjectPtr& object, bool on);
+
     gp_Trsf objectTransformation(const GraphicsObjectPtr& object) const;
     void setObjectTransformation(const GraphicsObjectPtr& object, const gp_Trsf& trsf);
 
@@ -80,6 +85,9 @@ public:
     GraphicsOwnerPtr firstSelectedOwner() const;
     void toggleOwnerSelection(const GraphicsOwnerPtr& owner);
     void clearSelection();
+    // Selects the visible objects as a whole(ie their global owner). Current selection is replaced
+    // in SelectionMode::Single, extended in SelectionMode::Multi
+    void selectObjects(Span<const GraphicsObjectPtr> spanObject);
 
     template<typename Function>
     void foreachDisplayedObject(Function fn) const;
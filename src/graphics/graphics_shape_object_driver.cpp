@@ -70,35 +70,31 @@ void GraphicsShapeObjectDriver::applyDisplayMode(GraphicsObjectPtr object, Enume
     if (!context)
         return;
 
-    auto fnSetViewComputedMode = [=](bool on) {
-        for (auto it = context->CurrentViewer()->DefinedViewIterator(); it.More(); it.Next())
-            it.Value()->SetComputedMode(on);
-    };
+    // Hidden lines aren't computed by the views(which would block on each camera change) but in
+    // background by HlrController(see GuiDocument). Object is shaded until lines are available
+    for (auto it = context->CurrentViewer()->DefinedViewIterator(); it.More(); it.Next())
+        it.Value()->SetComputedMode(false);
 
-    if (mode == DisplayMode_HiddenLineRemoval) {
-        context->DefaultDrawer()->SetTypeOfHLR(Prs3d_TOH_PolyAlgo);
+    if (mode == DisplayMode_HiddenLineRemoval)
         context->DefaultDrawer()->EnableDrawHiddenLine();
-        fnSetViewComputedMode(true);
-    }
-    else {
-        context->DefaultDrawer()->SetTypeOfHLR(Prs3d_TOH_NotSet);
+    else
         context->DefaultDrawer()->DisableDrawHiddenLine();
-        fnSetViewComputedMode(false);
-        const AIS_DisplayMode aisDispMode = mode == DisplayMode_Wireframe ? AIS_WireFrame : AIS_Shaded;
-        const bool showFaceBounds = mode == DisplayMode_ShadedWithFaceBoundary;
-        if (object->DisplayMode() != aisDispMode)
-            context->SetDisplayMode(object, aisDispMode, false);
-
-        if (object->Attributes()->FaceBoundaryDraw() != showFaceBounds) {
-            object->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
-            auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
-            if (aisLink && aisLink->HasConnection()) {
-                aisLink->ConnectedTo()->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
-                aisLink->ConnectedTo()->Redisplay(true);
-            }
-            else {
-                object->Redisplay(true);
-            }
+
+    const AIS_DisplayMode aisDispMode = mode == DisplayMode_Wireframe ? AIS_WireFrame : AIS_Shaded;
+    const bool showFaceBounds =
+            mode == DisplayMode_ShadedWithFaceBoundary || mode == DisplayMode_HiddenLineRemoval;
+    if (object->DisplayMode() != aisDispMode)
+        context->SetDisplayMode(object, aisDispMode, false);
+
+    if (object->Attributes()->FaceBoundaryDraw() != showFaceBounds) {
+        object->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
+        auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
+        if (aisLink && aisLink->HasConnection()) {
+            aisLink->ConnectedTo()->Attributes()->SetFaceBoundaryDraw(showFaceBounds);
+            aisLink->ConnectedTo()->Redisplay(true);
+        }
+        else {
+            object->Redisplay(true);
         }
     }
 
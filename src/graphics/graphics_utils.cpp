@@ -11,6 +11,7 @@
 
 #include <Bnd_Box.hxx>
 #include <ElSLib.hxx>
+#include <Graphic3d_Camera.hxx>
 #include <Image_PixMap.hxx>
 #include <ProjLib.hxx>
 #include <SelectMgr_SelectionManager.hxx>
@@ -80,6 +81,34 @@ gp_Pnt GraphicsUtils::V3dView_to3dPosition(const Handle_V3d_View& view, double x
     return ElSLib::Value(pntConvertedOnPlane.X(), pntConvertedOnPlane.Y(), planeView);
 }
 
+double GraphicsUtils::V3dView_projectedSize(const Handle_V3d_View& view, const Bnd_Box& bndBox)
+{
+    if (bndBox.IsVoid() || BndUtils::isOpen(bndBox) || view->Window().IsNull())
+        return 0.;
+
+    const Handle_Graphic3d_Camera& camera = view->Camera();
+    double xMin = RealLast();
+    double yMin = RealLast();
+    double xMax = RealFirst();
+    double yMax = RealFirst();
+    for (const gp_Pnt& pnt : BndBoxCoords::get(bndBox).vertices()) {
+        // Normalized device coordinates, in [-1, 1] for points inside the view frustum
+        const gp_Pnt pntNdc = camera->Project(pnt);
+        xMin = std::min(xMin, pntNdc.X());
+        yMin = std::min(yMin, pntNdc.Y());
+        xMax = std::max(xMax, pntNdc.X());
+        yMax = std::max(yMax, pntNdc.Y());
+    }
+
+    // Ignore objects lying completely outside of the view
+    if (xMax < -1. || xMin > 1. || yMax < -1. || yMin > 1.)
+        return 0.;
+
+    const int wndWidth = GraphicsUtils::AspectWindow_width(view->Window());
+    const int wndHeight = GraphicsUtils::AspectWindow_height(view->Window());
+    return std::max((xMax - xMin) * wndWidth, (yMax - yMin) * wndHeight) / 2.;
+}
+
 void GraphicsUtils::AisContext_eraseObject(
         const Handle_AIS_InteractiveContext& context,
         const Handle_AIS_InteractiveObject& object)
@@ -19,6 +19,8 @@ struct GraphicsUtils {
     static void V3dView_fitAll(const Handle_V3d_View& view);
     static bool V3dView_hasClipPlane(const Handle_V3d_View& view, const Handle_Graphic3d_ClipPlane& plane);
     static gp_Pnt V3dView_to3dPosition(const Handle_V3d_View& view, double x, double y);
+    // Size(in pixels) on screen of the projected bounding box, zero if the box is out of the view
+    static double V3dView_projectedSize(const Handle_V3d_View& view, const Bnd_Box& bndBox);
 
     static void AisContext_eraseObject(
             const Handle_AIS_InteractiveContext& context,
@@ -8,30 +8,45 @@
 
 #include "../base/application.h"
 #include "../base/application_item.h"
+#include "../base/application_item_selection_model.h"
 #include "../base/bnd_utils.h"
+#include "../base/brep_utils.h"
 #include "../base/caf_utils.h"
 #include "../base/cpp_utils.h"
 #include "../base/document.h"
 #include "../base/math_utils.h"
 #include "../base/tkernel_utils.h"
+#include "../graphics/ais_point_cloud_lod.h"
+#include "../graphics/graphics_mesh_object_driver.h"
 #include "../graphics/graphics_utils.h"
 #include "../gui/gui_application.h"
+#include "hlr_controller.h"
+#include "mesh_lod_controller.h"
+#include "mesh_preview_controller.h"
 
 #if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 4, 0)
 #  include <AIS_ViewCube.hxx>
 #endif
 #include <AIS_ConnectedInteractive.hxx>
+#include <AIS_Shape.hxx>
 #include <AIS_Trihedron.hxx>
 #include <Geom_Axis2Placement.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
+#include <Graphic3d_ZLayerSettings.hxx>
+#include <Precision.hxx>
 #include <V3d_TypeOfOrientation.hxx>
 
+#include <algorithm>
 #include <cmath>
+#include <unordered_set>
 
 namespace Mayo {
 
 namespace Internal {
 
+// Count of points displayed for a big point cloud right after camera change
+const int pointCloudMinPointBudget = 500000;
+
 static Handle_AIS_Trihedron createOriginTrihedron()
 {
     Handle_Geom_Axis2Placement axis = new Geom_Axis2Placement(gp::XOY());
@@ -65,6 +80,52 @@ static GuiDocument::GradientBackground& defaultGradientBackground()
     return defaultGradientBackground;
 }
 
+// Side planes of the view volume going through view rectangle [xMin,xMax]x[yMin,yMax], normals
+// pointing inside. Returns empty array if the rectangle is degenerated
+static std::vector<gp_Pln> viewRectanglePlanes(const GuiDocument* guiDoc, int xMin, int yMin, int xMax, int yMax)
+{
+    if (xMin >= xMax || yMin >= yMax)
+        return {};
+
+    const gp_Lin rays[] = {
+        guiDoc->viewRay(xMin, yMin), guiDoc->viewRay(xMax, yMin),
+        guiDoc->viewRay(xMax, yMax), guiDoc->viewRay(xMin, yMax)
+    };
+    std::vector<gp_Pln> vecPlane;
+    for (int i = 0; i < 4; ++i) {
+        const gp_Lin& ray = rays[i];
+        const gp_Pnt& pntNext = rays[(i + 1) % 4].Location();
+        const gp_Pnt& pntOpposite = rays[(i + 2) % 4].Location();
+        gp_Vec normal = gp_Vec(ray.Location(), pntNext) ^ gp_Vec(ray.Direction());
+        if (normal.Magnitude() < gp::Resolution())
+            return {};
+
+        if (normal.Dot(gp_Vec(ray.Location(), pntOpposite)) < 0)
+            normal.Reverse();
+
+        vecPlane.push_back(gp_Pln(ray.Location(), normal));
+    }
+
+    return vecPlane;
+}
+
+// Whether 'box' is completely on the inner side of all the planes
+static bool isBoxInsidePlanes(const Bnd_Box& box, Span<const gp_Pln> spanPlane)
+{
+    if (box.IsVoid())
+        return false;
+
+    const auto boxVertices = BndBoxCoords::get(box).vertices();
+    for (const gp_Pln& plane : spanPlane) {
+        for (const gp_Pnt& pnt : boxVertices) {
+            if (gp_Vec(plane.Location(), pnt).Dot(gp_Vec(plane.Axis().Direction())) < 0)
+                return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace Internal
 
 GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
@@ -72,7 +133,10 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
       m_document(doc),
       m_v3dView(m_gfxScene.createV3dView()),
       m_aisOriginTrihedron(Internal::createOriginTrihedron()),
-      m_cameraAnimation(new V3dViewCameraAnimation)
+      m_cameraAnimation(new V3dViewCameraAnimation),
+      m_meshLodController(new MeshLodController(&m_gfxScene, m_v3dView)),
+      m_meshPreviewController(new MeshPreviewController(&m_gfxScene)),
+      m_hlrController(new HlrController(&m_gfxScene, m_v3dView))
 {
     Expects(!doc.IsNull());
 
@@ -102,11 +166,17 @@ GuiDocument::GuiDocument(const DocumentPtr& doc, GuiApplication* guiApp)
 
     m_cameraAnimation->setView(m_v3dView);
 
+    m_meshPreviewController->signalObjectsCompleted.connectSlot(&GuiDocument::onMeshPreviewsCompleted, this);
+    m_meshPreviewController->signalPendingChanged.connectSlot([=](bool isPending) {
+        this->signalMeshPreviewsPendingChanged.send(isPending);
+    });
+
     for (int i = 0; i < doc->entityCount(); ++i)
         this->mapEntity(doc->entityTreeNodeId(i));
 
     doc->signalEntityAdded.connectSlot(&GuiDocument::onDocumentEntityAdded, this);
     doc->signalEntityAboutToBeDestroyed.connectSlot(&GuiDocument::onDocumentEntityAboutToBeDestroyed, this);
+    doc->signalImportPreviewMeshChanged.connectSlot(&GuiDocument::onDocumentImportPreviewMeshChanged, this);
     m_gfxScene.signalSelectionChanged.connectSlot(&GuiDocument::onGraphicsSelectionChanged, this);
 }
 
@@ -149,6 +219,9 @@ void GuiDocument::setDevicePixelRatio(double ratio)
 
 GuiDocument::~GuiDocument()
 {
+    delete m_hlrController;
+    delete m_meshPreviewController;
+    delete m_meshLodController;
     delete m_cameraAnimation;
 }
 
@@ -175,13 +248,42 @@ TreeNodeId GuiDocument::nodeFromGraphicsObject(const GraphicsObjectPtr& gfxObjec
     if (!gfxObject)
         return 0;
 
-    for (const GraphicsEntity& gfxEntity: m_vecGraphicsEntity) {
-        auto it = gfxEntity.mapGfxObjectTreeNode.find(gfxObject);
-        if (it != gfxEntity.mapGfxObjectTreeNode.cend())
-            return it->second;
-    }
+    auto itFound = m_mapGfxObjectNode.find(gfxObject);
+    return itFound != m_mapGfxObjectNode.cend() ? itFound->second.treeNodeId : 0;
+}
 
-    return 0;
+gp_Lin GuiDocument::viewRay(int x, int y) const
+{
+    double px, py, pz, dx, dy, dz;
+    m_v3dView->ConvertWithProj(x, y, px, py, pz, dx, dy, dz);
+    return gp_Lin(gp_Pnt(px, py, pz), gp_Dir(dx, dy, dz));
+}
+
+bool GuiDocument::hasGraphicsObjectAt(int x, int y) const
+{
+    // Any visible object crossed by the ray will do, so don't look for the nearest one
+    const auto object = m_gfxObjectIndex.findNearest(this->viewRay(x, y), [](const GraphicsObjectPtr& object) {
+        return GraphicsUtils::AisObject_isVisible(object) ? 0. : -1.;
+    });
+    return object.has_value();
+}
+
+std::vector<GraphicsObjectPtr> GuiDocument::graphicsObjectsInside(int xMin, int yMin, int xMax, int yMax) const
+{
+    const std::vector<gp_Pln> vecPlane = Internal::viewRectanglePlanes(this, xMin, yMin, xMax, yMax);
+    if (vecPlane.empty())
+        return {};
+
+    std::vector<GraphicsObjectPtr> vecObject;
+    m_gfxObjectIndex.visitInside(vecPlane, [&](const GraphicsObjectPtr& object) {
+        // Index query also reports objects crossing the planes
+        if (GraphicsUtils::AisObject_isVisible(object)
+                && Internal::isBoxInsidePlanes(m_gfxObjectIndex.itemBox(object), vecPlane))
+        {
+            vecObject.push_back(object);
+        }
+    });
+    return vecObject;
 }
 
 void GuiDocument::toggleItemSelected(const ApplicationItem& appItem)
@@ -232,6 +334,8 @@ void GuiDocument::setActiveDisplayMode(const GraphicsObjectDriverPtr& driver, in
                 driver->applyDisplayMode(object, mode);
         });
     }
+
+    m_hlrController->setEnabled(m_gfxScene.hiddenLineDrawingOn());
 }
 
 CheckState GuiDocument::nodeVisibleState(TreeNodeId nodeId) const
@@ -242,13 +346,12 @@ CheckState GuiDocument::nodeVisibleState(TreeNodeId nodeId) const
 
 void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
 {
-    auto itNode = m_mapTreeNodeCheckState.find(nodeId);
-    if (itNode == m_mapTreeNodeCheckState.end())
-        return; // Error: unknown tree node
+    this->setNodesVisible(Span<const TreeNodeId>(&nodeId, 1), on);
+}
 
+void GuiDocument::setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on)
+{
     const CheckState nodeVisibleState = on ? CheckState::On : CheckState::Off;
-    if (itNode->second == nodeVisibleState)
-        return; // Same visible state
 
     // Helper data/function to keep track of all the nodes whose visibility state are altered
     std::unordered_map<TreeNodeId, CheckState> mapNodeIdVisibleState;
@@ -264,43 +367,83 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
         }
     };
 
-    // Recursive show/hide of the input node graphics
     const Tree<TDF_Label>& docModelTree = m_document->modelTree();
-    traverseTree(nodeId, docModelTree , [=](TreeNodeId id) {
-        fnSetNodeVisibleState(id, nodeVisibleState);
-    });
-    this->foreachGraphicsObject(nodeId, [=](GraphicsObjectPtr gfxObject) {
-        GraphicsUtils::AisObject_setVisible(gfxObject, on);
-    });
+    const ApplicationItemSelectionModel* selectionModel = m_guiApp->selectionModel();
+    std::vector<TreeNodeId> vecNodeChanged;
+    {
+        GraphicsSceneRedrawBlocker redrawBlocker(&m_gfxScene);
+        for (const TreeNodeId nodeId : spanNodeId) {
+            auto itNode = m_mapTreeNodeCheckState.find(nodeId);
+            if (itNode == m_mapTreeNodeCheckState.end())
+                continue; // Error: unknown tree node
+
+            if (itNode->second == nodeVisibleState)
+                continue; // Same visible state(might have been set with an ancestor)
+
+            // Recursive show/hide of the input node graphics
+            traverseTree(nodeId, docModelTree, [&](TreeNodeId id) {
+                fnSetNodeVisibleState(id, nodeVisibleState);
+            });
+            this->foreachGraphicsObject(nodeId, [=](GraphicsObjectPtr gfxObject) {
+                GraphicsUtils::AisObject_setVisible(gfxObject, on);
+            });
+
+            vecNodeChanged.push_back(nodeId);
+        }
+
+        m_hlrController->update();
 
-    // Keep selection state of the input node: in case the node graphics are "shown" back again then
-    // AIS object selection status is lost
-    const ApplicationItem appItem({ m_document, nodeId });
-    bool isAppItemSelected = m_guiApp->selectionModel()->isSelected(appItem);
-    if (!isAppItemSelected) { // Check if a parent is selected
-        TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-        while (parentId != 0 && !isAppItemSelected) {
-            const ApplicationItem parentAppItem({ m_document, parentId });
-            isAppItemSelected = m_guiApp->selectionModel()->isSelected(parentAppItem);
-            parentId = docModelTree.nodeParent(parentId);
+        // Keep selection state of the input nodes: in case the node graphics are "shown" back again
+        // then AIS object selection status is lost
+        for (const TreeNodeId nodeId : vecNodeChanged) {
+            if (!on)
+                break;
+
+            const ApplicationItem appItem({ m_document, nodeId });
+            bool isAppItemSelected = selectionModel->isSelected(appItem);
+            TreeNodeId parentId = docModelTree.nodeParent(nodeId);
+            while (parentId != 0 && !isAppItemSelected) { // Check if a parent is selected
+                isAppItemSelected = selectionModel->isSelected(ApplicationItem({ m_document, parentId }));
+                parentId = docModelTree.nodeParent(parentId);
+            }
+
+            if (isAppItemSelected)
+                this->toggleItemSelected(appItem);
+
+            // Keep selection state of input node children
+            traverseTree(nodeId, docModelTree, [=](TreeNodeId id) {
+                if (id != nodeId) {
+                    const ApplicationItem childAppItem({ m_document, id });
+                    if (selectionModel->isSelected(childAppItem))
+                        this->toggleItemSelected(childAppItem);
+                }
+            });
         }
     }
 
-    if (on && isAppItemSelected)
-        this->toggleItemSelected(appItem);
-
-    // Keep selection state of input node children
-    traverseTree(nodeId, docModelTree, [=](TreeNodeId id) {
-        if (id != nodeId) {
-            const ApplicationItem childAppItem({ m_document, id });
-            if (on && m_guiApp->selectionModel()->isSelected(childAppItem))
-                this->toggleItemSelected(childAppItem);
+    // Parent nodes check state, each ancestor being updated once, deepest ones first
+    std::vector<std::pair<TreeNodeId, int>> vecAncestorDepth;
+    std::unordered_set<TreeNodeId> setAncestor;
+    for (const TreeNodeId nodeId : vecNodeChanged) {
+        int nodeDepth = 0;
+        for (TreeNodeId id = docModelTree.nodeParent(nodeId); id != 0; id = docModelTree.nodeParent(id))
+            ++nodeDepth;
+
+        int depth = nodeDepth;
+        for (TreeNodeId id = docModelTree.nodeParent(nodeId); id != 0; id = docModelTree.nodeParent(id)) {
+            --depth;
+            if (!setAncestor.insert(id).second)
+                break; // Remaining ancestors already recorded
+
+            vecAncestorDepth.push_back({ id, depth });
         }
-    });
+    }
 
-    // Parent nodes check state
-    TreeNodeId parentId = docModelTree.nodeParent(nodeId);
-    while (parentId != 0) {
+    std::stable_sort(vecAncestorDepth.begin(), vecAncestorDepth.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second > rhs.second;
+    });
+    for (const auto& ancestor : vecAncestorDepth) {
+        const TreeNodeId parentId = ancestor.first;
         int childCount = 0;
         int checkedCount = 0;
         int uncheckedCount = 0;
@@ -319,7 +462,6 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
             parentVisibleState = CheckState::Off;
 
         fnSetNodeVisibleState(parentId, parentVisibleState);
-        parentId = docModelTree.nodeParent(parentId);
     }
 
     // Notify all node visibility changes
@@ -329,14 +471,158 @@ void GuiDocument::setNodeVisible(TreeNodeId nodeId, bool on)
 
 void GuiDocument::setExplodingFactor(double t)
 {
+    if (MathUtils::fuzzyEqual(m_explodingFactor, t))
+        return;
+
+    // Translations are precomputed by mapEntity(), so only transformations have to be updated
     m_explodingFactor = t;
+    gp_Trsf trsfMove;
     for (const GraphicsEntity& entity : m_vecGraphicsEntity) {
-        const gp_Pnt entityCenter = BndBoxCoords::get(entity.bndBox).center();
         for (const GraphicsEntity::Object& object : entity.vecObject) {
-            const gp_Vec vecDirection(entityCenter, BndBoxCoords::get(object.bndBox).center());
-            gp_Trsf trsfMove;
-            trsfMove.SetTranslation(2 * t * vecDirection);
+            trsfMove.SetTranslation(t * object.explodeTranslation);
             m_gfxScene.setObjectTransformation(object.ptr, trsfMove * object.trsfOriginal);
+            m_gfxObjectIndex.setItem(object.ptr, object.bndBox.Transformed(trsfMove));
+        }
+    }
+
+    m_gfxBoundingBox = m_gfxObjectIndex.boundingBox();
+    this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
+    m_hlrController->update();
+    m_gfxScene.redraw();
+}
+
+bool GuiDocument::isMeshLevelsOfDetailEnabled() const
+{
+    return m_meshLodController->isEnabled();
+}
+
+void GuiDocument::setMeshLevelsOfDetailEnabled(bool on)
+{
+    m_meshLodController->setEnabled(on);
+}
+
+void GuiDocument::updateMeshLevelsOfDetail()
+{
+    m_meshLodController->update();
+}
+
+void GuiDocument::setMeshLevelsOfDetailParameters(
+        const std::function<OccBRepMeshParameters(const TopoDS_Shape&)>& fn
+    )
+{
+    m_meshLodController->setMeshParametersFunction(fn);
+}
+
+bool GuiDocument::hasPendingMeshPreviews() const
+{
+    return m_meshPreviewController->pendingPreviewCount() != 0;
+}
+
+void GuiDocument::abortMeshPreviewCompletion()
+{
+    m_meshPreviewController->abort();
+}
+
+bool GuiDocument::isHiddenLineRemovalActive() const
+{
+    return m_hlrController->isEnabled();
+}
+
+void GuiDocument::updateHiddenLineRemoval()
+{
+    m_hlrController->update();
+}
+
+void GuiDocument::setPointCloudMaxPointBudget(int pointCount)
+{
+    m_pointCloudMaxPointBudget = std::max(pointCount, Internal::pointCloudMinPointBudget);
+    if (m_pointCloudPointBudget > m_pointCloudMaxPointBudget)
+        this->resetPointCloudLevelsOfDetail();
+}
+
+void GuiDocument::resetPointCloudLevelsOfDetail()
+{
+    m_pointCloudPointBudget = std::min(Internal::pointCloudMinPointBudget, m_pointCloudMaxPointBudget);
+    this->updatePointCloudLevelsOfDetail();
+}
+
+bool GuiDocument::refinePointCloudLevelsOfDetail()
+{
+    if (m_vecPointCloudLodObject.empty() || m_pointCloudPointBudget >= m_pointCloudMaxPointBudget)
+        return false;
+
+    if (m_pointCloudPointBudget > m_pointCloudMaxPointBudget / 2)
+        m_pointCloudPointBudget = m_pointCloudMaxPointBudget;
+    else
+        m_pointCloudPointBudget = std::max(2 * m_pointCloudPointBudget, Internal::pointCloudMinPointBudget);
+
+    this->updatePointCloudLevelsOfDetail();
+    return m_pointCloudPointBudget < m_pointCloudMaxPointBudget;
+}
+
+void GuiDocument::setInteractionCullingSize(int pixelSize)
+{
+    m_interactionCullingSize = std::max(pixelSize, 0);
+}
+
+void GuiDocument::setViewInteractionActive(bool on)
+{
+    if (on == m_isViewInteractionActive)
+        return;
+
+    m_isViewInteractionActive = on;
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 3, 0)
+    if (on && m_interactionCullingSize <= 0)
+        return;
+
+    // Size culling is evaluated by the renderer for each frame, so switching is cheap
+    const Handle_V3d_Viewer& viewer = m_v3dView->Viewer();
+    Graphic3d_ZLayerSettings layerSettings = viewer->ZLayerSettings(Graphic3d_ZLayerId_Default);
+    const double cullingSize = on ? double(m_interactionCullingSize) : Precision::Infinite();
+    if (layerSettings.CullingSize() == cullingSize)
+        return;
+
+    layerSettings.SetCullingSize(cullingSize);
+    viewer->SetZLayerSettings(Graphic3d_ZLayerId_Default, layerSettings);
+    if (!on)
+        m_gfxScene.redraw();
+#endif
+}
+
+void GuiDocument::recomputeBRepShapeGraphics(const TopTools_IndexedMapOfShape& mapFace)
+{
+    if (mapFace.IsEmpty())
+        return;
+
+    auto fnContainsAnyFace = [&](const TopoDS_Shape& shape) {
+        for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+            if (mapFace.Contains(expl.Current().Located(TopLoc_Location())))
+                return true;
+        }
+
+        return false;
+    };
+
+    std::unordered_set<GraphicsObjectPtr> setPrsObjectDone;
+    for (const GraphicsEntity& entity : m_vecGraphicsEntity) {
+        for (const GraphicsEntity::Object& object : entity.vecObject) {
+            // Instances share the presentation of their product
+            auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object.ptr);
+            const bool isLink = aisLink && aisLink->HasConnection();
+            const GraphicsObjectPtr prsObject = isLink ? aisLink->ConnectedTo() : object.ptr;
+            if (!setPrsObjectDone.insert(prsObject).second)
+                continue;
+
+            auto aisShape = Handle_AIS_Shape::DownCast(prsObject);
+            if (!aisShape || !fnContainsAnyFace(aisShape->Shape()))
+                continue;
+
+            // Use the triangulations as they are, otherwise presentation might mesh the faces again
+            aisShape->Attributes()->SetAutoTriangulation(false);
+            if (isLink)
+                aisShape->Redisplay(true/*allModes*/);
+            else
+                m_gfxScene.recomputeObjectPresentation(aisShape);
         }
     }
 
@@ -511,18 +797,73 @@ void GuiDocument::setDefaultGradientBackground(const GradientBackground& gradien
 void GuiDocument::onDocumentEntityAdded(TreeNodeId entityTreeNodeId)
 {
     this->mapEntity(entityTreeNodeId);
-    BndUtils::add(&m_gfxBoundingBox, m_vecGraphicsEntity.back().bndBox);
+    m_gfxBoundingBox = m_gfxObjectIndex.boundingBox();
     this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
 }
 
 void GuiDocument::onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId)
 {
     this->unmapEntity(entityTreeNodeId);
-    // Recompute bounding box
-    m_gfxBoundingBox.SetVoid();
-    for (const GraphicsEntity& gfxEntity : m_vecGraphicsEntity)
-        BndUtils::add(&m_gfxBoundingBox, gfxEntity.bndBox);
+    m_gfxBoundingBox = m_gfxObjectIndex.boundingBox();
+    this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
+}
+
+void GuiDocument::onDocumentImportPreviewMeshChanged(
+        const FilePath& filepath, const Handle_Poly_Triangulation& mesh
+    )
+{
+    auto itPreview = m_mapImportPreviewObject.find(filepath);
+    if (itPreview != m_mapImportPreviewObject.end()) {
+        m_gfxScene.eraseObject(itPreview->second);
+        m_mapImportPreviewObject.erase(itPreview);
+    }
+
+    // Preview isn't selectable nor part of the graphics entities, it can just be viewed
+    if (mesh) {
+        const GraphicsMeshObjectDriver::DefaultValues& meshDefaults = GraphicsMeshObjectDriver::defaultValues();
+        Handle_AIS_Shape object = new AIS_Shape(BRepUtils::makeFace(mesh));
+        object->SetDisplayMode(AIS_Shaded);
+        object->SetColor(meshDefaults.color);
+        object->SetMaterial(meshDefaults.material);
+        m_gfxScene.addObject(object);
+        m_gfxScene.deactivateObjectSelection(object);
+        m_mapImportPreviewObject.insert({ filepath, object });
+        if (m_vecGraphicsEntity.empty())
+            GraphicsUtils::V3dView_fitAll(m_v3dView);
+    }
+
+    m_gfxScene.redraw();
+}
+
+void GuiDocument::onMeshPreviewsCompleted(Span<const GraphicsObjectPtr> spanObject)
+{
+    // Bounding boxes were computed from the previews, update them with the full resolution meshes
+    for (const GraphicsObjectPtr& gfxObject : spanObject) {
+        auto itNode = m_mapGfxObjectNode.find(gfxObject);
+        if (itNode == m_mapGfxObjectNode.end())
+            continue;
+
+        auto itEntityIndex = m_mapEntityIndex.find(itNode->second.entityTreeNodeId);
+        if (itEntityIndex == m_mapEntityIndex.end())
+            continue;
 
+        GraphicsEntity& gfxEntity = m_vecGraphicsEntity.at(itEntityIndex->second);
+        gfxEntity.bndBox.SetVoid();
+        for (GraphicsEntity::Object& object : gfxEntity.vecObject) {
+            if (object.ptr == gfxObject) {
+                // Current bounding box includes the exploding translation
+                const Bnd_Box bndBox = GraphicsUtils::AisObject_boundingBox(object.ptr);
+                gp_Trsf trsfMove;
+                trsfMove.SetTranslation(-m_explodingFactor * object.explodeTranslation);
+                object.bndBox = bndBox.Transformed(trsfMove);
+                m_gfxObjectIndex.setItem(object.ptr, bndBox);
+            }
+
+            BndUtils::add(&gfxEntity.bndBox, object.bndBox);
+        }
+    }
+
+    m_gfxBoundingBox = m_gfxObjectIndex.boundingBox();
     this->signalGraphicsBoundingBoxChanged.send(m_gfxBoundingBox);
 }
 
@@ -538,6 +879,7 @@ void GuiDocument::onGraphicsSelectionChanged()
     }
 
     std::vector<ApplicationItem> vecSelected;
+    std::unordered_set<ApplicationItem> setSelected;
     m_gfxScene.foreachSelectedOwner([&](const GraphicsOwnerPtr& gfxOwner) {
         auto gfxObject = GraphicsObjectPtr::DownCast(
                     gfxOwner ? gfxOwner->Selectable() : Handle_SelectMgr_SelectableObject()
@@ -545,17 +887,18 @@ void GuiDocument::onGraphicsSelectionChanged()
         const TreeNodeId nodeId = this->nodeFromGraphicsObject(gfxObject);
         if (nodeId != 0) {
             const ApplicationItem appItem({ m_document, nodeId });
-            vecSelected.push_back(std::move(appItem));
+            if (setSelected.insert(appItem).second)
+                vecSelected.push_back(std::move(appItem));
         }
     });
 
+    // Difference between current application selection and graphics selection
     std::vector<ApplicationItem> vecRemoved;
     for (const ApplicationItem& appItem : appSelectionModel->selectedItems()) {
         if (appItem.document() != m_document)
             continue;
 
-        auto it = std::find(vecSelected.cbegin(), vecSelected.cend(), appItem);
-        if (it == vecSelected.cend())
+        if (setSelected.find(appItem) == setSelected.cend())
             vecRemoved.push_back(appItem);
     }
 
@@ -611,7 +954,7 @@ void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
 
             const GraphicsEntity::Object& lastGfxObject = gfxEntity.vecObject.back();
             gfxEntity.mapTreeNodeGfxObject.insert({ id, lastGfxObject.ptr });
-            gfxEntity.mapGfxObjectTreeNode.insert({ lastGfxObject.ptr, id });
+            m_mapGfxObjectNode.insert({ lastGfxObject.ptr, { entityTreeNodeId, id } });
         }
     });
 
@@ -626,6 +969,19 @@ void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
         object.bndBox = GraphicsUtils::AisObject_boundingBox(object.ptr);
         object.trsfOriginal = m_gfxScene.objectTransformation(object.ptr);
         BndUtils::add(&gfxEntity.bndBox, object.bndBox);
+        m_gfxObjectIndex.setItem(object.ptr, object.bndBox);
+        m_meshLodController->addObject(object.ptr, object.bndBox);
+        m_meshPreviewController->addObject(object.ptr);
+        m_hlrController->addObject(object.ptr);
+        if (Handle_AIS_PointCloudLod::DownCast(object.ptr))
+            m_vecPointCloudLodObject.push_back(object.ptr);
+    }
+
+    // Objects move away from the entity center when exploding
+    const gp_Pnt entityCenter = BndBoxCoords::get(gfxEntity.bndBox).center();
+    for (GraphicsEntity::Object& object : gfxEntity.vecObject) {
+        const gp_Vec vecDirection(entityCenter, BndBoxCoords::get(object.bndBox).center());
+        object.explodeTranslation = 2 * vecDirection;
     }
 
     m_gfxScene.redraw();
@@ -635,6 +991,8 @@ void GuiDocument::mapEntity(TreeNodeId entityTreeNodeId)
     });
 
     GraphicsUtils::V3dView_fitAll(m_v3dView);
+    m_hlrController->update();
+    m_mapEntityIndex.insert({ entityTreeNodeId, m_vecGraphicsEntity.size() });
     m_vecGraphicsEntity.push_back(std::move(gfxEntity));
 }
 
@@ -645,11 +1003,25 @@ void GuiDocument::unmapEntity(TreeNodeId entityTreeNodeId)
         if (!ptrItem)
             return;
 
-        for (const GraphicsEntity::Object& object : ptrItem->vecObject)
+        for (const GraphicsEntity::Object& object : ptrItem->vecObject) {
+            m_meshLodController->removeObject(object.ptr);
+            m_meshPreviewController->removeObject(object.ptr);
+            m_hlrController->removeObject(object.ptr);
+            auto& vecLodObject = m_vecPointCloudLodObject;
+            vecLodObject.erase(std::remove(vecLodObject.begin(), vecLodObject.end(), object.ptr), vecLodObject.end());
             m_gfxScene.eraseObject(object.ptr);
+            m_mapGfxObjectNode.erase(object.ptr);
+            m_gfxObjectIndex.removeItem(object.ptr);
+        }
 
         const auto indexItem = ptrItem - &m_vecGraphicsEntity.front();
         m_vecGraphicsEntity.erase(m_vecGraphicsEntity.begin() + indexItem);
+        m_mapEntityIndex.erase(entityTreeNodeId);
+        for (auto& mapPair : m_mapEntityIndex) {
+            if (mapPair.second > size_t(indexItem))
+                --mapPair.second;
+        }
+
         m_gfxScene.redraw();
     }
 
@@ -660,12 +1032,23 @@ void GuiDocument::unmapEntity(TreeNodeId entityTreeNodeId)
 
 const GuiDocument::GraphicsEntity* GuiDocument::findGraphicsEntity(TreeNodeId entityTreeNodeId) const
 {
-    auto itFound = std::find_if(
-                m_vecGraphicsEntity.cbegin(),
-                m_vecGraphicsEntity.cend(),
-                [=](const GraphicsEntity& item) { return item.treeNodeId == entityTreeNodeId; }
-    );
-    return itFound != m_vecGraphicsEntity.cend() ? &(*itFound) : nullptr;
+    auto itFound = m_mapEntityIndex.find(entityTreeNodeId);
+    return itFound != m_mapEntityIndex.cend() ? &m_vecGraphicsEntity.at(itFound->second) : nullptr;
+}
+
+void GuiDocument::updatePointCloudLevelsOfDetail()
+{
+    bool changed = false;
+    for (const GraphicsObjectPtr& object : m_vecPointCloudLodObject) {
+        auto pointCloud = Handle_AIS_PointCloudLod::DownCast(object);
+        if (GraphicsUtils::AisObject_isVisible(object) && pointCloud->updateNodes(m_v3dView, m_pointCloudPointBudget)) {
+            m_gfxScene.recomputeObjectPresentation(object);
+            changed = true;
+        }
+    }
+
+    if (changed)
+        m_gfxScene.redraw();
 }
 
 void GuiDocument::v3dViewTrihedronDisplay(Aspect_TypeOfTriedronPosition corner)
@@ -8,7 +8,10 @@
 
 #include "../base/document.h"
 #include "../base/global.h"
+#include "../base/occ_brep_mesh_parameters.h"
 #include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/spatial_index.h"
 #include "../base/tkernel_utils.h"
 #include "../graphics/graphics_object_driver.h"
 #include "../graphics/graphics_scene.h"
@@ -16,8 +19,11 @@
 
 #include <Aspect_TypeOfTriedronPosition.hxx>
 #include <Bnd_Box.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 #include <V3d_View.hxx>
+#include <gp_Lin.hxx>
 #include <functional>
+#include <map>
 #include <memory>
 #include <unordered_map>
 #include <vector>
@@ -26,6 +32,9 @@ namespace Mayo {
 
 class ApplicationItem;
 class GuiApplication;
+class HlrController;
+class MeshLodController;
+class MeshPreviewController;
 class V3dViewCameraAnimation;
 
 // Provides the link between Base::Document and graphical representations
@@ -60,6 +69,21 @@ public:
     // Finds the tree node id associated to graphics object
     TreeNodeId nodeFromGraphicsObject(const GraphicsObjectPtr& gfxObject) const;
 
+    // Spatial index of the graphics objects over their bounding boxes in world space(exploding
+    // included). It's updated on entity add/remove and on exploding changes, so queries such as
+    // "objects intersecting box/plane/frustum" or "object nearest to ray" don't have to iterate
+    // over all the objects. Use nodeFromGraphicsObject() to get the tree nodes of found objects
+    const SpatialIndex<GraphicsObjectPtr>& graphicsObjectIndex() const { return m_gfxObjectIndex; }
+
+    // -- Picking through graphicsObjectIndex(), positions are in view pixels
+    // Ray going from the near plane of the view through position (x,y)
+    gp_Lin viewRay(int x, int y) const;
+    // Whether position (x,y) is over the bounding box of some visible graphics object. Quick test
+    // allowing to skip exact picking where there is obviously nothing
+    bool hasGraphicsObjectAt(int x, int y) const;
+    // Visible graphics objects whose bounding box is completely inside the view rectangle
+    std::vector<GraphicsObjectPtr> graphicsObjectsInside(int xMin, int yMin, int xMax, int yMax) const;
+
     // Toggles selected status of an application item(doesn't affect Application's selection model)
     void toggleItemSelected(const ApplicationItem& appItem);
 
@@ -73,11 +97,55 @@ public:
     // -- Visible state of document's tree nodes
     CheckState nodeVisibleState(TreeNodeId nodeId) const;
     void setNodeVisible(TreeNodeId nodeId, bool on);
+    // Batch version of setNodeVisible(): ancestors check states are updated once and a single
+    // signalNodesVisibilityChanged is emitted
+    void setNodesVisible(Span<const TreeNodeId> spanNodeId, bool on);
 
     // -- Exploding
     double explodingFactor() const { return m_explodingFactor; }
     void setExplodingFactor(double t); // Must be in [0,1]
 
+    // -- Levels of detail of BRep shape meshes, switched depending on the size of objects on screen
+    bool isMeshLevelsOfDetailEnabled() const;
+    void setMeshLevelsOfDetailEnabled(bool on);
+    void updateMeshLevelsOfDetail(); // To be called once camera of the view has changed
+    // Meshing parameters of the BRep shapes, levels are derived from them
+    void setMeshLevelsOfDetailParameters(const std::function<OccBRepMeshParameters(const TopoDS_Shape&)>& fn);
+
+    // -- Progressive display of huge meshes(see GraphicsMeshObjectDriver::DefaultValues::previewTriangleCount)
+    // Such meshes are first displayed with a preview, full resolution is then built in background
+    bool hasPendingMeshPreviews() const;
+    void abortMeshPreviewCompletion(); // Pending meshes are left with their preview
+    mutable Signal<bool> signalMeshPreviewsPendingChanged;
+
+    // -- Hidden line removal of BRep shapes, active with the matching display mode of shapes
+    // Lines are computed in background for each camera direction(see HlrController)
+    bool isHiddenLineRemovalActive() const;
+    void updateHiddenLineRemoval(); // To be called once camera of the view has changed
+
+    // -- Levels of detail of big point clouds(see PointCloudOctree)
+    // Displayed points of each point cloud are limited by a budget. It's reset to a low value when
+    // camera changes and then doubled by each refinement step, up to 'pointCloudMaxPointBudget'
+    int pointCloudMaxPointBudget() const { return m_pointCloudMaxPointBudget; }
+    void setPointCloudMaxPointBudget(int pointCount);
+    void resetPointCloudLevelsOfDetail(); // To be called once camera of the view has changed
+    bool refinePointCloudLevelsOfDetail(); // Returns true if further refinement is possible
+    // Selects again the displayed nodes for the current camera, budget is kept. To be called
+    // periodically while the camera is interactively moved
+    void updatePointCloudLevelsOfDetail();
+
+    // -- Display quality while the view is interactively moved(rotation, panning, zoom, ...)
+    // Objects smaller on screen than 'pixelSize' aren't drawn while interaction is active, so
+    // frame rate is preserved on big assemblies. Zero disables this size culling
+    int interactionCullingSize() const { return m_interactionCullingSize; }
+    void setInteractionCullingSize(int pixelSize);
+    bool isViewInteractionActive() const { return m_isViewInteractionActive; }
+    void setViewInteractionActive(bool on); // Full quality is restored when switched off
+
+    // Recomputes presentation of the BRep shape graphics objects containing any of the faces in
+    // 'mapFace'(faces are expected with identity location), typically after these faces were re-meshed
+    void recomputeBRepShapeGraphics(const TopTools_IndexedMapOfShape& mapFace);
+
     // -- Visibility of trihedron at world origin
     bool isOriginTrihedronVisible() const;
     void toggleOriginTrihedronVisibility();
@@ -123,7 +191,9 @@ public:
 private:
     void onDocumentEntityAdded(TreeNodeId entityTreeNodeId);
     void onDocumentEntityAboutToBeDestroyed(TreeNodeId entityTreeNodeId);
+    void onDocumentImportPreviewMeshChanged(const FilePath& filepath, const Handle_Poly_Triangulation& mesh);
     void onGraphicsSelectionChanged();
+    void onMeshPreviewsCompleted(Span<const GraphicsObjectPtr> spanObject);
 
     void mapEntity(TreeNodeId entityTreeNodeId);
     void unmapEntity(TreeNodeId entityTreeNodeId);
@@ -134,15 +204,23 @@ private:
             GraphicsObjectPtr ptr;
             gp_Trsf trsfOriginal;
             Bnd_Box bndBox;
+            gp_Vec explodeTranslation; // Translation applied when exploding factor is 1
         };
 
         TreeNodeId treeNodeId;
         std::vector<Object> vecObject;
         std::unordered_map<TreeNodeId, GraphicsObjectPtr> mapTreeNodeGfxObject;
-        std::unordered_map<GraphicsObjectPtr, TreeNodeId> mapGfxObjectTreeNode;
         Bnd_Box bndBox;
     };
 
+    // Tree node associated to a graphics object, see m_mapGfxObjectNode
+    struct GraphicsObjectNode {
+        // Entity owning the graphics object, gives its GraphicsEntity through m_mapEntityIndex
+        // without walking up the model tree(see onMeshPreviewsCompleted())
+        TreeNodeId entityTreeNodeId;
+        TreeNodeId treeNodeId;
+    };
+
     const GraphicsEntity* findGraphicsEntity(TreeNodeId entityTreeNodeId) const;
 
     void v3dViewTrihedronDisplay(Aspect_TypeOfTriedronPosition corner);
@@ -155,17 +233,30 @@ private:
     double m_devicePixelRatio = 1.;
 
     V3dViewCameraAnimation* m_cameraAnimation = nullptr;
+    MeshLodController* m_meshLodController = nullptr;
+    MeshPreviewController* m_meshPreviewController = nullptr;
+    // Meshes displayed while files are being imported, see Document::signalImportPreviewMeshChanged
+    std::map<FilePath, GraphicsObjectPtr> m_mapImportPreviewObject;
+    HlrController* m_hlrController = nullptr;
     ViewTrihedronMode m_viewTrihedronMode = ViewTrihedronMode::None;
     Aspect_TypeOfTriedronPosition m_viewTrihedronCorner = Aspect_TOTP_LEFT_UPPER;
     Handle_AIS_InteractiveObject m_aisViewCube;
 
     std::vector<GraphicsEntity> m_vecGraphicsEntity;
+    std::unordered_map<TreeNodeId, size_t> m_mapEntityIndex; // Index in m_vecGraphicsEntity
+    std::unordered_map<GraphicsObjectPtr, GraphicsObjectNode> m_mapGfxObjectNode;
+    SpatialIndex<GraphicsObjectPtr> m_gfxObjectIndex;
     Bnd_Box m_gfxBoundingBox;
 
     std::unordered_map<GraphicsObjectDriverPtr, int> m_mapGfxDriverDisplayMode;
     std::unordered_map<TreeNodeId, CheckState> m_mapTreeNodeCheckState;
 
     double m_explodingFactor = 0.;
+    std::vector<GraphicsObjectPtr> m_vecPointCloudLodObject;
+    int m_pointCloudMaxPointBudget = 10000000;
+    int m_pointCloudPointBudget = 0;
+    int m_interactionCullingSize = 0;
+    bool m_isViewInteractionActive = false;
 };
 
 } // namespace Mayo
@@ -0,0 +1,315 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "hlr_controller.h"
+
+#include "../base/math_utils.h"
+#include "../base/task_progress.h"
+#include "../graphics/graphics_scene.h"
+#include "../graphics/graphics_utils.h"
+
+#include <AIS_ConnectedInteractive.hxx>
+#include <AIS_Shape.hxx>
+#include <Precision.hxx>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace Mayo {
+
+namespace {
+
+bool isSameTransformation(const gp_Trsf& lhs, const gp_Trsf& rhs)
+{
+    return lhs.TranslationPart().IsEqual(rhs.TranslationPart(), Precision::Confusion())
+            && lhs.GetRotation().IsEqual(rhs.GetRotation())
+            && MathUtils::fuzzyEqual(lhs.ScaleFactor(), rhs.ScaleFactor());
+}
+
+} // namespace
+
+HlrController::HlrController(GraphicsScene* scene, const Handle_V3d_View& view)
+    : m_scene(scene),
+      m_view(view)
+{
+    std::weak_ptr<bool> aliveToken = m_aliveToken;
+    m_taskMgr.signalEnded.connectSlot([=](TaskId taskId) {
+        if (!aliveToken.expired())
+            this->onJobEnded(taskId);
+    });
+}
+
+HlrController::~HlrController()
+{
+    // Running job stops at the next abort check, it's then waited for by ~TaskManager()
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+}
+
+void HlrController::setEnabled(bool on)
+{
+    if (on == m_isEnabled)
+        return;
+
+    m_isEnabled = on;
+    if (on) {
+        this->update();
+        return;
+    }
+
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    m_queueJob.clear();
+    for (auto& mapPair : m_mapProduct) {
+        Product& product = mapPair.second;
+        for (Instance& instance : product.vecInstance)
+            this->hideLines(&instance);
+
+        product.cacheLines.clear();
+    }
+
+    m_scene->redraw();
+}
+
+void HlrController::addObject(const GraphicsObjectPtr& object)
+{
+    const GraphicsObjectPtr prsObject = HlrController::presentationObject(object);
+    if (!Handle_AIS_Shape::DownCast(prsObject))
+        return;
+
+    Product& product = m_mapProduct[prsObject];
+    product.prsObject = prsObject;
+    Instance instance;
+    instance.object = object;
+    product.vecInstance.push_back(std::move(instance));
+}
+
+void HlrController::removeObject(const GraphicsObjectPtr& object)
+{
+    const GraphicsObjectPtr prsObject = HlrController::presentationObject(object);
+    auto itProduct = m_mapProduct.find(prsObject);
+    if (itProduct == m_mapProduct.end())
+        return;
+
+    auto& vecInstance = itProduct->second.vecInstance;
+    auto itInstance = std::find_if(vecInstance.begin(), vecInstance.end(), [&](const Instance& instance) {
+        return instance.object == object;
+    });
+    if (itInstance != vecInstance.end()) {
+        this->hideLines(&(*itInstance));
+        vecInstance.erase(itInstance);
+    }
+
+    if (!vecInstance.empty())
+        return;
+
+    if (m_currentJob && m_currentJob->prsObject == prsObject)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    m_queueJob.erase(
+                std::remove_if(m_queueJob.begin(), m_queueJob.end(), [&](const Job& job) {
+                    return job.prsObject == prsObject;
+                }),
+                m_queueJob.end()
+    );
+    m_mapProduct.erase(itProduct);
+}
+
+void HlrController::update()
+{
+    if (!m_isEnabled || m_view.IsNull())
+        return;
+
+    // Requests for previous camera directions are outdated
+    m_queueJob.clear();
+    const gp_Dir viewDirection = m_view->Camera()->Direction();
+    bool changed = false;
+    for (auto& mapPair : m_mapProduct) {
+        Product& product = mapPair.second;
+        for (Instance& instance : product.vecInstance) {
+            const bool isVisible = GraphicsUtils::AisObject_isVisible(instance.object);
+            const gp_Trsf trsf = m_scene->objectTransformation(instance.object);
+            if (instance.aisLines) {
+                // Shape object might have been moved(ie exploded), shown or hidden meanwhile
+                if (m_scene->isObjectVisible(instance.aisLines) != isVisible) {
+                    m_scene->setObjectVisible(instance.aisLines, isVisible);
+                    changed = true;
+                }
+
+                if (!isSameTransformation(m_scene->objectTransformation(instance.aisLines), trsf)) {
+                    m_scene->setObjectTransformation(instance.aisLines, trsf);
+                    changed = true;
+                }
+
+                // Displaying again the shape object also shows its presentation
+                if (isVisible)
+                    m_scene->setObjectPresentationVisible(instance.object, false);
+            }
+
+            if (!isVisible)
+                continue;
+
+            const gp_Dir localDirection = viewDirection.Transformed(trsf.Inverted());
+            instance.targetKey = HlrController::directionKey(localDirection);
+            if (instance.aisLines && instance.linesKey == instance.targetKey)
+                continue;
+
+            const AIS_HlrLines::Lines* lines = HlrController::useCachedLines(&product.cacheLines, instance.targetKey);
+            if (lines) {
+                this->showLines(&instance, instance.targetKey, *lines);
+                changed = true;
+            }
+            else if (!this->isJobPending(product.prsObject, instance.targetKey)) {
+                Job job;
+                job.prsObject = product.prsObject;
+                job.directionKey = instance.targetKey;
+                job.direction = localDirection;
+                m_queueJob.push_back(std::move(job));
+            }
+        }
+    }
+
+    if (changed)
+        m_scene->redraw();
+
+    this->runNextJob();
+}
+
+GraphicsObjectPtr HlrController::presentationObject(const GraphicsObjectPtr& object)
+{
+    auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
+    if (aisLink && aisLink->HasConnection())
+        return aisLink->ConnectedTo();
+
+    return object;
+}
+
+HlrController::DirectionKey HlrController::directionKey(const gp_Dir& dir)
+{
+    // Directions closer than ~0.06 degree are considered the same
+    auto fnRound = [](double coord) { return int(std::lround(coord * 1000.)); };
+    return { fnRound(dir.X()), fnRound(dir.Y()), fnRound(dir.Z()) };
+}
+
+const AIS_HlrLines::Lines* HlrController::useCachedLines(LinesCache* cache, const DirectionKey& key)
+{
+    auto itFound = std::find_if(cache->begin(), cache->end(), [&](const auto& entry) {
+        return entry.first == key;
+    });
+    if (itFound == cache->end())
+        return nullptr;
+
+    if (itFound != std::prev(cache->end())) {
+        auto entry = std::move(*itFound);
+        cache->erase(itFound);
+        cache->push_back(std::move(entry));
+    }
+
+    return &cache->back().second;
+}
+
+const AIS_HlrLines::Lines& HlrController::addCachedLines(
+        LinesCache* cache, const DirectionKey& key, AIS_HlrLines::Lines&& lines
+    )
+{
+    cache->emplace_back(key, std::move(lines));
+    while (int(cache->size()) > HlrController::MaxCachedDirectionCount)
+        cache->pop_front();
+
+    return cache->back().second;
+}
+
+bool HlrController::isJobPending(const GraphicsObjectPtr& prsObject, const DirectionKey& key) const
+{
+    auto fnIsSameJob = [&](const Job& job) {
+        return job.prsObject == prsObject && job.directionKey == key;
+    };
+    return (m_currentJob && fnIsSameJob(*m_currentJob))
+            || std::any_of(m_queueJob.cbegin(), m_queueJob.cend(), fnIsSameJob);
+}
+
+void HlrController::showLines(Instance* instance, const DirectionKey& key, const AIS_HlrLines::Lines& lines)
+{
+    instance->linesKey = key;
+    if (instance->aisLines) {
+        instance->aisLines->setLines(lines);
+        m_scene->recomputeObjectPresentation(instance->aisLines);
+        return;
+    }
+
+    instance->aisLines = new AIS_HlrLines;
+    instance->aisLines->setLines(lines);
+    m_scene->addObject(instance->aisLines);
+    m_scene->deactivateObjectSelection(instance->aisLines);
+    m_scene->setObjectTransformation(instance->aisLines, m_scene->objectTransformation(instance->object));
+    m_scene->setObjectPresentationVisible(instance->object, false);
+}
+
+void HlrController::hideLines(Instance* instance)
+{
+    if (!instance->aisLines)
+        return;
+
+    m_scene->eraseObject(instance->aisLines);
+    instance->aisLines.Nullify();
+    m_scene->setObjectPresentationVisible(instance->object, true);
+}
+
+void HlrController::runNextJob()
+{
+    if (m_currentJob || !m_isEnabled || m_queueJob.empty())
+        return;
+
+    auto job = std::make_unique<Job>(std::move(m_queueJob.front()));
+    m_queueJob.pop_front();
+
+    // Shape is only read: levels of detail of meshes are computed on copies of the shapes(see
+    // BRepMeshLevels) so its triangulations aren't replaced meanwhile
+    const TopoDS_Shape shape = Handle_AIS_Shape::DownCast(job->prsObject)->Shape();
+    const gp_Dir direction = job->direction;
+    Job* ptrJob = job.get();
+    job->taskId = m_taskMgr.newTask([=](TaskProgress* progress) {
+        ptrJob->result = AIS_HlrLines::computeLines(shape, direction, progress);
+        ptrJob->isAborted = TaskProgress::isAbortRequested(progress);
+    });
+    const TaskId taskId = job->taskId;
+    m_currentJob = std::move(job);
+    m_taskMgr.run(taskId);
+}
+
+void HlrController::onJobEnded(TaskId taskId)
+{
+    if (!m_currentJob || m_currentJob->taskId != taskId)
+        return;
+
+    std::unique_ptr<Job> job = std::move(m_currentJob);
+    auto itProduct = m_mapProduct.find(job->prsObject);
+    if (itProduct != m_mapProduct.end() && !job->isAborted && m_isEnabled) {
+        Product& product = itProduct->second;
+        const AIS_HlrLines::Lines& lines =
+                HlrController::addCachedLines(&product.cacheLines, job->directionKey, std::move(job->result));
+
+        bool changed = false;
+        for (Instance& instance : product.vecInstance) {
+            const bool isLinesExpected =
+                    instance.targetKey == job->directionKey
+                    && (!instance.aisLines || instance.linesKey != job->directionKey)
+                    && GraphicsUtils::AisObject_isVisible(instance.object);
+            if (isLinesExpected) {
+                this->showLines(&instance, job->directionKey, lines);
+                changed = true;
+            }
+        }
+
+        if (changed)
+            m_scene->redraw();
+    }
+
+    this->runNextJob();
+}
+
+} // namespace Mayo
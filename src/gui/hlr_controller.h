@@ -0,0 +1,114 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/task_manager.h"
+#include "../graphics/ais_hlr_lines.h"
+#include "../graphics/graphics_object_ptr.h"
+
+#include <V3d_View.hxx>
+#include <array>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Mayo {
+
+class GraphicsScene;
+
+// Provides view-dependent hidden line removal(HLR) of BRep shape graphics objects
+//
+// When enabled, the lines of each shape are computed in background(one shape at a time) for the
+// camera direction and displayed with an AIS_HlrLines object, the presentation of the shape object
+// itself being hidden. Until lines are available for the current direction, the previous ones are
+// displayed(or the shape object if there's none yet)
+// Lines are cached per camera direction, so switching back to some previous direction(ie standard
+// views) is immediate. Graphics objects sharing the same presentation(ie AIS_ConnectedInteractive
+// instances of a product) share the lines computed for the same direction relative to the product
+// Lines are computed with a parallel projection, even if the camera of the view is perspective
+class HlrController {
+public:
+    HlrController(GraphicsScene* scene, const Handle_V3d_View& view);
+    ~HlrController();
+
+    // Not copyable
+    HlrController(const HlrController&) = delete;
+    HlrController& operator=(const HlrController&) = delete;
+
+    // Disabling restores the presentations of the shape objects and releases all lines
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool on);
+
+    // Registers/unregisters graphics object
+    void addObject(const GraphicsObjectPtr& object);
+    void removeObject(const GraphicsObjectPtr& object);
+
+    // Displays the lines suited to the current camera of the view, missing lines are queued for
+    // computation. Has also to be called once visibility or transformation of objects has changed
+    void update();
+
+    // Maximum count of camera directions whose lines are kept for each product
+    static constexpr int MaxCachedDirectionCount = 10;
+
+    // Camera direction(relative to a product) rounded to some angular tolerance
+    using DirectionKey = std::array<int, 3>;
+    static DirectionKey directionKey(const gp_Dir& dir);
+
+    // Lines computed for the last camera directions of a product, most recently used at back
+    using LinesCache = std::deque<std::pair<DirectionKey, AIS_HlrLines::Lines>>;
+    // Finds the lines cached for 'key', they're then considered as the most recently used
+    static const AIS_HlrLines::Lines* useCachedLines(LinesCache* cache, const DirectionKey& key);
+    // Adds the lines of 'key' as the most recently used, the least recently used ones are dropped
+    // beyond MaxCachedDirectionCount
+    static const AIS_HlrLines::Lines& addCachedLines(
+            LinesCache* cache, const DirectionKey& key, AIS_HlrLines::Lines&& lines
+    );
+
+private:
+
+    struct Instance {
+        GraphicsObjectPtr object;
+        Handle_AIS_HlrLines aisLines; // Null until some lines are available
+        DirectionKey linesKey = {}; // Direction of the lines displayed by 'aisLines'
+        DirectionKey targetKey = {}; // Direction of the lines suited to the current camera
+    };
+
+    struct Product {
+        GraphicsObjectPtr prsObject; // Object owning the presentation
+        std::vector<Instance> vecInstance;
+        LinesCache cacheLines;
+    };
+
+    struct Job {
+        TaskId taskId = 0;
+        GraphicsObjectPtr prsObject;
+        DirectionKey directionKey = {};
+        gp_Dir direction;
+        AIS_HlrLines::Lines result;
+        bool isAborted = false;
+    };
+
+    static GraphicsObjectPtr presentationObject(const GraphicsObjectPtr& object);
+    bool isJobPending(const GraphicsObjectPtr& prsObject, const DirectionKey& key) const;
+    void showLines(Instance* instance, const DirectionKey& key, const AIS_HlrLines::Lines& lines);
+    void hideLines(Instance* instance);
+    void runNextJob();
+    void onJobEnded(TaskId taskId);
+
+    GraphicsScene* m_scene = nullptr;
+    Handle_V3d_View m_view;
+    bool m_isEnabled = false;
+    std::unordered_map<GraphicsObjectPtr, Product> m_mapProduct;
+    std::deque<Job> m_queueJob;
+    std::unique_ptr<Job> m_currentJob;
+    TaskManager m_taskMgr;
+    std::shared_ptr<bool> m_aliveToken = std::make_shared<bool>(true);
+};
+
+} // namespace Mayo
@@ -0,0 +1,262 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_lod_controller.h"
+
+#include "../base/task_progress.h"
+#include "../graphics/graphics_scene.h"
+#include "../graphics/graphics_utils.h"
+
+#include <AIS_ColoredShape.hxx>
+#include <AIS_ConnectedInteractive.hxx>
+#include <AIS_Shape.hxx>
+#include <algorithm>
+
+namespace Mayo {
+
+MeshLodController::MeshLodController(GraphicsScene* scene, const Handle_V3d_View& view)
+    : m_scene(scene),
+      m_view(view)
+{
+    std::weak_ptr<bool> aliveToken = m_aliveToken;
+    m_taskMgr.signalEnded.connectSlot([=](TaskId taskId) {
+        if (!aliveToken.expired())
+            this->onJobEnded(taskId);
+    });
+}
+
+MeshLodController::~MeshLodController()
+{
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+}
+
+void MeshLodController::setEnabled(bool on)
+{
+    if (on == m_isEnabled)
+        return;
+
+    m_isEnabled = on;
+    if (on) {
+        this->update();
+        return;
+    }
+
+    // Restore the initial meshes and forget other levels, they would be outdated in case meshes
+    // are modified while disabled
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    m_queueJob.clear();
+    bool changed = false;
+    for (auto& mapPair : m_mapProduct) {
+        Product& product = mapPair.second;
+        product.isQueued = false;
+        product.targetLevel = BRepMeshLevels::Level_Normal;
+        changed = this->activateLevel(&product, BRepMeshLevels::Level_Normal) || changed;
+
+        product.ptrLevels.reset();
+    }
+
+    if (changed)
+        m_scene->redraw();
+}
+
+void MeshLodController::addObject(const GraphicsObjectPtr& object, const Bnd_Box& bndBox)
+{
+    const GraphicsObjectPtr prsObject = MeshLodController::presentationObject(object);
+    if (!Handle_AIS_Shape::DownCast(prsObject))
+        return;
+
+    Product& product = m_mapProduct[prsObject];
+    product.prsObject = prsObject;
+    product.vecInstance.emplace_back(object, bndBox);
+}
+
+void MeshLodController::removeObject(const GraphicsObjectPtr& object)
+{
+    const GraphicsObjectPtr prsObject = MeshLodController::presentationObject(object);
+    auto itProduct = m_mapProduct.find(prsObject);
+    if (itProduct == m_mapProduct.end())
+        return;
+
+    Product& product = itProduct->second;
+    auto& vecInstance = product.vecInstance;
+    vecInstance.erase(
+                std::remove_if(vecInstance.begin(), vecInstance.end(), [&](const auto& instance) {
+                    return instance.first == object;
+                }),
+                vecInstance.end()
+    );
+    if (!vecInstance.empty())
+        return;
+
+    if (m_currentJob && m_currentJob->prsObject == prsObject)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    m_queueJob.erase(std::remove(m_queueJob.begin(), m_queueJob.end(), prsObject), m_queueJob.end());
+    m_mapProduct.erase(itProduct);
+}
+
+void MeshLodController::update()
+{
+    if (!m_isEnabled || m_view.IsNull())
+        return;
+
+    bool changed = false;
+    for (auto& mapPair : m_mapProduct) {
+        Product& product = mapPair.second;
+        double maxPixelSize = 0.;
+        for (const auto& instance : product.vecInstance) {
+            if (GraphicsUtils::AisObject_isVisible(instance.first))
+                maxPixelSize = std::max(maxPixelSize, GraphicsUtils::V3dView_projectedSize(m_view, instance.second));
+        }
+
+        if (maxPixelSize <= 0.)
+            continue; // Nothing visible, keep current level
+
+        product.targetLevel = this->levelForSize(maxPixelSize);
+        if (!product.ptrLevels) {
+            if (product.targetLevel == BRepMeshLevels::Level_Normal)
+                continue;
+
+            const TopoDS_Shape& shape = Handle_AIS_Shape::DownCast(product.prsObject)->Shape();
+            const OccBRepMeshParameters params =
+                    m_fnMeshParameters ? m_fnMeshParameters(shape) : OccBRepMeshParameters{};
+            product.ptrLevels = std::make_unique<BRepMeshLevels>(shape, params);
+        }
+
+        if (!product.ptrLevels->isSupported() || product.activeLevel == product.targetLevel)
+            continue;
+
+        if (product.ptrLevels->hasLevel(product.targetLevel)) {
+            changed = this->activateLevel(&product, product.targetLevel) || changed;
+        }
+        else if (!product.isQueued) {
+            product.isQueued = true;
+            m_queueJob.push_back(product.prsObject);
+        }
+    }
+
+    if (changed)
+        m_scene->redraw();
+
+    this->runNextJob();
+}
+
+GraphicsObjectPtr MeshLodController::presentationObject(const GraphicsObjectPtr& object)
+{
+    auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
+    if (aisLink && aisLink->HasConnection())
+        return aisLink->ConnectedTo();
+
+    return object;
+}
+
+BRepMeshLevels::Level MeshLodController::levelForSize(double pixelSize) const
+{
+    if (pixelSize < m_thresholds.coarseBelow)
+        return BRepMeshLevels::Level_Coarse;
+    else if (pixelSize > m_thresholds.fineAbove)
+        return BRepMeshLevels::Level_Fine;
+    else
+        return BRepMeshLevels::Level_Normal;
+}
+
+bool MeshLodController::activateLevel(Product* product, BRepMeshLevels::Level level)
+{
+    if (level == product->activeLevel || !product->ptrLevels || !product->ptrLevels->hasLevel(level))
+        return false;
+
+    auto aisShape = Handle_AIS_Shape::DownCast(product->prsObject);
+    auto aisColoredShape = Handle_AIS_ColoredShape::DownCast(aisShape);
+    AIS_DataMapOfShapeDrawer mapNormalAspects;
+    if (aisColoredShape) {
+        // Styles are bound to sub-shapes of the displayed shape, map them onto the level shape
+        mapNormalAspects = aisColoredShape->CustomAspectsMap();
+        AIS_DataMapOfShapeDrawer mapAspects;
+        for (AIS_DataMapOfShapeDrawer::Iterator it(mapNormalAspects); it.More(); it.Next()) {
+            const TopoDS_Shape levelSubShape = product->ptrLevels->levelSubShape(level, it.Key());
+            if (!levelSubShape.IsNull())
+                mapAspects.Bind(levelSubShape, it.Value());
+        }
+
+        aisColoredShape->ChangeCustomAspectsMap() = mapAspects;
+    }
+
+    // Presentation must use the triangulations as they are, otherwise coarser levels would be
+    // refined again when computing the presentation
+    product->prsObject->Attributes()->SetAutoTriangulation(false);
+    // Only the presentation is computed from the level shape. Object is then reverted to the
+    // document shape, so selection owners(and so measures, picking, ...) keep referring to it
+    aisShape->SetShape(product->ptrLevels->levelShape(level));
+    product->prsObject->Redisplay(true);
+    aisShape->SetShape(product->ptrLevels->shape());
+    if (aisColoredShape)
+        aisColoredShape->ChangeCustomAspectsMap() = mapNormalAspects;
+
+    product->activeLevel = level;
+    return true;
+}
+
+void MeshLodController::runNextJob()
+{
+    if (m_currentJob || !m_isEnabled)
+        return;
+
+    while (!m_queueJob.empty()) {
+        const GraphicsObjectPtr prsObject = m_queueJob.front();
+        m_queueJob.pop_front();
+        auto itProduct = m_mapProduct.find(prsObject);
+        if (itProduct == m_mapProduct.end())
+            continue;
+
+        Product& product = itProduct->second;
+        product.isQueued = false;
+        const BRepMeshLevels::Level level = product.targetLevel;
+        if (product.ptrLevels->hasLevel(level)) {
+            if (this->activateLevel(&product, level))
+                m_scene->redraw();
+
+            continue;
+        }
+
+        // Meshing is done on a copy of the shape, the shape itself is just read
+        auto job = std::make_unique<Job>();
+        job->prsObject = prsObject;
+        job->level = level;
+        Job* ptrJob = job.get();
+        const TopoDS_Shape shape = product.ptrLevels->shape();
+        const OccBRepMeshParameters params = product.ptrLevels->levelParameters(level);
+        job->taskId = m_taskMgr.newTask([=](TaskProgress* progress) {
+            ptrJob->result = BRepMeshLevels::computeLevel(shape, params, progress);
+            ptrJob->isAborted = TaskProgress::isAbortRequested(progress);
+        });
+        const TaskId taskId = job->taskId;
+        m_currentJob = std::move(job);
+        m_taskMgr.run(taskId);
+        return;
+    }
+}
+
+void MeshLodController::onJobEnded(TaskId taskId)
+{
+    if (!m_currentJob || m_currentJob->taskId != taskId)
+        return;
+
+    std::unique_ptr<Job> job = std::move(m_currentJob);
+    auto itProduct = m_mapProduct.find(job->prsObject);
+    if (itProduct != m_mapProduct.end() && !job->isAborted) {
+        Product& product = itProduct->second;
+        product.ptrLevels->setLevel(job->level, std::move(job->result));
+        if (m_isEnabled && product.targetLevel == job->level && this->activateLevel(&product, job->level))
+            m_scene->redraw();
+    }
+
+    this->runNextJob();
+}
+
+} // namespace Mayo
@@ -0,0 +1,102 @@
+/****************************************************************************
+** Copyright (c) 2022, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/brep_mesh_levels.h"
+#include "../base/task_manager.h"
+#include "../graphics/graphics_object_ptr.h"
+
+#include <Bnd_Box.hxx>
+#include <V3d_View.hxx>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class GraphicsScene;
+
+// Provides view-dependent switching between levels of detail of BRep shape graphics objects
+//
+// Graphics objects sharing the same presentation(ie AIS_ConnectedInteractive instances of a product)
+// are grouped, the level of the product is then driven by its biggest visible instance on screen
+// Calling update() evaluates the projected size of the instances bounding boxes for the current
+// camera and activates the best suited levels. Missing levels are computed in background(one shape
+// at a time) and activated once available
+// Activating a level computes the presentation of the graphics object from the shape of that
+// level(a meshed copy), the shapes of the document are left untouched
+class MeshLodController {
+public:
+    MeshLodController(GraphicsScene* scene, const Handle_V3d_View& view);
+    ~MeshLodController();
+
+    // Not copyable
+    MeshLodController(const MeshLodController&) = delete;
+    MeshLodController& operator=(const MeshLodController&) = delete;
+
+    // Disabling restores the initial meshes and releases the other levels
+    bool isEnabled() const { return m_isEnabled; }
+    void setEnabled(bool on);
+
+    // Screen sizes(in pixels) of the projected bounding boxes triggering level changes
+    struct Thresholds {
+        int coarseBelow = 48;
+        int fineAbove = 640;
+    };
+    const Thresholds& thresholds() const { return m_thresholds; }
+    void setThresholds(const Thresholds& thresholds) { m_thresholds = thresholds; }
+
+    // Function providing the meshing parameters of a shape, levels are derived from them
+    using FunctionMeshParameters = std::function<OccBRepMeshParameters(const TopoDS_Shape&)>;
+    void setMeshParametersFunction(const FunctionMeshParameters& fn) { m_fnMeshParameters = fn; }
+
+    // Registers/unregisters graphics object. 'bndBox' is the bounding box of the object in world space
+    void addObject(const GraphicsObjectPtr& object, const Bnd_Box& bndBox);
+    void removeObject(const GraphicsObjectPtr& object);
+
+    // Activates the levels suited to the current camera of the view
+    void update();
+
+private:
+    struct Product {
+        GraphicsObjectPtr prsObject; // Object owning the presentation
+        std::vector<std::pair<GraphicsObjectPtr, Bnd_Box>> vecInstance;
+        std::unique_ptr<BRepMeshLevels> ptrLevels;
+        BRepMeshLevels::Level activeLevel = BRepMeshLevels::Level_Normal;
+        BRepMeshLevels::Level targetLevel = BRepMeshLevels::Level_Normal;
+        bool isQueued = false;
+    };
+
+    struct Job {
+        TaskId taskId = 0;
+        GraphicsObjectPtr prsObject;
+        BRepMeshLevels::Level level = BRepMeshLevels::Level_Normal;
+        BRepMeshLevels::LevelData result;
+        bool isAborted = false;
+    };
+
+    static GraphicsObjectPtr presentationObject(const GraphicsObjectPtr& object);
+    BRepMeshLevels::Level levelForSize(double pixelSize) const;
+    bool activateLevel(Product* product, BRepMeshLevels::Level level);
+    void runNextJob();
+    void onJobEnded(TaskId taskId);
+
+    GraphicsScene* m_scene = nullptr;
+    Handle_V3d_View m_view;
+    bool m_isEnabled = false;
+    Thresholds m_thresholds;
+    FunctionMeshParameters m_fnMeshParameters;
+    std::unordered_map<GraphicsObjectPtr, Product> m_mapProduct;
+    std::deque<GraphicsObjectPtr> m_queueJob;
+    std::unique_ptr<Job> m_currentJob;
+    TaskManager m_taskMgr;
+    std::shared_ptr<bool> m_aliveToken = std::make_shared<bool>(true);
+};
+
+} // namespace Mayo
@@ -0,0 +1,148 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "mesh_preview_controller.h"
+
+#include "../base/task_progress.h"
+#include "../graphics/graphics_scene.h"
+
+#include <AIS_ConnectedInteractive.hxx>
+#include <algorithm>
+
+namespace Mayo {
+
+MeshPreviewController::MeshPreviewController(GraphicsScene* scene)
+    : m_scene(scene)
+{
+    std::weak_ptr<bool> aliveToken = m_aliveToken;
+    m_taskMgr.signalEnded.connectSlot([=](TaskId taskId) {
+        if (!aliveToken.expired())
+            this->onJobEnded(taskId);
+    });
+}
+
+MeshPreviewController::~MeshPreviewController()
+{
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+}
+
+void MeshPreviewController::addObject(const GraphicsObjectPtr& object)
+{
+    const GraphicsObjectPtr prsObject = MeshPreviewController::presentationObject(object);
+    if (!GraphicsMeshObjectDriver::isPreviewObject(prsObject))
+        return;
+
+    const bool wasPending = !m_mapProduct.empty();
+    std::vector<GraphicsObjectPtr>& vecInstance = m_mapProduct[prsObject];
+    if (vecInstance.empty())
+        m_queueJob.push_back(prsObject);
+
+    vecInstance.push_back(object);
+    if (!wasPending)
+        this->signalPendingChanged.send(true);
+
+    this->runNextJob();
+}
+
+void MeshPreviewController::removeObject(const GraphicsObjectPtr& object)
+{
+    const GraphicsObjectPtr prsObject = MeshPreviewController::presentationObject(object);
+    auto itProduct = m_mapProduct.find(prsObject);
+    if (itProduct == m_mapProduct.end())
+        return;
+
+    std::vector<GraphicsObjectPtr>& vecInstance = itProduct->second;
+    vecInstance.erase(std::remove(vecInstance.begin(), vecInstance.end(), object), vecInstance.end());
+    if (!vecInstance.empty())
+        return;
+
+    if (m_currentJob && m_currentJob->prsObject == prsObject)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    this->eraseProduct(prsObject);
+}
+
+void MeshPreviewController::abort()
+{
+    if (m_currentJob)
+        m_taskMgr.requestAbort(m_currentJob->taskId);
+
+    const bool wasPending = !m_mapProduct.empty();
+    m_queueJob.clear();
+    m_mapProduct.clear();
+    if (wasPending)
+        this->signalPendingChanged.send(false);
+}
+
+GraphicsObjectPtr MeshPreviewController::presentationObject(const GraphicsObjectPtr& object)
+{
+    auto aisLink = Handle_AIS_ConnectedInteractive::DownCast(object);
+    if (aisLink && aisLink->HasConnection())
+        return aisLink->ConnectedTo();
+
+    return object;
+}
+
+void MeshPreviewController::eraseProduct(const GraphicsObjectPtr& prsObject)
+{
+    m_queueJob.erase(std::remove(m_queueJob.begin(), m_queueJob.end(), prsObject), m_queueJob.end());
+    m_mapProduct.erase(prsObject);
+    if (m_mapProduct.empty())
+        this->signalPendingChanged.send(false);
+}
+
+void MeshPreviewController::runNextJob()
+{
+    if (m_currentJob || m_queueJob.empty())
+        return;
+
+    auto job = std::make_unique<Job>();
+    job->prsObject = m_queueJob.front();
+    m_queueJob.pop_front();
+    Job* ptrJob = job.get();
+    const GraphicsObjectPtr prsObject = job->prsObject;
+    job->taskId = m_taskMgr.newTask([=](TaskProgress* progress) {
+        ptrJob->result = GraphicsMeshObjectDriver::createFullResolutionData(prsObject, progress);
+        ptrJob->isAborted = TaskProgress::isAbortRequested(progress);
+    });
+    const TaskId taskId = job->taskId;
+    m_currentJob = std::move(job);
+    m_taskMgr.run(taskId);
+}
+
+void MeshPreviewController::onJobEnded(TaskId taskId)
+{
+    if (!m_currentJob || m_currentJob->taskId != taskId)
+        return;
+
+    std::unique_ptr<Job> job = std::move(m_currentJob);
+    auto itProduct = m_mapProduct.find(job->prsObject);
+    if (itProduct != m_mapProduct.end() && !job->isAborted) {
+        GraphicsMeshObjectDriver::setFullResolutionData(job->prsObject, job->result);
+        const std::vector<GraphicsObjectPtr> vecInstance = itProduct->second;
+        const bool isReferenced = std::any_of(vecInstance.cbegin(), vecInstance.cend(), [&](const auto& object) {
+            return object != job->prsObject;
+        });
+        if (isReferenced) {
+            // Presentation and selection of the product are shared by its instances(see
+            // AIS_ConnectedInteractive), they have to be updated first
+            job->prsObject->Redisplay(true);
+            job->prsObject->RecomputePrimitives();
+        }
+
+        for (const GraphicsObjectPtr& object : vecInstance)
+            m_scene->recomputeObjectPresentation(object);
+
+        this->eraseProduct(job->prsObject);
+        m_scene->redraw();
+        this->signalObjectsCompleted.send(vecInstance);
+    }
+
+    this->runNextJob();
+}
+
+} // namespace Mayo
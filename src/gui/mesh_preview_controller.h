@@ -0,0 +1,80 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/task_manager.h"
+#include "../graphics/graphics_mesh_object_driver.h"
+#include "../graphics/graphics_object_ptr.h"
+
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Mayo {
+
+class GraphicsScene;
+
+// Provides progressive display of huge meshes
+//
+// Graphics objects of such meshes are first created with a preview(see
+// GraphicsMeshObjectDriver::isPreviewObject()), so they can be quickly displayed and inspected.
+// Full resolution data of the previews is then built in background(one mesh at a time) and swapped
+// with the preview once available
+// Graphics objects sharing the same presentation(ie AIS_ConnectedInteractive instances of a product)
+// are grouped, the presentation being completed once for all of them
+class MeshPreviewController {
+public:
+    MeshPreviewController(GraphicsScene* scene);
+    ~MeshPreviewController();
+
+    // Not copyable
+    MeshPreviewController(const MeshPreviewController&) = delete;
+    MeshPreviewController& operator=(const MeshPreviewController&) = delete;
+
+    // Registers/unregisters graphics object, nothing is done if it isn't a mesh preview
+    void addObject(const GraphicsObjectPtr& object);
+    void removeObject(const GraphicsObjectPtr& object);
+
+    // Count of mesh previews waiting for(or being completed with) full resolution data
+    int pendingPreviewCount() const { return int(m_mapProduct.size()); }
+
+    // Stops building of full resolution data, pending objects are left with their preview
+    void abort();
+
+    // Signals
+    // Emitted once the full resolution data of a preview is in place, with all the graphics
+    // objects sharing it. Their bounding boxes typically have to be updated
+    Signal<Span<const GraphicsObjectPtr>> signalObjectsCompleted;
+    // Emitted when pendingPreviewCount() changes from/to zero
+    Signal<bool> signalPendingChanged;
+
+private:
+    struct Job {
+        TaskId taskId = 0;
+        GraphicsObjectPtr prsObject;
+        GraphicsMeshObjectDriver::FullResolutionData result;
+        bool isAborted = false;
+    };
+
+    static GraphicsObjectPtr presentationObject(const GraphicsObjectPtr& object);
+    void eraseProduct(const GraphicsObjectPtr& prsObject);
+    void runNextJob();
+    void onJobEnded(TaskId taskId);
+
+    GraphicsScene* m_scene = nullptr;
+    // Instances of each pending product, keyed by the object owning the presentation
+    std::unordered_map<GraphicsObjectPtr, std::vector<GraphicsObjectPtr>> m_mapProduct;
+    std::deque<GraphicsObjectPtr> m_queueJob;
+    std::unique_ptr<Job> m_currentJob;
+    TaskManager m_taskMgr;
+    std::shared_ptr<bool> m_aliveToken = std::make_shared<bool>(true);
+};
+
+} // namespace Mayo
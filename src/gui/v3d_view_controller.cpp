@@ -71,6 +71,11 @@ bool V3dViewController::isWindowZoomingStarted() const
     return m_dynamicAction == DynamicAction::WindowZoom;
 }
 
+bool V3dViewController::isBoxSelectionStarted() const
+{
+    return m_dynamicAction == DynamicAction::BoxSelection;
+}
+
 void V3dViewController::rotation(const Position& currPos)
 {
     if (this->currentDynamicAction() != DynamicAction::Rotation)
@@ -135,6 +140,27 @@ void V3dViewController::windowZoom(const Position& currPos)
     this->hideRubberBand();
 }
 
+void V3dViewController::boxSelectionRubberBand(const Position& currPos)
+{
+    if (!this->isBoxSelectionStarted()) {
+        this->startDynamicAction(DynamicAction::BoxSelection);
+        m_posRubberBandStart = currPos;
+    }
+
+    this->drawRubberBand(m_posRubberBandStart, currPos);
+}
+
+void V3dViewController::boxSelection(const Position& currPos)
+{
+    this->hideRubberBand();
+    this->signalBoxSelected.send(
+                std::min(m_posRubberBandStart.x, currPos.x),
+                std::min(m_posRubberBandStart.y, currPos.y),
+                std::max(m_posRubberBandStart.x, currPos.x),
+                std::max(m_posRubberBandStart.y, currPos.y)
+    );
+}
+
 void V3dViewController::startInstantZoom(const Position& currPos)
 {
     this->startDynamicAction(DynamicAction::InstantZoom);
@@ -23,7 +23,8 @@ public:
         Rotation,
         Zoom,
         WindowZoom,
-        InstantZoom
+        InstantZoom,
+        BoxSelection
     };
 
     struct IRubberBand {
@@ -51,6 +52,7 @@ public:
     Signal<int, int> signalMouseMoved; // x,y: mouse position in view
     Signal<Aspect_VKeyMouse> signalMouseButtonClicked;
     Signal<bool> signalMultiSelectionToggled;
+    Signal<int, int, int, int> signalBoxSelected; // xMin,yMin,xMax,yMax: rectangle in view
 
 protected:
     struct Position { int x; int y; };
@@ -62,6 +64,7 @@ protected:
     bool isPanningStarted() const;
     bool isZoomStarted() const;
     bool isWindowZoomingStarted() const;
+    bool isBoxSelectionStarted() const;
 
     void rotation(const Position& currPos);
     void pan(const Position& prevPos, const Position& currPos);
@@ -72,6 +75,9 @@ protected:
     void windowZoomRubberBand(const Position& currPos);
     void windowZoom(const Position& currPos);
 
+    void boxSelectionRubberBand(const Position& currPos);
+    void boxSelection(const Position& currPos);
+
     void startInstantZoom(const Position& currPos);
     void stopInstantZoom();
 
@@ -19,16 +19,24 @@
 #include "../base/property_enumeration.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
+#include "../base/xcaf.h"
 #include "../graphics/graphics_scene.h"
 #include "../graphics/graphics_utils.h"
 #include "../gui/gui_application.h"
 
 #include <Aspect_Window.hxx>
+#include <BRep_Tool.hxx>
+#include <TDF_AttributeIterator.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <gp.hxx>
 #include <Graphic3d_GraphicDriver.hxx>
 #include <Image_AlienPixMap.hxx>
 #include <V3d_View.hxx>
 
 #include <gsl/util>
+#include <algorithm>
+#include <future>
 #include <limits>
 #include <unordered_set>
 
@@ -58,6 +66,11 @@ public:
 
         this->cameraOrientation.setDescription(
                     ImageWriterI18N::textIdTr("Camera orientation expressed in Z-up convention as a unit vector"));
+
+        this->cameraViews.setDescription(
+                    ImageWriterI18N::textIdTr("With standard views, one image file is written for each view "
+                                              "(isometric, front, back, left, right, top and bottom) with "
+                                              "file name suffixed by the view name"));
     }
 
     void restoreDefaults() override {
@@ -67,6 +80,7 @@ public:
         this->backgroundColor.setValue(defaults.backgroundColor);
         this->cameraOrientation.setValue(defaults.cameraOrientation);
         this->cameraProjection.setValue(defaults.cameraProjection);
+        this->cameraViews.setValue(defaults.cameraViews);
     }
 
     PropertyInt width{ this, ImageWriterI18N::textId("width") };
@@ -74,6 +88,7 @@ public:
     PropertyOccColor backgroundColor{ this, ImageWriterI18N::textId("backgroundColor") };
     PropertyOccVec cameraOrientation{ this, ImageWriterI18N::textId("cameraOrientation") };
     PropertyEnum<CameraProjection> cameraProjection{ this, ImageWriterI18N::textId("cameraProjection") };
+    PropertyEnum<CameraViews> cameraViews{ this, ImageWriterI18N::textId("cameraViews") };
 };
 
 namespace {
@@ -83,10 +98,85 @@ bool isVectorNull(const gp_Vec& vec)
     return vec.IsEqual({}, Precision::Confusion(), Precision::Angular());
 }
 
+// Applies camera and background parameters to 'view'
+void setV3dViewParameters(const Handle_V3d_View& view, const ImageWriter::Parameters& params)
+{
+    auto fnToGfxCamProjection = [](ImageWriter::CameraProjection proj) {
+        switch (proj) {
+        case ImageWriter::CameraProjection::Orthographic: return Graphic3d_Camera::Projection_Orthographic;
+        case ImageWriter::CameraProjection::Perspective:  return Graphic3d_Camera::Projection_Perspective;
+        default: return Graphic3d_Camera::Projection_Orthographic;
+        }
+    };
+
+    view->SetBackgroundColor(params.backgroundColor);
+    view->Camera()->SetProjectionType(fnToGfxCamProjection(params.cameraProjection));
+    const gp_Vec vecOrientation = !isVectorNull(params.cameraOrientation) ? params.cameraOrientation : gp_Vec(1, -1, 1);
+    // Camera is set directly as the view might be reused: V3d_View::SetProj() fails when the new
+    // orientation is parallel to the current up direction
+    // Z-up convention, except when looking along Z axis
+    const Handle_Graphic3d_Camera& camera = view->Camera();
+    const bool isAlongZ = vecOrientation.IsParallel(gp_Vec(gp::DZ()), Precision::Angular());
+    camera->SetDirection(gp_Dir(vecOrientation.Reversed()));
+    camera->SetUp(isAlongZ ? gp::DY() : gp::DZ());
+    camera->OrthogonalizeUp();
+}
+
+// Shots of the standard views, image file of each shot is 'filepath' suffixed with the view name
+std::vector<ImageWriter::Shot> standardViewShots(const FilePath& filepath, const gp_Vec& vecIsometric)
+{
+    const std::pair<const char*, gp_Vec> arrayView[] = {
+        { "iso", vecIsometric },
+        { "front", gp_Vec(0, -1, 0) },
+        { "back", gp_Vec(0, 1, 0) },
+        { "left", gp_Vec(-1, 0, 0) },
+        { "right", gp_Vec(1, 0, 0) },
+        { "top", gp_Vec(0, 0, 1) },
+        { "bottom", gp_Vec(0, 0, -1) }
+    };
+    std::vector<ImageWriter::Shot> vecShot;
+    for (const auto& view : arrayView) {
+        FilePath viewFilepath = filepath;
+        viewFilepath.replace_filename(filepath.stem());
+        viewFilepath += "_";
+        viewFilepath += view.first;
+        viewFilepath += filepath.extension();
+        vecShot.push_back({ view.second, viewFilepath });
+    }
+
+    return vecShot;
+}
+
+// Data a graphics object of 'label' is computed from: attributes of the label, shape and meshes of
+// its faces. Re-meshing replaces face triangulations, so comparing such data tells whether a graphics
+// object created previously is outdated
+std::vector<Handle_Standard_Transient> graphicsSourceData(const TDF_Label& label)
+{
+    std::vector<Handle_Standard_Transient> vecData;
+    for (TDF_AttributeIterator it(label); it.More(); it.Next())
+        vecData.push_back(Handle_Standard_Transient(it.Value()));
+
+    const TopoDS_Shape shape = XCaf::isShape(label) ? XCaf::shape(label) : TopoDS_Shape();
+    if (!shape.IsNull()) {
+        vecData.push_back(shape.TShape());
+        for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+            TopLoc_Location locFace;
+            vecData.push_back(BRep_Tool::Triangulation(TopoDS::Face(expl.Current()), locFace));
+        }
+    }
+
+    return vecData;
+}
+
 } // namespace
 
 ImageWriter::ImageWriter(GuiApplication* guiApp)
-    : m_guiApp(guiApp)
+    : m_renderer(std::make_shared<ImageRenderer>(guiApp))
+{
+}
+
+ImageWriter::ImageWriter(const std::shared_ptr<ImageRenderer>& renderer)
+    : m_renderer(renderer)
 {
 }
 
@@ -102,41 +192,57 @@ bool ImageWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /
 
 bool ImageWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
 {
-    if (isVectorNull(m_params.cameraOrientation))
-        this->messenger()->emitError(ImageWriterI18N::textIdTr("Camera orientation vector must not be null"));
+    return this->writeFiles(this->shots(filepath), progress);
+}
 
-    // Create 3D view
-    GraphicsScene gfxScene;
-    Handle_V3d_View view = ImageWriter::createV3dView(&gfxScene, m_params);
+std::vector<ImageWriter::Shot> ImageWriter::shots(const FilePath& filepath) const
+{
+    if (m_params.cameraViews == CameraViews::Standard)
+        return standardViewShots(filepath, m_params.cameraOrientation);
 
-    const int itemCount = CppUtils::safeStaticCast<int>(m_vecAppItem.size());
-    // Render application items
-    for (const ApplicationItem& appItem : m_vecAppItem) {
-        if (appItem.isDocument()) {
-            // Iterate other root entities
-            const DocumentPtr doc = appItem.document();
-            for (int i = 0; i < doc->entityCount(); ++i) {
-                const TDF_Label labelEntity = doc->entityLabel(i);
-                gfxScene.addObject(m_guiApp->createGraphicsObject(labelEntity));
-            }
-        }
-        else if (appItem.isDocumentTreeNode()) {
-            const TDF_Label labelNode = appItem.documentTreeNode().label();
-            gfxScene.addObject(m_guiApp->createGraphicsObject(labelNode));
-        }
+    return { Shot{ m_params.cameraOrientation, filepath } };
+}
 
-        const auto itemProgress = &appItem - &m_vecAppItem.front();
-        progress->setValue(MathUtils::toPercent(itemProgress, 0, itemCount));
+bool ImageWriter::writeFiles(Span<const Shot> spanShot, TaskProgress* progress)
+{
+    for (const Shot& shot : spanShot) {
+        if (isVectorNull(shot.cameraOrientation)) {
+            this->messenger()->emitError(ImageWriterI18N::textIdTr("Camera orientation vector must not be null"));
+            return false;
+        }
     }
 
-    gfxScene.redraw();
-    GraphicsUtils::V3dView_fitAll(view);
-    Handle_Image_AlienPixMap pixmap = ImageWriter::createImage(view);
-    if (!pixmap)
+    // Only rendering takes place in the renderer thread, image files are encoded in this thread
+    std::vector<Handle_Image_AlienPixMap> vecPixmap;
+    m_renderer->exec([&]{
+        // Release the graphics objects once rendering is done, they would keep documents alive
+        auto _ = gsl::finally([=]{ m_renderer->setItems({}); });
+        m_renderer->setItems(m_vecAppItem);
+        for (const Shot& shot : spanShot) {
+            Parameters params = m_params;
+            params.cameraOrientation = shot.cameraOrientation;
+            Handle_Image_AlienPixMap pixmap = m_renderer->renderImage(params);
+            if (!pixmap)
+                return;
+
+            vecPixmap.push_back(pixmap);
+        }
+    });
+
+    if (vecPixmap.size() != spanShot.size())
         return false;
 
-    const bool okSave = pixmap->Save(filepathTo<TCollection_AsciiString>(filepath));
-    return okSave;
+    const int shotCount = CppUtils::safeStaticCast<int>(spanShot.size());
+    for (const Shot& shot : spanShot) {
+        const Handle_Image_AlienPixMap& pixmap = vecPixmap.at(&shot - &spanShot.front());
+        if (!pixmap->Save(filepathTo<TCollection_AsciiString>(shot.filepath)))
+            return false;
+
+        const auto shotProgress = &shot - &spanShot.front() + 1;
+        progress->setValue(MathUtils::toPercent(shotProgress, 0, shotCount));
+    }
+
+    return true;
 }
 
 std::unique_ptr<PropertyGroup> ImageWriter::createProperties(PropertyGroup* parentGroup)
@@ -153,6 +259,7 @@ void ImageWriter::applyProperties(const PropertyGroup* params)
         m_params.backgroundColor = ptr->backgroundColor;
         m_params.cameraOrientation = ptr->cameraOrientation;
         m_params.cameraProjection = ptr->cameraProjection;
+        m_params.cameraViews = ptr->cameraViews;
     }
 }
 
@@ -197,24 +304,11 @@ Handle_Image_AlienPixMap ImageWriter::createImage(Handle_V3d_View view)
 
 Handle_V3d_View ImageWriter::createV3dView(GraphicsScene* gfxScene, const Parameters& params)
 {
-    auto fnToGfxCamProjection = [](ImageWriter::CameraProjection proj) {
-        switch (proj) {
-        case CameraProjection::Orthographic: return Graphic3d_Camera::Projection_Orthographic;
-        case CameraProjection::Perspective:  return Graphic3d_Camera::Projection_Perspective;
-        default: return Graphic3d_Camera::Projection_Orthographic;
-        }
-    };
-
     // Create 3D view
     Handle_V3d_View view = gfxScene->createV3dView();
     view->ChangeRenderingParams().IsAntialiasingEnabled = true;
     view->ChangeRenderingParams().NbMsaaSamples = 4;
-    view->SetBackgroundColor(params.backgroundColor);
-    view->Camera()->SetProjectionType(fnToGfxCamProjection(params.cameraProjection));
-    if (!isVectorNull(params.cameraOrientation))
-        view->SetProj(params.cameraOrientation.X(), params.cameraOrientation.Y(), params.cameraOrientation.Z());
-    else
-        view->SetProj(1, -1, 1);
+    setV3dViewParameters(view, params);
 
     // Create virtual window
     auto wnd = graphicsCreateVirtualWindow(view->Viewer()->Driver(), params.width, params.height);
@@ -223,8 +317,195 @@ Handle_V3d_View ImageWriter::createV3dView(GraphicsScene* gfxScene, const Parame
     return view;
 }
 
+ImageRenderer::ImageRenderer(GuiApplication* guiApp)
+    : m_guiApp(guiApp),
+      m_thread([=]{ this->runJobs(); })
+{
+    m_connDocumentAboutToClose = guiApp->application()->signalDocumentAboutToClose.connectSlot(
+                &ImageRenderer::onDocumentAboutToClose, this
+    );
+}
+
+ImageRenderer::~ImageRenderer()
+{
+    m_connDocumentAboutToClose.disconnect();
+    // Graphics resources have to be released in the rendering thread
+    this->post([=]{
+        m_mapLabelObject.clear();
+        m_view.Nullify();
+        m_gfxScene.reset();
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutexJob);
+        m_isStopRequested = true;
+    }
+
+    m_condJob.notify_all();
+    m_thread.join();
+}
+
+void ImageRenderer::exec(const std::function<void()>& fn)
+{
+    if (std::this_thread::get_id() == m_thread.get_id()) {
+        fn(); // Nested call
+        return;
+    }
+
+    std::packaged_task<void()> task(fn);
+    std::future<void> future = task.get_future();
+    this->post([&]{ task(); });
+    future.get();
+}
+
+void ImageRenderer::post(const std::function<void()>& fn)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutexJob);
+        m_queueJob.push_back(fn);
+    }
+
+    m_condJob.notify_one();
+}
+
+void ImageRenderer::runJobs()
+{
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutexJob);
+            m_condJob.wait(lock, [=]{ return !m_queueJob.empty() || m_isStopRequested; });
+            if (m_queueJob.empty())
+                return; // Stop requested, all jobs done
+
+            job = std::move(m_queueJob.front());
+            m_queueJob.pop_front();
+        }
+
+        // Note: exceptions of exec() jobs are forwarded to the caller by std::packaged_task
+        try {
+            job();
+        } catch (...) {
+        }
+    }
+}
+
+void ImageRenderer::setItems(Span<const ApplicationItem> appItems)
+{
+    if (!m_gfxScene)
+        m_gfxScene = std::make_unique<GraphicsScene>();
+
+    // Labels of the graphics objects to be displayed, along with the identifier of their document
+    std::unordered_map<TDF_Label, Document::Identifier> mapLabelDocId;
+    for (const ApplicationItem& appItem : appItems) {
+        if (appItem.isDocument()) {
+            // Iterate other root entities
+            const DocumentPtr doc = appItem.document();
+            for (int i = 0; i < doc->entityCount(); ++i)
+                mapLabelDocId.insert({ doc->entityLabel(i), doc->identifier() });
+        }
+        else if (appItem.isDocumentTreeNode()) {
+            const DocumentTreeNode& node = appItem.documentTreeNode();
+            mapLabelDocId.insert({ node.label(), node.document()->identifier() });
+        }
+    }
+
+    // Erase objects not needed anymore or computed from outdated data, the others are kept with
+    // their computed presentations
+    std::unordered_map<TDF_Label, std::vector<Handle_Standard_Transient>> mapLabelSourceData;
+    for (auto it = m_mapLabelObject.begin(); it != m_mapLabelObject.end(); ) {
+        auto itFound = mapLabelDocId.find(it->first);
+        bool isUpToDate = itFound != mapLabelDocId.cend() && itFound->second == it->second.docId;
+        if (isUpToDate) {
+            std::vector<Handle_Standard_Transient> vecSourceData = graphicsSourceData(it->first);
+            isUpToDate = vecSourceData == it->second.vecSourceData;
+            mapLabelSourceData.insert({ it->first, std::move(vecSourceData) });
+        }
+
+        if (!isUpToDate) {
+            m_gfxScene->eraseObject(it->second.object);
+            it = m_mapLabelObject.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (const auto& [label, docId] : mapLabelDocId) {
+        if (m_mapLabelObject.find(label) != m_mapLabelObject.cend())
+            continue;
+
+        GraphicsObjectPtr object = m_guiApp->createGraphicsObject(label);
+        if (object) {
+            m_gfxScene->addObject(object);
+            auto itSourceData = mapLabelSourceData.find(label);
+            LabelObject labelObject;
+            labelObject.docId = docId;
+            labelObject.object = object;
+            labelObject.vecSourceData =
+                    itSourceData != mapLabelSourceData.end() ?
+                        std::move(itSourceData->second) :
+                        graphicsSourceData(label);
+            m_mapLabelObject.insert({ label, std::move(labelObject) });
+        }
+    }
+}
+
+Handle_Image_AlienPixMap ImageRenderer::renderImage(const ImageWriter::Parameters& params)
+{
+    if (!m_gfxScene)
+        m_gfxScene = std::make_unique<GraphicsScene>();
+
+    if (!m_view) {
+        m_view = ImageWriter::createV3dView(m_gfxScene.get(), params);
+    }
+    else {
+        setV3dViewParameters(m_view, params);
+        int wndWidth, wndHeight;
+        m_view->Window()->Size(wndWidth, wndHeight);
+        if (wndWidth != params.width || wndHeight != params.height)
+            m_view->SetWindow(graphicsCreateVirtualWindow(m_view->Viewer()->Driver(), params.width, params.height));
+    }
+
+    m_gfxScene->redraw();
+    GraphicsUtils::V3dView_fitAll(m_view);
+    return ImageWriter::createImage(m_view);
+}
+
+GraphicsObjectPtr ImageRenderer::findObject(const TDF_Label& label) const
+{
+    auto it = m_mapLabelObject.find(label);
+    return it != m_mapLabelObject.cend() ? it->second.object : GraphicsObjectPtr{};
+}
+
+void ImageRenderer::onDocumentAboutToClose(const DocumentPtr& doc)
+{
+    // Don't wait for a rendering in progress, objects are erased once it's done
+    const Document::Identifier docId = doc->identifier();
+    this->post([=]{ this->eraseDocumentObjects(Span<const Document::Identifier>(&docId, 1)); });
+}
+
+// Labels of closed documents must not be accessed, objects are found with document identifiers
+void ImageRenderer::eraseDocumentObjects(Span<const Document::Identifier> spanDocId)
+{
+    if (spanDocId.empty())
+        return;
+
+    for (auto it = m_mapLabelObject.begin(); it != m_mapLabelObject.end(); ) {
+        const Document::Identifier docId = it->second.docId;
+        if (std::find(spanDocId.begin(), spanDocId.end(), docId) != spanDocId.end()) {
+            m_gfxScene->eraseObject(it->second.object);
+            it = m_mapLabelObject.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
 ImageFactoryWriter::ImageFactoryWriter(GuiApplication* guiApp)
-    : m_guiApp(guiApp)
+    : m_guiApp(guiApp),
+      m_renderer(std::make_shared<ImageRenderer>(guiApp))
 {
 }
 
@@ -237,7 +518,7 @@ Span<const Format> ImageFactoryWriter::formats() const
 std::unique_ptr<Writer> ImageFactoryWriter::create(Format format) const
 {
     if (format == Format_Image)
-        return std::make_unique<ImageWriter>(m_guiApp);
+        return std::make_unique<ImageWriter>(m_renderer);
 
     return {};
 }
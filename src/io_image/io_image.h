@@ -9,7 +9,10 @@
 #include "../base/io_writer.h"
 #include "../base/application_item.h"
 #include "../base/caf_utils.h"
+#include "../base/document.h"
+#include "../base/signal.h"
 #include "../base/tkernel_utils.h"
+#include "../graphics/graphics_object_ptr.h"
 
 #include <gp_Dir.hxx>
 #include <Image_AlienPixMap.hxx>
@@ -17,6 +20,13 @@
 #include <TDF_Label.hxx>
 #include <V3d_View.hxx>
 
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
 // Pre-decls
@@ -29,13 +39,28 @@ class GuiDocument;
 namespace Mayo {
 namespace IO {
 
+class ImageRenderer;
+
 class ImageWriter : public Writer {
 public:
     ImageWriter(GuiApplication* guiApp);
+    // Use 'renderer' instead of a graphics scene built for each writeFile() call
+    ImageWriter(const std::shared_ptr<ImageRenderer>& renderer);
 
     bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
     bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
 
+    // Batch version of writeFile(): transferred items are rendered once for each shot, graphics
+    // scene being built just once
+    struct Shot {
+        gp_Vec cameraOrientation;
+        FilePath filepath;
+    };
+    bool writeFiles(Span<const Shot> spanShot, TaskProgress* progress);
+
+    // Shots written by writeFile() for 'filepath', depending on parameter 'cameraViews'
+    std::vector<Shot> shots(const FilePath& filepath) const;
+
     static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* params) override;
 
@@ -44,12 +69,20 @@ public:
         Perspective, Orthographic
     };
 
+    // Single: one image with 'cameraOrientation'
+    // Standard: one image per standard view(isometric with 'cameraOrientation', front, back, left,
+    // right, top and bottom), image files are suffixed with the view name
+    enum class CameraViews {
+        Single, Standard
+    };
+
     struct Parameters {
         int width = 128;
         int height = 128;
         Quantity_Color backgroundColor = Quantity_NOC_BLACK;
         gp_Vec cameraOrientation = gp_Vec(1, -1, 1); // X+ Y- Z+
         CameraProjection cameraProjection = CameraProjection::Orthographic;
+        CameraViews cameraViews = CameraViews::Single;
     };
     Parameters& parameters() { return m_params; }
     const Parameters& constParameters() const { return m_params; }
@@ -61,11 +94,70 @@ public:
 
 private:
     class Properties;
-    GuiApplication* m_guiApp = nullptr;
+    std::shared_ptr<ImageRenderer> m_renderer;
     Parameters m_params;
     std::vector<ApplicationItem> m_vecAppItem;
 };
 
+// Provides a persistent offscreen rendering context: graphics scene and 3D view(with virtual window)
+// are created once and reused for all the images
+// All graphics operations are executed by a thread owned by the renderer, so the OpenGL context is
+// always used from that same thread whatever the threads of the client code(eg concurrent
+// ImageWriter objects). Client code runs its rendering operations with exec()
+// Graphics objects are kept between renderings, so presentations aren't computed again when the
+// same items are rendered several times(eg with different camera orientations). An object is
+// created again if the data it was computed from changed meanwhile(eg shape re-meshed)
+class ImageRenderer {
+public:
+    ImageRenderer(GuiApplication* guiApp);
+    ~ImageRenderer();
+
+    // Not copyable
+    ImageRenderer(const ImageRenderer&) = delete;
+    ImageRenderer& operator=(const ImageRenderer&) = delete;
+
+    // Executes 'fn' in the rendering thread and waits for its completion, exception thrown by 'fn'
+    // is rethrown. Calls are serialized, so 'fn' has exclusive access to the renderer
+    // The other functions below must be called from within 'fn'
+    void exec(const std::function<void()>& fn);
+
+    // Updates the graphics scene so it contains only the objects of 'appItems'
+    void setItems(Span<const ApplicationItem> appItems);
+
+    // Renders the graphics scene, camera is adjusted to fit all objects
+    Handle_Image_AlienPixMap renderImage(const ImageWriter::Parameters& params);
+
+    // Graphics object currently in the scene for 'label', null if none
+    GraphicsObjectPtr findObject(const TDF_Label& label) const;
+    int objectCount() const { return int(m_mapLabelObject.size()); }
+
+private:
+    struct LabelObject {
+        Document::Identifier docId = -1;
+        GraphicsObjectPtr object;
+        std::vector<Handle_Standard_Transient> vecSourceData; // See graphicsSourceData()
+    };
+
+    void post(const std::function<void()>& fn);
+    void runJobs();
+
+    void onDocumentAboutToClose(const DocumentPtr& doc);
+    void eraseDocumentObjects(Span<const Document::Identifier> spanDocId);
+
+    GuiApplication* m_guiApp = nullptr;
+    std::unique_ptr<GraphicsScene> m_gfxScene; // Created on first use
+    Handle_V3d_View m_view;
+    std::unordered_map<TDF_Label, LabelObject> m_mapLabelObject;
+    SignalConnectionHandle m_connDocumentAboutToClose;
+
+    // Queue of jobs executed by the rendering thread
+    std::mutex m_mutexJob;
+    std::condition_variable m_condJob;
+    std::deque<std::function<void()>> m_queueJob;
+    bool m_isStopRequested = false;
+    std::thread m_thread; // Declared last so it's started once the other members are initialized
+};
+
 class ImageFactoryWriter : public FactoryWriter {
 public:
     ImageFactoryWriter(GuiApplication* guiApp);
@@ -75,6 +167,7 @@ public:
 
 private:
     GuiApplication* m_guiApp = nullptr;
+    std::shared_ptr<ImageRenderer> m_renderer; // Shared by all created ImageWriter objects
 };
 
 } // namespace IO
@@ -12,6 +12,7 @@
 #include "../base/triangulation_annex_data.h"
 #include "../base/document.h"
 #include "../base/filepath_conv.h"
+#include "../base/mesh_utils.h"
 #include "../base/messenger.h"
 #include "../base/occ_progress_indicator.h"
 #include "../base/property_enumeration.h"
@@ -25,6 +26,14 @@
 #include <TDataStd_Name.hxx>
 #include <TopoDS_Compound.hxx>
 
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
 namespace Mayo {
 namespace IO {
 
@@ -50,6 +59,145 @@ static TopoDS_Shape asShape(const DocumentPtr& doc)
     return shape;
 }
 
+// Preview meshes are read directly from the STL file by sampling its facets
+// Binary STL has fixed-size facet records, any facet can be read without parsing the others
+// ASCII STL is sampled at regular file offsets, reading the first facet found after each offset
+
+constexpr int StlBinaryHeaderSize = 84; // 80 bytes header + 32 bits facet count
+constexpr int StlBinaryFacetSize = 50; // Normal and vertices(32 bits floats) + 16 bits attribute
+constexpr int StlAsciiChunkSize = 1024; // Large enough to contain a facet
+
+using StlFacet = std::array<gp_Pnt, 3>;
+
+// Facet count if 'ifs' is a binary STL file, zero otherwise
+uint32_t binaryStlFacetCount(std::ifstream& ifs, uintmax_t fileSize)
+{
+    if (fileSize < StlBinaryHeaderSize)
+        return 0;
+
+    unsigned char buff[4] = {};
+    ifs.seekg(80);
+    ifs.read(reinterpret_cast<char*>(buff), 4);
+    const uint32_t facetCount = buff[0] | (buff[1] << 8) | (buff[2] << 16) | (uint32_t(buff[3]) << 24);
+    // Same test as RWStl
+    const uintmax_t expectedFileSize = StlBinaryHeaderSize + uintmax_t(StlBinaryFacetSize) * facetCount;
+    return ifs && fileSize == expectedFileSize ? facetCount : 0;
+}
+
+std::vector<StlFacet> sampledBinaryStlFacets(std::ifstream& ifs, uint32_t facetCount, int maxFacetCount)
+{
+    std::vector<StlFacet> vecFacet;
+    if (facetCount <= uint32_t(maxFacetCount))
+        return vecFacet; // Small enough to be displayed as is
+
+    const uint32_t step = (facetCount + maxFacetCount - 1) / maxFacetCount;
+    vecFacet.reserve(facetCount / step + 1);
+    for (uint32_t i = 0; i < facetCount; i += step) {
+        char buff[36];
+        ifs.seekg(StlBinaryHeaderSize + uintmax_t(StlBinaryFacetSize) * i + 12/*normal*/);
+        if (!ifs.read(buff, sizeof(buff)))
+            break;
+
+        StlFacet facet;
+        for (int j = 0; j < 3; ++j) {
+            float coords[3];
+            std::memcpy(coords, buff + 12 * j, 12); // Little-endian assumed, as RWStl does
+            facet.at(j).SetCoord(coords[0], coords[1], coords[2]);
+        }
+
+        vecFacet.push_back(facet);
+    }
+
+    return vecFacet;
+}
+
+// Parses the first facet found in 'text' from position 'pos'
+// Returns the position where the facet begins, std::string::npos if there is no complete facet
+size_t parseAsciiStlFacet(const std::string& text, size_t pos, StlFacet* facet)
+{
+    const size_t posFacet = text.find("outer loop", pos);
+    if (posFacet == std::string::npos)
+        return std::string::npos;
+
+    const char* str = text.c_str() + posFacet;
+    for (gp_Pnt& pnt : *facet) {
+        str = std::strstr(str, "vertex");
+        if (!str)
+            return std::string::npos;
+
+        str += 6;
+        double coords[3];
+        for (double& coord : coords) {
+            char* strEnd = nullptr;
+            coord = std::strtod(str, &strEnd);
+            if (strEnd == str)
+                return std::string::npos;
+
+            str = strEnd;
+        }
+
+        pnt.SetCoord(coords[0], coords[1], coords[2]);
+    }
+
+    return posFacet;
+}
+
+std::vector<StlFacet> sampledAsciiStlFacets(std::ifstream& ifs, uintmax_t fileSize, int maxFacetCount)
+{
+    auto fnReadChunk = [&](uintmax_t offset) {
+        std::string chunk(StlAsciiChunkSize, '\0');
+        ifs.clear();
+        ifs.seekg(offset);
+        ifs.read(chunk.data(), chunk.size());
+        chunk.resize(ifs.gcount());
+        return chunk;
+    };
+
+    // Facet count is estimated with the size of the first facet
+    std::vector<StlFacet> vecFacet;
+    StlFacet facet;
+    const std::string firstChunk = fnReadChunk(0);
+    const size_t posFirstFacet = parseAsciiStlFacet(firstChunk, 0, &facet);
+    const size_t posSecondFacet = posFirstFacet != std::string::npos ?
+                parseAsciiStlFacet(firstChunk, posFirstFacet + 1, &facet) :
+                std::string::npos;
+    if (posSecondFacet == std::string::npos)
+        return vecFacet;
+
+    const uintmax_t facetSize = posSecondFacet - posFirstFacet;
+    if (fileSize / facetSize <= uintmax_t(maxFacetCount))
+        return vecFacet; // Small enough to be displayed as is
+
+    vecFacet.reserve(maxFacetCount);
+    uintmax_t lastFacetOffset = 0;
+    for (int i = 0; i < maxFacetCount; ++i) {
+        const uintmax_t offset = posFirstFacet + (fileSize - posFirstFacet) * i / maxFacetCount;
+        const std::string chunk = fnReadChunk(offset);
+        const size_t posFacet = parseAsciiStlFacet(chunk, 0, &facet);
+        if (posFacet != std::string::npos && (vecFacet.empty() || offset + posFacet > lastFacetOffset)) {
+            vecFacet.push_back(facet);
+            lastFacetOffset = offset + posFacet;
+        }
+    }
+
+    return vecFacet;
+}
+
+Handle_Poly_Triangulation createPreviewMesh(const std::vector<StlFacet>& vecFacet)
+{
+    // Nodes aren't shared by facets, which is enough for display
+    const int facetCount = int(vecFacet.size());
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(3 * facetCount, facetCount, false/*!hasUvNodes*/);
+    for (int i = 0; i < facetCount; ++i) {
+        for (int j = 0; j < 3; ++j)
+            MeshUtils::setNode(mesh, 3 * i + j + 1, vecFacet.at(i).at(j));
+
+        MeshUtils::setTriangle(mesh, i + 1, Poly_Triangle(3 * i + 1, 3 * i + 2, 3 * i + 3));
+    }
+
+    return mesh;
+}
+
 } // namespace
 
 struct OccStlWriterI18N {
@@ -79,6 +227,24 @@ bool OccStlReader::readFile(const FilePath& filepath, TaskProgress* progress)
     return !m_mesh.IsNull();
 }
 
+Handle_Poly_Triangulation OccStlReader::readPreviewMesh(const FilePath& filepath, int maxTriangleCount)
+{
+    std::ifstream ifs(filepath, std::ios::binary);
+    if (!ifs.is_open() || maxTriangleCount <= 0)
+        return {};
+
+    const uintmax_t fileSize = filepathFileSize(filepath);
+    const uint32_t binaryFacetCount = binaryStlFacetCount(ifs, fileSize);
+    const std::vector<StlFacet> vecFacet =
+            binaryFacetCount != 0 ?
+                sampledBinaryStlFacets(ifs, binaryFacetCount, maxTriangleCount) :
+                sampledAsciiStlFacets(ifs, fileSize, maxTriangleCount);
+    if (vecFacet.empty())
+        return {};
+
+    return createPreviewMesh(vecFacet);
+}
+
 TDF_LabelSequence OccStlReader::transfer(DocumentPtr doc, TaskProgress* /*progress*/)
 {
     if (m_mesh.IsNull())
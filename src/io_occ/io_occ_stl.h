@@ -18,6 +18,7 @@ namespace IO {
 class OccStlReader : public Reader {
 public:
     bool readFile(const FilePath& filepath, TaskProgress* progress) override;
+    Handle_Poly_Triangulation readPreviewMesh(const FilePath& filepath, int maxTriangleCount) override;
     TDF_LabelSequence transfer(DocumentPtr doc, TaskProgress* progress) override;
     void applyProperties(const PropertyGroup*) override {}
 
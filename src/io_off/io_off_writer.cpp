@@ -7,26 +7,75 @@
 #include "io_off_writer.h"
 
 #include "../base/caf_utils.h"
+#include "../base/cpp_utils.h"
 #include "../base/document.h"
 #include "../base/label_data.h"
 #include "../base/io_system.h"
+#include "../base/math_utils.h"
 #include "../base/mesh_access.h"
+#include "../base/mesh_decimation.h"
+#include "../base/mesh_utils.h"
 #include "../base/messenger.h"
 #include "../base/property_builtins.h"
 #include "../base/task_progress.h"
 #include "../base/text_id.h"
+#include "../base/unit_system.h"
 
 #include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
 
 #include <fstream>
 #include <locale>
+#include <optional>
 #include <string>
+#include <vector>
 
 namespace Mayo {
 namespace IO {
 
 struct OffWriterI18N { MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::IO::OffWriterI18N) };
 
+class OffWriter::Properties : public PropertyGroup {
+public:
+    Properties(PropertyGroup* parentGroup)
+        : PropertyGroup(parentGroup)
+    {
+        this->cleanupMeshes.setDescription(
+                    OffWriterI18N::textIdTr("Merge coincident mesh nodes and remove degenerate triangles. "
+                                            "Meshes coming from BRep shapes have duplicated nodes along "
+                                            "the boundaries of faces"));
+        this->weldTolerance.setDescription(
+                    OffWriterI18N::textIdTr("Mesh nodes closer than this distance are merged, only exactly "
+                                            "coincident nodes are merged if zero"));
+        this->decimateMeshes.setDescription(
+                    OffWriterI18N::textIdTr("Simplify meshes so they have less triangles. Boundaries and "
+                                            "colors of meshes are preserved"));
+        this->decimationTargetRatio.setDescription(
+                    OffWriterI18N::textIdTr("Count of triangles to keep relative to the input count"));
+        this->decimationTargetRatio.setRange(0., 1.);
+        this->decimationTargetRatio.setSingleStep(0.05);
+        this->decimationTargetRatio.setConstraintsEnabled(true);
+        this->decimationMaxError.setDescription(
+                    OffWriterI18N::textIdTr("Maximum deviation of simplified meshes from the input meshes, "
+                                            "not limited if zero"));
+    }
+
+    void restoreDefaults() override {
+        const OffWriter::Parameters defaultParams;
+        this->cleanupMeshes.setValue(defaultParams.cleanupMeshes);
+        this->weldTolerance.setQuantity(defaultParams.weldTolerance * Quantity_Millimeter);
+        this->decimateMeshes.setValue(defaultParams.decimateMeshes);
+        this->decimationTargetRatio.setValue(defaultParams.decimationTargetRatio);
+        this->decimationMaxError.setQuantity(defaultParams.decimationMaxError * Quantity_Millimeter);
+    }
+
+    PropertyBool cleanupMeshes{ this, OffWriterI18N::textId("cleanupMeshes") };
+    PropertyLength weldTolerance{ this, OffWriterI18N::textId("weldTolerance") };
+    PropertyBool decimateMeshes{ this, OffWriterI18N::textId("decimateMeshes") };
+    PropertyDouble decimationTargetRatio{ this, OffWriterI18N::textId("decimationTargetRatio") };
+    PropertyLength decimationMaxError{ this, OffWriterI18N::textId("decimationMaxError") };
+};
+
 bool OffWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* /*progress*/)
 {
     m_vecTreeNode.clear();
@@ -50,71 +99,133 @@ bool OffWriter::writeFile(const FilePath& filepath, TaskProgress* progress)
     fstr.imbue(std::locale::classic());
     fstr << "OFF\n";
 
-    // Count vertices and facets
-    int vertexCount = 0;
-    int facetCount = 0;
-    for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
-        IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            vertexCount += mesh.triangulation()->NbNodes();
-            facetCount += mesh.triangulation()->NbTriangles();
-        });
+    // Decimate meshes in parallel
+    MeshDecimation::ResultMap mapDecimatedMesh;
+    if (m_params.decimateMeshes) {
+        TaskProgress decimationProgress(progress, 50, OffWriterI18N::textIdTr("Decimate meshes"));
+        MeshDecimation::Options options;
+        options.targetRatio = m_params.decimationTargetRatio;
+        options.maxError = m_params.decimationMaxError;
+        mapDecimatedMesh = MeshDecimation::runParallel(m_vecTreeNode, options, &decimationProgress);
+        if (decimationProgress.isAbortRequested())
+            return false;
+    }
+
+    // Gather vertices and facets(triangles)
+    // Meshes are visited once whatever their instance count, then recorded for each instance
+    std::vector<gp_Pnt> vecVertex;
+    std::vector<std::optional<Quantity_Color>> vecVertexColor;
+    std::vector<MeshUtils::Triangle> vecFacet;
+    IMeshAccess_visitMeshInstances(m_vecTreeNode, [&](const IMeshInstancesAccess& meshInstances) {
+        const IMeshAccess& mesh = meshInstances.mesh();
+        const MeshDecimation::Result* decimatedMesh = mapDecimatedMesh.find(mesh);
+        const Handle(Poly_Triangulation)& triangulation = decimatedMesh ? decimatedMesh->mesh : mesh.triangulation();
+        for (const TopLoc_Location& loc : meshInstances.instanceLocations()) {
+            const int offsetVertex = CppUtils::safeStaticCast<int>(vecVertex.size());
+            const gp_Trsf& meshTrsf = loc.Transformation();
+            for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+                const int sourceNode = decimatedMesh ? decimatedMesh->sourceNodes.at(i - 1) : i - 1;
+                vecVertex.push_back(triangulation->Node(i).Transformed(meshTrsf));
+                vecVertexColor.push_back(mesh.nodeColor(sourceNode));
+            }
+
+            for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+                const Poly_Triangle& tri = triangulation->Triangle(i);
+                vecFacet.push_back({
+                        offsetVertex + tri.Value(1) - 1,
+                        offsetVertex + tri.Value(2) - 1,
+                        offsetVertex + tri.Value(3) - 1
+                });
+            }
+        }
+    });
+
+    if (m_params.cleanupMeshes) {
+        MeshUtils::CleanupOptions options;
+        options.weldTolerance = m_params.weldTolerance;
+        options.reorderForLocality = true;
+        options.fnCanMergeNodes = [&](int i, int j) {
+            const std::optional<Quantity_Color>& lhs = vecVertexColor.at(i);
+            const std::optional<Quantity_Color>& rhs = vecVertexColor.at(j);
+            if (lhs.has_value() != rhs.has_value())
+                return false;
+
+            return !lhs.has_value() || lhs->IsEqual(rhs.value());
+        };
+        MeshUtils::CleanupResult result = MeshUtils::cleanup(
+                    CppUtils::safeStaticCast<int>(vecVertex.size()),
+                    [&](int i) { return vecVertex.at(i); },
+                    vecFacet,
+                    options
+        );
+
+        std::vector<gp_Pnt> vecCleanVertex;
+        std::vector<std::optional<Quantity_Color>> vecCleanVertexColor;
+        vecCleanVertex.reserve(result.sourceNodes.size());
+        vecCleanVertexColor.reserve(result.sourceNodes.size());
+        for (int ivertex : result.sourceNodes) {
+            vecCleanVertex.push_back(vecVertex.at(ivertex));
+            vecCleanVertexColor.push_back(vecVertexColor.at(ivertex));
+        }
+
+        vecVertex = std::move(vecCleanVertex);
+        vecVertexColor = std::move(vecCleanVertexColor);
+        vecFacet = std::move(result.triangles);
     }
 
+    const auto vertexCount = CppUtils::safeStaticCast<int>(vecVertex.size());
+    const auto facetCount = CppUtils::safeStaticCast<int>(vecFacet.size());
+
     // Helper function for progress report
-    auto fnUpdateProgress = [=](int current) {
+    TaskProgress writeProgress(progress, m_params.decimateMeshes ? 50 : 100);
+    auto fnUpdateProgress = [&](int current) {
         const auto total = vertexCount + facetCount;
         if (current % 100 || current >= total)
-            progress->setValue(MathUtils::toPercent(current, 0, total));
+            writeProgress.setValue(MathUtils::toPercent(current, 0, total));
     };
 
     fstr << vertexCount << " " << facetCount << " " << 0/*edgeCount*/ << "\n";
     // Write vertices
-    int ivertex = 0;
-    for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
-        IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            const gp_Trsf& meshTrsf = mesh.location().Transformation();
-            const Handle(Poly_Triangulation)& triangulation = mesh.triangulation();
-            for (int i = 1; i <= triangulation->NbNodes(); ++i) {
-                const gp_Pnt pnt = triangulation->Node(i).Transformed(meshTrsf);
-                const std::optional<Quantity_Color> color = mesh.nodeColor(i - 1);
-                fstr << pnt.X() << " " << pnt.Y() << " " << pnt.Z();
-                if (color.has_value()) {
-                    //fstr << " " << int(color->Red()   * 255)
-                    //     << " " << int(color->Green() * 255)
-                    //     << " " << int(color->Blue()  * 255);
-                    fstr << " " << color->Red() << " " << color->Green() << " " << color->Blue();
-                }
-
-                fstr << "\n";
-                fnUpdateProgress(++ivertex);
-            }
-        });
+    for (int ivertex = 0; ivertex < vertexCount; ++ivertex) {
+        const gp_Pnt& pnt = vecVertex.at(ivertex);
+        const std::optional<Quantity_Color>& color = vecVertexColor.at(ivertex);
+        fstr << pnt.X() << " " << pnt.Y() << " " << pnt.Z();
+        if (color.has_value()) {
+            //fstr << " " << int(color->Red()   * 255)
+            //     << " " << int(color->Green() * 255)
+            //     << " " << int(color->Blue()  * 255);
+            fstr << " " << color->Red() << " " << color->Green() << " " << color->Blue();
+        }
+
+        fstr << "\n";
+        fnUpdateProgress(ivertex + 1);
     }
 
     // Write facets(triangles)
-    int offsetVertex = 0;
-    int ifacet = 0;
-    for (const DocumentTreeNode& treeNode : m_vecTreeNode) {
-        IMeshAccess_visitMeshes(treeNode, [&](const IMeshAccess& mesh) {
-            const Handle(Poly_Triangulation)& triangulation = mesh.triangulation();
-            for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
-                const Poly_Triangle& tri = triangulation->Triangle(i);
-                fstr << "3 "
-                     << offsetVertex + tri.Value(1) - 1 << " "
-                     << offsetVertex + tri.Value(2) - 1 << " "
-                     << offsetVertex + tri.Value(3) - 1 << "\n";
-                fnUpdateProgress(vertexCount + (++ifacet));
-            }
-
-            offsetVertex += triangulation->NbNodes();
-        });
+    for (int ifacet = 0; ifacet < facetCount; ++ifacet) {
+        const MeshUtils::Triangle& facet = vecFacet.at(ifacet);
+        fstr << "3 " << facet[0] << " " << facet[1] << " " << facet[2] << "\n";
+        fnUpdateProgress(vertexCount + ifacet + 1);
     }
 
     return true;
 }
 
-void OffWriter::applyProperties(const PropertyGroup*)
+std::unique_ptr<PropertyGroup> OffWriter::createProperties(PropertyGroup* parentGroup)
+{
+    return std::make_unique<Properties>(parentGroup);
+}
+
+void OffWriter::applyProperties(const PropertyGroup* params)
 {
+    auto ptr = dynamic_cast<const Properties*>(params);
+    if (ptr) {
+        m_params.cleanupMeshes = ptr->cleanupMeshes;
+        m_params.weldTolerance = UnitSystem::millimeters(ptr->weldTolerance.quantity());
+        m_params.decimateMeshes = ptr->decimateMeshes;
+        m_params.decimationTargetRatio = ptr->decimationTargetRatio;
+        m_params.decimationMaxError = UnitSystem::millimeters(ptr->decimationMaxError.quantity());
+    }
 }
 
 } // namespace IO
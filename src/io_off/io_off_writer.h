@@ -20,11 +20,27 @@ class OffWriter : public Writer {
 public:
     bool transfer(Span<const ApplicationItem> appItems, TaskProgress* progress) override;
     bool writeFile(const FilePath& filepath, TaskProgress* progress) override;
+
+    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup* parentGroup);
     void applyProperties(const PropertyGroup* group) override;
 
-    static std::unique_ptr<PropertyGroup> createProperties(PropertyGroup*)  { return {}; }
+    // Parameters
+    struct Parameters {
+        // Merge coincident nodes of meshes(within 'weldTolerance'), remove degenerate triangles and
+        // reorder triangles for locality. See MeshUtils::cleanup()
+        bool cleanupMeshes = false;
+        double weldTolerance = 0.; // In millimeters
+        // Simplify meshes before writing them, see MeshDecimation
+        bool decimateMeshes = false;
+        double decimationTargetRatio = 0.5;
+        double decimationMaxError = 0.; // In millimeters, disabled if zero
+    };
+    Parameters& parameters() { return m_params; }
+    const Parameters& constParameters() const { return m_params; }
 
 private:
+    class Properties;
+    Parameters m_params;
     std::vector<DocumentTreeNode> m_vecTreeNode;
 };
 
@@ -13,13 +13,16 @@
 #include "../base/io_system.h"
 #include "../base/math_utils.h"
 #include "../base/mesh_access.h"
+#include "../base/mesh_utils.h"
 #include "../base/messenger.h"
 #include "../base/property_builtins.h"
 #include "../base/property_enumeration.h"
 #include "../base/task_progress.h"
 #include "../base/tkernel_utils.h"
+#include "../base/unit_system.h"
 
 #include <Poly_Triangulation.hxx>
+#include <TopLoc_Location.hxx>
 
 #include <gsl/util>
 #include <fmt/format.h>
@@ -66,6 +69,24 @@ public:
     {
         this->targetFormat.mutableEnumeration().changeTrContext(PlyWriterI18N::textIdContext());
         this->comment.setDescription(PlyWriterI18N::textIdTr("Line that will appear in header"));
+        this->cleanupMeshes.setDescription(
+                    PlyWriterI18N::textIdTr("Merge coincident mesh nodes and remove degenerate triangles. "
+                                            "Meshes coming from BRep shapes have duplicated nodes along "
+                                            "the boundaries of faces"));
+        this->weldTolerance.setDescription(
+                    PlyWriterI18N::textIdTr("Mesh nodes closer than this distance are merged, only exactly "
+                                            "coincident nodes are merged if zero"));
+        this->decimateMeshes.setDescription(
+                    PlyWriterI18N::textIdTr("Simplify meshes so they have less triangles. Boundaries and "
+                                            "colors of meshes are preserved"));
+        this->decimationTargetRatio.setDescription(
+                    PlyWriterI18N::textIdTr("Count of triangles to keep relative to the input count"));
+        this->decimationTargetRatio.setRange(0., 1.);
+        this->decimationTargetRatio.setSingleStep(0.05);
+        this->decimationTargetRatio.setConstraintsEnabled(true);
+        this->decimationMaxError.setDescription(
+                    PlyWriterI18N::textIdTr("Maximum deviation of simplified meshes from the input meshes, "
+                                            "not limited if zero"));
     }
 
     void restoreDefaults() override {
@@ -74,12 +95,22 @@ public:
         this->writeColors.setValue(defaultParams.writeColors);
         this->defaultColor.setValue(defaultParams.defaultColor.GetRGB());
         this->comment.setValue(defaultParams.comment);
+        this->cleanupMeshes.setValue(defaultParams.cleanupMeshes);
+        this->weldTolerance.setQuantity(defaultParams.weldTolerance * Quantity_Millimeter);
+        this->decimateMeshes.setValue(defaultParams.decimateMeshes);
+        this->decimationTargetRatio.setValue(defaultParams.decimationTargetRatio);
+        this->decimationMaxError.setQuantity(defaultParams.decimationMaxError * Quantity_Millimeter);
     }
 
     PropertyEnum<PlyWriter::Format> targetFormat{ this, PlyWriterI18N::textId("targetFormat") };
     PropertyBool writeColors{ this, PlyWriterI18N::textId("writeColors") };
     PropertyOccColor defaultColor{ this, PlyWriterI18N::textId("defaultColor") };
     PropertyString comment{ this, PlyWriterI18N::textId("comment") };
+    PropertyBool cleanupMeshes{ this, PlyWriterI18N::textId("cleanupMeshes") };
+    PropertyLength weldTolerance{ this, PlyWriterI18N::textId("weldTolerance") };
+    PropertyBool decimateMeshes{ this, PlyWriterI18N::textId("decimateMeshes") };
+    PropertyDouble decimationTargetRatio{ this, PlyWriterI18N::textId("decimationTargetRatio") };
+    PropertyLength decimationMaxError{ this, PlyWriterI18N::textId("decimationMaxError") };
 };
 
 bool PlyWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* progress)
@@ -92,35 +123,50 @@ bool PlyWriter::transfer(Span<const ApplicationItem> appItems, TaskProgress* pro
     // TODO Investigate bad looking 3D mesh when defining vertex colors
     // TODO Investigate task abort issue
 
-    // Count number of faces for progress report
+    // Count number of meshes for progress report
     int count = 0;
+    std::vector<DocumentTreeNode> vecLeafTreeNode;
     System::traverseUniqueItems(appItems, [&](const DocumentTreeNode& docTreeNode) {
         if (docTreeNode.isLeaf()) {
-            IMeshAccess_visitMeshes(docTreeNode, [&](const IMeshAccess&) { ++count; });
+            vecLeafTreeNode.push_back(docTreeNode);
             if (findLabelDataFlags(docTreeNode.label()) & LabelData_HasPointCloudData)
                 ++count;
         }
     });
+    IMeshAccess_visitMeshInstances(vecLeafTreeNode, [&](const IMeshInstancesAccess&) { ++count; });
+
+    // Decimate meshes in parallel
+    MeshDecimation::ResultMap mapDecimatedMesh;
+    if (m_params.decimateMeshes) {
+        TaskProgress decimationProgress(progress, 50, PlyWriterI18N::textIdTr("Decimate meshes"));
+        MeshDecimation::Options options;
+        options.targetRatio = m_params.decimationTargetRatio;
+        options.maxError = m_params.decimationMaxError;
+        mapDecimatedMesh = MeshDecimation::runParallel(vecLeafTreeNode, options, &decimationProgress);
+    }
 
     // Record face meshes
+    TaskProgress recordProgress(progress, m_params.decimateMeshes ? 50 : 100);
     int iCount = 0;
-    System::traverseUniqueItems(appItems, [&](const DocumentTreeNode& docTreeNode) {
-        if (docTreeNode.isLeaf() && !progress->isAbortRequested()) {
-            IMeshAccess_visitMeshes(docTreeNode, [&](const IMeshAccess& mesh) {
-                this->addMesh(mesh);
-                progress->setValue(MathUtils::toPercent(++iCount, 0, count));
-            });
+    IMeshAccess_visitMeshInstances(vecLeafTreeNode, [&](const IMeshInstancesAccess& meshInstances) {
+        if (!recordProgress.isAbortRequested()) {
+            this->addMesh(meshInstances, mapDecimatedMesh.find(meshInstances.mesh()));
+            recordProgress.setValue(MathUtils::toPercent(++iCount, 0, count));
         }
     });
 
+    // Point clouds aren't affected as they are recorded afterwards
+    if (m_params.cleanupMeshes && !recordProgress.isAbortRequested())
+        this->cleanupMeshes();
+
     // Record point clouds
     System::traverseUniqueItems(appItems, [&](const DocumentTreeNode& docTreeNode) {
         if (docTreeNode.isLeaf()
                 && (findLabelDataFlags(docTreeNode.label()) & LabelData_HasPointCloudData)
-                && !progress->isAbortRequested())
+                && !recordProgress.isAbortRequested())
         {
             this->addPointCloud(CafUtils::findAttribute<PointCloudData>(docTreeNode.label()));
-            progress->setValue(MathUtils::toPercent(++iCount, 0, count));
+            recordProgress.setValue(MathUtils::toPercent(++iCount, 0, count));
         }
     });
 
@@ -255,32 +301,47 @@ void PlyWriter::applyProperties(const PropertyGroup* params)
         m_params.writeColors = ptr->writeColors;
         m_params.defaultColor = Quantity_ColorRGBA(ptr->defaultColor);
         m_params.comment = ptr->comment;
+        m_params.cleanupMeshes = ptr->cleanupMeshes;
+        m_params.weldTolerance = UnitSystem::millimeters(ptr->weldTolerance.quantity());
+        m_params.decimateMeshes = ptr->decimateMeshes;
+        m_params.decimationTargetRatio = ptr->decimationTargetRatio;
+        m_params.decimationMaxError = UnitSystem::millimeters(ptr->decimationMaxError.quantity());
     }
 }
 
-void PlyWriter::addMesh(const IMeshAccess& mesh)
+void PlyWriter::addMesh(const IMeshInstancesAccess& meshInstances, const MeshDecimation::Result* decimatedMesh)
 {
-    const Handle(Poly_Triangulation)& triangulation = mesh.triangulation();
-    for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
-        const Poly_Triangle& triangle = triangulation->Triangle(i);
-        const int32_t offset = CppUtils::safeStaticCast<int32_t>(m_vecNode.size());
-        const Face face{
-            offset + triangle(1) - 1, offset + triangle(2) - 1, offset + triangle(3) - 1
-        };
-        m_vecFace.push_back(std::move(face));
-    }
-
-    for (int i = 1; i <= triangulation->NbNodes(); ++i) {
-        const Vertex vertex = PlyWriter::toVertex(triangulation->Node(i).Transformed(mesh.location()));
-        m_vecNode.push_back(std::move(vertex));
-    }
-
+    const IMeshAccess& mesh = meshInstances.mesh();
+    const Handle(Poly_Triangulation)& triangulation = decimatedMesh ? decimatedMesh->mesh : mesh.triangulation();
+    std::vector<Color> vecMeshNodeColor;
     if (m_params.writeColors) {
+        vecMeshNodeColor.reserve(triangulation->NbNodes());
         for (int i = 0; i < triangulation->NbNodes(); ++i) {
-            const std::optional<Quantity_Color> nodeColor = mesh.nodeColor(i);
+            const int sourceNode = decimatedMesh ? decimatedMesh->sourceNodes.at(i) : i;
+            const std::optional<Quantity_Color> nodeColor = mesh.nodeColor(sourceNode);
             const Quantity_Color& defaultNodeColor = m_params.defaultColor.GetRGB();
-            m_vecNodeColor.push_back(PlyWriter::toColor(nodeColor ? nodeColor.value() : defaultNodeColor));
+            vecMeshNodeColor.push_back(PlyWriter::toColor(nodeColor ? nodeColor.value() : defaultNodeColor));
+        }
+    }
+
+    // Mesh data is written for each instance
+    for (const TopLoc_Location& loc : meshInstances.instanceLocations()) {
+        const int32_t offset = CppUtils::safeStaticCast<int32_t>(m_vecNode.size());
+        for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+            const Poly_Triangle& triangle = triangulation->Triangle(i);
+            const Face face{
+                offset + triangle(1) - 1, offset + triangle(2) - 1, offset + triangle(3) - 1
+            };
+            m_vecFace.push_back(std::move(face));
         }
+
+        const gp_Trsf& trsf = loc.Transformation();
+        for (int i = 1; i <= triangulation->NbNodes(); ++i) {
+            const Vertex vertex = PlyWriter::toVertex(triangulation->Node(i).Transformed(trsf));
+            m_vecNode.push_back(std::move(vertex));
+        }
+
+        m_vecNodeColor.insert(m_vecNodeColor.end(), vecMeshNodeColor.cbegin(), vecMeshNodeColor.cend());
     }
 }
 
@@ -302,6 +363,48 @@ void PlyWriter::addPointCloud(const PointCloudDataPtr& pntCloud)
     }
 }
 
+void PlyWriter::cleanupMeshes()
+{
+    std::vector<MeshUtils::Triangle> vecTriangle;
+    vecTriangle.reserve(m_vecFace.size());
+    for (const Face& face : m_vecFace)
+        vecTriangle.push_back({ face.v1, face.v2, face.v3 });
+
+    MeshUtils::CleanupOptions options;
+    options.weldTolerance = m_params.weldTolerance;
+    options.reorderForLocality = true;
+    if (m_params.writeColors) {
+        options.fnCanMergeNodes = [&](int i, int j) {
+            const Color& lhs = m_vecNodeColor.at(i);
+            const Color& rhs = m_vecNodeColor.at(j);
+            return lhs.red == rhs.red && lhs.green == rhs.green && lhs.blue == rhs.blue;
+        };
+    }
+
+    const MeshUtils::CleanupResult result = MeshUtils::cleanup(
+                CppUtils::safeStaticCast<int>(m_vecNode.size()),
+                [&](int i) { const Vertex& node = m_vecNode.at(i); return gp_Pnt(node.x, node.y, node.z); },
+                vecTriangle,
+                options
+    );
+
+    std::vector<Vertex> vecNode;
+    std::vector<Color> vecNodeColor;
+    vecNode.reserve(result.sourceNodes.size());
+    for (int inode : result.sourceNodes) {
+        vecNode.push_back(m_vecNode.at(inode));
+        if (m_params.writeColors)
+            vecNodeColor.push_back(m_vecNodeColor.at(inode));
+    }
+
+    m_vecFace.clear();
+    for (const MeshUtils::Triangle& tri : result.triangles)
+        m_vecFace.push_back({ tri[0], tri[1], tri[2] });
+
+    m_vecNode = std::move(vecNode);
+    m_vecNodeColor = std::move(vecNodeColor);
+}
+
 PlyWriter::Vertex PlyWriter::toVertex(const gp_Pnt& pnt)
 {
     return Vertex{ float(pnt.X()), float(pnt.Y()), float(pnt.Z()) };
@@ -9,12 +9,13 @@
 #include "../base/document_ptr.h"
 #include "../base/io_writer.h"
 #include "../base/io_single_format_factory.h"
+#include "../base/mesh_decimation.h"
 #include "../base/point_cloud_data.h"
 
 #include <Quantity_ColorRGBA.hxx>
 #include <vector>
 
-namespace Mayo { class IMeshAccess; }
+namespace Mayo { class IMeshInstancesAccess; }
 
 namespace Mayo {
 namespace IO {
@@ -36,6 +37,14 @@ public:
         bool writeColors = true;
         Quantity_ColorRGBA defaultColor{ Quantity_Color(Quantity_NOC_GRAY) };
         std::string comment;
+        // Merge coincident nodes of meshes(within 'weldTolerance'), remove degenerate triangles and
+        // reorder triangles for locality. See MeshUtils::cleanup()
+        bool cleanupMeshes = false;
+        double weldTolerance = 0.; // In millimeters
+        // Simplify meshes before writing them, see MeshDecimation
+        bool decimateMeshes = false;
+        double decimationTargetRatio = 0.5;
+        double decimationMaxError = 0.; // In millimeters, disabled if zero
         // TODO bool writeNormals = false;
         // TODO bool writeEdges = true;
     };
@@ -50,8 +59,9 @@ private:
     static Vertex toVertex(const gp_Pnt& pnt);
     static Color toColor(const Quantity_Color& c);
 
-    void addMesh(const IMeshAccess& mesh);
+    void addMesh(const IMeshInstancesAccess& meshInstances, const MeshDecimation::Result* decimatedMesh);
     void addPointCloud(const PointCloudDataPtr& pntCloud);
+    void cleanupMeshes();
 
     class Properties;
     Parameters m_params;
@@ -0,0 +1,123 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "clearance_analysis.h"
+#include "measure_tool_brep.h"
+
+#include "../base/assembly_instances.h"
+#include "../base/brep_utils.h"
+#include "../base/caf_utils.h"
+#include "../base/task_progress.h"
+#include "../base/xcaf.h"
+
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace Mayo {
+
+namespace {
+
+bool isGeometricShape(const TopoDS_Shape& shape)
+{
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        if (!BRepUtils::isGeometric(TopoDS::Face(expl.Current())))
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace
+
+void ClearanceAnalysis::run(const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId, TaskProgress* progress)
+{
+    AssemblyInstances instances;
+    {
+        TaskProgress subProgress(progress, 10, textIdTr("Bounding boxes"));
+        instances = AssemblyInstances::collect(doc, spanNodeId, &subProgress);
+    }
+
+    TaskProgress subProgress(progress, 90, textIdTr("Distances"));
+    this->run(instances, &subProgress);
+}
+
+void ClearanceAnalysis::run(const AssemblyInstances& instances, TaskProgress* progress)
+{
+    m_vecResult.clear();
+    m_candidatePairCount = 0;
+    m_failedPairCount = 0;
+
+    // Parts not supported by BRepExtrema_DistShapeShape, evaluated once per product
+    std::vector<bool> vecInstanceSkipped(instances.instances().size(), false);
+    {
+        std::unordered_map<TDF_Label, bool> mapProductGeometric;
+        for (size_t i = 0; i < vecInstanceSkipped.size(); ++i) {
+            const TDF_Label& productLabel = instances.instance(int(i)).productLabel;
+            auto it = mapProductGeometric.find(productLabel);
+            if (it == mapProductGeometric.cend())
+                it = mapProductGeometric.insert({ productLabel, isGeometricShape(XCaf::shape(productLabel)) }).first;
+
+            vecInstanceSkipped.at(i) = !it->second;
+        }
+    }
+
+    // Broad phase
+    const double maxDistance = m_maxDistance / Quantity_Millimeter;
+    std::vector<std::pair<int, int>> vecCandidatePair;
+    instances.bvh().visitPairs(maxDistance, [&](int i, int j) {
+        if (!vecInstanceSkipped.at(i) && !vecInstanceSkipped.at(j))
+            vecCandidatePair.emplace_back(i, j);
+    });
+    m_candidatePairCount = int(vecCandidatePair.size());
+
+    // Exact distances
+    std::atomic<int> pairDoneCount = 0;
+    std::atomic<int> pairFailedCount = 0;
+    std::mutex mutex;
+    OSD_Parallel::For(0, int(vecCandidatePair.size()), [&](int iPair) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        const auto [i, j] = vecCandidatePair.at(iPair);
+        std::optional<MeasureMinDistance> minDist;
+        try {
+            minDist = MeasureToolBRep::brepMinDistance(instances.instanceShape(i), instances.instanceShape(j));
+        } catch (const IMeasureError&) {
+            ++pairFailedCount;
+        } catch (const Standard_Failure&) {
+            ++pairFailedCount;
+        }
+
+        const int doneCount = ++pairDoneCount;
+        std::lock_guard<std::mutex> lock(mutex);
+        if (minDist && minDist->value <= m_maxDistance) {
+            Result result;
+            result.treeNodeId1 = instances.instance(i).treeNodeId;
+            result.treeNodeId2 = instances.instance(j).treeNodeId;
+            result.minDistance = *minDist;
+            m_vecResult.push_back(result);
+            this->signalResultFound.send(result);
+        }
+
+        if (progress)
+            progress->setValue((100 * doneCount) / int(vecCandidatePair.size()));
+    });
+
+    m_failedPairCount = pairFailedCount;
+    std::sort(m_vecResult.begin(), m_vecResult.end(), [](const Result& lhs, const Result& rhs) {
+        return lhs.minDistance.value < rhs.minDistance.value;
+    });
+}
+
+} // namespace Mayo
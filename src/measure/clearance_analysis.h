@@ -0,0 +1,64 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/document_ptr.h"
+#include "../base/libtree.h"
+#include "../base/quantity.h"
+#include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/text_id.h"
+#include "measure_tool.h"
+
+#include <vector>
+
+namespace Mayo {
+
+class AssemblyInstances;
+class TaskProgress;
+
+// Finds all the pairs of parts closer than some distance in a document
+//
+// Broad phase culls the pairs of instances whose bounding boxes are too far apart(see BoxBvh), then
+// the exact minimum distance of the remaining pairs is computed in parallel
+// Parts consisting of mesh-only faces(ie without geometric surface) are not supported and skipped
+class ClearanceAnalysis {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::ClearanceAnalysis)
+public:
+    struct Result {
+        TreeNodeId treeNodeId1 = 0;
+        TreeNodeId treeNodeId2 = 0;
+        MeasureMinDistance minDistance;
+    };
+
+    QuantityLength maxDistance() const { return m_maxDistance; }
+    void setMaxDistance(QuantityLength dist) { m_maxDistance = dist; }
+
+    // Runs analysis on the parts located below tree nodes 'spanNodeId', all the document if empty
+    void run(const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId = {}, TaskProgress* progress = nullptr);
+    void run(const AssemblyInstances& instances, TaskProgress* progress = nullptr);
+
+    // Results of the last run, sorted by increasing distance
+    const std::vector<Result>& results() const { return m_vecResult; }
+
+    // Count of pairs retained by the broad phase in the last run
+    int candidatePairCount() const { return m_candidatePairCount; }
+    // Count of pairs for which distance computation failed in the last run
+    int failedPairCount() const { return m_failedPairCount; }
+
+    // Emitted from the threads computing distances as soon as a pair is found. Emissions are
+    // serialized, so that slots connected with Signal::connectSlot() are safely called
+    Signal<const Result&> signalResultFound;
+
+private:
+    QuantityLength m_maxDistance = 1 * Quantity_Millimeter;
+    std::vector<Result> m_vecResult;
+    int m_candidatePairCount = 0;
+    int m_failedPairCount = 0;
+};
+
+} // namespace Mayo
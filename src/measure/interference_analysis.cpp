@@ -0,0 +1,342 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "interference_analysis.h"
+
+#include "../base/assembly_instances.h"
+#include "../base/bnd_utils.h"
+#include "../base/box_bvh.h"
+#include "../base/brep_utils.h"
+#include "../base/caf_utils.h"
+#include "../base/mesh_utils.h"
+#include "../base/task_progress.h"
+#include "../base/xcaf.h"
+
+#include <BRep_Tool.hxx>
+#include <BRepAlgoAPI_Common.hxx>
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <OSD_Parallel.hxx>
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Mayo {
+
+namespace {
+
+// Triangles of all the faces of a product shape, expressed in the coordinate system of the product
+struct ProductMesh {
+    std::vector<gp_XYZ> vecNode;
+    std::vector<std::array<int, 3>> vecTriangle;
+    BoxBvh bvh; // Items are the triangles
+    Bnd_Box bndBox;
+    bool isComplete = true; // Whether all faces have a triangulation
+    bool isGeometric = true; // Whether all faces have a geometric surface
+
+    bool isEmpty() const { return vecTriangle.empty(); }
+};
+
+ProductMesh buildProductMesh(const TopoDS_Shape& shape)
+{
+    ProductMesh mesh;
+    std::vector<Bnd_Box> vecTriangleBox;
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        const TopoDS_Face& face = TopoDS::Face(expl.Current());
+        mesh.isGeometric = mesh.isGeometric && BRepUtils::isGeometric(face);
+        TopLoc_Location loc;
+        const Handle_Poly_Triangulation& triangulation = BRep_Tool::Triangulation(face, loc);
+        if (triangulation.IsNull()) {
+            mesh.isComplete = false;
+            continue;
+        }
+
+        const gp_Trsf& trsf = loc.Transformation();
+        const int nodeOffset = int(mesh.vecNode.size()) - 1; // Nodes of Poly_Triangulation start at 1
+        for (int i = 1; i <= triangulation->NbNodes(); ++i)
+            mesh.vecNode.push_back(triangulation->Node(i).Transformed(trsf).XYZ());
+
+        for (int i = 1; i <= triangulation->NbTriangles(); ++i) {
+            int n1, n2, n3;
+            triangulation->Triangle(i).Get(n1, n2, n3);
+            const std::array<int, 3> triangle = { nodeOffset + n1, nodeOffset + n2, nodeOffset + n3 };
+            Bnd_Box triangleBox;
+            for (int n : triangle)
+                triangleBox.Add(gp_Pnt(mesh.vecNode.at(n)));
+
+            BndUtils::add(&mesh.bndBox, triangleBox);
+            mesh.vecTriangle.push_back(triangle);
+            vecTriangleBox.push_back(triangleBox);
+        }
+    }
+
+    mesh.bvh = BoxBvh(std::move(vecTriangleBox), 8);
+    return mesh;
+}
+
+// Does any triangle of 'mesh1' intersect any triangle of 'mesh2'?
+// 'trsf2to1' maps coordinates of mesh2 to mesh1, 'trsf1to2' is the inverse
+bool meshesIntersect(
+        const ProductMesh& mesh1, const ProductMesh& mesh2,
+        const gp_Trsf& trsf2to1, const gp_Trsf& trsf1to2,
+        double tolerance
+    )
+{
+    // Only the triangles of mesh2 located around mesh1 are worth testing
+    Bnd_Box mesh1BoxIn2 = mesh1.bndBox.Transformed(trsf1to2);
+    mesh1BoxIn2.Enlarge(tolerance);
+    bool isIntersecting = false;
+    mesh2.bvh.visitIntersecting(mesh1BoxIn2, [&](int j) {
+        if (isIntersecting)
+            return;
+
+        std::array<gp_XYZ, 3> triangle2;
+        Bnd_Box triangle2Box;
+        for (int k = 0; k < 3; ++k) {
+            triangle2.at(k) = mesh2.vecNode.at(mesh2.vecTriangle.at(j).at(k));
+            trsf2to1.Transforms(triangle2.at(k));
+            triangle2Box.Add(gp_Pnt(triangle2.at(k)));
+        }
+
+        triangle2Box.Enlarge(tolerance);
+        mesh1.bvh.visitIntersecting(triangle2Box, [&](int i) {
+            if (isIntersecting)
+                return;
+
+            const std::array<int, 3>& triangle1 = mesh1.vecTriangle.at(i);
+            isIntersecting = MeshUtils::trianglesIntersect(
+                        mesh1.vecNode.at(triangle1.at(0)),
+                        mesh1.vecNode.at(triangle1.at(1)),
+                        mesh1.vecNode.at(triangle1.at(2)),
+                        triangle2.at(0), triangle2.at(1), triangle2.at(2),
+                        tolerance
+            );
+        });
+    });
+
+    return isIntersecting;
+}
+
+// Counts crossings of the triangles of 'mesh' with the ray cast from 'pnt' along unit vector 'dir'
+int rayCrossingCount(const ProductMesh& mesh, const gp_XYZ& pnt, const gp_XYZ& dir)
+{
+    // Ray is clipped to a length reaching beyond the bounding box of the mesh
+    const BndBoxCoords meshCoords = BndBoxCoords::get(mesh.bndBox);
+    const double length = (pnt - meshCoords.center().XYZ()).Modulus() + std::sqrt(mesh.bndBox.SquareExtent());
+    Bnd_Box rayBox;
+    rayBox.Add(gp_Pnt(pnt));
+    rayBox.Add(gp_Pnt(pnt + length * dir));
+    int crossingCount = 0;
+    mesh.bvh.visitIntersecting(rayBox, [&](int i) {
+        // Moller-Trumbore ray/triangle intersection
+        const std::array<int, 3>& triangle = mesh.vecTriangle.at(i);
+        const gp_XYZ& v0 = mesh.vecNode.at(triangle.at(0));
+        const gp_XYZ edge1 = mesh.vecNode.at(triangle.at(1)) - v0;
+        const gp_XYZ edge2 = mesh.vecNode.at(triangle.at(2)) - v0;
+        const gp_XYZ h = dir.Crossed(edge2);
+        const double a = edge1.Dot(h);
+        if (std::abs(a) < 1e-12)
+            return; // Ray is parallel to the triangle
+
+        const double f = 1. / a;
+        const gp_XYZ s = pnt - v0;
+        const double u = f * s.Dot(h);
+        if (u < 0. || u > 1.)
+            return;
+
+        const gp_XYZ q = s.Crossed(edge1);
+        const double v = f * dir.Dot(q);
+        if (v < 0. || u + v > 1.)
+            return;
+
+        if (f * edge2.Dot(q) > 0.)
+            ++crossingCount;
+    });
+
+    return crossingCount;
+}
+
+// Is point 'pnt'(expressed in the coordinate system of 'mesh') inside closed mesh?
+// A ray going exactly through an edge or a vertex shared by several triangles gives a wrong count
+// of crossings. So parity of crossings is evaluated along three rays of unrelated directions(far
+// from the axes, along which edges of CAD meshes are typically aligned) and the majority wins
+bool isInside(const ProductMesh& mesh, const gp_XYZ& pnt)
+{
+    if (mesh.bndBox.IsOut(gp_Pnt(pnt)))
+        return false;
+
+    static const gp_XYZ rayDirs[] = {
+        gp_XYZ(1., 0.3141, 0.1592).Normalized(),
+        gp_XYZ(-0.2718, 1., 0.5772).Normalized(),
+        gp_XYZ(0.1414, -0.7321, 1.).Normalized()
+    };
+    int insideCount = 0;
+    for (const gp_XYZ& dir : rayDirs) {
+        if (rayCrossingCount(mesh, pnt, dir) % 2 == 1)
+            ++insideCount;
+    }
+
+    return insideCount >= 2;
+}
+
+bool boxContains(const Bnd_Box& box, const Bnd_Box& other)
+{
+    const BndBoxCoords coords = BndBoxCoords::get(box);
+    const BndBoxCoords otherCoords = BndBoxCoords::get(other);
+    return coords.xmin <= otherCoords.xmin && otherCoords.xmax <= coords.xmax
+            && coords.ymin <= otherCoords.ymin && otherCoords.ymax <= coords.ymax
+            && coords.zmin <= otherCoords.zmin && otherCoords.zmax <= coords.zmax;
+}
+
+std::optional<QuantityVolume> commonVolume(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2)
+{
+    try {
+        BRepAlgoAPI_Common common(shape1, shape2);
+        if (!common.IsDone())
+            return {};
+
+        GProp_GProps gprops;
+        BRepGProp::VolumeProperties(common.Shape(), gprops);
+        return std::abs(gprops.Mass()) * Quantity_CubicMillimeter;
+    } catch (const Standard_Failure&) {
+        return {};
+    }
+}
+
+} // namespace
+
+void InterferenceAnalysis::run(const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId, TaskProgress* progress)
+{
+    AssemblyInstances instances;
+    {
+        TaskProgress subProgress(progress, 10, textIdTr("Bounding boxes"));
+        instances = AssemblyInstances::collect(doc, spanNodeId, &subProgress);
+    }
+
+    TaskProgress subProgress(progress, 90, textIdTr("Interferences"));
+    this->run(instances, &subProgress);
+}
+
+void InterferenceAnalysis::run(const AssemblyInstances& instances, TaskProgress* progress)
+{
+    m_vecResult.clear();
+    m_candidatePairCount = 0;
+    m_uncheckedPairCount = 0;
+
+    // Broad phase
+    const double tolerance = m_tolerance / Quantity_Millimeter;
+    std::vector<std::pair<int, int>> vecCandidatePair;
+    instances.bvh().visitPairs(tolerance, [&](int i, int j) { vecCandidatePair.emplace_back(i, j); });
+    m_candidatePairCount = int(vecCandidatePair.size());
+
+    // Build the meshes of the products involved in candidate pairs, once per product
+    std::vector<TDF_Label> vecProduct;
+    std::unordered_map<TDF_Label, int> mapProductIndex; // Index in vecProduct
+    std::vector<int> vecInstanceProduct(instances.instances().size(), -1);
+    for (const auto& [i, j] : vecCandidatePair) {
+        for (int instanceIndex : { i, j }) {
+            const TDF_Label& productLabel = instances.instance(instanceIndex).productLabel;
+            auto [it, isNewProduct] = mapProductIndex.insert({ productLabel, int(vecProduct.size()) });
+            if (isNewProduct)
+                vecProduct.push_back(productLabel);
+
+            vecInstanceProduct.at(instanceIndex) = it->second;
+        }
+    }
+
+    std::vector<ProductMesh> vecProductMesh(vecProduct.size());
+    std::atomic<int> doneCount = 0;
+    std::mutex mutex;
+    const int workCount = int(vecProduct.size() + vecCandidatePair.size());
+    auto fnWorkDone = [&]{
+        const int count = ++doneCount;
+        if (progress) {
+            std::lock_guard<std::mutex> lock(mutex);
+            progress->setValue((100 * count) / workCount);
+        }
+    };
+
+    OSD_Parallel::For(0, int(vecProduct.size()), [&](int i) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        vecProductMesh.at(i) = buildProductMesh(XCaf::shape(vecProduct.at(i)));
+        fnWorkDone();
+    });
+
+    // Narrow phase
+    std::atomic<int> uncheckedPairCount = 0;
+    OSD_Parallel::For(0, int(vecCandidatePair.size()), [&](int iPair) {
+        if (TaskProgress::isAbortRequested(progress))
+            return;
+
+        auto [i, j] = vecCandidatePair.at(iPair);
+        if (vecProductMesh.at(vecInstanceProduct.at(i)).vecTriangle.size()
+                < vecProductMesh.at(vecInstanceProduct.at(j)).vecTriangle.size())
+        {
+            std::swap(i, j); // Iterate over the triangles of the mesh having less triangles
+        }
+
+        const AssemblyInstances::Instance& instance1 = instances.instance(i);
+        const AssemblyInstances::Instance& instance2 = instances.instance(j);
+        const ProductMesh& mesh1 = vecProductMesh.at(vecInstanceProduct.at(i));
+        const ProductMesh& mesh2 = vecProductMesh.at(vecInstanceProduct.at(j));
+        if (mesh1.isEmpty() || mesh2.isEmpty()) {
+            ++uncheckedPairCount;
+            fnWorkDone();
+            return;
+        }
+
+        const gp_Trsf trsf2to1 = (instance1.location.Inverted() * instance2.location).Transformation();
+        const gp_Trsf trsf1to2 = trsf2to1.Inverted();
+        std::optional<Type> type;
+        if (meshesIntersect(mesh1, mesh2, trsf2to1, trsf1to2, tolerance)) {
+            type = Type::Intersection;
+        }
+        else if (mesh1.isComplete && boxContains(instance1.bndBox, instance2.bndBox)) {
+            const gp_XYZ pnt2 = gp_Pnt(mesh2.vecNode.front()).Transformed(trsf2to1).XYZ();
+            if (isInside(mesh1, pnt2))
+                type = Type::Inclusion;
+        }
+        else if (mesh2.isComplete && boxContains(instance2.bndBox, instance1.bndBox)) {
+            const gp_XYZ pnt1 = gp_Pnt(mesh1.vecNode.front()).Transformed(trsf1to2).XYZ();
+            if (isInside(mesh2, pnt1))
+                type = Type::Inclusion;
+        }
+
+        if (!mesh1.isComplete || !mesh2.isComplete)
+            ++uncheckedPairCount; // Partially checked actually
+
+        if (type) {
+            Result result;
+            result.treeNodeId1 = instances.instance(std::min(i, j)).treeNodeId;
+            result.treeNodeId2 = instances.instance(std::max(i, j)).treeNodeId;
+            result.type = *type;
+            if (m_isCommonVolumeEnabled && mesh1.isGeometric && mesh2.isGeometric)
+                result.commonVolume = commonVolume(instances.instanceShape(i), instances.instanceShape(j));
+
+            std::lock_guard<std::mutex> lock(mutex);
+            m_vecResult.push_back(result);
+            this->signalResultFound.send(result);
+        }
+
+        fnWorkDone();
+    });
+
+    m_uncheckedPairCount = uncheckedPairCount;
+    std::sort(m_vecResult.begin(), m_vecResult.end(), [](const Result& lhs, const Result& rhs) {
+        return std::make_pair(lhs.treeNodeId1, lhs.treeNodeId2) < std::make_pair(rhs.treeNodeId1, rhs.treeNodeId2);
+    });
+}
+
+} // namespace Mayo
@@ -0,0 +1,78 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "../base/document_ptr.h"
+#include "../base/libtree.h"
+#include "../base/quantity.h"
+#include "../base/signal.h"
+#include "../base/span.h"
+#include "../base/text_id.h"
+
+#include <optional>
+#include <vector>
+
+namespace Mayo {
+
+class AssemblyInstances;
+class TaskProgress;
+
+// Finds all the pairs of parts overlapping each other in a document
+//
+// Broad phase culls the pairs of instances whose bounding boxes don't intersect(see BoxBvh). Each
+// remaining pair is then confirmed by testing the triangles of existing BRep triangulations
+// against each other, a part fully enclosed in another one being detected as well. Optionally the
+// volume common to the parts of a confirmed pair is computed with a boolean operation
+// Pairs are processed in parallel
+class InterferenceAnalysis {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::InterferenceAnalysis)
+public:
+    enum class Type {
+        Intersection, // Boundaries of the parts intersect or touch each other
+        Inclusion // A part is located inside the other one
+    };
+
+    struct Result {
+        TreeNodeId treeNodeId1 = 0;
+        TreeNodeId treeNodeId2 = 0;
+        Type type = Type::Intersection;
+        // Only available when common volume computation is enabled and succeeded
+        std::optional<QuantityVolume> commonVolume;
+    };
+
+    // Triangles separated by less than this tolerance are considered touching
+    QuantityLength tolerance() const { return m_tolerance; }
+    void setTolerance(QuantityLength tol) { m_tolerance = tol; }
+
+    bool isCommonVolumeEnabled() const { return m_isCommonVolumeEnabled; }
+    void setCommonVolumeEnabled(bool on) { m_isCommonVolumeEnabled = on; }
+
+    // Runs analysis on the parts located below tree nodes 'spanNodeId', all the document if empty
+    void run(const DocumentPtr& doc, Span<const TreeNodeId> spanNodeId = {}, TaskProgress* progress = nullptr);
+    void run(const AssemblyInstances& instances, TaskProgress* progress = nullptr);
+
+    // Results of the last run, sorted by tree node identifiers
+    const std::vector<Result>& results() const { return m_vecResult; }
+
+    // Count of pairs retained by the broad phase in the last run
+    int candidatePairCount() const { return m_candidatePairCount; }
+    // Count of pairs that couldn't be checked because of missing triangulation in the last run
+    int uncheckedPairCount() const { return m_uncheckedPairCount; }
+
+    // Emitted from the threads processing pairs as soon as an interference is confirmed. Emissions
+    // are serialized, so that slots connected with Signal::connectSlot() are safely called
+    Signal<const Result&> signalResultFound;
+
+private:
+    QuantityLength m_tolerance = 0.001 * Quantity_Millimeter;
+    bool m_isCommonVolumeEnabled = false;
+    std::vector<Result> m_vecResult;
+    int m_candidatePairCount = 0;
+    int m_uncheckedPairCount = 0;
+};
+
+} // namespace Mayo
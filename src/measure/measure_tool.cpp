@@ -31,12 +31,13 @@ MeasureValue IMeasureTool_computeValue(
         const IMeasureTool& tool,
         MeasureType type,
         const GraphicsOwnerPtr& owner1,
-        const GraphicsOwnerPtr& owner2)
+        const GraphicsOwnerPtr& owner2,
+        TaskProgress* progress)
 {
     MeasureValue value;
     switch (type) {
     case MeasureType::MinDistance:
-        return tool.minDistance(owner1, owner2);
+        return tool.minDistance(owner1, owner2, progress);
     case MeasureType::Angle:
         return tool.angle(owner1, owner2);
     default:
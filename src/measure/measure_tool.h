@@ -21,6 +21,8 @@
 
 namespace Mayo {
 
+class TaskProgress;
+
 // Void measure value
 struct MeasureNone {};
 
@@ -68,10 +70,20 @@ public:
 
     virtual gp_Pnt vertexPosition(const GraphicsOwnerPtr& owner) const = 0;
     virtual MeasureCircle circle(const GraphicsOwnerPtr& owner) const = 0;
-    virtual MeasureMinDistance minDistance(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const = 0;
+    // Minimum distance computation might be long, it's interrupted when abort is requested on
+    // 'progress'(which can be null)
+    virtual MeasureMinDistance minDistance(
+            const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2, TaskProgress* progress
+    ) const = 0;
     virtual MeasureAngle angle(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const = 0;
     virtual QuantityLength length(const GraphicsOwnerPtr& owner) const = 0;
     virtual QuantityArea area(const GraphicsOwnerPtr& owner) const = 0;
+
+    // Returns a copy of 'owner' capturing the graphics data needed by the measure services(placement,
+    // mesh, ...). Measure services can then be called with the copy from a worker thread, even if
+    // the graphics object of 'owner' is modified meanwhile(eg exploded, mesh replaced)
+    // Must be called in the main thread. Default implementation returns 'owner' as is
+    virtual GraphicsOwnerPtr snapshotOwner(const GraphicsOwnerPtr& owner) const { return owner; }
 };
 
 // Base interface for errors reported by measurement services of IMeasureTool
@@ -103,7 +115,8 @@ MeasureValue IMeasureTool_computeValue(
         const IMeasureTool& tool,
         MeasureType type,
         const GraphicsOwnerPtr& owner1,
-        const GraphicsOwnerPtr& owner2
+        const GraphicsOwnerPtr& owner2,
+        TaskProgress* progress = nullptr
 );
 
 } // namespace Mayo
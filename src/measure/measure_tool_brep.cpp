@@ -7,7 +7,9 @@
 #include "measure_tool_brep.h"
 
 #include "../base/geom_utils.h"
+#include "../base/global.h"
 #include "../base/math_utils.h"
+#include "../base/occ_progress_indicator.h"
 #include "../base/text_id.h"
 #include "../graphics/graphics_shape_object_driver.h"
 
@@ -154,9 +156,10 @@ MeasureCircle MeasureToolBRep::circle(const GraphicsOwnerPtr& owner) const
     return brepCircle(getShape(owner));
 }
 
-MeasureMinDistance MeasureToolBRep::minDistance(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const
+MeasureMinDistance MeasureToolBRep::minDistance(
+        const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2, TaskProgress* progress) const
 {
-    return brepMinDistance(getShape(owner1), getShape(owner2));
+    return brepMinDistance(getShape(owner1), getShape(owner2), progress);
 }
 
 MeasureAngle MeasureToolBRep::angle(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const
@@ -179,6 +182,17 @@ QuantityArea MeasureToolBRep::area(const GraphicsOwnerPtr& owner) const
     return area * Quantity_SquareMillimeter;
 }
 
+GraphicsOwnerPtr MeasureToolBRep::snapshotOwner(const GraphicsOwnerPtr& owner) const
+{
+    auto brepOwner = Handle_StdSelect_BRepOwner::DownCast(owner);
+    if (!brepOwner)
+        return owner;
+
+    // Owner without selectable object, so its location is identity and getShape() returns the
+    // shape as placed at the time of the snapshot
+    return new StdSelect_BRepOwner(getShape(owner), brepOwner->Priority());
+}
+
 gp_Pnt MeasureToolBRep::brepVertexPosition(const TopoDS_Shape& shape)
 {
     throwErrorIf<ErrorCode::NotVertex>(shape.IsNull() || shape.ShapeType() != TopAbs_VERTEX);
@@ -272,12 +286,21 @@ MeasureCircle MeasureToolBRep::brepCircle(const TopoDS_Shape& shape)
 }
 
 MeasureMinDistance MeasureToolBRep::brepMinDistance(
-        const TopoDS_Shape& shape1, const TopoDS_Shape& shape2)
+        const TopoDS_Shape& shape1, const TopoDS_Shape& shape2, TaskProgress* progress)
 {
     throwErrorIf<ErrorCode::NotBRepShape>(shape1.IsNull());
     throwErrorIf<ErrorCode::NotBRepShape>(shape2.IsNull());
 
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    // Computation stops once abort is requested, then it's reported as not done
+    Handle_Message_ProgressIndicator indicator = new OccProgressIndicator(progress);
+    const BRepExtrema_DistShapeShape dist(
+                shape1, shape2, Extrema_ExtFlag_MINMAX, Extrema_ExtAlgo_Grad, TKernelUtils::start(indicator)
+    );
+#else
     const BRepExtrema_DistShapeShape dist(shape1, shape2);
+    MAYO_UNUSED(progress);
+#endif
     throwErrorIf<ErrorCode::MinDistanceFailure>(!dist.IsDone());
 
     MeasureMinDistance distResult;
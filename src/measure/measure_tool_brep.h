@@ -22,14 +22,19 @@ public:
 
     gp_Pnt vertexPosition(const GraphicsOwnerPtr& owner) const override;
     MeasureCircle circle(const GraphicsOwnerPtr& owner) const override;
-    MeasureMinDistance minDistance(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const override;
+    MeasureMinDistance minDistance(
+            const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2, TaskProgress* progress
+    ) const override;
     MeasureAngle angle(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const override;
     QuantityLength length(const GraphicsOwnerPtr& owner) const override;
     QuantityArea area(const GraphicsOwnerPtr& owner) const override;
+    GraphicsOwnerPtr snapshotOwner(const GraphicsOwnerPtr& owner) const override;
 
     static gp_Pnt brepVertexPosition(const TopoDS_Shape& shape);
     static MeasureCircle brepCircle(const TopoDS_Shape& shape);
-    static MeasureMinDistance brepMinDistance(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2);
+    static MeasureMinDistance brepMinDistance(
+            const TopoDS_Shape& shape1, const TopoDS_Shape& shape2, TaskProgress* progress = nullptr
+    );
     static MeasureAngle brepAngle(const TopoDS_Shape& shape1, const TopoDS_Shape& shape2);
     static QuantityLength brepLength(const TopoDS_Shape& shape);
 
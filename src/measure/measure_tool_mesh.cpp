@@ -0,0 +1,658 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#include "measure_tool_mesh.h"
+
+#include "../base/box_bvh.h"
+#include "../base/mesh_utils.h"
+#include "../base/text_id.h"
+#include "../graphics/graphics_mesh_data_source.h"
+#include "../graphics/graphics_mesh_object_driver.h"
+
+#include <MeshVS_Mesh.hxx>
+#include <MeshVS_MeshEntityOwner.hxx>
+#include <MeshVS_SelectionModeFlags.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Mayo {
+
+namespace {
+
+enum class ErrorCode {
+    Unknown,
+    NotMeshEntity,
+    NotMeshNode,
+    NotMeshTriangleOrMesh,
+    EmptyMesh,
+    MinDistanceFailure,
+    UnsupportedMeasure
+};
+
+template<ErrorCode Err>
+class MeshMeasureError : public IMeasureError {
+    MAYO_DECLARE_TEXT_ID_FUNCTIONS(Mayo::MeshMeasureError)
+public:
+    std::string_view message() const override
+    {
+        switch (Err) {
+        case ErrorCode::NotMeshEntity:
+            return textIdTr("Entity must be a mesh node, triangle or whole mesh");
+        case ErrorCode::NotMeshNode:
+            return textIdTr("Entity must be a mesh node");
+        case ErrorCode::NotMeshTriangleOrMesh:
+            return textIdTr("Entity must be a mesh triangle or whole mesh");
+        case ErrorCode::EmptyMesh:
+            return textIdTr("Mesh has no triangles");
+        case ErrorCode::MinDistanceFailure:
+            return textIdTr("Computation of minimum distance failed");
+        case ErrorCode::UnsupportedMeasure:
+            return textIdTr("Measure not supported for mesh entities");
+        default:
+            return textIdTr("Unknown error");
+        }
+    }
+};
+
+template<ErrorCode Err> void throwErrorIf(bool cond)
+{
+    if (cond)
+        throw MeshMeasureError<Err>();
+}
+
+// Point or triangle
+struct Primitive {
+    std::array<gp_XYZ, 3> pnts;
+    int pntCount = 0; // 1 for a point, 3 for a triangle
+};
+
+struct ClosestPoints {
+    gp_XYZ pnt1;
+    gp_XYZ pnt2;
+    double sqrDistance = std::numeric_limits<double>::max();
+};
+
+// Axis-aligned bounding box
+struct Aabb {
+    gp_XYZ min;
+    gp_XYZ max;
+};
+
+Primitive transformed(const Primitive& prim, const gp_Trsf& trsf)
+{
+    Primitive res = prim;
+    for (int i = 0; i < prim.pntCount; ++i)
+        trsf.Transforms(res.pnts[i]);
+
+    return res;
+}
+
+void enlarge(Aabb* box, const gp_XYZ& pnt)
+{
+    box->min.SetCoord(std::min(box->min.X(), pnt.X()), std::min(box->min.Y(), pnt.Y()), std::min(box->min.Z(), pnt.Z()));
+    box->max.SetCoord(std::max(box->max.X(), pnt.X()), std::max(box->max.Y(), pnt.Y()), std::max(box->max.Z(), pnt.Z()));
+}
+
+Aabb primitiveBox(const Primitive& prim)
+{
+    Aabb box{ prim.pnts[0], prim.pnts[0] };
+    for (int i = 1; i < prim.pntCount; ++i)
+        enlarge(&box, prim.pnts[i]);
+
+    return box;
+}
+
+Aabb transformed(const Aabb& box, const gp_Trsf& trsf)
+{
+    Aabb res;
+    for (int i = 0; i < 8; ++i) {
+        gp_XYZ corner(
+                    (i & 1) ? box.max.X() : box.min.X(),
+                    (i & 2) ? box.max.Y() : box.min.Y(),
+                    (i & 4) ? box.max.Z() : box.min.Z()
+        );
+        trsf.Transforms(corner);
+        if (i == 0)
+            res = Aabb{ corner, corner };
+        else
+            enlarge(&res, corner);
+    }
+
+    return res;
+}
+
+double sqrDistance(const Aabb& box1, const Aabb& box2)
+{
+    double sqrDist = 0.;
+    for (int i = 1; i <= 3; ++i) {
+        const double gap = std::max({
+            0., box1.min.Coord(i) - box2.max.Coord(i), box2.min.Coord(i) - box1.max.Coord(i)
+        });
+        sqrDist += gap * gap;
+    }
+
+    return sqrDist;
+}
+
+// Point of triangle(a, b, c) closest to point 'p'
+// See "Real-Time Collision Detection" by Christer Ericson, section 5.1.5
+gp_XYZ closestPointOnTriangle(const gp_XYZ& p, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+{
+    const gp_XYZ ab = b - a;
+    const gp_XYZ ac = c - a;
+    const gp_XYZ ap = p - a;
+    const double d1 = ab.Dot(ap);
+    const double d2 = ac.Dot(ap);
+    if (d1 <= 0 && d2 <= 0)
+        return a;
+
+    const gp_XYZ bp = p - b;
+    const double d3 = ab.Dot(bp);
+    const double d4 = ac.Dot(bp);
+    if (d3 >= 0 && d4 <= d3)
+        return b;
+
+    const double vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0)
+        return a + ab * (d1 / (d1 - d3));
+
+    const gp_XYZ cp = p - c;
+    const double d5 = ab.Dot(cp);
+    const double d6 = ac.Dot(cp);
+    if (d6 >= 0 && d5 <= d6)
+        return c;
+
+    const double vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0)
+        return a + ac * (d2 / (d2 - d6));
+
+    const double va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+    const double sum = va + vb + vc;
+    if (sum <= 0) // Degenerated triangle
+        return a;
+
+    return a + ab * (vb / sum) + ac * (vc / sum);
+}
+
+// Closest points between segments [p1, q1] and [p2, q2]
+// See "Real-Time Collision Detection" by Christer Ericson, section 5.1.9
+std::pair<gp_XYZ, gp_XYZ> closestPointsOnSegments(
+        const gp_XYZ& p1, const gp_XYZ& q1, const gp_XYZ& p2, const gp_XYZ& q2)
+{
+    const gp_XYZ d1 = q1 - p1;
+    const gp_XYZ d2 = q2 - p2;
+    const gp_XYZ r = p1 - p2;
+    const double a = d1.SquareModulus();
+    const double e = d2.SquareModulus();
+    const double f = d2.Dot(r);
+    double s = 0.;
+    double t = 0.;
+    if (a > 0 && e <= 0) {
+        s = std::clamp(-d1.Dot(r) / a, 0., 1.);
+    }
+    else if (a <= 0 && e > 0) {
+        t = std::clamp(f / e, 0., 1.);
+    }
+    else if (a > 0 && e > 0) {
+        const double b = d1.Dot(d2);
+        const double c = d1.Dot(r);
+        const double denom = a * e - b * b;
+        s = denom > 0 ? std::clamp((b * f - c * e) / denom, 0., 1.) : 0.;
+        t = (b * s + f) / e;
+        if (t < 0) {
+            t = 0.;
+            s = std::clamp(-c / a, 0., 1.);
+        }
+        else if (t > 1) {
+            t = 1.;
+            s = std::clamp((b - c) / a, 0., 1.);
+        }
+    }
+
+    return { p1 + d1 * s, p2 + d2 * t };
+}
+
+// Intersection point of segment [p, q] with triangle(a, b, c), if any
+// Coplanar configurations are not reported
+std::optional<gp_XYZ> segmentTriangleIntersection(
+        const gp_XYZ& p, const gp_XYZ& q, const gp_XYZ& a, const gp_XYZ& b, const gp_XYZ& c)
+{
+    // Moller-Trumbore ray/triangle intersection, restricted to the segment
+    const gp_XYZ dir = q - p;
+    const gp_XYZ e1 = b - a;
+    const gp_XYZ e2 = c - a;
+    const gp_XYZ h = dir ^ e2;
+    const double det = e1.Dot(h);
+    if (det == 0.)
+        return {};
+
+    const gp_XYZ s = p - a;
+    const double u = s.Dot(h) / det;
+    if (u < 0 || u > 1)
+        return {};
+
+    const gp_XYZ sxe1 = s ^ e1;
+    const double v = dir.Dot(sxe1) / det;
+    if (v < 0 || u + v > 1)
+        return {};
+
+    const double t = e2.Dot(sxe1) / det;
+    if (t < 0 || t > 1)
+        return {};
+
+    return p + dir * t;
+}
+
+void updateClosest(ClosestPoints* best, const gp_XYZ& pnt1, const gp_XYZ& pnt2)
+{
+    const double sqrDist = (pnt2 - pnt1).SquareModulus();
+    if (sqrDist < best->sqrDistance)
+        *best = { pnt1, pnt2, sqrDist };
+}
+
+// Updates 'best' with the closest points between primitives 'prim1' and 'prim2'
+void updateClosest(ClosestPoints* best, const Primitive& prim1, const Primitive& prim2)
+{
+    const auto& p = prim1.pnts;
+    const auto& q = prim2.pnts;
+    if (prim1.pntCount == 1 && prim2.pntCount == 1) {
+        updateClosest(best, p[0], q[0]);
+    }
+    else if (prim1.pntCount == 1) {
+        updateClosest(best, p[0], closestPointOnTriangle(p[0], q[0], q[1], q[2]));
+    }
+    else if (prim2.pntCount == 1) {
+        updateClosest(best, closestPointOnTriangle(q[0], p[0], p[1], p[2]), q[0]);
+    }
+    else {
+        // Crossing triangles: an edge of one triangle goes through the other one
+        for (int i = 0; i < 3; ++i) {
+            auto pnt = segmentTriangleIntersection(p[i], p[(i + 1) % 3], q[0], q[1], q[2]);
+            if (!pnt)
+                pnt = segmentTriangleIntersection(q[i], q[(i + 1) % 3], p[0], p[1], p[2]);
+
+            if (pnt) {
+                updateClosest(best, *pnt, *pnt);
+                return;
+            }
+        }
+
+        // Otherwise minimum distance is reached at a vertex or between two edges
+        for (int i = 0; i < 3; ++i) {
+            updateClosest(best, p[i], closestPointOnTriangle(p[i], q[0], q[1], q[2]));
+            updateClosest(best, closestPointOnTriangle(q[i], p[0], p[1], p[2]), q[i]);
+            for (int j = 0; j < 3; ++j) {
+                const auto [pnt1, pnt2] = closestPointsOnSegments(p[i], p[(i + 1) % 3], q[j], q[(j + 1) % 3]);
+                updateClosest(best, pnt1, pnt2);
+            }
+        }
+    }
+}
+
+// Triangle at index 'i'(1-based) in 'triangulation'
+Primitive triangle(const Handle_Poly_Triangulation& triangulation, int i)
+{
+    int n1, n2, n3;
+    triangulation->Triangle(i).Get(n1, n2, n3);
+    Primitive tri;
+    tri.pnts = { triangulation->Node(n1).XYZ(), triangulation->Node(n2).XYZ(), triangulation->Node(n3).XYZ() };
+    tri.pntCount = 3;
+    return tri;
+}
+
+Aabb toAabb(const Bnd_Box& box)
+{
+    return Aabb{ box.CornerMin().XYZ(), box.CornerMax().XYZ() };
+}
+
+// BVH of the triangles of a Poly_Triangulation, expressed in the frame of the triangulation
+// Item 'i' of the BoxBvh is the triangle at index 'i + 1' in the triangulation
+struct TriangulationBvh {
+    TriangulationBvh(const Handle_Poly_Triangulation& mesh);
+
+    Primitive itemTriangle(int item) const { return triangle(this->triangulation, item + 1); }
+
+    Handle_Poly_Triangulation triangulation;
+    BoxBvh bvh;
+};
+
+TriangulationBvh::TriangulationBvh(const Handle_Poly_Triangulation& mesh)
+    : triangulation(mesh)
+{
+    std::vector<Bnd_Box> vecTriangleBox(mesh->NbTriangles());
+    for (int i = 0; i < int(vecTriangleBox.size()); ++i) {
+        const Primitive tri = triangle(mesh, i + 1);
+        for (const gp_XYZ& pnt : tri.pnts)
+            vecTriangleBox.at(i).Add(gp_Pnt(pnt));
+    }
+
+    this->bvh = BoxBvh(std::move(vecTriangleBox), 8);
+}
+
+// BVHs of the most recently used triangulations
+struct TriangulationBvhCache {
+    static constexpr size_t MaxCount = 4;
+    std::mutex mutex;
+    std::list<std::shared_ptr<const TriangulationBvh>> listBvh;
+};
+
+TriangulationBvhCache& triangulationBvhCache()
+{
+    static TriangulationBvhCache cache;
+    return cache;
+}
+
+// Returns the BVH of 'triangulation', built on first request
+std::shared_ptr<const TriangulationBvh> getTriangulationBvh(const Handle_Poly_Triangulation& triangulation)
+{
+    TriangulationBvhCache& cache = triangulationBvhCache();
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto itFound = std::find_if(cache.listBvh.begin(), cache.listBvh.end(), [&](const auto& bvh) {
+            // Also check triangle count in case the triangulation was modified in place
+            return bvh->triangulation == triangulation
+                    && bvh->bvh.itemCount() == triangulation->NbTriangles();
+        });
+        if (itFound != cache.listBvh.end()) {
+            cache.listBvh.splice(cache.listBvh.begin(), cache.listBvh, itFound);
+            return cache.listBvh.front();
+        }
+    }
+
+    // Build can be long with huge meshes, don't block concurrent requests meanwhile
+    auto bvh = std::make_shared<const TriangulationBvh>(triangulation);
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.listBvh.remove_if([&](const auto& item) { return item->triangulation == triangulation; });
+    cache.listBvh.push_front(bvh);
+    if (cache.listBvh.size() > TriangulationBvhCache::MaxCount)
+        cache.listBvh.pop_back();
+
+    return bvh;
+}
+
+// Updates 'best' with the closest points between the triangles of 'bvh' and primitive 'prim'
+// 'prim' must be expressed in the frame of the triangulation
+void updateClosest(ClosestPoints* best, const TriangulationBvh& bvh, const Primitive& prim)
+{
+    const Aabb primBox = primitiveBox(prim);
+    bvh.bvh.visitNearest(
+        [&](const Bnd_Box& box) { return sqrDistance(toAabb(box), primBox); },
+        [&](int item) {
+            updateClosest(best, bvh.itemTriangle(item), prim);
+            return best->sqrDistance;
+        }
+    );
+}
+
+// Updates 'best' with the closest points between the triangles of 'bvh1' and 'bvh2'
+// 'trsf' is the transformation from the frame of 'bvh2' to the frame of 'bvh1'
+void updateClosest(ClosestPoints* best, const TriangulationBvh& bvh1, const TriangulationBvh& bvh2, const gp_Trsf& trsf)
+{
+    BoxBvh::visitNearestPairs(
+        bvh1.bvh, bvh2.bvh,
+        [&](const Bnd_Box& box1, const Bnd_Box& box2) {
+            return sqrDistance(toAabb(box1), transformed(toAabb(box2), trsf));
+        },
+        [&](int item1, int item2) {
+            updateClosest(best, bvh1.itemTriangle(item1), transformed(bvh2.itemTriangle(item2), trsf));
+            return best->sqrDistance;
+        }
+    );
+}
+
+MeasureMinDistance toMeasureMinDistance(const ClosestPoints& closest, const gp_Trsf& trsf)
+{
+    throwErrorIf<ErrorCode::MinDistanceFailure>(closest.sqrDistance == std::numeric_limits<double>::max());
+    MeasureMinDistance distResult;
+    distResult.pnt1 = gp_Pnt(closest.pnt1).Transformed(trsf);
+    distResult.pnt2 = gp_Pnt(closest.pnt2).Transformed(trsf);
+    distResult.value = distResult.pnt1.Distance(distResult.pnt2) * Quantity_Millimeter;
+    return distResult;
+}
+
+// Minimum distance between triangulation 'mesh' placed with 'trsf' and primitive 'prim'
+MeasureMinDistance meshPrimitiveMinDistance(
+        const Handle_Poly_Triangulation& mesh, const gp_Trsf& trsf, const Primitive& prim)
+{
+    throwErrorIf<ErrorCode::EmptyMesh>(mesh.IsNull() || mesh->NbTriangles() == 0);
+    ClosestPoints closest;
+    updateClosest(&closest, *getTriangulationBvh(mesh), transformed(prim, trsf.Inverted()));
+    return toMeasureMinDistance(closest, trsf);
+}
+
+// Mesh entity pointed to by a graphics owner
+struct MeshEntity {
+    Handle_Poly_Triangulation triangulation;
+    gp_Trsf trsf; // Placement of the triangulation
+    // MeshVS_ET_Node, MeshVS_ET_Face or MeshVS_ET_All for the whole mesh
+    MeshVS_EntityType type = MeshVS_ET_NONE;
+    int id = 0; // Index of the node or triangle in the triangulation
+};
+
+// Graphics owner holding a mesh entity captured by MeasureToolMesh::snapshotOwner()
+class MeshEntitySnapshotOwner : public SelectMgr_EntityOwner {
+public:
+    MeshEntitySnapshotOwner(const MeshEntity& entity) : m_entity(entity) {}
+    const MeshEntity& entity() const { return m_entity; }
+
+    DEFINE_STANDARD_RTTI_INLINE(MeshEntitySnapshotOwner, SelectMgr_EntityOwner)
+
+private:
+    MeshEntity m_entity;
+};
+
+MeshEntity getMeshEntity(const GraphicsOwnerPtr& owner)
+{
+    auto snapshot = Handle(MeshEntitySnapshotOwner)::DownCast(owner);
+    if (snapshot)
+        return snapshot->entity();
+
+    MeshEntity entity;
+    auto mesh = owner ? Handle_MeshVS_Mesh::DownCast(owner->Selectable()) : Handle_MeshVS_Mesh();
+    if (!mesh)
+        return entity;
+
+    auto dataSource = Handle(GraphicsMeshDataSource)::DownCast(mesh->GetDataSource());
+    if (!dataSource || dataSource->triangulation().IsNull())
+        return entity;
+
+    entity.triangulation = dataSource->triangulation();
+    entity.trsf = owner->Location().Transformation();
+    auto entityOwner = Handle_MeshVS_MeshEntityOwner::DownCast(owner);
+    if (!entityOwner) {
+        entity.type = MeshVS_ET_All;
+    }
+    else if (!entityOwner->IsGroup()) {
+        entity.type = entityOwner->Type();
+        entity.id = entityOwner->ID();
+    }
+
+    return entity;
+}
+
+// Node or triangle pointed to by 'entity', in world frame
+Primitive getPrimitive(const MeshEntity& entity)
+{
+    Primitive prim;
+    if (entity.type == MeshVS_ET_Node) {
+        prim.pnts[0] = entity.triangulation->Node(entity.id).XYZ();
+        prim.pntCount = 1;
+    }
+    else if (entity.type == MeshVS_ET_Face) {
+        int n1, n2, n3;
+        entity.triangulation->Triangle(entity.id).Get(n1, n2, n3);
+        prim.pnts = {
+            entity.triangulation->Node(n1).XYZ(),
+            entity.triangulation->Node(n2).XYZ(),
+            entity.triangulation->Node(n3).XYZ()
+        };
+        prim.pntCount = 3;
+    }
+
+    return transformed(prim, entity.trsf);
+}
+
+bool isPrimitiveEntity(const MeshEntity& entity)
+{
+    if (entity.triangulation.IsNull())
+        return false;
+
+    if (entity.type == MeshVS_ET_Node)
+        return 1 <= entity.id && entity.id <= entity.triangulation->NbNodes();
+
+    if (entity.type == MeshVS_ET_Face)
+        return 1 <= entity.id && entity.id <= entity.triangulation->NbTriangles();
+
+    return false;
+}
+
+bool isWholeMeshEntity(const MeshEntity& entity)
+{
+    return !entity.triangulation.IsNull() && entity.type == MeshVS_ET_All;
+}
+
+} // namespace
+
+Span<const GraphicsObjectSelectionMode> MeasureToolMesh::selectionModes(MeasureType type) const
+{
+    switch (type) {
+    case MeasureType::VertexPosition: {
+        static const GraphicsObjectSelectionMode modes[] = { MeshVS_SMF_Node };
+        return modes;
+    }
+    case MeasureType::MinDistance: {
+        static const GraphicsObjectSelectionMode modes[] = { MeshVS_SMF_Mesh, MeshVS_SMF_Node, MeshVS_SMF_Face };
+        return modes;
+    }
+    case MeasureType::Area: {
+        static const GraphicsObjectSelectionMode modes[] = { MeshVS_SMF_Face };
+        return modes;
+    }
+    default: {
+        return {};
+    }
+    } // endswitch
+}
+
+bool MeasureToolMesh::supports(const GraphicsObjectPtr& object) const
+{
+    auto gfxDriver = GraphicsObjectDriver::get(object);
+    return gfxDriver ? !GraphicsMeshObjectDriverPtr::DownCast(gfxDriver).IsNull() : false;
+}
+
+bool MeasureToolMesh::supports(MeasureType type) const
+{
+    return type == MeasureType::VertexPosition || type == MeasureType::MinDistance || type == MeasureType::Area;
+}
+
+gp_Pnt MeasureToolMesh::vertexPosition(const GraphicsOwnerPtr& owner) const
+{
+    const MeshEntity entity = getMeshEntity(owner);
+    throwErrorIf<ErrorCode::NotMeshNode>(!isPrimitiveEntity(entity) || entity.type != MeshVS_ET_Node);
+    return getPrimitive(entity).pnts[0];
+}
+
+MeasureCircle MeasureToolMesh::circle(const GraphicsOwnerPtr& /*owner*/) const
+{
+    throw MeshMeasureError<ErrorCode::UnsupportedMeasure>();
+}
+
+MeasureMinDistance MeasureToolMesh::minDistance(
+        const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2, TaskProgress* /*progress*/) const
+{
+    const MeshEntity entity1 = getMeshEntity(owner1);
+    const MeshEntity entity2 = getMeshEntity(owner2);
+    throwErrorIf<ErrorCode::NotMeshEntity>(!isPrimitiveEntity(entity1) && !isWholeMeshEntity(entity1));
+    throwErrorIf<ErrorCode::NotMeshEntity>(!isPrimitiveEntity(entity2) && !isWholeMeshEntity(entity2));
+    if (isWholeMeshEntity(entity1) && isWholeMeshEntity(entity2))
+        return meshMinDistance(entity1.triangulation, entity1.trsf, entity2.triangulation, entity2.trsf);
+
+    if (isWholeMeshEntity(entity1))
+        return meshPrimitiveMinDistance(entity1.triangulation, entity1.trsf, getPrimitive(entity2));
+
+    if (isWholeMeshEntity(entity2)) {
+        MeasureMinDistance distResult = meshPrimitiveMinDistance(entity2.triangulation, entity2.trsf, getPrimitive(entity1));
+        std::swap(distResult.pnt1, distResult.pnt2);
+        return distResult;
+    }
+
+    ClosestPoints closest;
+    updateClosest(&closest, getPrimitive(entity1), getPrimitive(entity2));
+    return toMeasureMinDistance(closest, gp_Trsf());
+}
+
+MeasureAngle MeasureToolMesh::angle(const GraphicsOwnerPtr& /*owner1*/, const GraphicsOwnerPtr& /*owner2*/) const
+{
+    throw MeshMeasureError<ErrorCode::UnsupportedMeasure>();
+}
+
+QuantityLength MeasureToolMesh::length(const GraphicsOwnerPtr& /*owner*/) const
+{
+    throw MeshMeasureError<ErrorCode::UnsupportedMeasure>();
+}
+
+QuantityArea MeasureToolMesh::area(const GraphicsOwnerPtr& owner) const
+{
+    // Only one triangle or the whole mesh, a region made of several triangles isn't supported
+    const MeshEntity entity = getMeshEntity(owner);
+    if (isWholeMeshEntity(entity)) {
+        const double scale = entity.trsf.ScaleFactor();
+        return MeshUtils::triangulationArea(entity.triangulation) * scale * scale * Quantity_SquareMillimeter;
+    }
+
+    throwErrorIf<ErrorCode::NotMeshTriangleOrMesh>(!isPrimitiveEntity(entity) || entity.type != MeshVS_ET_Face);
+    const Primitive tri = getPrimitive(entity);
+    return MeshUtils::triangleArea(tri.pnts[0], tri.pnts[1], tri.pnts[2]) * Quantity_SquareMillimeter;
+}
+
+GraphicsOwnerPtr MeasureToolMesh::snapshotOwner(const GraphicsOwnerPtr& owner) const
+{
+    const MeshEntity entity = getMeshEntity(owner);
+    if (entity.triangulation.IsNull())
+        return owner;
+
+    return new MeshEntitySnapshotOwner(entity);
+}
+
+void MeasureToolMesh::clearCache()
+{
+    TriangulationBvhCache& cache = triangulationBvhCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.listBvh.clear();
+}
+
+MeasureMinDistance MeasureToolMesh::meshMinDistance(
+        const Handle_Poly_Triangulation& mesh1, const gp_Trsf& trsf1,
+        const Handle_Poly_Triangulation& mesh2, const gp_Trsf& trsf2)
+{
+    throwErrorIf<ErrorCode::EmptyMesh>(mesh1.IsNull() || mesh1->NbTriangles() == 0);
+    throwErrorIf<ErrorCode::EmptyMesh>(mesh2.IsNull() || mesh2->NbTriangles() == 0);
+    ClosestPoints closest;
+    updateClosest(&closest, *getTriangulationBvh(mesh1), *getTriangulationBvh(mesh2), trsf1.Inverted() * trsf2);
+    return toMeasureMinDistance(closest, trsf1);
+}
+
+MeasureMinDistance MeasureToolMesh::meshMinDistance(
+        const Handle_Poly_Triangulation& mesh, const gp_Trsf& trsf, const gp_Pnt& pnt)
+{
+    Primitive prim;
+    prim.pnts[0] = pnt.XYZ();
+    prim.pntCount = 1;
+    return meshPrimitiveMinDistance(mesh, trsf, prim);
+}
+
+} // namespace Mayo
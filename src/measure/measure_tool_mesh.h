@@ -0,0 +1,54 @@
+/****************************************************************************
+** Copyright (c) 2023, Fougue Ltd. <http://www.fougue.pro>
+** All rights reserved.
+** See license at https://github.com/fougue/mayo/blob/master/LICENSE.txt
+****************************************************************************/
+
+#pragma once
+
+#include "measure_tool.h"
+
+#include <Poly_Triangulation.hxx>
+#include <gp_Trsf.hxx>
+
+namespace Mayo {
+
+// Provides measurement services for mesh objects(see GraphicsMeshObjectDriver)
+//
+// Supported entities are mesh nodes, triangles and whole meshes. Queries involving a whole mesh
+// are accelerated by a BVH of its triangles, built on first use and kept in a cache shared by all
+// MeasureToolMesh objects
+// Area is measured for a single triangle or a whole mesh only: regions made of several selected
+// triangles aren't supported
+class MeasureToolMesh : public IMeasureTool {
+public:
+    Span<const GraphicsObjectSelectionMode> selectionModes(MeasureType type) const override;
+    bool supports(const GraphicsObjectPtr& object) const override;
+    bool supports(MeasureType type) const override;
+
+    gp_Pnt vertexPosition(const GraphicsOwnerPtr& owner) const override;
+    MeasureCircle circle(const GraphicsOwnerPtr& owner) const override;
+    MeasureMinDistance minDistance(
+            const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2, TaskProgress* progress
+    ) const override;
+    MeasureAngle angle(const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) const override;
+    QuantityLength length(const GraphicsOwnerPtr& owner) const override;
+    QuantityArea area(const GraphicsOwnerPtr& owner) const override;
+    GraphicsOwnerPtr snapshotOwner(const GraphicsOwnerPtr& owner) const override;
+
+    // Releases the cached BVHs, which keep their triangulations alive. Typically called when a
+    // document is closed
+    static void clearCache();
+
+    // Minimum distance between two triangulations, each one being placed with transformation 'trsf'
+    static MeasureMinDistance meshMinDistance(
+            const Handle_Poly_Triangulation& mesh1, const gp_Trsf& trsf1,
+            const Handle_Poly_Triangulation& mesh2, const gp_Trsf& trsf2
+    );
+    // Minimum distance between a triangulation placed with transformation 'trsf' and point 'pnt'
+    static MeasureMinDistance meshMinDistance(
+            const Handle_Poly_Triangulation& mesh, const gp_Trsf& trsf, const gp_Pnt& pnt
+    );
+};
+
+} // namespace Mayo
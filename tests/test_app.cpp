@@ -11,14 +11,39 @@
 
 #include "test_app.h"
 
+#include "../src/app/document_tree_item_model.h"
 #include "../src/app/filepath_conv.h"
+#include "../src/app/io_worker_process.h"
+#include "../src/app/measure_cache.h"
 #include "../src/app/qstring_conv.h"
 #include "../src/app/qstring_utils.h"
 #include "../src/app/qtgui_utils.h"
 #include "../src/app/recent_files.h"
 #include "../src/app/theme.h"
+#include "../src/app/widget_model_tree_builder.h"
+#include "../src/base/application.h"
+#include "../src/base/application_item_selection_model.h"
+#include "../src/base/brep_utils.h"
+#include "../src/base/mesh_utils.h"
+#include "../src/base/property_builtins.h"
+#include "../src/base/settings.h"
+#include "../src/base/xcaf.h"
+#include "../src/graphics/graphics_mesh_object_driver.h"
+#include "../src/graphics/graphics_scene.h"
+#include "../src/graphics/graphics_shape_object_driver.h"
+#include "../src/gui/gui_application.h"
+#include "../src/gui/gui_document.h"
+#include "../src/gui/hlr_controller.h"
+#include "../src/gui/mesh_preview_controller.h"
+#include "../src/io_image/io_image.h"
 #include "../src/io_occ/io_occ.h"
 
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepTools.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
+#include <gp_Vec.hxx>
+
 #include <QtCore/QtDebug>
 #include <QtCore/QFile>
 #include <QtCore/QTemporaryFile>
@@ -26,6 +51,16 @@
 #include <QtGui/QPainter>
 #include <QtGui/QPixmap>
 #include <QtTest/QSignalSpy>
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+#  include <QtTest/QAbstractItemModelTester>
+#endif
+
+#include <gsl/util>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Mayo {
 
@@ -189,4 +224,427 @@ void TestApp::QtGuiUtils_test()
     QCOMPARE(QtGuiUtils::toQColor(occColorA), qtColorA);
 }
 
+void TestApp::DocumentTreeItemModel_setData_test()
+{
+    // GuiDocument requires a graphics driver, which might not be available(eg headless environment)
+    try {
+        GraphicsScene scene;
+    } catch (...) {
+        QSKIP("Graphics driver not available");
+    }
+
+    auto app = Application::instance();
+    GuiApplication guiApp(app);
+    guiApp.addGraphicsObjectDriver(std::make_unique<GraphicsShapeObjectDriver>());
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    std::vector<TreeNodeId> vecEntityId;
+    for (int i = 0; i < 3; ++i) {
+        const TDF_Label label = doc->xcaf().shapeTool()->AddShape(shapeBox, false);
+        doc->addEntityTreeNode(label);
+        vecEntityId.push_back(doc->entityTreeNodeId(doc->entityCount() - 1));
+    }
+
+    const GuiDocument* guiDoc = guiApp.findGuiDocument(doc);
+    QVERIFY(guiDoc);
+    WidgetModelTreeBuilder builder;
+    DocumentTreeItemModel model;
+    model.setGuiApplication(&guiApp);
+    model.addBuilder(&builder);
+    model.appendDocument(doc);
+    for (TreeNodeId entityId : vecEntityId)
+        model.appendDocumentEntity(DocumentTreeNode(doc, entityId));
+
+    auto fnIndex = [&](int i) { return model.indexOf(DocumentTreeNode(doc, vecEntityId.at(i))); };
+    auto fnState = [&](int i) { return guiDoc->nodeVisibleState(vecEntityId.at(i)); };
+
+    // Unselected item: only its node is changed
+    QVERIFY(model.setData(fnIndex(0), Qt::Unchecked, Qt::CheckStateRole));
+    QCOMPARE(fnState(0), CheckState::Off);
+    QCOMPARE(fnState(1), CheckState::On);
+    QCOMPARE(fnState(2), CheckState::On);
+
+    // Selected item: all the selected nodes are changed
+    guiApp.selectionModel()->add(DocumentTreeNode(doc, vecEntityId.at(1)));
+    guiApp.selectionModel()->add(DocumentTreeNode(doc, vecEntityId.at(2)));
+    QVERIFY(model.setData(fnIndex(1), Qt::Unchecked, Qt::CheckStateRole));
+    QCOMPARE(fnState(1), CheckState::Off);
+    QCOMPARE(fnState(2), CheckState::Off);
+    QVERIFY(model.setData(fnIndex(2), Qt::Checked, Qt::CheckStateRole));
+    QCOMPARE(fnState(0), CheckState::Off);
+    QCOMPARE(fnState(1), CheckState::On);
+    QCOMPARE(fnState(2), CheckState::On);
+}
+
+void TestApp::DocumentTreeItemModel_modelTester_test()
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 11, 0)
+    // Merges references with their referred shape, like WidgetModelTreeBuilder_Xde does
+    class MergeReferenceBuilder : public WidgetModelTreeBuilder {
+    public:
+        TreeNodeId childrenHolderNode(const DocumentTreeNode& node) const override {
+            if (XCaf::isShapeReference(node.label())) {
+                const TreeNodeId productId = node.document()->modelTree().nodeChildFirst(node.id());
+                if (productId != 0)
+                    return productId;
+            }
+
+            return node.id();
+        }
+    };
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Assembly with two instances of the same product
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelProduct = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 20, 30), false);
+    const TDF_Label labelAssembly = shapeTool->NewShape();
+    const TDF_Label labelRef1 = shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location());
+    const TDF_Label labelRef2 = shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location());
+    shapeTool->UpdateAssemblies();
+
+    MergeReferenceBuilder builder;
+    DocumentTreeItemModel model;
+    QAbstractItemModelTester tester(&model, QAbstractItemModelTester::FailureReportingMode::QtTest);
+    model.addBuilder(&builder);
+    model.appendDocument(doc);
+    doc->addEntityTreeNode(labelAssembly);
+    const TreeNodeId entityId = doc->entityTreeNodeId(doc->entityCount() - 1);
+    model.appendDocumentEntity(DocumentTreeNode(doc, entityId));
+
+    // Children of the entity item are populated on request
+    const QModelIndex indexEntity = model.indexOf(DocumentTreeNode(doc, entityId));
+    QVERIFY(indexEntity.isValid());
+    QVERIFY(model.hasChildren(indexEntity));
+    QCOMPARE(model.rowCount(indexEntity), 2);
+
+    // Product nodes are merged with the items of the references
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    std::vector<TreeNodeId> vecRefId;
+    for (TreeNodeId id = modelTree.nodeChildFirst(entityId); id != 0; id = modelTree.nodeSiblingNext(id))
+        vecRefId.push_back(id);
+
+    QCOMPARE(int(vecRefId.size()), 2);
+    for (TreeNodeId refId : vecRefId) {
+        const QModelIndex indexRef = model.indexOf(DocumentTreeNode(doc, refId));
+        QVERIFY(indexRef.isValid());
+        QCOMPARE(indexRef.parent(), indexEntity);
+        QCOMPARE(model.documentTreeNode(indexRef).id(), refId);
+        QCOMPARE(model.indexOf(DocumentTreeNode(doc, modelTree.nodeChildFirst(refId))), indexRef);
+        QCOMPARE(model.rowCount(indexRef), 0);
+    }
+
+    // Only the items displaying the refreshed labels are notified
+    QSignalSpy spyDataChanged(&model, &QAbstractItemModel::dataChanged);
+    model.refreshItems(doc, std::vector<TDF_Label>{ labelRef1 });
+    QCOMPARE(spyDataChanged.count(), 1);
+    spyDataChanged.clear();
+    model.refreshItems(doc, std::vector<TDF_Label>{ labelProduct });
+    QCOMPARE(spyDataChanged.count(), 2);
+    spyDataChanged.clear();
+    model.refreshItems(doc, std::vector<TDF_Label>{ labelAssembly, labelRef2 });
+    QCOMPARE(spyDataChanged.count(), 2);
+
+    model.removeDocumentEntity(DocumentTreeNode(doc, entityId));
+    model.removeDocument(doc);
+#else
+    QSKIP("QAbstractItemModelTester requires Qt >= 5.11");
+#endif
+}
+
+void TestApp::WorkerProcessFactoryReader_settingsSnapshot_test()
+{
+    struct TestSettingsGroup : public PropertyGroup {
+        TestSettingsGroup(Settings* settings) : PropertyGroup(settings) {
+            const Settings::GroupIndex groupId = settings->addGroup(std::string_view("test"));
+            settings->addSetting(&this->visible, groupId);
+            settings->addSetting(&this->hidden, groupId);
+            this->visible.setValue(1);
+            this->hidden.setUserVisible(false);
+        }
+
+        PropertyInt visible{ this, TextId{ "TestApp", "visible" } };
+        PropertyInt hidden{ this, TextId{ "TestApp", "hidden" } };
+    };
+
+    Settings settings;
+    TestSettingsGroup group(&settings);
+    IO::WorkerProcessFactoryReader factory(std::make_unique<IO::OccFactoryReader>(), &settings, []{ return true; });
+
+    // Settings not visible to the user are excluded, like when the application settings are saved
+    std::shared_ptr<const Settings::Storage> snapshot1 = factory.settingsSnapshot();
+    QVERIFY(snapshot1);
+    QCOMPARE(snapshot1->value("test/visible").toInt(), 1);
+    QVERIFY(!snapshot1->contains("test/hidden"));
+
+    // Changing a setting captures a new snapshot, the previous one is left untouched
+    group.visible.setValue(2);
+    std::shared_ptr<const Settings::Storage> snapshot2 = factory.settingsSnapshot();
+    QVERIFY(snapshot2 != snapshot1);
+    QCOMPARE(snapshot2->value("test/visible").toInt(), 2);
+    QCOMPARE(snapshot1->value("test/visible").toInt(), 1);
+
+    // Snapshots can be accessed from other threads while the settings change
+    std::atomic<bool> isValueValid = true;
+    std::thread threadReader([&]{
+        for (int i = 0; i < 1000; ++i) {
+            const int value = factory.settingsSnapshot()->value("test/visible").toInt();
+            if (value < 2 || value > 100)
+                isValueValid = false;
+        }
+    });
+    for (int i = 3; i <= 100; ++i)
+        group.visible.setValue(i);
+
+    threadReader.join();
+    QVERIFY(isValueValid);
+    QCOMPARE(factory.settingsSnapshot()->value("test/visible").toInt(), 100);
+}
+
+void TestApp::MeasureCache_test()
+{
+    const GraphicsOwnerPtr ownerA = new SelectMgr_EntityOwner;
+    const GraphicsOwnerPtr ownerB = new SelectMgr_EntityOwner;
+    auto fnKey = [](MeasureType type, const GraphicsOwnerPtr& owner1, const GraphicsOwnerPtr& owner2) {
+        MeasureKey key;
+        key.type = type;
+        key.owner1 = owner1;
+        key.owner2 = owner2;
+        return key;
+    };
+    auto fnResult = [](const char* errorMessage) {
+        MeasureResult result;
+        result.errorMessage = errorMessage;
+        return result;
+    };
+
+    MeasureCache cache(2);
+    cache.add(fnKey(MeasureType::MinDistance, ownerA, ownerB), fnResult("distance"));
+    QCOMPARE(cache.count(), size_t(1));
+
+    // Symmetric measure is found whatever the order of owners
+    const MeasureResult* result = cache.find(fnKey(MeasureType::MinDistance, ownerB, ownerA));
+    QVERIFY(result);
+    QCOMPARE(result->errorMessage, QString("distance"));
+    cache.add(fnKey(MeasureType::MinDistance, ownerB, ownerA), fnResult("distance"));
+    QCOMPARE(cache.count(), size_t(1));
+
+    // Order of owners matters for other measures
+    cache.add(fnKey(MeasureType::CircleCenter, ownerA, ownerB), fnResult("circle"));
+    QVERIFY(cache.find(fnKey(MeasureType::CircleCenter, ownerA, ownerB)));
+    QVERIFY(!cache.find(fnKey(MeasureType::CircleCenter, ownerB, ownerA)));
+
+    // Measure depends on the state of the owners
+    MeasureKey keyMoved = fnKey(MeasureType::MinDistance, ownerA, ownerB);
+    keyMoved.state2.trsf.SetTranslation(gp_Vec(10, 0, 0));
+    QVERIFY(!cache.find(keyMoved));
+
+    // Least recently used entry is evicted
+    QVERIFY(cache.find(fnKey(MeasureType::MinDistance, ownerA, ownerB)));
+    cache.add(fnKey(MeasureType::Angle, ownerA, ownerB), fnResult("angle"));
+    QCOMPARE(cache.count(), size_t(2));
+    QVERIFY(!cache.find(fnKey(MeasureType::CircleCenter, ownerA, ownerB)));
+    QVERIFY(cache.find(fnKey(MeasureType::MinDistance, ownerA, ownerB)));
+    QVERIFY(cache.find(fnKey(MeasureType::Angle, ownerB, ownerA)));
+}
+
+void TestApp::MeshPreviewController_test()
+{
+    // Graphics scene requires a graphics driver, which might not be available(eg headless environment)
+    std::unique_ptr<GraphicsScene> ptrScene;
+    try {
+        ptrScene = std::make_unique<GraphicsScene>();
+    } catch (...) {
+        QSKIP("Graphics driver not available");
+    }
+
+    const GraphicsMeshObjectDriver::DefaultValues defaultValues = GraphicsMeshObjectDriver::defaultValues();
+    auto _ = gsl::finally([=]{ GraphicsMeshObjectDriver::setDefaultValues(defaultValues); });
+    GraphicsMeshObjectDriver::DefaultValues values = defaultValues;
+    values.previewTriangleCount = 10;
+    values.maxTriangleCount = 0;
+    GraphicsMeshObjectDriver::setDefaultValues(values);
+
+    // Flat square grid of unit cells, stored as a face in a document
+    const int gridSize = 10;
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(
+                gridSize * gridSize, 2 * (gridSize - 1) * (gridSize - 1), false
+    );
+    auto fnNodeIndex = [=](int i, int j) { return i * gridSize + j + 1; };
+    int iTriangle = 0;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            MeshUtils::setNode(mesh, fnNodeIndex(i, j), gp_Pnt(i, j, 0));
+            if (i < gridSize - 1 && j < gridSize - 1) {
+                MeshUtils::setTriangle(mesh, ++iTriangle, { fnNodeIndex(i, j), fnNodeIndex(i + 1, j), fnNodeIndex(i + 1, j + 1) });
+                MeshUtils::setTriangle(mesh, ++iTriangle, { fnNodeIndex(i, j), fnNodeIndex(i + 1, j + 1), fnNodeIndex(i, j + 1) });
+            }
+        }
+    }
+
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _2 = gsl::finally([=]{ app->closeDocument(doc); });
+    const TDF_Label labelMesh = doc->xcaf().shapeTool()->AddShape(BRepUtils::makeFace(mesh), false);
+
+    const GraphicsMeshObjectDriverPtr driver = new GraphicsMeshObjectDriver;
+    auto fnCreatePreviewObject = [&]{
+        const GraphicsObjectPtr object = driver->createObject(labelMesh);
+        ptrScene->addObject(object);
+        return object;
+    };
+
+    MeshPreviewController controller(ptrScene.get());
+    std::vector<bool> vecPendingChanged;
+    controller.signalPendingChanged.connectSlot([&](bool isPending) { vecPendingChanged.push_back(isPending); });
+    std::atomic<int> completedCount = 0;
+    controller.signalObjectsCompleted.connectSlot([&](Span<const GraphicsObjectPtr> spanObject) {
+        completedCount += int(spanObject.size());
+    });
+
+    {   // Preview is replaced by full resolution data in background
+        const GraphicsObjectPtr object = fnCreatePreviewObject();
+        QVERIFY(GraphicsMeshObjectDriver::isPreviewObject(object));
+        controller.addObject(object);
+        QCOMPARE(controller.pendingPreviewCount(), 1);
+        QTRY_COMPARE_WITH_TIMEOUT(completedCount.load(), 1, 10000);
+        QCOMPARE(controller.pendingPreviewCount(), 0);
+        QVERIFY(!GraphicsMeshObjectDriver::isPreviewObject(object));
+        QCOMPARE(vecPendingChanged, std::vector<bool>({ true, false }));
+    }
+
+    {   // Objects which aren't previews are ignored
+        const GraphicsObjectPtr object = fnCreatePreviewObject();
+        values.previewTriangleCount = 0;
+        GraphicsMeshObjectDriver::setDefaultValues(values);
+        const GraphicsObjectPtr objectFull = driver->createObject(labelMesh);
+        QVERIFY(!GraphicsMeshObjectDriver::isPreviewObject(objectFull));
+        controller.addObject(objectFull);
+        QCOMPARE(controller.pendingPreviewCount(), 0);
+
+        // Removed and aborted objects are left with their preview
+        vecPendingChanged.clear();
+        controller.addObject(object);
+        controller.removeObject(object);
+        QCOMPARE(controller.pendingPreviewCount(), 0);
+        controller.addObject(object);
+        controller.abort();
+        QCOMPARE(controller.pendingPreviewCount(), 0);
+        QCOMPARE(vecPendingChanged, std::vector<bool>({ true, false, true, false }));
+        QTest::qWait(100);
+        QCOMPARE(completedCount.load(), 1);
+        QVERIFY(GraphicsMeshObjectDriver::isPreviewObject(object));
+    }
+}
+
+void TestApp::HlrController_test()
+{
+    // Directions closer than the angular tolerance share the same key
+    const gp_Dir dir(1, 1, 1);
+    QVERIFY(HlrController::directionKey(dir) == HlrController::directionKey(gp_Dir(1, 1, 1.0001)));
+    QVERIFY(HlrController::directionKey(dir) != HlrController::directionKey(gp_Dir(1, 1, 1.01)));
+    QVERIFY(HlrController::directionKey(dir) != HlrController::directionKey(dir.Reversed()));
+
+    // Cache keeps the most recently used directions
+    auto fnKey = [](int i) { return HlrController::DirectionKey{ i, 0, 0 }; };
+    HlrController::LinesCache cache;
+    for (int i = 0; i < HlrController::MaxCachedDirectionCount; ++i)
+        HlrController::addCachedLines(&cache, fnKey(i), {});
+
+    QCOMPARE(int(cache.size()), HlrController::MaxCachedDirectionCount);
+    QVERIFY(!HlrController::useCachedLines(&cache, fnKey(-1)));
+    const AIS_HlrLines::Lines* lines = HlrController::useCachedLines(&cache, fnKey(0));
+    QVERIFY(lines != nullptr);
+    QVERIFY(lines == &cache.back().second);
+
+    // Direction #1 is now the least recently used one, it's dropped first
+    HlrController::addCachedLines(&cache, fnKey(HlrController::MaxCachedDirectionCount), {});
+    QCOMPARE(int(cache.size()), HlrController::MaxCachedDirectionCount);
+    QVERIFY(HlrController::useCachedLines(&cache, fnKey(0)) != nullptr);
+    QVERIFY(!HlrController::useCachedLines(&cache, fnKey(1)));
+    QVERIFY(HlrController::useCachedLines(&cache, fnKey(2)) != nullptr);
+}
+
+void TestApp::ImageRenderer_test()
+{
+    auto app = Application::instance();
+    GuiApplication guiApp(app);
+    guiApp.setAutomaticDocumentMapping(false);
+    guiApp.addGraphicsObjectDriver(std::make_unique<GraphicsShapeObjectDriver>());
+    IO::ImageRenderer renderer(&guiApp);
+
+    DocumentPtr doc = app->newDocument();
+    bool isDocumentClosed = false;
+    auto _ = gsl::finally([&]{
+        if (!isDocumentClosed)
+            app->closeDocument(doc);
+    });
+
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    BRepMesh_IncrementalMesh(shapeBox, 1.);
+    const TDF_Label labelBox = doc->xcaf().shapeTool()->AddShape(shapeBox, false);
+    doc->addEntityTreeNode(labelBox);
+    const ApplicationItem appItems[] = { doc };
+
+    // Rendering always takes place in the same thread, whatever the calling thread
+    std::thread::id renderThreadId1;
+    std::thread::id renderThreadId2;
+    renderer.exec([&]{ renderThreadId1 = std::this_thread::get_id(); });
+    std::thread([&]{
+        renderer.exec([&]{ renderThreadId2 = std::this_thread::get_id(); });
+    }).join();
+    QVERIFY(renderThreadId1 == renderThreadId2);
+    QVERIFY(renderThreadId1 != std::this_thread::get_id());
+
+    // Graphics scene requires a graphics driver, which might not be available(eg headless environment)
+    try {
+        renderer.exec([&]{ renderer.setItems(appItems); });
+    } catch (...) {
+        QSKIP("Graphics driver not available");
+    }
+
+    GraphicsObjectPtr object;
+    int objectCount = 0;
+    auto fnSetItems = [&](Span<const ApplicationItem> spanItem) {
+        renderer.exec([&]{
+            renderer.setItems(spanItem);
+            object = renderer.findObject(labelBox);
+            objectCount = renderer.objectCount();
+        });
+    };
+
+    fnSetItems(appItems);
+    QVERIFY(object);
+    QCOMPARE(objectCount, 1);
+
+    // Object is reused for the same items
+    const GraphicsObjectPtr objectFirst = object;
+    fnSetItems(appItems);
+    QVERIFY(object == objectFirst);
+
+    // Object is created again once the shape is re-meshed
+    BRepTools::Clean(shapeBox);
+    BRepMesh_IncrementalMesh(shapeBox, 0.1);
+    fnSetItems(appItems);
+    QVERIFY(object);
+    QVERIFY(object != objectFirst);
+    QCOMPARE(objectCount, 1);
+
+    // Objects are released with empty items
+    fnSetItems({});
+    QVERIFY(!object);
+    QCOMPARE(objectCount, 0);
+
+    // Objects of the document are erased once it's closed
+    fnSetItems(appItems);
+    QCOMPARE(objectCount, 1);
+    app->closeDocument(doc);
+    isDocumentClosed = true;
+    renderer.exec([&]{ objectCount = renderer.objectCount(); });
+    QCOMPARE(objectCount, 0);
+}
+
 } // namespace Mayo
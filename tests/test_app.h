@@ -26,6 +26,16 @@ private slots:
     void StringConv_test();
 
     void QtGuiUtils_test();
+
+    void DocumentTreeItemModel_setData_test();
+    void DocumentTreeItemModel_modelTester_test();
+    void WorkerProcessFactoryReader_settingsSnapshot_test();
+
+    void MeasureCache_test();
+
+    void MeshPreviewController_test();
+    void HlrController_test();
+    void ImageRenderer_test();
 };
 
 } // namespace Mayo
@@ -12,6 +12,10 @@
 #include "test_base.h"
 
 #include "../src/base/application.h"
+#include "../src/base/application_item_selection_model.h"
+#include "../src/base/assembly_instances.h"
+#include "../src/base/box_bvh.h"
+#include "../src/base/brep_mesh_levels.h"
 #include "../src/base/brep_utils.h"
 #include "../src/base/caf_utils.h"
 #include "../src/base/cpp_utils.h"
@@ -23,11 +27,17 @@
 #include "../src/base/io_system.h"
 #include "../src/base/occ_static_variables_rollback.h"
 #include "../src/base/libtree.h"
+#include "../src/base/mass_properties.h"
+#include "../src/base/mesh_access.h"
+#include "../src/base/mesh_decimation.h"
 #include "../src/base/mesh_utils.h"
+#include "../src/base/part_deduplication.h"
 #include "../src/base/meta_enum.h"
+#include "../src/base/point_cloud_octree.h"
 #include "../src/base/property_builtins.h"
 #include "../src/base/property_enumeration.h"
 #include "../src/base/property_value_conversion.h"
+#include "../src/base/spatial_index.h"
 #include "../src/base/string_conv.h"
 #include "../src/base/task_manager.h"
 #include "../src/base/tkernel_utils.h"
@@ -35,17 +45,33 @@
 #include "../src/base/unit_system.h"
 #include "../src/io_dxf/io_dxf.h"
 #include "../src/io_occ/io_occ.h"
+#include "../src/io_occ/io_occ_stl.h"
 #include "../src/io_ply/io_ply_reader.h"
 #include "../src/io_ply/io_ply_writer.h"
 
 #include <BRep_Tool.hxx>
 #include <BRepAdaptor_Curve.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRep_Builder.hxx>
+#include <Precision.hxx>
+#include <TopoDS_Compound.hxx>
 #include <GCPnts_TangentialDeflection.hxx>
 #include <Interface_ParamType.hxx>
 #include <Interface_Static.hxx>
 #include <TopAbs_ShapeEnum.hxx>
+#include <TopExp.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+#include <TopoDS.hxx>
+#include <TDataStd_Name.hxx>
+#include <TNaming_NamedShape.hxx>
+#include <XCAFDoc_ColorTool.hxx>
+#include <XCAFDoc_LayerTool.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
 
 #include <QtCore/QtDebug>
 #include <QtCore/QFile>
@@ -59,6 +85,7 @@
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <type_traits>
@@ -209,6 +236,97 @@ void TestBase::DocumentRefCount_test()
     QCOMPARE(doc->GetRefCount(), 1);
 }
 
+void TestBase::DocumentScratch_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    const int docCount = app->documentCount();
+    DocumentPtr scratchDoc = doc->newScratchDocument();
+    QCOMPARE(app->documentCount(), docCount);
+    QVERIFY(scratchDoc->identifier() >= 0);
+    QVERIFY(scratchDoc->identifier() != doc->identifier());
+    QVERIFY(app->findDocumentByIdentifier(scratchDoc->identifier()).IsNull());
+
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    const TDF_Label labelBox = scratchDoc->xcaf().shapeTool()->AddShape(shapeBox, false);
+    TDataStd_Name::Set(labelBox, "Box");
+    const TDF_Label labelOther = scratchDoc->newEntityLabel();
+    TDataStd_Name::Set(labelOther, "Other");
+
+    const TDF_LabelSequence seqLabelCopy = doc->copyEntities(CafUtils::makeLabelSequence({ labelBox, labelOther }));
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    QCOMPARE(seqLabelCopy.Size(), 2);
+    const TDF_Label labelBoxCopy = seqLabelCopy.First();
+    QVERIFY(Document::findFrom(labelBoxCopy) == doc);
+    QVERIFY(XCaf::shape(labelBoxCopy).TShape() == shapeBox.TShape()); // Shared, not duplicated
+    QCOMPARE(CafUtils::labelAttrStdName(labelBoxCopy), TCollection_ExtendedString("Box"));
+#else
+    QCOMPARE(seqLabelCopy.Size(), 1); // Only non-shape entity is copied
+#endif
+    const TDF_Label labelOtherCopy = seqLabelCopy.Last();
+    QVERIFY(Document::findFrom(labelOtherCopy) == doc);
+    QCOMPARE(CafUtils::labelAttrStdName(labelOtherCopy), TCollection_ExtendedString("Other"));
+
+    // Closing the scratch document releases it and leaves the copied entities untouched
+    Document::closeScratchDocument(scratchDoc);
+    QCOMPARE(scratchDoc->GetRefCount(), 1);
+    QCOMPARE(CafUtils::labelAttrStdName(labelOtherCopy), TCollection_ExtendedString("Other"));
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    QVERIFY(XCaf::shape(labelBoxCopy).TShape() == shapeBox.TShape());
+#endif
+}
+
+void TestBase::ApplicationItemSelectionModel_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    std::vector<ApplicationItem> vecItem;
+    for (TreeNodeId id = 1; id <= 5; ++id)
+        vecItem.push_back(DocumentTreeNode(doc, id));
+
+    ApplicationItemSelectionModel selModel;
+    std::vector<ApplicationItem> vecLastSelected;
+    std::vector<ApplicationItem> vecLastDeselected;
+    selModel.signalChanged.connectSlot([&](Span<const ApplicationItem> selected, Span<const ApplicationItem> deselected) {
+        vecLastSelected.assign(selected.begin(), selected.end());
+        vecLastDeselected.assign(deselected.begin(), deselected.end());
+    });
+
+    // Duplicates are ignored, insertion order is kept
+    std::vector<ApplicationItem> vecToAdd = { vecItem.at(2), vecItem.at(0), vecItem.at(2), vecItem.at(4) };
+    selModel.add(vecToAdd);
+    QVERIFY(selModel.selectedItems().size() == 3);
+    QVERIFY(selModel.selectedItems()[0] == vecItem.at(2));
+    QVERIFY(selModel.selectedItems()[1] == vecItem.at(0));
+    QVERIFY(selModel.selectedItems()[2] == vecItem.at(4));
+    QVERIFY(vecLastSelected.size() == 3);
+    QVERIFY(selModel.isSelected(vecItem.at(0)));
+    QVERIFY(!selModel.isSelected(vecItem.at(1)));
+    QVERIFY(selModel.isSelected(ApplicationItem(DocumentTreeNode(doc, 3))));
+
+    // Items not selected are ignored
+    std::vector<ApplicationItem> vecToRemove = { vecItem.at(1), vecItem.at(2) };
+    selModel.remove(vecToRemove);
+    QVERIFY(selModel.selectedItems().size() == 2);
+    QVERIFY(selModel.selectedItems()[0] == vecItem.at(0));
+    QVERIFY(selModel.selectedItems()[1] == vecItem.at(4));
+    QVERIFY(vecLastSelected.empty());
+    QVERIFY(vecLastDeselected.size() == 1);
+    QVERIFY(vecLastDeselected.front() == vecItem.at(2));
+    QVERIFY(!selModel.isSelected(vecItem.at(2)));
+
+    selModel.remove(vecItem.at(0));
+    QVERIFY(selModel.selectedItems().size() == 1);
+    selModel.clear();
+    QVERIFY(selModel.selectedItems().size() == 0);
+    QVERIFY(vecLastDeselected.size() == 1);
+    QVERIFY(!selModel.isSelected(vecItem.at(4)));
+}
+
 void TestBase::CppUtils_toggle_test()
 {
     bool v = false;
@@ -522,6 +640,54 @@ void TestBase::IO_bugGitHub166_test_data()
 #endif
 }
 
+void TestBase::IO_OccStlReader_previewMesh_test()
+{
+    QFETCH(QString, strFilePath);
+    const FilePath filepath = strFilePath.toStdString();
+
+    // Input cube has 12 facets, no preview needed
+    IO::OccStlReader reader;
+    QVERIFY(!reader.readPreviewMesh(filepath, 12));
+
+    const Handle_Poly_Triangulation previewMesh = reader.readPreviewMesh(filepath, 4);
+    QVERIFY(previewMesh);
+    QVERIFY(previewMesh->NbTriangles() > 0);
+    QVERIFY(previewMesh->NbTriangles() <= 4);
+    QCOMPARE(previewMesh->NbNodes(), 3 * previewMesh->NbTriangles());
+    for (int i = 1; i <= previewMesh->NbNodes(); ++i) {
+        const gp_Pnt pnt = previewMesh->Node(i);
+        for (double coord : { pnt.X(), pnt.Y(), pnt.Z() })
+            QVERIFY(std::abs(coord) < 1e-6 || std::abs(coord - 10.) < 1e-6);
+    }
+
+    // Preview is reported during import, then discarded
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    std::vector<Handle_Poly_Triangulation> vecPreviewMesh;
+    doc->signalImportPreviewMeshChanged.connectSlot([&](const FilePath& fp, const Handle_Poly_Triangulation& mesh) {
+        QVERIFY(fp == filepath);
+        vecPreviewMesh.push_back(mesh);
+    });
+    const bool okImport = m_ioSystem->importInDocument()
+            .targetDocument(doc)
+            .withFilepath(filepath)
+            .withPreviewMesh(4)
+            .execute();
+    QVERIFY(okImport);
+    QCOMPARE(doc->entityCount(), 1);
+    QCOMPARE(int(vecPreviewMesh.size()), 2);
+    QVERIFY(vecPreviewMesh.front());
+    QVERIFY(!vecPreviewMesh.back());
+}
+
+void TestBase::IO_OccStlReader_previewMesh_test_data()
+{
+    QTest::addColumn<QString>("strFilePath");
+    QTest::newRow("cube.stla") << "tests/inputs/cube.stla";
+    QTest::newRow("cube.stlb") << "tests/inputs/cube.stlb";
+}
+
 void TestBase::DoubleToString_test()
 {
     auto fnGetLocale = [](const char* name) -> std::optional<std::locale> {
@@ -595,6 +761,123 @@ void TestBase::BRepUtils_test()
         QVERIFY(BRepUtils::hashCode(shapeBase) >= 0);
         QCOMPARE(BRepUtils::hashCode(shapeBase), BRepUtils::hashCode(shapeCopy));
     }
+
+    {
+        // Checks polygons of each edge match on all the faces sharing the edge
+        auto fnCheckConformalMesh = [](const TopoDS_Shape& shape) {
+            TopTools_IndexedDataMapOfShapeListOfShape mapEdgeFaces;
+            TopExp::MapShapesAndAncestors(shape, TopAbs_EDGE, TopAbs_FACE, mapEdgeFaces);
+            for (int i = 1; i <= mapEdgeFaces.Extent(); ++i) {
+                const TopoDS_Edge& edge = TopoDS::Edge(mapEdgeFaces.FindKey(i));
+                std::vector<gp_Pnt> vecRefNode;
+                for (const TopoDS_Shape& face : mapEdgeFaces.FindFromIndex(i)) {
+                    TopLoc_Location loc;
+                    const auto triangulation = BRep_Tool::Triangulation(TopoDS::Face(face), loc);
+                    QVERIFY(!triangulation.IsNull());
+                    const auto polygon = BRep_Tool::PolygonOnTriangulation(edge, triangulation, loc);
+                    QVERIFY(!polygon.IsNull());
+                    std::vector<gp_Pnt> vecNode;
+                    for (int iNode : polygon->Nodes())
+                        vecNode.push_back(triangulation->Node(iNode).Transformed(loc));
+
+                    if (vecRefNode.empty()) {
+                        vecRefNode = vecNode;
+                        continue;
+                    }
+
+                    QCOMPARE(vecNode.size(), vecRefNode.size());
+                    for (unsigned iNode = 0; iNode < vecNode.size(); ++iNode)
+                        QVERIFY(vecNode.at(iNode).IsEqual(vecRefNode.at(iNode), Precision::Confusion()));
+                }
+            }
+        };
+
+        const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(25, 25, 25);
+        OccBRepMeshParameters params;
+        params.Deflection = 1.;
+        QCOMPARE(BRepUtils::remesh(shapeBox, params).Extent(), 6);
+        fnCheckConformalMesh(shapeBox);
+
+        // Computation doesn't modify the source shape
+        const TopoDS_Face faceBox = TopoDS::Face(TopExp_Explorer(shapeBox, TopAbs_FACE).Current());
+        TopLoc_Location locFace;
+        BRep_Builder().UpdateFace(faceBox, Handle_Poly_Triangulation());
+        const BRepUtils::RemeshData data = BRepUtils::computeRemesh(shapeBox, params);
+        QVERIFY(BRep_Tool::Triangulation(faceBox, locFace).IsNull());
+        // All faces connected to the unmeshed one have to be meshed again
+        QCOMPARE(data.mapFace.Extent(), 6);
+        BRepUtils::applyRemesh(data);
+        QVERIFY(!BRep_Tool::Triangulation(faceBox, locFace).IsNull());
+        fnCheckConformalMesh(shapeBox);
+
+        // Faces not connected to unmeshed ones are left untouched
+        const TopoDS_Shape shapeMeshed = BRepPrimAPI_MakeBox(10, 10, 10);
+        BRepUtils::computeMesh(shapeMeshed, params);
+        const TopoDS_Shape shapeCylinder = BRepPrimAPI_MakeCylinder(5, 10);
+        TopoDS_Compound compShape = BRepUtils::makeEmptyCompound();
+        BRep_Builder().Add(compShape, shapeMeshed);
+        BRep_Builder().Add(compShape, shapeCylinder);
+        const TopTools_IndexedMapOfShape mapFaceRemeshed = BRepUtils::remesh(compShape, params, 1e6);
+        QCOMPARE(mapFaceRemeshed.Extent(), 3);
+        for (TopExp_Explorer expl(shapeMeshed, TopAbs_FACE); expl.More(); expl.Next())
+            QVERIFY(!mapFaceRemeshed.Contains(expl.Current()));
+
+        fnCheckConformalMesh(compShape);
+    }
+}
+
+void TestBase::BRepMeshLevels_test()
+{
+    const TopoDS_Shape shape = BRepPrimAPI_MakeCylinder(5, 20);
+    OccBRepMeshParameters params;
+    params.Deflection = 0.1;
+    params.Angle = 0.3;
+    BRepUtils::computeMesh(shape, params);
+
+    std::vector<Handle_Poly_Triangulation> vecTriangulation;
+    int normalTriangleCount = 0;
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        TopLoc_Location loc;
+        vecTriangulation.push_back(BRep_Tool::Triangulation(TopoDS::Face(expl.Current()), loc));
+        QVERIFY(!vecTriangulation.back().IsNull());
+        normalTriangleCount += vecTriangulation.back()->NbTriangles();
+    }
+
+    BRepMeshLevels levels(shape, params);
+    QVERIFY(levels.isSupported());
+    QVERIFY(levels.hasLevel(BRepMeshLevels::Level_Normal));
+    QVERIFY(!levels.hasLevel(BRepMeshLevels::Level_Coarse));
+    QVERIFY(levels.levelShape(BRepMeshLevels::Level_Normal).IsSame(shape));
+
+    // Angular deflection is derived from meshing parameters, not hardcoded
+    const OccBRepMeshParameters coarseParams = levels.levelParameters(BRepMeshLevels::Level_Coarse);
+    const OccBRepMeshParameters fineParams = levels.levelParameters(BRepMeshLevels::Level_Fine);
+    QCOMPARE(coarseParams.Angle, 2 * params.Angle);
+    QCOMPARE(fineParams.Angle, params.Angle / 2.);
+    QVERIFY(coarseParams.Deflection > fineParams.Deflection);
+
+    levels.setLevel(
+            BRepMeshLevels::Level_Coarse,
+            BRepMeshLevels::computeLevel(shape, coarseParams)
+    );
+    QVERIFY(levels.hasLevel(BRepMeshLevels::Level_Coarse));
+    QVERIFY(!levels.levelShape(BRepMeshLevels::Level_Coarse).IsSame(shape));
+
+    // Meshes of the initial shape must be left untouched
+    int iFace = 0;
+    int coarseTriangleCount = 0;
+    for (TopExp_Explorer expl(shape, TopAbs_FACE); expl.More(); expl.Next()) {
+        TopLoc_Location loc;
+        QVERIFY(BRep_Tool::Triangulation(TopoDS::Face(expl.Current()), loc) == vecTriangulation.at(iFace++));
+        const TopoDS_Shape coarseFace = levels.levelSubShape(BRepMeshLevels::Level_Coarse, expl.Current());
+        QVERIFY(!coarseFace.IsNull());
+        QCOMPARE(coarseFace.ShapeType(), TopAbs_FACE);
+        const Handle_Poly_Triangulation coarseTriangulation = BRep_Tool::Triangulation(TopoDS::Face(coarseFace), loc);
+        QVERIFY(!coarseTriangulation.IsNull());
+        coarseTriangleCount += coarseTriangulation->NbTriangles();
+    }
+
+    QVERIFY(coarseTriangleCount < normalTriangleCount);
 }
 
 void TestBase::CafUtils_test()
@@ -679,6 +962,789 @@ void TestBase::MeshUtils_orientation_test_data()
     }
 }
 
+void TestBase::MeshUtils_trianglesIntersect_test()
+{
+    const gp_XYZ p1(0, 0, 0);
+    const gp_XYZ p2(1, 0, 0);
+    const gp_XYZ p3(0, 1, 0);
+    // Crossing triangle
+    QVERIFY(MeshUtils::trianglesIntersect(p1, p2, p3, { 0.2, 0.2, -1 }, { 0.2, 0.2, 1 }, { 2, 2, 0 }));
+    // Parallel triangle above
+    QVERIFY(!MeshUtils::trianglesIntersect(p1, p2, p3, { 0, 0, 0.1 }, { 1, 0, 0.1 }, { 0, 1, 0.1 }));
+    // Same triangle moved within tolerance
+    QVERIFY(MeshUtils::trianglesIntersect(p1, p2, p3, { 0, 0, 0.1 }, { 1, 0, 0.1 }, { 0, 1, 0.1 }, 0.2));
+    // Coplanar triangles, overlapping then disjoint
+    QVERIFY(MeshUtils::trianglesIntersect(p1, p2, p3, { 0.2, 0.2, 0 }, { 2, 0.2, 0 }, { 0.2, 2, 0 }));
+    QVERIFY(!MeshUtils::trianglesIntersect(p1, p2, p3, { 1, 1, 0 }, { 2, 1, 0 }, { 1, 2, 0 }));
+    // Triangles sharing an edge touch each other
+    QVERIFY(MeshUtils::trianglesIntersect(p1, p2, p3, p2, p3, { 1, 1, 0 }));
+}
+
+void TestBase::MeshUtils_cleanup_test()
+{
+    // Triangle soup of a unit square split in two triangles, with a node slightly moved and a
+    // degenerate triangle
+    const std::vector<gp_Pnt> vecNode = {
+        { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+        { 0, 0, 0 }, { 1, 1, 1e-5 }, { 0, 1, 0 },
+        { 0, 0, 0 }, { 1, 0, 0 }, { 1, 0, 0 }
+    };
+    const std::vector<MeshUtils::Triangle> vecTriangle = { { 0, 1, 2 }, { 3, 4, 5 }, { 6, 7, 8 } };
+    auto fnNode = [&](int i) { return vecNode.at(i); };
+
+    // Exact welding
+    const std::vector<int> vecTarget = MeshUtils::weldNodes(int(vecNode.size()), fnNode, 0.);
+    QCOMPARE(vecTarget, std::vector<int>({ 0, 1, 2, 0, 4, 5, 0, 1, 1 }));
+
+    // Welding within tolerance
+    MeshUtils::CleanupOptions options;
+    options.weldTolerance = 1e-4;
+    const MeshUtils::CleanupResult result = MeshUtils::cleanup(int(vecNode.size()), fnNode, vecTriangle, options);
+    QCOMPARE(result.sourceNodes, std::vector<int>({ 0, 1, 2, 5 }));
+    QCOMPARE(result.mergedNodeCount, 5);
+    QCOMPARE(result.removedTriangleCount, 1);
+    QCOMPARE(int(result.triangles.size()), 2);
+    QVERIFY(result.triangles.at(0) == MeshUtils::Triangle({ 0, 1, 2 }));
+    QVERIFY(result.triangles.at(1) == MeshUtils::Triangle({ 0, 2, 3 }));
+
+    // Reordering keeps the same triangles, nodes being renumbered in order of first use
+    options.reorderForLocality = true;
+    const MeshUtils::CleanupResult resultReorder =
+            MeshUtils::cleanup(int(vecNode.size()), fnNode, vecTriangle, options);
+    QCOMPARE(int(resultReorder.triangles.size()), 2);
+    QCOMPARE(int(resultReorder.sourceNodes.size()), 4);
+    QCOMPARE(resultReorder.triangles.at(0), MeshUtils::Triangle({ 0, 1, 2 }));
+    double area = 0.;
+    for (const MeshUtils::Triangle& tri : resultReorder.triangles) {
+        area += MeshUtils::triangleArea(
+                    vecNode.at(resultReorder.sourceNodes.at(tri[0])).XYZ(),
+                    vecNode.at(resultReorder.sourceNodes.at(tri[1])).XYZ(),
+                    vecNode.at(resultReorder.sourceNodes.at(tri[2])).XYZ()
+        );
+    }
+
+    QVERIFY(std::abs(area - 1.) < 1e-6);
+
+    // Welding on a larger grid of duplicated nodes
+    const int gridSize = 50;
+    std::vector<gp_Pnt> vecGridNode;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            vecGridNode.emplace_back(i, j, 0);
+            vecGridNode.emplace_back(i + 1e-7, j, 0);
+        }
+    }
+
+    const std::vector<int> vecGridTarget = MeshUtils::weldNodes(
+                int(vecGridNode.size()), [&](int i) { return vecGridNode.at(i); }, 1e-6
+    );
+    for (size_t i = 0; i < vecGridTarget.size(); ++i)
+        QCOMPARE(vecGridTarget.at(i), int(i - (i % 2)));
+
+    // Nodes are merged only if allowed, eg having the same color
+    const std::vector<int> vecColorTarget = MeshUtils::weldNodes(
+                int(vecNode.size()), fnNode, 0., [](int i, int j) { return i % 2 == j % 2; }
+    );
+    QCOMPARE(vecColorTarget, std::vector<int>({ 0, 1, 2, 3, 4, 5, 0, 1, 8 }));
+
+    // Merging doesn't chain across rejected pairs: three coincident nodes whose colors only allow
+    // merging of consecutive nodes, node 2 can't be merged into node 0
+    const gp_Pnt pntChain(5, 5, 5);
+    const std::vector<int> vecChainTarget = MeshUtils::weldNodes(
+                3, [&](int) { return pntChain; }, 0., [](int i, int j) { return std::abs(i - j) <= 1; }
+    );
+    QCOMPARE(vecChainTarget, std::vector<int>({ 0, 0, 2 }));
+
+    // Same with distance: nodes 1mm apart, tolerance of 1.5mm
+    const std::vector<int> vecDistChainTarget = MeshUtils::weldNodes(
+                3, [](int i) { return gp_Pnt(i, 0, 0); }, 1.5
+    );
+    QCOMPARE(vecDistChainTarget, std::vector<int>({ 0, 0, 2 }));
+
+    // Poly_Triangulation overload: mesh without duplicated nodes is left untouched, even if
+    // reordering is requested
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(4, 2, false);
+    MeshUtils::setNode(mesh, 1, gp_Pnt(0, 0, 0));
+    MeshUtils::setNode(mesh, 2, gp_Pnt(1, 0, 0));
+    MeshUtils::setNode(mesh, 3, gp_Pnt(1, 1, 0));
+    MeshUtils::setNode(mesh, 4, gp_Pnt(0, 1, 0));
+    MeshUtils::setTriangle(mesh, 1, { 1, 2, 3 });
+    MeshUtils::setTriangle(mesh, 2, { 1, 3, 4 });
+    QVERIFY(MeshUtils::cleanup(mesh, options) == mesh);
+
+    // Poly_Triangulation overload: normals are transferred, nodes across a crease aren't merged
+    // Two triangles folded at 90 degrees along edge (0,0,0)-(1,0,0), nodes of the edge duplicated
+    Handle_Poly_Triangulation meshFolded = new Poly_Triangulation(6, 2, false);
+    MeshUtils::allocateNormals(meshFolded);
+    const gp_Pnt pntsFolded[] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 } };
+    for (int i = 0; i < 6; ++i) {
+        MeshUtils::setNode(meshFolded, i + 1, pntsFolded[i]);
+        const MeshUtils::Poly_Triangulation_NormalType n = i < 3 ?
+                    MeshUtils::Poly_Triangulation_NormalType(0, 0, 1) : MeshUtils::Poly_Triangulation_NormalType(0, -1, 0);
+        MeshUtils::setNormal(meshFolded, i + 1, n);
+    }
+
+    MeshUtils::setTriangle(meshFolded, 1, { 1, 2, 3 });
+    MeshUtils::setTriangle(meshFolded, 2, { 4, 6, 5 });
+    QVERIFY(MeshUtils::cleanup(meshFolded, options) == meshFolded);
+    MeshUtils::CleanupOptions optionsNoCrease = options;
+    optionsNoCrease.creaseAngle = 180 * Quantity_Degree;
+    const Handle_Poly_Triangulation meshUnfolded = MeshUtils::cleanup(meshFolded, optionsNoCrease);
+    QCOMPARE(meshUnfolded->NbNodes(), 4);
+    QVERIFY(meshUnfolded->HasNormals());
+    for (int i = 1; i <= meshUnfolded->NbNodes(); ++i)
+        QCOMPARE(MeshUtils::normal(meshUnfolded, i).Magnitude(), 1.);
+}
+
+void TestBase::MeshUtils_sampledMesh_test()
+{
+    // Flat square grid of unit cells
+    const int gridSize = 20;
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(
+                gridSize * gridSize, 2 * (gridSize - 1) * (gridSize - 1), false
+    );
+    auto fnNodeIndex = [=](int i, int j) { return i * gridSize + j + 1; };
+    int iTriangle = 0;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            MeshUtils::setNode(mesh, fnNodeIndex(i, j), gp_Pnt(i, j, 0));
+            if (i < gridSize - 1 && j < gridSize - 1) {
+                MeshUtils::setTriangle(mesh, ++iTriangle, { fnNodeIndex(i, j), fnNodeIndex(i + 1, j), fnNodeIndex(i + 1, j + 1) });
+                MeshUtils::setTriangle(mesh, ++iTriangle, { fnNodeIndex(i, j), fnNodeIndex(i + 1, j + 1), fnNodeIndex(i, j + 1) });
+            }
+        }
+    }
+
+    {   // Sample is made of evenly spaced triangles of the source mesh
+        const int maxTriangleCount = 100;
+        std::vector<int> vecSourceNode;
+        const Handle_Poly_Triangulation preview = MeshUtils::sampledMesh(mesh, maxTriangleCount, &vecSourceNode);
+        QVERIFY(preview->NbTriangles() > 0);
+        QVERIFY(preview->NbTriangles() <= maxTriangleCount);
+        QCOMPARE(int(vecSourceNode.size()), preview->NbNodes());
+        for (int i = 1; i <= preview->NbNodes(); ++i)
+            QCOMPARE(preview->Node(i).Distance(mesh->Node(vecSourceNode.at(i - 1) + 1)), 0.);
+
+        const int step = (mesh->NbTriangles() + maxTriangleCount - 1) / maxTriangleCount;
+        for (int i = 1; i <= preview->NbTriangles(); ++i) {
+            int previewNodes[3];
+            int sourceNodes[3];
+            MeshUtils::triangles(preview)(i).Get(previewNodes[0], previewNodes[1], previewNodes[2]);
+            MeshUtils::triangles(mesh)(1 + (i - 1) * step).Get(sourceNodes[0], sourceNodes[1], sourceNodes[2]);
+            for (int j = 0; j < 3; ++j)
+                QCOMPARE(vecSourceNode.at(previewNodes[j] - 1), sourceNodes[j] - 1);
+        }
+    }
+
+    {   // Limit not reached, all triangles are kept
+        std::vector<int> vecSourceNode;
+        const Handle_Poly_Triangulation preview = MeshUtils::sampledMesh(mesh, 10000, &vecSourceNode);
+        QCOMPARE(preview->NbTriangles(), mesh->NbTriangles());
+        QCOMPARE(preview->NbNodes(), mesh->NbNodes());
+    }
+
+    {   // Invalid limit
+        std::vector<int> vecSourceNode;
+        const Handle_Poly_Triangulation preview = MeshUtils::sampledMesh(mesh, 0, &vecSourceNode);
+        QCOMPARE(preview->NbTriangles(), 0);
+        QVERIFY(vecSourceNode.empty());
+    }
+}
+
+void TestBase::MeshDecimation_test()
+{
+    // Flat square grid of unit cells
+    const int gridSize = 20;
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(
+                gridSize * gridSize, 2 * (gridSize - 1) * (gridSize - 1), false
+    );
+    auto fnNodeIndex = [=](int i, int j) { return i * gridSize + j + 1; };
+    int iTriangle = 0;
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            MeshUtils::setNode(mesh, fnNodeIndex(i, j), gp_Pnt(i, j, 0));
+            if (i < gridSize - 1 && j < gridSize - 1) {
+                const int n00 = fnNodeIndex(i, j);
+                const int n10 = fnNodeIndex(i + 1, j);
+                const int n11 = fnNodeIndex(i + 1, j + 1);
+                const int n01 = fnNodeIndex(i, j + 1);
+                MeshUtils::setTriangle(mesh, ++iTriangle, { n00, n10, n11 });
+                MeshUtils::setTriangle(mesh, ++iTriangle, { n00, n11, n01 });
+            }
+        }
+    }
+
+    MeshDecimation::Options options;
+    options.targetRatio = 0.1;
+    const MeshDecimation::Result result = MeshDecimation::run(mesh, options);
+    QVERIFY(result.mesh);
+    QVERIFY(result.mesh->NbTriangles() < mesh->NbTriangles() / 2);
+    QCOMPARE(int(result.sourceNodes.size()), result.mesh->NbNodes());
+
+    // Flat surface and its boundary nodes are preserved
+    QVERIFY(std::abs(MeshUtils::triangulationArea(result.mesh) - MeshUtils::triangulationArea(mesh)) < 1e-6);
+    int boundaryNodeCount = 0;
+    for (int i = 1; i <= result.mesh->NbNodes(); ++i) {
+        const gp_Pnt pnt = result.mesh->Node(i);
+        QVERIFY(pnt.Distance(mesh->Node(result.sourceNodes.at(i - 1) + 1)) < 1e-9);
+        if (pnt.X() == 0 || pnt.Y() == 0 || pnt.X() == gridSize - 1 || pnt.Y() == gridSize - 1)
+            ++boundaryNodeCount;
+    }
+
+    QCOMPARE(boundaryNodeCount, 4 * (gridSize - 1));
+
+    // Nodes of different colors aren't merged: all nodes are kept
+    auto fnNodeColor = [](int i) -> std::optional<Quantity_Color> {
+        return Quantity_Color(i / 1000., 0., 0., Quantity_TOC_RGB);
+    };
+    const MeshDecimation::Result resultColors = MeshDecimation::run(mesh, options, fnNodeColor);
+    QVERIFY(resultColors.mesh);
+    QCOMPARE(resultColors.mesh->NbTriangles(), mesh->NbTriangles());
+
+    // Spike of height 0.5 at the middle of the grid is kept as max error is lower, while flat
+    // areas are still decimated
+    const int spikeNode = fnNodeIndex(gridSize / 2, gridSize / 2);
+    MeshUtils::setNode(mesh, spikeNode, gp_Pnt(gridSize / 2, gridSize / 2, 0.5));
+    options.maxError = 0.1;
+    const MeshDecimation::Result resultMaxError = MeshDecimation::run(mesh, options);
+    QVERIFY(resultMaxError.mesh);
+    QVERIFY(resultMaxError.mesh->NbTriangles() < mesh->NbTriangles() / 2);
+    const auto& vecSourceNode = resultMaxError.sourceNodes;
+    QVERIFY(std::find(vecSourceNode.cbegin(), vecSourceNode.cend(), spikeNode - 1) != vecSourceNode.cend());
+}
+
+void TestBase::MeshAccess_visitMeshInstances_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Assembly with two instances of the same meshed product
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    BRepMesh_IncrementalMesh(shapeBox, 0.1);
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelProduct = shapeTool->AddShape(shapeBox, false);
+    const TDF_Label labelAssembly = shapeTool->NewShape();
+    gp_Trsf trsf1;
+    trsf1.SetTranslation(gp_Vec(100, 0, 0));
+    gp_Trsf trsf2;
+    trsf2.SetTranslation(gp_Vec(0, 200, 0));
+    shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location(trsf1));
+    shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location(trsf2));
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAssembly);
+
+    // Leaf nodes are the product nodes under each reference node
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    const TreeNodeId entityId = doc->entityTreeNodeId(doc->entityCount() - 1);
+    std::vector<DocumentTreeNode> vecLeafNode;
+    for (TreeNodeId id = modelTree.nodeChildFirst(entityId); id != 0; id = modelTree.nodeSiblingNext(id))
+        vecLeafNode.push_back(DocumentTreeNode(doc, modelTree.nodeChildFirst(id)));
+
+    QCOMPARE(int(vecLeafNode.size()), 2);
+
+    // Expected meshes, as visited by IMeshAccess_visitMeshes()
+    int expectedMeshCount = 0;
+    std::vector<gp_Pnt> vecExpectedFirstNode;
+    for (const DocumentTreeNode& leafNode : vecLeafNode) {
+        IMeshAccess_visitMeshes(leafNode, [&](const IMeshAccess& mesh) {
+            ++expectedMeshCount;
+            vecExpectedFirstNode.push_back(mesh.triangulation()->Node(1).Transformed(mesh.location()));
+        });
+    }
+
+    QCOMPARE(expectedMeshCount, 2 * 6);
+
+    // Each face of the product is visited once, with the locations of the two instances
+    int meshCount = 0;
+    std::vector<gp_Pnt> vecFirstNode;
+    IMeshAccess_visitMeshInstances(vecLeafNode, [&](const IMeshInstancesAccess& meshInstances) {
+        ++meshCount;
+        QVERIFY(meshInstances.mesh().location().IsIdentity());
+        QCOMPARE(int(meshInstances.instanceLocations().size()), 2);
+        for (const TopLoc_Location& loc : meshInstances.instanceLocations())
+            vecFirstNode.push_back(meshInstances.mesh().triangulation()->Node(1).Transformed(loc));
+    });
+    QCOMPARE(meshCount, 6);
+    QCOMPARE(vecFirstNode.size(), vecExpectedFirstNode.size());
+    for (const gp_Pnt& pnt : vecFirstNode) {
+        auto itFound = std::find_if(vecExpectedFirstNode.cbegin(), vecExpectedFirstNode.cend(), [&](const gp_Pnt& pntExpected) {
+            return pnt.IsEqual(pntExpected, Precision::Confusion());
+        });
+        QVERIFY(itFound != vecExpectedFirstNode.cend());
+    }
+
+    // Tree nodes of a same product are grouped, invalid ones are skipped
+    std::vector<DocumentTreeNode> vecNode = vecLeafNode;
+    vecNode.push_back(DocumentTreeNode::null());
+    meshCount = 0;
+    IMeshAccess_visitMeshInstances(vecNode, [&](const IMeshInstancesAccess&) { ++meshCount; });
+    QCOMPARE(meshCount, 6);
+
+    // Faces sharing a triangulation are grouped only if they have the same color
+    const TopoDS_Face face = BRepBuilderAPI_MakeFace(gp_Pln(gp::XOY()), 0, 10, 0, 10);
+    BRepMesh_IncrementalMesh(face, 0.1);
+    gp_Trsf trsfFace;
+    trsfFace.SetTranslation(gp_Vec(0, 0, 50));
+    const TopoDS_Face faceMoved = TopoDS::Face(face.Moved(TopLoc_Location(trsfFace)));
+    TopoDS_Compound compound;
+    BRep_Builder builder;
+    builder.MakeCompound(compound);
+    builder.Add(compound, face);
+    builder.Add(compound, faceMoved);
+    const TDF_Label labelCompound = shapeTool->AddShape(compound, false);
+    doc->addEntityTreeNode(labelCompound);
+    const DocumentTreeNode compoundNode(doc, doc->entityTreeNodeId(doc->entityCount() - 1));
+    auto fnVisitCompound = [&]{
+        std::vector<std::optional<Quantity_Color>> vecColor;
+        IMeshAccess_visitMeshInstances(Span<const DocumentTreeNode>(&compoundNode, 1), [&](const IMeshInstancesAccess& meshInstances) {
+            for (int i = 0; i < int(meshInstances.instanceLocations().size()); ++i)
+                vecColor.push_back(meshInstances.mesh().nodeColor(0));
+        });
+        return vecColor;
+    };
+
+    const std::vector<std::optional<Quantity_Color>> vecColorNone = fnVisitCompound();
+    QCOMPARE(int(vecColorNone.size()), 2);
+    QVERIFY(!vecColorNone.at(0) && !vecColorNone.at(1));
+
+    doc->xcaf().colorTool()->SetColor(shapeTool->AddSubShape(labelCompound, face), Quantity_NOC_RED, XCAFDoc_ColorSurf);
+    doc->xcaf().colorTool()->SetColor(shapeTool->AddSubShape(labelCompound, faceMoved), Quantity_NOC_BLUE1, XCAFDoc_ColorSurf);
+    int groupCount = 0;
+    IMeshAccess_visitMeshInstances(Span<const DocumentTreeNode>(&compoundNode, 1), [&](const IMeshInstancesAccess&) {
+        ++groupCount;
+    });
+    QCOMPARE(groupCount, 2);
+    const std::vector<std::optional<Quantity_Color>> vecColor = fnVisitCompound();
+    QCOMPARE(int(vecColor.size()), 2);
+    QVERIFY(vecColor.at(0) && vecColor.at(1));
+    QVERIFY(*vecColor.at(0) != *vecColor.at(1));
+}
+
+void TestBase::PointCloudOctree_test()
+{
+    // Points on a regular 3D grid
+    const int gridSize = 40;
+    Handle_Graphic3d_ArrayOfPoints points = new Graphic3d_ArrayOfPoints(gridSize * gridSize * gridSize);
+    for (int i = 0; i < gridSize; ++i) {
+        for (int j = 0; j < gridSize; ++j) {
+            for (int k = 0; k < gridSize; ++k)
+                points->AddVertex(gp_Pnt(i, j, k));
+        }
+    }
+
+    PointCloudOctree::Parameters params;
+    params.maxPointCountPerNode = 1000;
+    params.maxDepth = 4;
+    const PointCloudOctree octree(points, params);
+    QVERIFY(!octree.nodes().empty());
+    QVERIFY(octree.nodes()[0].pointCount == params.maxPointCountPerNode);
+
+    // Each point belongs to exactly one node, located within the node bounding box
+    std::vector<int> vecPointNodeCount(points->VertexNumber() + 1, 0);
+    for (const PointCloudOctree::Node& node : octree.nodes()) {
+        QVERIFY(node.depth <= params.maxDepth);
+        for (int index : octree.nodePointIndices(node)) {
+            QVERIFY(!node.bndBox.IsOut(points->Vertice(index)));
+            ++vecPointNodeCount.at(index);
+        }
+
+        for (int childIndex : node.children) {
+            if (childIndex >= 0)
+                QVERIFY(octree.nodes()[childIndex].depth == node.depth + 1);
+        }
+    }
+
+    for (int i = 1; i <= points->VertexNumber(); ++i)
+        QCOMPARE(vecPointNodeCount.at(i), 1);
+}
+
+void TestBase::BoxBvh_test()
+{
+    // Unit cubes along X axis, separated by a gap of 0.5
+    const int boxCount = 100;
+    std::vector<Bnd_Box> vecBox;
+    for (int i = 0; i < boxCount; ++i) {
+        Bnd_Box box;
+        box.Update(i * 1.5, 0, 0, i * 1.5 + 1, 1, 1);
+        vecBox.push_back(box);
+    }
+
+    vecBox.push_back(Bnd_Box{}); // Void box is never reported
+    const BoxBvh bvh(vecBox);
+    QCOMPARE(bvh.itemCount(), boxCount + 1);
+
+    // Each item belongs to exactly one leaf node
+    std::vector<int> vecItemLeafCount(bvh.itemCount(), 0);
+    for (const BoxBvh::Node& node : bvh.nodes()) {
+        if (node.isLeaf()) {
+            for (int i : bvh.nodeItems(node))
+                ++vecItemLeafCount.at(i);
+        }
+    }
+
+    for (int count : vecItemLeafCount)
+        QCOMPARE(count, 1);
+
+    // Only consecutive boxes are closer than the gap
+    std::vector<std::pair<int, int>> vecPair;
+    bvh.visitPairs(0.6, [&](int i, int j) { vecPair.emplace_back(i, j); });
+    QCOMPARE(int(vecPair.size()), boxCount - 1);
+    for (const auto& [i, j] : vecPair)
+        QCOMPARE(j, i + 1);
+
+    vecPair.clear();
+    bvh.visitPairs(0.4, [&](int i, int j) { vecPair.emplace_back(i, j); });
+    QVERIFY(vecPair.empty());
+
+    Bnd_Box queryBox;
+    queryBox.Update(2, 0.5, 0.5, 4, 0.5, 0.5);
+    std::vector<int> vecItem;
+    bvh.visitIntersecting(queryBox, [&](int i) { vecItem.push_back(i); });
+    std::sort(vecItem.begin(), vecItem.end());
+    QCOMPARE(vecItem, std::vector<int>({ 1, 2 }));
+
+    // Nearest item to a point located between cubes 26 and 27, not all items are visited
+    Bnd_Box pntBox;
+    pntBox.Add(gp_Pnt(40.2, 0.5, 0.5));
+    int nearestItem = -1;
+    double nearestDistance = std::numeric_limits<double>::max();
+    int visitedCount = 0;
+    bvh.visitNearest(
+        [&](const Bnd_Box& box) { return box.Distance(pntBox); },
+        [&](int i) {
+            ++visitedCount;
+            const double distance = bvh.itemBox(i).Distance(pntBox);
+            if (distance < nearestDistance) {
+                nearestItem = i;
+                nearestDistance = distance;
+            }
+
+            return nearestDistance;
+        }
+    );
+    QCOMPARE(nearestItem, 26);
+    QVERIFY(std::abs(nearestDistance - 0.2) < 1e-9);
+    QVERIFY(visitedCount < boxCount / 2);
+
+    // Nearest pair of items between two hierarchies, 2nd one being located after the 1st one
+    std::vector<Bnd_Box> vecBox2;
+    for (int i = 0; i < 10; ++i) {
+        Bnd_Box box;
+        box.Update(200 + i * 1.5, 0, 0, 200 + i * 1.5 + 1, 1, 1);
+        vecBox2.push_back(box);
+    }
+
+    const BoxBvh bvh2(vecBox2);
+    std::pair<int, int> nearestPair = { -1, -1 };
+    nearestDistance = std::numeric_limits<double>::max();
+    BoxBvh::visitNearestPairs(
+        bvh, bvh2,
+        [](const Bnd_Box& box1, const Bnd_Box& box2) { return box1.Distance(box2); },
+        [&](int i, int j) {
+            const double distance = bvh.itemBox(i).Distance(bvh2.itemBox(j));
+            if (distance < nearestDistance) {
+                nearestPair = { i, j };
+                nearestDistance = distance;
+            }
+
+            return nearestDistance;
+        }
+    );
+    QVERIFY(nearestPair == std::make_pair(boxCount - 1, 0));
+    QVERIFY(std::abs(nearestDistance - 50.5) < 1e-9);
+}
+
+void TestBase::SpatialIndex_test()
+{
+    // Unit cubes along X axis, separated by a gap of 0.5
+    auto fnCubeBox = [](int i) {
+        Bnd_Box box;
+        box.Update(i * 1.5, 0, 0, i * 1.5 + 1, 1, 1);
+        return box;
+    };
+
+    SpatialIndex<int> index;
+    const int cubeCount = 100;
+    for (int i = 0; i < cubeCount; ++i)
+        index.setItem(i, fnCubeBox(i));
+
+    QCOMPARE(index.itemCount(), cubeCount);
+    QCOMPARE(BndBoxCoords::get(index.boundingBox()).xmax, 149.5);
+    auto fnItems = [&](auto fnQuery) {
+        std::vector<int> vecItem;
+        fnQuery([&](int i) { vecItem.push_back(i); });
+        std::sort(vecItem.begin(), vecItem.end());
+        return vecItem;
+    };
+
+    // Plane x=15.25 crosses cube #10 only
+    const gp_Pln planeX(gp_Pnt(15.25, 0, 0), gp::DX());
+    QCOMPARE(fnItems([&](auto fn) { index.visitIntersecting(planeX, fn); }), std::vector<int>{ 10 });
+
+    // Half-spaces 3<x<6.2 contain cubes #2 #3 #4
+    const gp_Pln arrayPlane[] = { gp_Pln(gp_Pnt(3, 0, 0), gp::DX()), gp_Pln(gp_Pnt(6.2, 0, 0), -gp::DX()) };
+    QCOMPARE(fnItems([&](auto fn) { index.visitInside(arrayPlane, fn); }), (std::vector<int>{ 2, 3, 4 }));
+
+    // Ray along X axis coming from x=160 hits cube #99 first
+    const gp_Lin ray(gp_Pnt(160, 0.5, 0.5), -gp::DX());
+    QCOMPARE(index.findNearest(ray).value_or(-1), 99);
+
+    // Pending items(not yet in the hierarchy) must be tested the same way as BoxBvh items
+    {
+        SpatialIndex<int> pendingIndex;
+        std::vector<Bnd_Box> vecBox;
+        for (int i = 0; i < 10; ++i) {
+            pendingIndex.setItem(i, fnCubeBox(i));
+            vecBox.push_back(fnCubeBox(i));
+        }
+
+        const BoxBvh bvh(vecBox);
+        const gp_Pln planeTouch(gp_Pnt(2.5, 0, 0), gp::DX()); // Touches max face of cube #1
+        QCOMPARE(fnItems([&](auto fn) { pendingIndex.visitIntersecting(planeTouch, fn); }),
+                 fnItems([&](auto fn) { bvh.visitIntersecting(planeTouch, fn); }));
+        QCOMPARE(fnItems([&](auto fn) { pendingIndex.visitIntersecting(fnCubeBox(3), fn); }),
+                 fnItems([&](auto fn) { bvh.visitIntersecting(fnCubeBox(3), fn); }));
+        QCOMPARE(fnItems([&](auto fn) { pendingIndex.visitInside(arrayPlane, fn); }),
+                 fnItems([&](auto fn) { bvh.visitInside(arrayPlane, fn); }));
+        QCOMPARE(pendingIndex.findNearest(ray).value_or(-1), bvh.findNearest(ray));
+    }
+
+    // Incremental changes
+    index.removeItem(99);
+    QCOMPARE(index.findNearest(ray).value_or(-1), 98);
+    index.setItem(cubeCount, fnCubeBox(99)); // New item at location of cube #99
+    index.setItem(98, fnCubeBox(200)); // Move cube #98 behind the ray
+    QCOMPARE(index.itemCount(), cubeCount);
+    QCOMPARE(index.findNearest(ray).value_or(-1), cubeCount);
+    QCOMPARE(fnItems([&](auto fn) { index.visitIntersecting(fnCubeBox(99), fn); }), std::vector<int>{ cubeCount });
+    QCOMPARE(fnItems([&](auto fn) { index.visitIntersecting(fnCubeBox(200), fn); }), std::vector<int>{ 98 });
+
+    // Trigger a rebuild of the hierarchy, queries must give the same results
+    for (int i = 0; i < 50; ++i)
+        index.removeItem(i);
+
+    QCOMPARE(index.itemCount(), cubeCount - 50);
+    QCOMPARE(index.findNearest(ray).value_or(-1), cubeCount);
+    QVERIFY(fnItems([&](auto fn) { index.visitIntersecting(fnCubeBox(10), fn); }).empty());
+    QCOMPARE(fnItems([&](auto fn) { index.visitIntersecting(fnCubeBox(200), fn); }), std::vector<int>{ 98 });
+}
+
+void TestBase::AssemblyInstances_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Assembly with two instances of a box
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    const TDF_Label labelProduct = shapeTool->AddShape(BRepPrimAPI_MakeBox(10, 20, 30), false);
+    const TDF_Label labelAssembly = shapeTool->NewShape();
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec(100, 0, 0));
+    shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location());
+    shapeTool->AddComponent(labelAssembly, labelProduct, TopLoc_Location(trsf));
+    shapeTool->UpdateAssemblies();
+    doc->addEntityTreeNode(labelAssembly);
+    const Tree<TDF_Label>& modelTree = doc->modelTree();
+    const TreeNodeId entityId = doc->entityTreeNodeId(doc->entityCount() - 1);
+    const TreeNodeId ref1Id = modelTree.nodeChildFirst(entityId);
+
+    const AssemblyInstances allInstances = AssemblyInstances::collect(doc);
+    QCOMPARE(int(allInstances.instances().size()), 2);
+    QCOMPARE(allInstances.bvh().itemCount(), 2);
+
+    // Selecting a node along with its ancestor doesn't duplicate the instances
+    const TreeNodeId arrayNodeId[] = { ref1Id, entityId, ref1Id };
+    const AssemblyInstances instances = AssemblyInstances::collect(doc, arrayNodeId);
+    QCOMPARE(int(instances.instances().size()), 2);
+    QVERIFY(instances.instance(0).treeNodeId != instances.instance(1).treeNodeId);
+
+    // Selecting a single reference node
+    const AssemblyInstances refInstances = AssemblyInstances::collect(doc, Span<const TreeNodeId>(&ref1Id, 1));
+    QCOMPARE(int(refInstances.instances().size()), 1);
+    QCOMPARE(refInstances.instance(0).treeNodeId, ref1Id);
+}
+
+void TestBase::MassProperties_test()
+{
+    auto fnFuzzyCompareMat = [](const gp_Mat& lhs, const gp_Mat& rhs) {
+        for (int i = 1; i <= 3; ++i) {
+            for (int j = 1; j <= 3; ++j) {
+                if (std::abs(lhs.Value(i, j) - rhs.Value(i, j)) > 1e-9 * (1 + std::abs(rhs.Value(i, j))))
+                    return false;
+            }
+        }
+
+        return true;
+    };
+
+    const QuantityDensity density = 1000 * Quantity_KilogramPerCubicMeter;
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    const MassProperties boxProps = MassProperties::fromShape(shapeBox, density);
+    QCOMPARE(boxProps.volume.value(), 6000.);
+    QCOMPARE(boxProps.area.value(), 2200.);
+    QVERIFY(boxProps.centroid.IsEqual(gp_Pnt(5, 10, 15), Precision::Confusion()));
+    QVERIFY(boxProps.mass.has_value());
+    QCOMPARE(boxProps.mass->value(), 6e-3);
+    QVERIFY(!MassProperties::fromShape(shapeBox, QuantityDensity{0.}).mass.has_value());
+
+    // Properties of moved instances must match the ones computed on the moved shapes
+    gp_Trsf trsf;
+    trsf.SetRotation(gp_Ax1(gp::Origin(), gp::DZ()), UnitSystem::radians(30 * Quantity_Degree).value);
+    trsf.SetTranslationPart(gp_Vec(100, 0, 0));
+    const TopoDS_Shape shapeBoxMoved = shapeBox.Moved(trsf);
+    const MassProperties movedProps = boxProps.transformed(trsf);
+    const MassProperties movedBoxProps = MassProperties::fromShape(shapeBoxMoved, density);
+    QVERIFY(movedProps.centerOfMass.IsEqual(movedBoxProps.centerOfMass, Precision::Confusion()));
+    QVERIFY(fnFuzzyCompareMat(movedProps.inertia, movedBoxProps.inertia));
+
+    // Combined properties must match the ones of the compound
+    TopoDS_Compound shapeCompound;
+    BRep_Builder builder;
+    builder.MakeCompound(shapeCompound);
+    builder.Add(shapeCompound, shapeBox);
+    builder.Add(shapeCompound, shapeBoxMoved);
+    MassProperties sumProps = boxProps;
+    sumProps.add(movedProps);
+    const MassProperties compoundProps = MassProperties::fromShape(shapeCompound, density);
+    QCOMPARE(sumProps.volume.value(), compoundProps.volume.value());
+    QCOMPARE(sumProps.mass->value(), compoundProps.mass->value());
+    QVERIFY(sumProps.centroid.IsEqual(compoundProps.centroid, Precision::Confusion()));
+    QVERIFY(fnFuzzyCompareMat(sumProps.inertia, compoundProps.inertia));
+
+    // Cache: parts collected from OCAF are computed apart, entries are cleared per document
+    auto app = Application::instance();
+    DocumentPtr doc1 = app->newDocument();
+    DocumentPtr doc2 = app->newDocument();
+    auto _ = gsl::finally([=]{
+        app->closeDocument(doc1);
+        app->closeDocument(doc2);
+    });
+    const TDF_Label label1 = doc1->xcaf().shapeTool()->AddShape(shapeBox, false);
+    const TDF_Label label2 = doc2->xcaf().shapeTool()->AddShape(shapeBoxMoved, false);
+    MassPropertiesCache cache;
+    const MassPropertiesCache::PartsInput parts1 = cache.missingParts(label1);
+    QCOMPARE(int(parts1.vecLabel.size()), 1);
+    QVERIFY(!cache.find(label1));
+    QVERIFY(cache.computeParts(parts1));
+    QVERIFY(cache.missingParts(label1).vecLabel.empty());
+    QVERIFY(cache.find(label1).has_value());
+    QCOMPARE(cache.find(label1)->volume.value(), 6000.);
+    QVERIFY(cache.compute(label2).has_value());
+
+    cache.clear(doc1->GetData());
+    QVERIFY(!cache.find(label1));
+    QVERIFY(cache.find(label2).has_value());
+}
+
+void TestBase::ShapeFingerprint_test()
+{
+    gp_Trsf trsf;
+    trsf.SetRotation(gp_Ax1(gp_Pnt(5, 5, 5), gp_Dir(1, 1, 0)), UnitSystem::radians(40 * Quantity_Degree).value);
+    trsf.SetTranslationPart(gp_Vec(-50, 20, 100));
+    const double tolerance = 1e-6;
+    auto fnCheckTransformation = [&](const TopoDS_Shape& shape) {
+        const ShapeFingerprint fp = ShapeFingerprint::compute(shape);
+        const ShapeFingerprint fpMoved = ShapeFingerprint::compute(shape.Moved(trsf));
+        QVERIFY(fp.hasSameTopology(fpMoved));
+        QVERIFY(fp.hasSameMassProperties(fpMoved, 1e-6));
+        const std::optional<gp_Trsf> trsfFound = ShapeFingerprint::findTransformation(fp, fpMoved, tolerance);
+        QVERIFY(trsfFound.has_value());
+        // Shapes are symmetric so 'trsfFound' might differ from 'trsf', but centroids must match
+        QVERIFY(fp.centroid.Transformed(*trsfFound).IsEqual(fpMoved.centroid, 1e-6));
+    };
+
+    // Inertia has distinct principal moments
+    fnCheckTransformation(BRepPrimAPI_MakeBox(10, 20, 30));
+    // Inertia has rotational symmetry
+    fnCheckTransformation(BRepPrimAPI_MakeBox(10, 10, 30));
+    // Inertia is isotropic
+    fnCheckTransformation(BRepPrimAPI_MakeBox(10, 10, 10));
+
+    // Geometry with rotational symmetry, any transformation matching the shapes is fine
+    {
+        const TopoDS_Shape shapeCylinder = BRepPrimAPI_MakeCylinder(5, 20);
+        const ShapeFingerprint fp = ShapeFingerprint::compute(shapeCylinder);
+        const ShapeFingerprint fpMoved = ShapeFingerprint::compute(shapeCylinder.Moved(trsf));
+        QVERIFY(ShapeFingerprint::findTransformation(fp, fpMoved, tolerance).has_value());
+    }
+
+    // Different shapes
+    {
+        const ShapeFingerprint fp1 = ShapeFingerprint::compute(BRepPrimAPI_MakeBox(10, 20, 30));
+        const ShapeFingerprint fp2 = ShapeFingerprint::compute(BRepPrimAPI_MakeBox(10, 20, 31));
+        QVERIFY(fp1.hasSameTopology(fp2));
+        QVERIFY(!fp1.hasSameMassProperties(fp2, 1e-4));
+        QVERIFY(!ShapeFingerprint::findTransformation(fp1, fp2, tolerance).has_value());
+    }
+}
+
+void TestBase::PartDeduplication_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+
+    // Flattened assembly: two identical boxes(geometry already placed) separated by another part
+    gp_Trsf trsf;
+    trsf.SetRotation(gp_Ax1(gp::Origin(), gp::DZ()), UnitSystem::radians(90 * Quantity_Degree).value);
+    trsf.SetTranslationPart(gp_Vec(100, 0, 0));
+    const TopoDS_Shape shapeBox = BRepPrimAPI_MakeBox(10, 20, 30);
+    const TopoDS_Shape shapeBoxMoved = BRepBuilderAPI_Transform(shapeBox, trsf, true/*copy*/).Shape();
+    const TopoDS_Shape shapeCylinder = BRepPrimAPI_MakeCylinder(5, 20);
+
+    Handle_XCAFDoc_ShapeTool shapeTool = doc->xcaf().shapeTool();
+    Handle_XCAFDoc_ColorTool colorTool = doc->xcaf().colorTool();
+    const TDF_Label labelAssembly = shapeTool->NewShape();
+    const TDF_Label labelBox = shapeTool->AddShape(shapeBox, false);
+    const TDF_Label labelCylinder = shapeTool->AddShape(shapeCylinder, false);
+    const TDF_Label labelBoxMoved = shapeTool->AddShape(shapeBoxMoved, false);
+    for (const TDF_Label& label : { labelBox, labelBoxMoved })
+        colorTool->SetColor(label, Quantity_NOC_RED, XCAFDoc_ColorGen);
+
+    const TDF_Label component1 = shapeTool->AddComponent(labelAssembly, labelBox, TopLoc_Location());
+    const TDF_Label component2 = shapeTool->AddComponent(labelAssembly, labelCylinder, TopLoc_Location());
+    const TDF_Label component3 = shapeTool->AddComponent(labelAssembly, labelBoxMoved, TopLoc_Location());
+    colorTool->SetColor(component3, Quantity_NOC_BLUE1, XCAFDoc_ColorSurf);
+    doc->xcaf().layerTool()->SetLayer(component3, TCollection_ExtendedString("Layer"));
+    shapeTool->UpdateAssemblies();
+
+    const PartDeduplication::Result result = PartDeduplication::run(labelAssembly);
+    QCOMPARE(result.partCount, 3);
+    QCOMPARE(result.mergedPartCount, 1);
+    QVERIFY(!labelBoxMoved.IsAttribute(TNaming_NamedShape::GetID()));
+
+    // Components are kept in place, the third one now refers to the first box
+    const TDF_LabelSequence seqComponent = XCaf::shapeComponents(labelAssembly);
+    QCOMPARE(seqComponent.Size(), 3);
+    QVERIFY(seqComponent.Value(1) == component1);
+    QVERIFY(seqComponent.Value(2) == component2);
+    QVERIFY(seqComponent.Value(3) == component3);
+    QVERIFY(XCaf::shapeReferred(component1) == labelBox);
+    QVERIFY(XCaf::shapeReferred(component2) == labelCylinder);
+    QVERIFY(XCaf::shapeReferred(component3) == labelBox);
+
+    // Geometry of the instance is unchanged(box is symmetric, so its location may differ from 'trsf')
+    const ShapeFingerprint fpBoxMoved = ShapeFingerprint::compute(shapeBoxMoved);
+    const ShapeFingerprint fpComponent3 = ShapeFingerprint::compute(XCaf::shape(component3));
+    QVERIFY(fpComponent3.centroid.IsEqual(fpBoxMoved.centroid, 1e-6));
+    for (const gp_Pnt& pnt : fpComponent3.vertices) {
+        const bool isFound = std::any_of(fpBoxMoved.vertices.cbegin(), fpBoxMoved.vertices.cend(), [&](const gp_Pnt& other) {
+            return other.IsEqual(pnt, 1e-6);
+        });
+        QVERIFY(isFound);
+    }
+
+    // Attributes of the component are kept
+    Quantity_Color color;
+    QVERIFY(colorTool->GetColor(component3, XCAFDoc_ColorSurf, color));
+    QCOMPARE(color, Quantity_Color(Quantity_NOC_BLUE1));
+    QVERIFY(colorTool->GetColor(labelBox, XCAFDoc_ColorGen, color));
+    QCOMPARE(color, Quantity_Color(Quantity_NOC_RED));
+    QCOMPARE(doc->xcaf().layers(component3).Size(), 1);
+}
+
 void TestBase::Enumeration_test()
 {
     enum class TestBase_Enum1 { Value0, Value1, Value2, Value3, Value4 };
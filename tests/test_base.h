@@ -18,6 +18,8 @@ class TestBase : public QObject {
 private slots:
     void Application_test();
     void DocumentRefCount_test();
+    void DocumentScratch_test();
+    void ApplicationItemSelectionModel_test();
 
     void CppUtils_toggle_test();
     void CppUtils_safeStaticCast_test();
@@ -38,10 +40,13 @@ private slots:
     void IO_OccStaticVariablesRollback_test_data();
     void IO_bugGitHub166_test();
     void IO_bugGitHub166_test_data();
+    void IO_OccStlReader_previewMesh_test();
+    void IO_OccStlReader_previewMesh_test_data();
 
     void DoubleToString_test();
 
     void BRepUtils_test();
+    void BRepMeshLevels_test();
 
     void CafUtils_test();
 
@@ -49,6 +54,19 @@ private slots:
     void MeshUtils_test_data();
     void MeshUtils_orientation_test();
     void MeshUtils_orientation_test_data();
+    void MeshUtils_trianglesIntersect_test();
+    void MeshUtils_cleanup_test();
+    void MeshUtils_sampledMesh_test();
+    void MeshDecimation_test();
+    void MeshAccess_visitMeshInstances_test();
+
+    void PointCloudOctree_test();
+    void BoxBvh_test();
+    void SpatialIndex_test();
+    void AssemblyInstances_test();
+    void MassProperties_test();
+    void ShapeFingerprint_test();
+    void PartDeduplication_test();
 
     void Enumeration_test();
     void MetaEnum_test();
@@ -6,14 +6,22 @@
 
 #include "test_measure.h"
 
+#include "../src/base/application.h"
+#include "../src/base/document.h"
 #include "../src/base/geom_utils.h"
+#include "../src/base/mesh_utils.h"
+#include "../src/base/task_manager.h"
+#include "../src/base/tkernel_utils.h"
 #include "../src/base/unit_system.h"
+#include "../src/measure/interference_analysis.h"
 #include "../src/measure/measure_tool_brep.h"
+#include "../src/measure/measure_tool_mesh.h"
 
 #include <BRep_Builder.hxx>
 #include <BRepAdaptor_Curve.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
 #include <BRepPrimAPI_MakeBox.hxx>
 #include <Geom_BSplineCurve.hxx>
 #include <GeomConvert_ApproxCurve.hxx>
@@ -21,8 +29,11 @@
 #include <GC_MakeEllipse.hxx>
 #include <TopoDS_Edge.hxx>
 #include <TopoDS_Vertex.hxx>
+#include <XCAFDoc_ShapeTool.hxx>
 
 #include <QtCore/QtDebug>
+#include <gsl/util>
+#include <algorithm>
 #include <cmath>
 
 namespace Mayo {
@@ -44,6 +55,31 @@ TopoDS_Edge makePolygonEdge(const TColgp_Array1OfPnt& points)
     return edge;
 }
 
+// Triangulation of square [0, size]x[0, size] in plane Z=0, made of 2*cellCount*cellCount triangles
+Handle_Poly_Triangulation makeGridMesh(double size, int cellCount)
+{
+    const int rowNodeCount = cellCount + 1;
+    Handle_Poly_Triangulation mesh = new Poly_Triangulation(rowNodeCount * rowNodeCount, 2 * cellCount * cellCount, false);
+    for (int i = 0; i < rowNodeCount; ++i) {
+        for (int j = 0; j < rowNodeCount; ++j) {
+            const gp_Pnt pnt(i * size / cellCount, j * size / cellCount, 0);
+            MeshUtils::setNode(mesh, 1 + i * rowNodeCount + j, pnt);
+        }
+    }
+
+    int iTriangle = 1;
+    for (int i = 0; i < cellCount; ++i) {
+        for (int j = 0; j < cellCount; ++j) {
+            const int n1 = 1 + i * rowNodeCount + j;
+            const int n2 = n1 + rowNodeCount;
+            MeshUtils::setTriangle(mesh, iTriangle++, Poly_Triangle(n1, n2, n2 + 1));
+            MeshUtils::setTriangle(mesh, iTriangle++, Poly_Triangle(n1, n2 + 1, n1 + 1));
+        }
+    }
+
+    return mesh;
+}
+
 } // namespace
 
 void TestMeasure::BRepVertexPosition_test()
@@ -142,6 +178,30 @@ void TestMeasure::BRepMinDistance_TwoBoxes_test()
     QCOMPARE(UnitSystem::millimeters(minDist.value).value, minDist.pnt1.Distance(minDist.pnt2));
 }
 
+void TestMeasure::BRepMinDistance_Abort_test()
+{
+#if OCC_VERSION_HEX >= OCC_VERSION_CHECK(7, 6, 0)
+    const TopoDS_Shape shape1 = BRepPrimAPI_MakeBox(gp_Pnt{ 5, 5, 5 }, gp_Pnt{ 20, 7, 7 });
+    const TopoDS_Shape shape2 = BRepPrimAPI_MakeBox(gp_Pnt{ 40, 5, 5 }, gp_Pnt{ 55, 7, 7 });
+    TaskManager taskMgr;
+    bool isInterrupted = false;
+    const TaskId taskId = taskMgr.newTask([&](TaskProgress* progress) {
+        try {
+            MeasureToolBRep::brepMinDistance(shape1, shape2, progress);
+        } catch (const IMeasureError&) {
+            isInterrupted = true;
+        }
+    });
+
+    // Abort is requested before the task is executed, computation has to stop immediately
+    taskMgr.requestAbort(taskId);
+    taskMgr.exec(taskId);
+    QVERIFY(isInterrupted);
+#else
+    QSKIP("Interruption of minimum distance computation requires OpenCascade >= 7.6");
+#endif
+}
+
 void TestMeasure::BRepAngle_TwoLinesIntersect_test()
 {
     const TopoDS_Shape shape1 = BRepBuilderAPI_MakeEdge(gp_Lin(gp::Origin(), gp::DX()));
@@ -171,4 +231,65 @@ void TestMeasure::BRepLength_PolygonEdge_test()
     QCOMPARE(UnitSystem::millimeters(len).value, 24.);
 }
 
+void TestMeasure::MeshMinDistance_TwoGrids_test()
+{
+    const Handle_Poly_Triangulation mesh = makeGridMesh(10., 30);
+    gp_Trsf trsf2;
+    trsf2.SetTranslation(gp_Vec{ 3, 4, 7 });
+    const MeasureMinDistance minDist = MeasureToolMesh::meshMinDistance(mesh, gp_Trsf(), mesh, trsf2);
+    QCOMPARE(UnitSystem::millimeters(minDist.value).value, 7.);
+    QVERIFY(std::abs(minDist.pnt1.Z()) < Precision::Confusion());
+    QVERIFY(std::abs(minDist.pnt2.Z() - 7.) < Precision::Confusion());
+
+    // Grids crossing each other
+    gp_Trsf trsf3;
+    trsf3.SetRotation(gp::OX(), UnitSystem::radians(90. * Quantity_Degree).value);
+    trsf3.SetTranslationPart(gp_Vec{ 0, 5, -5 });
+    const MeasureMinDistance minDistCross = MeasureToolMesh::meshMinDistance(mesh, gp_Trsf(), mesh, trsf3);
+    QVERIFY(UnitSystem::millimeters(minDistCross.value).value < Precision::Confusion());
+}
+
+void TestMeasure::MeshMinDistance_Point_test()
+{
+    const Handle_Poly_Triangulation mesh = makeGridMesh(10., 30);
+    gp_Trsf trsf;
+    trsf.SetTranslation(gp_Vec{ 0, 0, 2 });
+    const MeasureMinDistance minDist = MeasureToolMesh::meshMinDistance(mesh, trsf, gp_Pnt{ 4.2, 6.1, -3 });
+    QCOMPARE(UnitSystem::millimeters(minDist.value).value, 5.);
+    QVERIFY(minDist.pnt1.IsEqual(gp_Pnt{ 4.2, 6.1, 2 }, Precision::Confusion()));
+
+    // Point outside of the grid
+    const MeasureMinDistance minDistOut = MeasureToolMesh::meshMinDistance(mesh, gp_Trsf(), gp_Pnt{ 13, 14, 0 });
+    QCOMPARE(UnitSystem::millimeters(minDistOut.value).value, 5.);
+    QVERIFY(minDistOut.pnt1.IsEqual(gp_Pnt{ 10, 10, 0 }, Precision::Confusion()));
+}
+
+void TestMeasure::InterferenceAnalysis_BoxInsideBox_test()
+{
+    auto app = Application::instance();
+    DocumentPtr doc = app->newDocument();
+    auto _ = gsl::finally([=]{ app->closeDocument(doc); });
+    auto fnAddBox = [&](const gp_Pnt& pntMin, double size) {
+        const TopoDS_Shape box = BRepPrimAPI_MakeBox(pntMin, size, size, size);
+        BRepMesh_IncrementalMesh(box, 0.1);
+        const TDF_Label label = doc->xcaf().shapeTool()->AddShape(box, false);
+        doc->addEntityTreeNode(label);
+        return doc->entityTreeNodeId(doc->entityCount() - 1);
+    };
+
+    // Boxes are concentric: a ray cast along an axis from a corner of the inner box goes through
+    // the diagonal edge shared by two triangles of an outer box face
+    const TreeNodeId outerNodeId = fnAddBox(gp_Pnt(0, 0, 0), 10);
+    const TreeNodeId innerNodeId = fnAddBox(gp_Pnt(2, 2, 2), 6);
+    InterferenceAnalysis analysis;
+    analysis.run(doc);
+    QCOMPARE(analysis.candidatePairCount(), 1);
+    QCOMPARE(analysis.uncheckedPairCount(), 0);
+    QCOMPARE(analysis.results().size(), size_t(1));
+    const InterferenceAnalysis::Result& result = analysis.results().front();
+    QCOMPARE(result.type, InterferenceAnalysis::Type::Inclusion);
+    QCOMPARE(result.treeNodeId1, std::min(outerNodeId, innerNodeId));
+    QCOMPARE(result.treeNodeId2, std::max(outerNodeId, innerNodeId));
+}
+
 } // namespace Mayo
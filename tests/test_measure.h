@@ -23,11 +23,17 @@ private slots:
 
     void BRepMinDistance_TwoPoints_test();
     void BRepMinDistance_TwoBoxes_test();
+    void BRepMinDistance_Abort_test();
 
     void BRepAngle_TwoLinesIntersect_test();
     void BRepAngle_TwoLinesParallelError_test();
 
     void BRepLength_PolygonEdge_test();
+
+    void MeshMinDistance_TwoGrids_test();
+    void MeshMinDistance_Point_test();
+
+    void InterferenceAnalysis_BoxInsideBox_test();
 };
 
 } // namespace Mayo